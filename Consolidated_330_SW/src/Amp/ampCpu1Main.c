@@ -0,0 +1,46 @@
+//*****************************************************************************
+// Program for CPU1 in AMP mode (see supportFiles/amp.h): draws on the LCD and
+// runs the TicTacToe AI search for CPU0. Build it as its own application on a
+// ps7_cortexa9_1 BSP (with -DUSE_AMP=1), linked at AMP_CPU1_START_ADDRESS.
+//*****************************************************************************
+
+#include <string.h>
+#include "supportFiles/amp.h"
+#include "supportFiles/display.h"
+#include "supportFiles/globalTimer.h"
+#include "TicTacToe/minimax.h"
+#include "TicTacToe/ticTacToeAmp.h"
+
+static minimax_search_t search;  // Kept out of the stack, it holds the transposition table.
+
+// CPU0 starts the global timer; both CPUs can read it.
+static uint64_t ampCpu1_readClock() {
+  return globalTimer_getTimerValue();
+}
+
+// Carries out one request from CPU0.
+static void ampCpu1_handleMessage(const ampRing_message_t* message) {
+  switch (message->type) {
+    case AMP_MESSAGE_DISPLAY_COMMAND:  // CPU0 queued it (display_enableAmpRendering()).
+      display_runAmpCommand(message);
+      break;
+    case TICTACTOEAMP_SEARCH_REQUEST: {
+      ticTacToeAmp_searchRequest_t request;
+      ticTacToeAmp_searchResult_t result;
+      memcpy(&request, message->payload, sizeof(request));
+      uint64_t deadline = ampCpu1_readClock() + (uint64_t) request.searchMs * (GLOBAL_TIMER_TICKS_PER_SECOND / 1000);
+      // The table lookup is as fast as sending the request, so CPU0 only asks for positions that need a search.
+      minimax_searchNextMove(&search, &request.board, request.player, ampCpu1_readClock, deadline,
+                             &result.row, &result.column);
+      amp_cpu1Reply(TICTACTOEAMP_SEARCH_RESULT, &result, sizeof(result));
+      break;
+    }
+    default:
+      break;  // Unknown request, ignore it.
+  }
+}
+
+int main() {
+  amp_cpu1Run(ampCpu1_handleMessage);
+  return 0;
+}
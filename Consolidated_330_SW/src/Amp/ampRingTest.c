@@ -0,0 +1,266 @@
+//*****************************************************************************
+// Host test of the AMP message rings (supportFiles/ampRing.c, amp.c), with
+// CPU1 played by a thread (halSim.c): a stress test of one ring, searches done
+// by CPU1, and a scene drawn by CPU1 from CPU0's display command queue
+// (display_enableAmpRendering()), compared pixel by pixel with the same scene
+// drawn directly by CPU0. Build and run under ThreadSanitizer with "make" in
+// this directory.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "supportFiles/amp.h"
+#include "supportFiles/ampRing.h"
+#include "supportFiles/display.h"
+#include "supportFiles/displayQueue.h"
+#include "supportFiles/halSim.h"
+#include "TicTacToe/minimax.h"
+#include "TicTacToe/ticTacToeAmp.h"
+
+#define STRESS_MESSAGES 200000   // Pushed through one ring by two threads.
+#define SEARCH_REQUESTS 200      // Searches done by the CPU1 thread.
+#define SCENE_SHAPES 600         // Drawing calls in the scene CPU1 draws.
+#define SCENE_FLUSH_SHAPES 32    // The scene waits for CPU1 this often, so the queue never fills up.
+
+static ampRing_t stressRing;
+static uint32_t producerFullCount = 0;  // Times the producer found the ring full (producer only).
+
+// Payload byte i of message n.
+static uint8_t stressByte(uint32_t n, uint32_t i) {
+  return (uint8_t) (n * 7 + i);
+}
+
+static void *stressProducer(void *unused) {
+  ampRing_message_t message;
+  uint32_t n, i;
+  for (n = 0; n < STRESS_MESSAGES; n++) {
+    message.type = n;
+    for (i = 0; i < AMPRING_PAYLOAD_BYTES; i++) {
+      message.payload[i] = stressByte(n, i);
+    }
+    while (!ampRing_push(&stressRing, &message)) {
+      producerFullCount++;
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+// Pushes messages from one thread and checks on this one that every message arrives once,
+// in order and intact.
+static uint32_t runStressTest() {
+  pthread_t producer;
+  ampRing_message_t message;
+  uint32_t n, i, errors = 0, emptyCount = 0;
+  ampRing_init(&stressRing);
+  pthread_create(&producer, NULL, stressProducer, NULL);
+  for (n = 0; n < STRESS_MESSAGES; n++) {
+    while (!ampRing_pop(&stressRing, &message)) {
+      emptyCount++;
+      sched_yield();
+    }
+    bool intact = (message.type == n);
+    for (i = 0; i < AMPRING_PAYLOAD_BYTES; i++) {
+      intact &= (message.payload[i] == stressByte(n, i));
+    }
+    if (!intact && (errors++ < 10)) {
+      printf("message %lu: got type %lu or a damaged payload\n", (unsigned long) n, (unsigned long) message.type);
+    }
+  }
+  pthread_join(producer, NULL);
+  printf("stress: %d messages, %lu errors, ring full %lu times, empty %lu times\n", STRESS_MESSAGES,
+         (unsigned long) errors, (unsigned long) producerFullCount, (unsigned long) emptyCount);
+  return errors;
+}
+
+static minimax_search_t cpu1Search;
+
+// Stands in for ampCpu1Main.c: draws and runs the searches CPU0 asks for.
+static void cpu1Handler(const ampRing_message_t* message) {
+  if (message->type == AMP_MESSAGE_DISPLAY_COMMAND) {
+    display_runAmpCommand(message);
+  }
+  else if (message->type == TICTACTOEAMP_SEARCH_REQUEST) {
+    ticTacToeAmp_searchRequest_t request;
+    ticTacToeAmp_searchResult_t result;
+    memcpy(&request, message->payload, sizeof(request));
+    minimax_searchNextMove(&cpu1Search, &request.board, request.player, NULL, 0, &result.row, &result.column);
+    amp_cpu1Reply(TICTACTOEAMP_SEARCH_RESULT, &result, sizeof(result));
+  }
+}
+
+static void cpu1Main() {
+  amp_cpu1Run(cpu1Handler);
+}
+
+// Stops the CPU1 thread and waits until it has let go of the rings.
+static void stopCpu1() {
+  ampRing_message_t message;
+  while (!amp_send(AMP_MESSAGE_STOP, NULL, 0)) {
+    sched_yield();
+  }
+  while (!amp_receive(&message) || (message.type != AMP_MESSAGE_STOPPED)) {
+    sched_yield();
+  }
+}
+
+// Sends search requests to the CPU1 thread a few at a time and checks its moves against
+// searches on this thread.
+static uint32_t runSearchTest() {
+  static minimax_search_t search;
+  minimax_board_t boards[SEARCH_REQUESTS];
+  uint32_t sent = 0, received = 0, errors = 0, i;
+  // Boards with a few pieces on them, different ones each time.
+  for (i = 0; i < SEARCH_REQUESTS; i++) {
+    minimax_initBoard(&boards[i]);
+    boards[i].squares[(i / MINIMAX_BOARD_COLUMNS) % MINIMAX_BOARD_ROWS][i % MINIMAX_BOARD_COLUMNS] = MINIMAX_PLAYER_SQUARE;
+    boards[i].squares[((i / 3) / MINIMAX_BOARD_COLUMNS) % MINIMAX_BOARD_ROWS][(i / 3 + 1) % MINIMAX_BOARD_COLUMNS] =
+      MINIMAX_OPPONENT_SQUARE;
+  }
+  amp_init(cpu1Main);
+  while (received < SEARCH_REQUESTS) {
+    if (sent < SEARCH_REQUESTS) {
+      ticTacToeAmp_searchRequest_t request;
+      request.board = boards[sent];
+      request.player = sent & 1;
+      request.searchMs = 0;
+      if (amp_send(TICTACTOEAMP_SEARCH_REQUEST, &request, sizeof(request))) {
+        sent++;
+      }
+    }
+    ampRing_message_t message;
+    if (!amp_receive(&message)) {
+      sched_yield();
+    }
+    else if (message.type == TICTACTOEAMP_SEARCH_RESULT) {
+      ticTacToeAmp_searchResult_t result;
+      uint8_t row, column;
+      memcpy(&result, message.payload, sizeof(result));
+      minimax_searchNextMove(&search, &boards[received], received & 1, NULL, 0, &row, &column);
+      if ((result.row != row) || (result.column != column)) {
+        errors++;
+        printf("search %lu: CPU1 found (%d, %d) instead of (%d, %d)\n", (unsigned long) received, result.row,
+               result.column, row, column);
+      }
+      received++;
+    }
+  }
+  // A payload longer than a slot is refused, not cut short.
+  uint8_t oversize[AMPRING_PAYLOAD_BYTES + 1] = {0};
+  if (amp_send(AMP_MESSAGE_USER, oversize, sizeof(oversize))) {
+    errors++;
+    printf("search: a %d-byte payload was sent\n", (int) sizeof(oversize));
+  }
+  stopCpu1();
+  printf("search: %d requests, %lu errors\n", SEARCH_REQUESTS, (unsigned long) errors);
+  return errors;
+}
+
+static const uint8_t sceneBitmap[] = {0x3C, 0x42, 0xA5, 0x81, 0xA5, 0x99, 0x42, 0x3C};  // 8x8.
+static uint16_t directPixels[HALSIM_LCD_HEIGHT][HALSIM_LCD_WIDTH];  // The scene drawn by CPU0.
+
+// Draws the same shapes, text and rotations each time, running the queue the way the mains do
+// between ticks.
+static void drawScene() {
+  display_setRotation(1);
+  display_fillScreen(DISPLAY_BLACK);
+  display_setTextWrap(true);
+  for (uint32_t i = 0; i < SCENE_SHAPES; i++) {
+    int16_t x = (int16_t) ((i * 37) % 340) - 10;
+    int16_t y = (int16_t) ((i * 53) % 260) - 10;
+    int16_t size = 4 + (i * 7) % 40;
+    uint16_t color = (uint16_t) ((i + 1) * 40503u);
+    switch (i % 10) {
+    case 0:
+      display_fillRect(x, y, size, size / 2, color);
+      break;
+    case 1:
+      display_drawLine(x, y, x + size, y - size / 3, color);
+      break;
+    case 2:
+      display_fillCircle(x, y, size / 3, color);
+      break;
+    case 3:
+      display_fillTriangle(x, y, x + size, y + size / 2, x - size / 4, y + size, color);
+      break;
+    case 4:
+      display_drawRoundRect(x, y, size, size, size / 5, color);
+      break;
+    case 5:
+      display_drawChar(x, y, 'A' + i % 26, color, DISPLAY_BLACK, 1 + i % 3);
+      break;
+    case 6:
+      display_drawBitmap(x, y, sceneBitmap, 8, 8, color);
+      break;
+    case 7:
+      display_drawThickLine(x, y, x - size, y + size, 1 + i % 5, color);
+      break;
+    case 8:
+      display_setCursor(x, y);
+      display_setTextColor(color, (i % 20 < 10) ? color : DISPLAY_BLUE);
+      display_setTextSize(1 + i % 3);
+      display_println("AMP text that wraps");
+      break;
+    case 9:
+      display_drawCircle(x, y, size / 2, color);
+      break;
+    }
+    if (i == SCENE_SHAPES / 3)
+      display_setRotation(3);  // Upside down for a third of the scene.
+    if (i == 2 * SCENE_SHAPES / 3)
+      display_setRotation(1);
+    if (i % SCENE_FLUSH_SHAPES == 0)
+      display_flush();
+    else
+      display_drainQueue(DISPLAY_DRAIN_BUDGET_US);
+  }
+  display_flush();
+}
+
+// Draws the scene straight to the LCD on this thread, then hands the LCD to the CPU1 thread,
+// sends it the same scene through the command queue and compares the two.
+static uint32_t runDisplayTest() {
+  uint32_t wrong = 0, errors = 0;
+  display_init();
+  display_enableCommandQueue(false);
+  drawScene();
+  for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++) {
+    for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++) {
+      directPixels[y][x] = halSim_lcdReadPixel(x, y);
+    }
+  }
+  display_fillScreen(DISPLAY_RED);  // So that a scene CPU1 never drew shows up.
+
+  display_enableCommandQueue(true);  // Starts the global timer while CPU0 still owns the hardware.
+  amp_init(cpu1Main);
+  display_enableAmpRendering();
+  uint32_t enqueued = displayQueue_getEnqueuedCount();
+  drawScene();
+  uint32_t sent = displayQueue_getEnqueuedCount() - enqueued;
+  // CPU1 has drawn everything once it has seen the stop message, which comes after the scene.
+  stopCpu1();
+  for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++) {
+    for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++) {
+      wrong += halSim_lcdReadPixel(x, y) != directPixels[y][x];
+    }
+  }
+  if (wrong) {
+    errors++;
+    printf("display: %lu pixels differ from the direct render\n", (unsigned long) wrong);
+  }
+  if (displayQueue_getDroppedCount()) {
+    errors++;
+    printf("display: %lu commands dropped\n", (unsigned long) displayQueue_getDroppedCount());
+  }
+  printf("display: %d shapes, %lu commands drawn by CPU1, %lu errors\n", SCENE_SHAPES, (unsigned long) sent,
+         (unsigned long) errors);
+  return errors;
+}
+
+int main() {
+  uint32_t errors = runStressTest() + runSearchTest() + runDisplayTest();
+  printf("%s\n", errors ? "FAILED" : "passed");
+  return errors ? 1 : 0;
+}
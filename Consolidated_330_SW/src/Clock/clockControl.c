@@ -14,7 +14,7 @@ enum clockControl_st {
   init_st,                // Start here, stay in this state for just one tick.
   never_touched_st,       // Wait for first touch - clock is disabled until set.
   waiting_for_touch_st,    // waiting for touch, clock is enabled and running.
-  ad_timer_running_st,    // waiting for the touch-controller ADC to settle.
+  touch_settling_st,      // waiting for the touch filter to settle on the point.
   auto_timer_running_st,  // waiting for the auto-update delay to expire
                               // (user is holding down button for auto-inc/dec)
   rate_timer_running_st,  // waiting for the rate-timer to expire to know when
@@ -24,7 +24,6 @@ enum clockControl_st {
 } currentState = init_st; // Initialize to init_st
 
 // Global variables representing the timers that will be used
-static uint32_t adTimer = 0;   // Time to wait for touch-controller ADC to settle.
 static uint32_t autoTimer = 0; // Time before auto-updating when user holds button
 static uint32_t rateTimer = 0; // Time between auto inc/dec calls
 static uint32_t msCounter = 0; // Time between normal second updates
@@ -54,8 +53,8 @@ void clockControl_debugStatePrint() {
       case waiting_for_touch_st:
         printf("waiting_for_touch_st\n\r");
         break;
-      case ad_timer_running_st:
-        printf("ad_timer_running_st\n\r");
+      case touch_settling_st:
+        printf("touch_settling_st\n\r");
         break;
       case auto_timer_running_st:
         printf("auto_timer_running_st\n\r");
@@ -76,6 +75,13 @@ void clockControl_debugStatePrint() {
   }
 }
 
+// True once the touch filter has settled on the touched point.
+static bool clockControl_isTouchStable() {
+  int16_t x, y;
+  uint8_t pressure;
+  return display_getStableTouchedPoint(&x, &y, &pressure);
+}
+
 void clockControl_tick() {
   // Print out state changes for reference
   //clockControl_debugStatePrint();
@@ -89,13 +95,11 @@ void clockControl_tick() {
     case never_touched_st:
       break;  // Do nothing in never_touched_st
     case waiting_for_touch_st:  // reset all of the timers
-      adTimer = 1;
       autoTimer = 1;
       rateTimer = 1;
       msCounter++;  // increment msCounter while waiting
       break;
-    case ad_timer_running_st: // increment adTimer
-      adTimer++;
+    case touch_settling_st:
       msCounter = 1;  // reset the second advancement counter
       break;
     case auto_timer_running_st: //increment autoTimer
@@ -140,7 +144,7 @@ void clockControl_tick() {
     case waiting_for_touch_st:
       // If the display is touched, move on to next state
       if (display_isTouched()) {
-        currentState = ad_timer_running_st;
+        currentState = touch_settling_st;
         display_clearOldTouchData();  // clear old touch data for fresh start
       }
       // Otherwise, if a second of time has passed, increment a second
@@ -153,19 +157,21 @@ void clockControl_tick() {
         currentState = waiting_for_touch_st;
       }
       break;
-    case ad_timer_running_st:
-      // if the display is only tapped, inc/dec once
-      if (!display_isTouched() && adTimer >= CLOCKCONTROL_ADC_WAIT) {
+    case touch_settling_st:
+      // if the display is only tapped, inc/dec once (unless the tap was too light
+      // or short for the touch filter to settle on a point)
+      if (!display_isTouched()) {
         currentState = waiting_for_touch_st;
-        clockDisplay_performIncDec(); // just inc/dec once based on touch
+        if (clockControl_isTouchStable())
+          clockDisplay_performIncDec(); // just inc/dec once based on touch
       }
-      // if they are still holding it after the ADC settles, move to auto_timer
-      else if (display_isTouched() && adTimer >= CLOCKCONTROL_ADC_WAIT) {
+      // if they are still holding it after the filter settles, move to auto_timer
+      else if (clockControl_isTouchStable()) {
         currentState = auto_timer_running_st;
       }
       // Otherwise, stay in this state
       else {
-        currentState = ad_timer_running_st;
+        currentState = touch_settling_st;
       }
       break;
     case auto_timer_running_st:
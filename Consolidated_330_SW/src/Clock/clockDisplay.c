@@ -6,11 +6,11 @@
 
 #include <stdio.h>
 #include <stdbool.h>
-#include <string.h>
 #include "clockDisplay.h"
 #include "xparameters.h"
 #include "supportFiles/display.h"
 #include "supportFiles/utils.h"
+#include "supportFiles/ui.h"
 
 /////////////////////////////////////////////////////////////////////////
 // Global variables for tracking time                                  //
@@ -23,8 +23,10 @@ static int8_t seconds = 0;  // track seconds
 // char array representing the current time
 static char current_time[CLOCKDISPLAY_NUM_CHARS];
 
-// char array representing the previous time
-static char old_time[CLOCKDISPLAY_NUM_CHARS];
+// The widgets of the clock: the six arrows (regions 0-5) and the characters of
+// "HH:MM:SS". Each character only repaints the dots that changed (see ui.h).
+static ui_widget_t arrows[CLOCKDISPLAY_NUM_ARROWS];
+static ui_widget_t characters[CLOCKDISPLAY_NUM_CHARS - 1];
 
 ////////////////////////////////////////////////////////////////////
 // Global variables (calculated in init()) used to draw the clock //
@@ -102,74 +104,6 @@ int8_t clockDisplay_getInputRegion(int16_t x, int16_t y) {
   return CLOCKDISPLAY_REGION_ERR;
 }
 
-/**
- * Draws the specified character at the specified location on the screen
- * @param index The column index of the clock to draw the character at
- * @param c     The character to draw
- */
-void clockDisplay_redrawDigit(uint8_t index, char c) {
-
-  // Draw the character based on the index
-  switch (index) {
-    case CLOCKDISPLAY_TENS_HRS:   // Tens-digit for Hours
-      display_drawChar( col[0],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    case CLOCKDISPLAY_ONES_HRS:   // Ones-digit for Hours
-      display_drawChar( col[1],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    case CLOCKDISPLAY_COLON_1:   // First ':', do nothing
-      break;
-    case CLOCKDISPLAY_TENS_MINS:   // Tens-digit for Mins
-      display_drawChar( col[3],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    case CLOCKDISPLAY_ONES_MINS:   // Ones-digit for Mins
-      display_drawChar( col[4],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    case CLOCKDISPLAY_COLON_2:   // 2nd ':', do nothing
-      break;
-    case CLOCKDISPLAY_TENS_SECS:   // Tens-digit for Secs
-      display_drawChar( col[6],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    case CLOCKDISPLAY_ONES_SECS:   // Ones-digit for Secs
-      display_drawChar( col[7],                         // x
-                        row[1] + CLOCKDISPLAY_BUFFER,   // y
-                        c,                              // char to draw
-                        DISPLAY_GREEN,                  // color of text
-                        DISPLAY_BLACK,                  // color of background
-                        CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-      break;
-    default:  // Otherwise, do nothing
-      break;
-  }
-
-
-}
-
 /**
  * Helper function that draws the lines representing the borders of each of
  * the sub boxes. Used for visually verifying the macro calculations.
@@ -195,80 +129,48 @@ void clockDisplay_drawLines() {
 
 
 /**
- * Helpter funtion that simply draws all of the initial components of the
- * display that do not change (e.g. arrows and colons).
+ * Helper function that adds the widgets of the display: the arrows, which
+ * never change, and one character widget per character of the time.
  */
-void clockDisplay_initDraw() {
-  // Draw all of the user-input triangles:
-  // Draw Hour Up Triangle
-  display_fillTriangle( col[0],                 // x0
-                        row[1],                 // y0
-                        col[2],                 // x1
-                        row[1],                 // y1
-                        col[1],                 // x2
-                        row[0] + arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw Minute Up Triangle
-  display_fillTriangle( col[3],                 // x0
-                        row[1],                 // y0
-                        col[5],                 // x1
-                        row[1],                 // y1
-                        col[4],                 // x2
-                        row[0] + arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw Second Up Triangle
-  display_fillTriangle( col[6],                 // x0
-                        row[1],                 // y0
-                        col[8],                 // x1
-                        row[1],                 // y1
-                        col[7],                 // x2
-                        row[0] + arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw Hours Down Triangle
-  display_fillTriangle( col[0],                 // x0
-                        row[2],                 // y0
-                        col[2],                 // x1
-                        row[2],                 // y1
-                        col[1],                 // x2
-                        row[3] - arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw Minute Down Triangle
-  display_fillTriangle( col[3],                 // x0
-                        row[2],                 // y0
-                        col[5],                 // x1
-                        row[2],                 // y1
-                        col[4],                 // x2
-                        row[3] - arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw Second Down Triangle
-  display_fillTriangle( col[6],                 // x0
-                        row[2],                 // y0
-                        col[8],                 // x1
-                        row[2],                 // y1
-                        col[7],                 // x2
-                        row[3] - arrow_height,  // y2
-                        DISPLAY_GREEN);         // color
-
-  // Draw the Clock Character ':' Separators
-  display_drawChar( col[2],                         // x
-                    row[1] + CLOCKDISPLAY_BUFFER,   // y
-                    ':',                            // char to draw
-                    DISPLAY_GREEN,                  // color of text
-                    DISPLAY_BLACK,                  // color of background
-                    CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
-
-  display_drawChar( col[5],                         // x
-                    row[1] + CLOCKDISPLAY_BUFFER,   // y
-                    ':',                            // char to draw
-                    DISPLAY_GREEN,                  // color of text
-                    DISPLAY_BLACK,                  // color of background
-                    CLOCKDISPLAY_CLOCK_TEXT_SIZE);  // size of text
+void clockDisplay_addWidgets() {
+  ui_init(DISPLAY_BLACK);
+  uint8_t i;
+  for (i = 0; i < CLOCKDISPLAY_NUM_ARROWS / 2; i++) {
+    uint16_t left = col[i * 3];  // Arrows span two columns, skipping the ':'
+    uint16_t width = col[i * 3 + 2] - left + 1;
+
+    // Up arrow: apex at row[0] + arrow_height, base on row[1]
+    ui_addButton( &arrows[i],                             // widget
+                  NULL, 0,                                // parent, z
+                  left,                                   // x
+                  row[0] + arrow_height,                  // y
+                  width,                                  // width
+                  row[1] - (row[0] + arrow_height) + 1,   // height
+                  UI_SHAPE_TRIANGLE_UP,                   // shape
+                  DISPLAY_GREEN);                         // color
+
+    // Down arrow: base on row[2], apex at row[3] - arrow_height
+    ui_addButton( &arrows[i + CLOCKDISPLAY_NUM_ARROWS / 2],
+                  NULL, 0,
+                  left,
+                  row[2],
+                  width,
+                  (row[3] - arrow_height) - row[2] + 1,
+                  UI_SHAPE_TRIANGLE_DOWN,
+                  DISPLAY_GREEN);
+  }
 
+  // One widget per clock character, including the ':' separators
+  for (i = 0; i < CLOCKDISPLAY_NUM_CHARS - 1; i++) {
+    ui_addDigit(  &characters[i],                   // widget
+                  NULL, 0,                          // parent, z
+                  col[i],                           // x
+                  row[1] + CLOCKDISPLAY_BUFFER,     // y
+                  current_time[i],                  // char to draw
+                  CLOCKDISPLAY_CLOCK_TEXT_SIZE,     // size of text
+                  DISPLAY_GREEN,                    // color of text
+                  DISPLAY_BLACK);                   // color of background
+  }
 }
 
 //********************** End Helper Functions *********************************
@@ -324,10 +226,8 @@ void clockDisplay_init() {
   // Initialize the current_time to the initial value
   sprintf(current_time, "%2d:%02d:%02d", hours, minutes, seconds);
 
-  // Draw all of the unchanging components of the display
-  clockDisplay_initDraw();
-
-  // Draw the rest of the normal digits
+  // Set up the arrows and characters, then draw them all
+  clockDisplay_addWidgets();
   clockDisplay_updateTimeDisplay(CLOCKDISPLAY_UPDATE_ALL);
 }
 
@@ -387,18 +287,12 @@ void clockDisplay_updateTimeDisplay(bool forceUpdateAll) {
   // Update current time
   sprintf(current_time, "%2d:%02d:%02d", hours, minutes, seconds);
 
-  // Draw the time digits only if the times have changed
+  // Hand the characters to their widgets: only those that changed are redrawn
   uint8_t i;
-  for (i = 0; i < CLOCKDISPLAY_NUM_CHARS; i++) {
-    // If the digit has changed
-    if (current_time[i] != old_time[i]) {
-      // Redraw the digit with the current value
-      clockDisplay_redrawDigit(i, current_time[i]);
-    }
+  for (i = 0; i < CLOCKDISPLAY_NUM_CHARS - 1; i++) {
+    ui_setDigit(&characters[i], current_time[i]);
   }
-
-  // Copy current_time into old_time
-  strcpy(old_time, current_time);
+  ui_render();
 }
 
 void clockDisplay_performIncDec() {
@@ -66,6 +66,7 @@
 #define CLOCKDISPLAY_NUM_COLS 9 // number of columns to divide the display into.
 #define CLOCKDISPLAY_NUM_ROWS 4 // number of rows to divide the display into.
 #define CLOCKDISPLAY_NUM_CHARS 9   // 8 chars for "HH:MM:SS" + 1 for '\0'
+#define CLOCKDISPLAY_NUM_ARROWS 6  // up and down for hours, minutes and seconds
 
 // Macros for names of the indexes in the char arrays
 #define CLOCKDISPLAY_TENS_HRS  0
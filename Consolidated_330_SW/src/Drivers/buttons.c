@@ -6,7 +6,7 @@
 
 #include <stdio.h>
 #include "buttons.h"
-#include "xparameters.h"
+#include "supportFiles/hal.h"
 #include "supportFiles/display.h"
 
 // Screen Position Macros
@@ -35,23 +35,6 @@ uint16_t y_three_fourths; // y-value of the bottom fourth of the screen
 
 //************************* Helper Functions **********************************
 
-// Helper function to read GPIO registers.
-// @param offset offset from the base address to read from
-int32_t buttons_readGpioRegister(int32_t offset) {
-  // Casted to (uint32_t *) to match data types
-  uint32_t *ptr = (uint32_t *)XPAR_GPIO_PUSH_BUTTONS_BASEADDR + offset;
-  return *ptr;
-}
-
-// Helper function to write GPIO registers.
-// @param offset offset from the base address to write to
-// @param value 32-bit value to write to the register
-void buttons_writeGpioRegister(int32_t offset, uint32_t value) {
-  // Casted to (uint32_t *) to match data types
-  uint32_t *ptr = (uint32_t *)XPAR_GPIO_PUSH_BUTTONS_BASEADDR + offset;
-  *ptr = value;
-}
-
 // Helper function to write data to the LCD based on what button is pressed,
 // blanks the screen otherwise.
 void buttons_write_LCD(int32_t buttons) {
@@ -146,8 +129,13 @@ void buttons_write_LCD(int32_t buttons) {
 int buttons_init() {
   int status = BUTTONS_INIT_STATUS_FAIL;  // Initialize as FAIL
 
+  // Get the button GPIO ready, leave status as FAIL if it can't be
+  if (hal_gpioInit(HAL_GPIO_PUSH_BUTTONS) != HAL_STATUS_OK) {
+    return status;
+  }
+
   //write 1s to the tri-state driver to set buttons as input
-  buttons_writeGpioRegister(BUTTONS_TRISTATE_OFFSET, BUTTONS_TRISTATE_SET_AS_INPUT);
+  hal_gpioSetDataDirection(HAL_GPIO_PUSH_BUTTONS, BUTTONS_TRISTATE_SET_AS_INPUT);
 
   status = BUTTONS_INIT_STATUS_OK; // Set status to OK
   return status;
@@ -156,7 +144,7 @@ int buttons_init() {
 int32_t buttons_read() {
 
   // Read the value of the buttons
-  int32_t registerValue = buttons_readGpioRegister(BUTTONS_VALUE_OFFSET);
+  int32_t registerValue = hal_gpioRead(HAL_GPIO_PUSH_BUTTONS);
 
   // Zero out all values but the bottom 4
   registerValue = registerValue & BUTTONS_BOTTOM_4_BITS;
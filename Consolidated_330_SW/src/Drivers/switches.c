@@ -5,17 +5,20 @@
 //*****************************************************************************
 
 #include <stdio.h>
-#include <xil_io.h>
 #include "switches.h"
-#include "xparameters.h"
+#include "supportFiles/hal.h"
 #include "supportFiles/leds.h"
 
 int switches_init() {
   int status = SWITCHES_INIT_STATUS_FAIL; // Initialize as FAIL
 
+  // Get the switch GPIO ready, leave status as FAIL if it can't be
+  if (hal_gpioInit(HAL_GPIO_SLIDE_SWITCHES) != HAL_STATUS_OK) {
+    return status;
+  }
+
   //write 1s to the tri-state driver to set buttons as input
-  Xil_Out32(XPAR_GPIO_SLIDE_SWITCHES_BASEADDR + SWITCHES_TRISTATE_OFFSET, // address
-            SWITCHES_TRISTATE_SET_AS_INPUT);  // value to write
+  hal_gpioSetDataDirection(HAL_GPIO_SLIDE_SWITCHES, SWITCHES_TRISTATE_SET_AS_INPUT);
 
   status = SWITCHES_INIT_STATUS_OK; // Set to OK
   return status;
@@ -23,8 +26,7 @@ int switches_init() {
 
 int32_t switches_read() {
   //read the value of the swithces
-  u32 switchValues = Xil_In32(XPAR_GPIO_SLIDE_SWITCHES_BASEADDR +
-                              SWITCHES_VALUE_OFFSET);
+  uint32_t switchValues = hal_gpioRead(HAL_GPIO_SLIDE_SWITCHES);
 
   // Zero out all bits except relevant switch values
   switchValues = switchValues & SWITCHES_BOTTOM_4_BITS;
@@ -14,7 +14,7 @@
 enum buttonHandler_st {
   init_st,             // Initial state when disabled
   wait_for_touch_st,   // wait for button to be touched state
-  debounce_st,         // wait for adc to settle
+  touch_settling_st,   // wait for the touch filter to settle on the point
   draw_square_st,      // draw the square that is being pressed
   wait_for_release_st, // wait for the user to let go
   release_detected_st  //waits here for enable == false
@@ -43,8 +43,8 @@ void buttonHandler_debugStatePrint() {
       case wait_for_touch_st:
         printf("wait_for_touch_st\n\r");
         break;
-      case debounce_st:
-        printf("debounce_st\n\r");
+      case touch_settling_st:
+        printf("touch_settling_st\n\r");
         break;
       case draw_square_st:
         printf("draw_square_st\n\r");
@@ -72,6 +72,13 @@ uint8_t buttonHandler_getRegionNumber() {
   return simonDisplay_computeRegionNumber(x,y);
 }
 
+// True once the touch filter has settled on the touched point.
+static bool buttonHandler_isTouchStable() {
+  int16_t x, y;
+  uint8_t pressure;
+  return display_getStableTouchedPoint(&x, &y, &pressure);
+}
+
 void buttonHandler_enable() {
   enabled = true; // enable the state machine
 }
@@ -87,20 +94,16 @@ bool buttonHandler_releaseDetected() {
 void buttonHandler_tick() {
   //buttonHandler_debugStatePrint();
 
-  static uint16_t adcTimer = 0;   // counter used to debounce
   static uint8_t currentRegion;
   /////////////////////////////////
   // Perform state action first. //
   /////////////////////////////////
   switch (buttonHandler_state) {
     case init_st:
-      adcTimer = 0;
       break;
     case wait_for_touch_st:
-      adcTimer = 0;
       break;
-    case debounce_st:
-      adcTimer++;
+    case touch_settling_st:
       break;
     case draw_square_st:
       break;
@@ -130,15 +133,15 @@ void buttonHandler_tick() {
     case wait_for_touch_st:
       if (display_isTouched()) {
         display_clearOldTouchData();
-        buttonHandler_state = debounce_st;
+        buttonHandler_state = touch_settling_st;
       }
       else {
         buttonHandler_state = wait_for_touch_st;
       }
       break;
-    case debounce_st:
-      // Wait for the time for the ADC to settle
-      if (adcTimer >= ADC_WAIT && display_isTouched()) {
+    case touch_settling_st:
+      // Wait for the touch filter to settle on the point (a light touch never does)
+      if (buttonHandler_isTouchStable() && display_isTouched()) {
         buttonHandler_state = draw_square_st;
       }
       else if (!display_isTouched()) {
@@ -146,7 +149,7 @@ void buttonHandler_tick() {
       }
       // Otherwise, wait here
       else {
-        buttonHandler_state = debounce_st;
+        buttonHandler_state = touch_settling_st;
       }
       break;
     case draw_square_st:
@@ -10,8 +10,6 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#define ADC_WAIT 6
-
 /**
  * Get the simon region numbers.
  * See the source code for the region numbering scheme.
@@ -0,0 +1,135 @@
+//*****************************************************************************
+// Host test for display_blit() (blit.cpp), run on the simulator backend of the
+// HAL. Encodes one image with no symmetry (odd width, so rows are padded) in
+// every source format, blits it straight to the LCD and through a frame buffer,
+// whole and clipped at each edge of the screen, and compares every pixel of the
+// LCD with the image. A swapped nibble, bit order or row padding shows up as
+// wrong pixels. Also prints the LCD bus writes of each format next to
+// fillRect + drawBitmap. Returns nonzero if a pixel differs.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "supportFiles/display.h"
+#include "supportFiles/frameBuffer.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/lcd.h"
+
+#define BLIT_TEST_WIDTH 13   // Odd, and not a multiple of 8: MASK1 and INDEX4 rows end mid-byte.
+#define BLIT_TEST_HEIGHT 9
+#define BLIT_TEST_PIXELS (BLIT_TEST_WIDTH * BLIT_TEST_HEIGHT)
+#define BLIT_TEST_BG DISPLAY_BLUE  // Around the image, to catch pixels drawn outside it.
+
+// 16 colors that differ in every component, so a wrong index never gives the right color.
+static const uint16_t palette[16] = {
+  0x0000, 0xF800, 0x07E0, 0x001F, 0xFFE0, 0xF81F, 0x07FF, 0xFFFF,
+  0x8410, 0x8000, 0x0400, 0x0010, 0x8400, 0x8010, 0x0410, 0xC618
+};
+static uint8_t indexes[BLIT_TEST_PIXELS];  // The image, as palette indexes.
+static uint8_t maskBits[BLIT_TEST_PIXELS];  // The image for MASK1, as 0/1.
+static uint16_t rgb565[BLIT_TEST_PIXELS];
+static uint8_t mask1[BLIT_TEST_HEIGHT * ((BLIT_TEST_WIDTH + 7) / 8)];
+static uint8_t index4[BLIT_TEST_HEIGHT * ((BLIT_TEST_WIDTH + 1) / 2)];
+static uint8_t index8[BLIT_TEST_PIXELS];
+static uint16_t rle565[2 * BLIT_TEST_PIXELS];
+static frameBuffer_pixel_t frameBufferPixels[FRAMEBUFFER_STORAGE_SIZE];
+static FrameBuffer frameBuffer(frameBufferPixels);
+static uint32_t errors = 0;
+
+// Encodes the image in every format, following blit.h.
+static void blitTest_makeImage() {
+  uint16_t runs = 0;
+  for (int16_t y = 0; y < BLIT_TEST_HEIGHT; y++) {
+    for (int16_t x = 0; x < BLIT_TEST_WIDTH; x++) {
+      int16_t i = y * BLIT_TEST_WIDTH + x;
+      indexes[i] = (x * 7 + y * y * 3 + x * y) % 16;
+      maskBits[i] = ((x * x + 3 * y) % 5) < 2;
+      rgb565[i] = palette[indexes[i]];
+      index8[i] = indexes[i];
+      if (maskBits[i])
+        mask1[y * ((BLIT_TEST_WIDTH + 7) / 8) + x / 8] |= 0x80 >> (x % 8);
+      index4[y * ((BLIT_TEST_WIDTH + 1) / 2) + x / 2] |= indexes[i] << ((x % 2) ? 0 : 4);
+      // Runs continue from one row to the next.
+      if (runs && (rle565[2 * runs - 1] == rgb565[i])) {
+        rle565[2 * runs - 2]++;
+      } else {
+        rle565[2 * runs] = 1;
+        rle565[2 * runs + 1] = rgb565[i];
+        runs++;
+      }
+    }
+  }
+}
+
+// Checks the LCD against the image drawn at (x0, y0) (in the format's colors), with BLIT_TEST_BG
+// around it.
+static void blitTest_check(const char *name, blit_format_t format, int16_t x0, int16_t y0) {
+  uint32_t wrong = 0;
+  for (int16_t y = y0 - 2; y < y0 + BLIT_TEST_HEIGHT + 2; y++) {
+    for (int16_t x = x0 - 2; x < x0 + BLIT_TEST_WIDTH + 2; x++) {
+      if ((x < 0) || (y < 0) || (x >= HALSIM_LCD_WIDTH) || (y >= HALSIM_LCD_HEIGHT))
+        continue;
+      uint16_t expected = BLIT_TEST_BG;
+      if ((x >= x0) && (y >= y0) && (x < x0 + BLIT_TEST_WIDTH) && (y < y0 + BLIT_TEST_HEIGHT)) {
+        int16_t i = (y - y0) * BLIT_TEST_WIDTH + (x - x0);
+        expected = (format == BLIT_FORMAT_MASK1) ? palette[maskBits[i]] : rgb565[i];
+      }
+      wrong += halSim_lcdReadPixel(x, y) != expected;
+    }
+  }
+  if (wrong) {
+    printf("%s at (%d, %d): %lu pixels wrong\n\r", name, x0, y0, (unsigned long) wrong);
+    errors++;
+  }
+}
+
+int main() {
+  static const char *formatNames[] = {"RGB565", "MASK1", "INDEX4", "INDEX8", "RLE565"};
+  const void *sources[] = {rgb565, mask1, index4, index8, rle565};
+  // Whole, then clipped at the left, top, right and bottom edges.
+  static const int16_t positions[][2] = {{101, 37}, {-5, 60}, {40, -4}, {HALSIM_LCD_WIDTH - 6, 100},
+    {200, HALSIM_LCD_HEIGHT - 3}};
+  blitTest_makeImage();
+  display_init();
+
+  for (uint8_t format = BLIT_FORMAT_RGB565; format <= BLIT_FORMAT_RLE565; format++) {
+    for (uint8_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+      display_fillScreen(BLIT_TEST_BG);
+      display_blit(positions[p][0], positions[p][1], BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT, sources[format],
+        (blit_format_t) format, palette);
+      blitTest_check(formatNames[format], (blit_format_t) format, positions[p][0], positions[p][1]);
+    }
+  }
+
+  // The same through the frame buffer, which copies the rows into RAM instead.
+  frameBuffer.begin();
+  frameBuffer.setRotation(1);  // Same as display_init().
+  frameBuffer.enable(true);
+  for (uint8_t format = BLIT_FORMAT_RGB565; format <= BLIT_FORMAT_RLE565; format++) {
+    for (uint8_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+      char name[32];
+      snprintf(name, sizeof(name), "frame buffer %s", formatNames[format]);
+      frameBuffer.fillScreen(BLIT_TEST_BG);
+      frameBuffer.blit(positions[p][0], positions[p][1], BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT, sources[format],
+        (blit_format_t) format, palette);
+      frameBuffer.flush();
+      blitTest_check(name, (blit_format_t) format, positions[p][0], positions[p][1]);
+    }
+  }
+  frameBuffer.enable(false);
+
+  // What each format costs on the bus, against the two calls it takes without display_blit().
+  LCD_clearBusWriteCount();
+  display_fillRect(0, 0, BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT, palette[0]);
+  display_drawBitmap(0, 0, mask1, BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT, palette[1]);
+  printf("%dx%d image: %4lu bus writes with fillRect + drawBitmap\n\r", BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT,
+    (unsigned long) LCD_getBusWriteCount());
+  for (uint8_t format = BLIT_FORMAT_RGB565; format <= BLIT_FORMAT_RLE565; format++) {
+    LCD_clearBusWriteCount();
+    display_blit(0, 0, BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT, sources[format], (blit_format_t) format, palette);
+    printf("%dx%d image: %4lu bus writes with display_blit(%s)\n\r", BLIT_TEST_WIDTH, BLIT_TEST_HEIGHT,
+      (unsigned long) LCD_getBusWriteCount(), formatNames[format]);
+  }
+  printf("%s\n\r", errors ? "blit test FAILED" : "blit test passed");
+  return errors != 0;
+}
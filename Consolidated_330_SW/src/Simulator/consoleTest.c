@@ -0,0 +1,95 @@
+//*****************************************************************************
+// Host test for the scrolling text console (display_consoleBegin()), run on
+// the simulator backend of the HAL, which models the ILI9341 vertical
+// scrolling registers. Appends lines to the console, then compares the
+// scrolled LCD image with the same last lines drawn conventionally, and
+// prints the GPIO transactions to append one line against redrawing the
+// screen. Returns nonzero if the images differ.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "supportFiles/display.h"
+#include "supportFiles/lcd.h"
+#include "supportFiles/halSim.h"
+
+#define CONSOLE_TEST_COLOR DISPLAY_GREEN
+#define CONSOLE_TEST_BG DISPLAY_BLUE
+#define CONSOLE_TEST_MAX_LINES 100
+#define CONSOLE_TEST_LINE_LENGTH 64
+
+static char lines[CONSOLE_TEST_MAX_LINES][CONSOLE_TEST_LINE_LENGTH];
+static uint16_t image[HALSIM_LCD_WIDTH * HALSIM_LCD_HEIGHT];
+
+// Fills in the text of line i; every few lines are longer than the screen is wide, to wrap.
+static void consoleTest_makeLine(uint32_t i, uint8_t columns) {
+  snprintf(lines[i], CONSOLE_TEST_LINE_LENGTH, "line %lu", (unsigned long) i);
+  if (i % 5 == 4) {
+    size_t length = strlen(lines[i]);
+    for (; length < columns + 3u; length++)
+      lines[i][length] = 'a' + length % 26;
+    lines[i][length] = '\0';
+  }
+}
+
+// Appends count lines to the console at the given text size, then checks the screen against the
+// last visible lines drawn without scrolling. Returns the number of differing pixels.
+static uint32_t consoleTest_run(uint8_t size, uint32_t count) {
+  uint8_t columns = 240 / (6 * size);
+  uint16_t lineHeight = 8 * size, screenLines = 320 / lineHeight;
+  display_consoleBegin(size, CONSOLE_TEST_COLOR, CONSOLE_TEST_BG);
+  uint32_t screenLine = 0;  // Lines the console has started, wrapped lines included.
+  unsigned long lastAppend = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    consoleTest_makeLine(i, columns);
+    LCD_clearTransactionCounts();
+    display_consolePrintln(lines[i]);
+    lastAppend = LCD_getTotalTransactionCount();
+    screenLine += (strlen(lines[i]) + columns - 1) / columns;
+  }
+  for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++)
+    for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++)
+      image[x * HALSIM_LCD_HEIGHT + y] = halSim_lcdReadPixel(x, y);
+  display_consoleEnd();
+
+  // The reference: split the text into screen lines again and draw the last screenLines of them,
+  // with the blank line the console starts after the last '\n' at the bottom.
+  display_setRotation(0);
+  LCD_clearTransactionCounts();
+  display_fillScreen(CONSOLE_TEST_BG);
+  display_setTextSize(size);
+  display_setTextColor(CONSOLE_TEST_COLOR, CONSOLE_TEST_BG);
+  display_setTextWrap(false);
+  int32_t first = (int32_t) screenLine + 1 - screenLines;  // Oldest screen line still shown.
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    for (size_t start = 0; start < strlen(lines[i]); start += columns, n++) {
+      if ((int32_t) n < first)
+        continue;
+      char text[CONSOLE_TEST_LINE_LENGTH];
+      snprintf(text, sizeof(text), "%.*s", columns, lines[i] + start);
+      int32_t row = (first < 0) ? n : n - first;
+      display_setCursor(0, 320 - screenLines * lineHeight + row * lineHeight);
+      display_println(text);
+    }
+  }
+  unsigned long redraw = LCD_getTotalTransactionCount();
+  uint32_t mismatches = 0;
+  for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++)
+    for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++)
+      mismatches += image[x * HALSIM_LCD_HEIGHT + y] != halSim_lcdReadPixel(x, y);
+  display_setRotation(1);
+  printf("text size %u, %3lu lines: %7lu GPIO transactions to append a line, %7lu to redraw, %lu mismatches\n\r",
+      size, (unsigned long) count, lastAppend, redraw, (unsigned long) mismatches);
+  return mismatches;
+}
+
+int main() {
+  display_init();
+  uint32_t mismatches = 0;
+  mismatches += consoleTest_run(1, 20);  // Not full yet.
+  mismatches += consoleTest_run(1, CONSOLE_TEST_MAX_LINES);
+  mismatches += consoleTest_run(2, CONSOLE_TEST_MAX_LINES);
+  mismatches += consoleTest_run(3, 7);
+  return mismatches != 0;
+}
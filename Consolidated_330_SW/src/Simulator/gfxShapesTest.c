@@ -0,0 +1,218 @@
+//*****************************************************************************
+// Host test for the filled shapes and lines of Adafruit_GFX.cpp. Draws 20000
+// random filled circles, round rects and triangles, many of them clipped by the
+// edges or degenerate (zero or negative sizes, radii larger than the shape,
+// points on one line), then 50000 random lines, many partly or fully off the
+// canvas, into a small canvas in RAM that clips like the LCD drivers, and
+// prints a hash of the canvas after each kind of shape. "make check" builds it
+// a second time with ADAFRUIT_GFX_SCANLINE_FILLS and ADAFRUIT_GFX_PIXEL_LINES
+// (the original one-line-per-column fills and one-pixel-at-a-time lines) and
+// compares the two outputs; any pixel that differs changes a hash. Thick lines
+// are also checked against thickness one-pixel lines side by side. Returns
+// nonzero if a thick line differs.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supportFiles/Adafruit_GFX.h"
+
+#define GFX_SHAPES_TEST_WIDTH 64
+#define GFX_SHAPES_TEST_HEIGHT 48
+#define GFX_SHAPES_TEST_MARGIN 40  // Shapes may start this far off the canvas.
+#define GFX_SHAPES_TEST_COUNT 20000
+#define GFX_SHAPES_TEST_LINE_COUNT 50000
+#define GFX_SHAPES_TEST_FAR 1000  // Some lines end this far off the canvas.
+
+// Clips the way genericFillRect(), genericDrawFastHLine() and genericDrawFastVLine() in
+// Adafruit_TFTLCD.cpp do: nothing for a width or height <= 0, the rest cut at the edges.
+class GfxShapesCanvas : public Adafruit_GFX {
+ public:
+  uint16_t pixels[GFX_SHAPES_TEST_HEIGHT][GFX_SHAPES_TEST_WIDTH];
+
+  GfxShapesCanvas() : Adafruit_GFX(GFX_SHAPES_TEST_WIDTH, GFX_SHAPES_TEST_HEIGHT) {
+    clear();
+  }
+  void clear() {
+    memset(pixels, 0, sizeof(pixels));
+  }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if ((x >= 0) && (y >= 0) && (x < GFX_SHAPES_TEST_WIDTH) && (y < GFX_SHAPES_TEST_HEIGHT))
+      pixels[y][x] = color;
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if ((w <= 0) || (h <= 0))
+      return;
+    for (int16_t j = y; j < y + h; j++) {
+      for (int16_t i = x; i < x + w; i++) {
+        drawPixel(i, j, color);
+      }
+    }
+  }
+  // FNV-1a over every pixel.
+  uint32_t hash(uint32_t h) {
+    const uint8_t *bytes = (const uint8_t *) pixels;
+    for (size_t i = 0; i < sizeof(pixels); i++) {
+      h = (h ^ bytes[i]) * 16777619u;
+    }
+    return h;
+  }
+};
+
+static GfxShapesCanvas canvas;
+static uint32_t randomState = 12345;
+
+// xorshift32, so the shapes are the same on every host.
+static uint32_t gfxShapesTest_random() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+// A number from low to high, both included.
+static int16_t gfxShapesTest_randomRange(int16_t low, int16_t high) {
+  return low + (int16_t) (gfxShapesTest_random() % (uint32_t) (high - low + 1));
+}
+
+static int16_t gfxShapesTest_randomX() {
+  return gfxShapesTest_randomRange(-GFX_SHAPES_TEST_MARGIN, GFX_SHAPES_TEST_WIDTH + GFX_SHAPES_TEST_MARGIN);
+}
+
+static int16_t gfxShapesTest_randomY() {
+  return gfxShapesTest_randomRange(-GFX_SHAPES_TEST_MARGIN, GFX_SHAPES_TEST_HEIGHT + GFX_SHAPES_TEST_MARGIN);
+}
+
+// A size that is often 0, 1 or negative.
+static int16_t gfxShapesTest_randomSize() {
+  return (gfxShapesTest_random() % 8 == 0) ? gfxShapesTest_randomRange(-3, 1) : gfxShapesTest_randomRange(2, 50);
+}
+
+static void gfxShapesTest_drawCircle(uint16_t color) {
+  canvas.fillCircle(gfxShapesTest_randomX(), gfxShapesTest_randomY(), gfxShapesTest_randomSize(), color);
+}
+
+static void gfxShapesTest_drawRoundRect(uint16_t color) {
+  int16_t w = gfxShapesTest_randomSize(), h = gfxShapesTest_randomSize();
+  // Radii up to past half the shorter side, which the corners then overlap.
+  int16_t radius = gfxShapesTest_randomRange(0, (w < h ? w : h) / 2 + 3);
+  canvas.fillRoundRect(gfxShapesTest_randomX(), gfxShapesTest_randomY(), w, h, radius, color);
+}
+
+static void gfxShapesTest_drawTriangle(uint16_t color) {
+  int16_t x[3], y[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    x[i] = gfxShapesTest_randomX();
+    y[i] = gfxShapesTest_randomY();
+  }
+  switch (gfxShapesTest_random() % 8) {
+  case 0:  // Two corners on the same row.
+    y[1] = y[0];
+    break;
+  case 1:  // All three on one row or one column.
+    y[1] = y[2] = y[0];
+    break;
+  case 2:
+    x[1] = x[2] = x[0];
+    break;
+  case 3:  // On one sloped line.
+    x[2] = 2 * x[1] - x[0];
+    y[2] = 2 * y[1] - y[0];
+    break;
+  case 4:  // Two corners in the same place.
+    x[2] = x[0];
+    y[2] = y[0];
+    break;
+  }
+  canvas.fillTriangle(x[0], y[0], x[1], y[1], x[2], y[2], color);
+}
+
+// An end point usually near the canvas, sometimes far away.
+static void gfxShapesTest_randomPoint(int16_t *x, int16_t *y) {
+  if (gfxShapesTest_random() % 8 == 0) {
+    *x = gfxShapesTest_randomRange(-GFX_SHAPES_TEST_FAR, GFX_SHAPES_TEST_FAR);
+    *y = gfxShapesTest_randomRange(-GFX_SHAPES_TEST_FAR, GFX_SHAPES_TEST_FAR);
+  } else {
+    *x = gfxShapesTest_randomX();
+    *y = gfxShapesTest_randomY();
+  }
+}
+
+static void gfxShapesTest_drawLine(uint16_t color) {
+  int16_t x0, y0, x1, y1;
+  gfxShapesTest_randomPoint(&x0, &y0);
+  gfxShapesTest_randomPoint(&x1, &y1);
+  switch (gfxShapesTest_random() % 8) {
+  case 0:  // Horizontal, vertical, a single point and 45 degrees.
+    y1 = y0;
+    break;
+  case 1:
+    x1 = x0;
+    break;
+  case 2:
+    x1 = x0;
+    y1 = y0;
+    break;
+  case 3:
+    y1 = y0 + (x1 - x0);
+    break;
+  }
+  canvas.drawLine(x0, y0, x1, y1, color);
+}
+
+// Draws a random thick line, then the same as one-pixel lines, shifted across the minor axis
+// the way drawThickLine() places its pixels, and counts the lines that came out different.
+static uint32_t thickLineErrors = 0;
+static uint16_t thickLinePixels[GFX_SHAPES_TEST_HEIGHT][GFX_SHAPES_TEST_WIDTH];
+
+static void gfxShapesTest_drawThickLine(uint16_t color) {
+  int16_t x0, y0, x1, y1;
+  gfxShapesTest_randomPoint(&x0, &y0);
+  gfxShapesTest_randomPoint(&x1, &y1);
+  int16_t thickness = gfxShapesTest_randomRange(1, 9);
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int16_t before = (thickness - 1) / 2;
+  for (int16_t k = -before; k < thickness - before; k++) {
+    canvas.drawLine(x0 + (steep ? k : 0), y0 + (steep ? 0 : k), x1 + (steep ? k : 0), y1 + (steep ? 0 : k),
+      color);
+  }
+  memcpy(thickLinePixels, canvas.pixels, sizeof(thickLinePixels));
+  canvas.clear();
+  canvas.drawThickLine(x0, y0, x1, y1, thickness, color);
+  if (memcmp(thickLinePixels, canvas.pixels, sizeof(thickLinePixels)) && (thickLineErrors++ < 10)) {
+    printf("drawThickLine(%d, %d, %d, %d, %d) differs from %d lines\n", x0, y0, x1, y1, thickness, thickness);
+  }
+}
+
+// Draws count shapes on a clear canvas, one at a time, and returns a hash of every result.
+static uint32_t gfxShapesTest_run(const char *name, void (*draw)(uint16_t), uint32_t count) {
+  uint32_t h = 2166136261u, drawn = 0;
+  for (uint32_t n = 0; n < count; n++) {
+    canvas.clear();
+    draw((uint16_t) (n + 1));
+    for (int16_t y = 0; y < GFX_SHAPES_TEST_HEIGHT; y++) {
+      for (int16_t x = 0; x < GFX_SHAPES_TEST_WIDTH; x++) {
+        drawn += canvas.pixels[y][x] != 0;
+      }
+    }
+    h = canvas.hash(h);
+  }
+  printf("%s: %lu shapes, %lu pixels on the canvas, hash %08lx\n", name, (unsigned long) count,
+    (unsigned long) drawn, (unsigned long) h);
+  return h;
+}
+
+int main() {
+  gfxShapesTest_run("fillCircle", gfxShapesTest_drawCircle, GFX_SHAPES_TEST_COUNT / 4);
+  gfxShapesTest_run("fillRoundRect", gfxShapesTest_drawRoundRect, GFX_SHAPES_TEST_COUNT / 4);
+  gfxShapesTest_run("fillTriangle", gfxShapesTest_drawTriangle, GFX_SHAPES_TEST_COUNT / 2);
+  gfxShapesTest_run("drawLine", gfxShapesTest_drawLine, GFX_SHAPES_TEST_LINE_COUNT);
+  gfxShapesTest_run("drawThickLine", gfxShapesTest_drawThickLine, GFX_SHAPES_TEST_COUNT / 4);
+  return thickLineErrors != 0;
+}
@@ -0,0 +1,171 @@
+//*****************************************************************************
+// Host benchmark for the LCD drawing primitives, run on the simulator backend
+// of the HAL. Prints calls per second of host time for drawPixel(),
+// drawFastHLine(), fillRect(), sloped lines, the filled shapes and text, the GPIO
+// transactions per call (which is what the calls cost on the board) and the
+// CASET/PASET writes the window cache saved. The Makefile builds it three
+// times, with the specialized ILI9341 drivers (lcdBenchmark), with
+// ADAFRUIT_TFTLCD_GENERIC_DRIVERS (lcdBenchmarkGeneric) and with
+// ADAFRUIT_GFX_SCANLINE_FILLS plus ADAFRUIT_GFX_PIXEL_LINES
+// (lcdBenchmarkScanline), for comparison. The frame buffer entries measure
+// flush() and a palette-animated button flash; lcdBenchmarkIndexed8 and
+// lcdBenchmarkIndexed4 run them with FRAMEBUFFER_INDEXED_BITS. An argument
+// runs only the entries whose names start with it.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "supportFiles/Adafruit_TFTLCD.h"
+#include "supportFiles/frameBuffer.h"
+#include "supportFiles/display.h"
+#include "supportFiles/lcd.h"
+#include "supportFiles/lcdDrivers.h"
+
+#define BENCHMARK_SECONDS 0.5   // Host time spent on each primitive.
+#define BENCHMARK_BATCH 1000    // Calls between clock checks.
+
+static Adafruit_TFTLCD lcd;
+static frameBuffer_pixel_t frameBufferPixels[FRAMEBUFFER_STORAGE_SIZE];
+static FrameBuffer frameBuffer(frameBufferPixels);
+static const char *benchmarkPrefix = "";  // Only entries whose names start with this run.
+
+// Calls draw(i) in batches until BENCHMARK_SECONDS of host time have passed.
+static void benchmark_run(const char *name, void (*draw)(uint32_t i)) {
+  if (strncmp(name, benchmarkPrefix, strlen(benchmarkPrefix)))
+    return;
+  uint32_t calls = 0;
+  LCD_clearTransactionCounts();
+  lcdDrivers_clearSkippedWindowRegisterWrites();
+  clock_t start = clock();
+  double seconds;
+  do {
+    for (uint32_t i = 0; i < BENCHMARK_BATCH; i++)
+      draw(calls + i);
+    calls += BENCHMARK_BATCH;
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+  } while (seconds < BENCHMARK_SECONDS);
+  printf("%-17s %10.0f calls/s %8.1f GPIO transactions/call %5.2f window registers skipped/call\n\r",
+      name, calls / seconds, (double) LCD_getTotalTransactionCount() / calls,
+      (double) lcdDrivers_getSkippedWindowRegisterWrites() / calls);
+}
+
+static void benchmark_drawPixel(uint32_t i) {
+  lcd.drawPixel(i % 320, (i / 320) % 240, i);
+}
+
+static void benchmark_drawFastHLine(uint32_t i) {
+  lcd.drawFastHLine(i % 280, (i / 280) % 240, 40, i);
+}
+
+static void benchmark_fillRect(uint32_t i) {
+  lcd.fillRect(i % 300, (i / 300) % 220, 20, 20, i);
+}
+
+// A shallow line, like one stroke of a TicTacToe X.
+static void benchmark_drawLine(uint32_t i) {
+  int16_t x = i % 240, y = (i / 240) % 200;
+  lcd.drawLine(x, y, x + 80, y + 30, i);
+}
+
+static void benchmark_fillTriangle(uint32_t i) {
+  int16_t x = i % 260, y = (i / 260) % 180;
+  lcd.fillTriangle(x + 30, y, x, y + 60, x + 60, y + 60, i);
+}
+
+static void benchmark_fillCircle(uint32_t i) {
+  lcd.fillCircle(20 + i % 280, 20 + (i / 280) % 200, 20, i);
+}
+
+static void benchmark_fillRoundRect(uint32_t i) {
+  lcd.fillRoundRect(i % 260, (i / 260) % 200, 60, 40, 8, i);
+}
+
+// The TicTacToe instructions (ticTacToeControl_tick()), in its white transparent text and in
+// opaque text, one character at a time (Print::write()) and as a whole string.
+#define BENCHMARK_MESSAGE "\n\nTouch a square to play 'X'\n\r\n\r    -or-\n\r\n\rwait for the computer and play 'O'"
+#define BENCHMARK_MESSAGE_TEXT_SIZE 2  // TICTACTOECONTROL_INSTR_TEXTSIZE
+
+static void benchmark_printMessage(bool opaque, bool whole) {
+  lcd.setCursor(0, 0);
+  lcd.setTextSize(BENCHMARK_MESSAGE_TEXT_SIZE);
+  if (opaque)
+    lcd.setTextColor(0xFFFF, 0x0000);
+  else
+    lcd.setTextColor(0xFFFF);
+  if (whole)
+    lcd.write(BENCHMARK_MESSAGE);
+  else
+    lcd.Print::write((const uint8_t *) BENCHMARK_MESSAGE, sizeof(BENCHMARK_MESSAGE) - 1);
+}
+
+static void benchmark_printChars(uint32_t i) {
+  benchmark_printMessage(false, false);
+}
+
+static void benchmark_printString(uint32_t i) {
+  benchmark_printMessage(false, true);
+}
+
+static void benchmark_printCharsOpaque(uint32_t i) {
+  benchmark_printMessage(true, false);
+}
+
+static void benchmark_printStringOpaque(uint32_t i) {
+  benchmark_printMessage(true, true);
+}
+
+// A quarter of the screen in one of the eight DISPLAY_* colors, then a flush.
+static const uint16_t benchmarkColors[] = {DISPLAY_BLACK, DISPLAY_BLUE, DISPLAY_RED, DISPLAY_GREEN,
+  DISPLAY_CYAN, DISPLAY_MAGENTA, DISPLAY_YELLOW, DISPLAY_WHITE};
+static void benchmark_frameBufferFlush(uint32_t i) {
+  frameBuffer.fillRect(i % 160, (i / 160) % 120, 160, 120, benchmarkColors[i % 8]);
+  frameBuffer.flush();
+}
+
+// Flashes a Simon-sized button (100x100) white and back, then flushes. With a palette only the
+// entry changes; otherwise the button is filled again.
+#define BENCHMARK_BUTTON_X 40
+#define BENCHMARK_BUTTON_Y 20
+#define BENCHMARK_BUTTON_SIZE 100
+static void benchmark_frameBufferFlash(uint32_t i) {
+  uint16_t color = (i & 1) ? DISPLAY_WHITE : DISPLAY_RED;
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  frameBuffer.setPaletteColor(frameBuffer.paletteIndex(DISPLAY_RED), color);
+#else
+  frameBuffer.fillRect(BENCHMARK_BUTTON_X, BENCHMARK_BUTTON_Y, BENCHMARK_BUTTON_SIZE,
+    BENCHMARK_BUTTON_SIZE, color);
+#endif
+  frameBuffer.flush();
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1)
+    benchmarkPrefix = argv[1];
+  lcd.begin();
+  lcd.setRotation(1);  // Same as display_init().
+  benchmark_run("drawPixel", benchmark_drawPixel);
+  benchmark_run("drawFastHLine", benchmark_drawFastHLine);
+  benchmark_run("fillRect", benchmark_fillRect);
+  benchmark_run("drawLine", benchmark_drawLine);
+  benchmark_run("fillTriangle", benchmark_fillTriangle);
+  benchmark_run("fillCircle", benchmark_fillCircle);
+  benchmark_run("fillRoundRect", benchmark_fillRoundRect);
+  benchmark_run("printChars", benchmark_printChars);
+  benchmark_run("printString", benchmark_printString);
+  benchmark_run("printCharsOpaque", benchmark_printCharsOpaque);
+  benchmark_run("printStringOpaque", benchmark_printStringOpaque);
+  printf("frame buffer: %d bits per pixel, %lu bytes of pixels, %lu bytes in all\n\r",
+      FRAMEBUFFER_BITS_PER_PIXEL, (unsigned long) FRAMEBUFFER_PIXEL_BYTES, (unsigned long) (sizeof(FrameBuffer) + FRAMEBUFFER_PIXEL_BYTES));
+  frameBuffer.begin();
+  frameBuffer.setRotation(1);
+  frameBuffer.enable(true);
+  frameBuffer.flush();
+  benchmark_run("frameBufferFlush", benchmark_frameBufferFlush);
+  frameBuffer.fillScreen(DISPLAY_BLACK);
+  frameBuffer.fillRect(BENCHMARK_BUTTON_X, BENCHMARK_BUTTON_Y, BENCHMARK_BUTTON_SIZE,
+    BENCHMARK_BUTTON_SIZE, DISPLAY_RED);
+  frameBuffer.flush();
+  benchmark_run("frameBufferFlash", benchmark_frameBufferFlash);
+  return 0;
+}
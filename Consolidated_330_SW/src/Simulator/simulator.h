@@ -0,0 +1,18 @@
+//*****************************************************************************
+// Header for the headless simulator runner (see simulatorMain.c).
+//*****************************************************************************
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+// One of these is linked in per application (simulatorClock.c, simulatorSimon.c, ...).
+typedef struct {
+  const char *name;           // Used for the final LCD dump (<name>.ppm).
+  double tickPeriodSeconds;   // Same TIMER_PERIOD as the application's main.
+  void (*init)();             // Called once before the timer is started (may be NULL).
+  void (*tick)();             // Called once per timer interrupt, like the main loop on the board.
+} simulator_app_t;
+
+extern const simulator_app_t simulator_app;
+
+#endif /* SIMULATOR_H_ */
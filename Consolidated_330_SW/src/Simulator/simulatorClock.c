@@ -0,0 +1,15 @@
+//*****************************************************************************
+// Runs the clock (src/Clock) in the simulator. Mirrors test_Full() in clockMain.c.
+//*****************************************************************************
+
+#include "simulator.h"
+#include "Clock/clockControl.h"
+#include "Clock/clockDisplay.h"
+
+#define TIMER_PERIOD .05  // 50ms period, same as clockMain.c
+
+static void simulatorClock_tick() {
+  clockControl_tick();
+}
+
+const simulator_app_t simulator_app = {"clock", TIMER_PERIOD, clockDisplay_init, simulatorClock_tick};
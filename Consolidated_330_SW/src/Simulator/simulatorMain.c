@@ -0,0 +1,170 @@
+//*****************************************************************************
+// Runs one of the applications (Clock, Simon, TicTacToe) headless on Linux on
+// top of the simulator backend of the HAL (supportFiles/halSim.c).
+//
+// Usage: <app>Sim <seconds> [scriptFile]
+//   Runs <seconds> of simulated time, then writes the LCD to <app>.ppm and
+//   prints timing statistics. The optional script feeds inputs, one event per
+//   line, at simulated time <ms> (lines must be in time order, # = comment):
+//     <ms> touch <x> <y>     touch at LCD coordinates (press or move)
+//     <ms> release           stop touching
+//     <ms> buttons <mask>    BTN3-BTN0 (e.g., 0x1 = BTN0 pressed)
+//     <ms> switches <mask>   SW3-SW0
+//     <ms> dump <file.ppm>   write the LCD image
+// Exits with 2 if the number of ticks run differs from interrupts_isrInvocationCount().
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simulator.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/interrupts.h"
+#include "supportFiles/leds.h"
+#include "supportFiles/display.h"
+#include "supportFiles/lcd.h"
+#include "supportFiles/lcdDrivers.h"
+#include "xparameters.h"
+
+#define TIMER_CLOCK_FREQUENCY ((XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ) / 2)
+
+#define SCRIPT_LINE_LENGTH 256
+#define SCRIPT_COMMAND_LENGTH 64
+#define DEFAULT_TOUCH_PRESSURE 100
+
+static FILE *script = NULL;
+static char scriptLine[SCRIPT_LINE_LENGTH];
+static bool scriptLinePending = false;  // scriptLine holds an event that is not due yet.
+static double scriptLineMs = 0;
+static uint32_t scriptLineNumber = 0;
+
+// Converts LCD coordinates to the raw touch-controller values that map back to them: the
+// calibration of touchCalibration_default(), run backwards.
+static void simulator_touchAt(int16_t x, int16_t y) {
+  // The extra half pixel keeps display_mapToLcdCoordinates() from rounding down to the neighbour.
+  double rawY = TOUCHCALIBRATION_MIN_X_TOUCH_POINT + (x + 0.5) * (TOUCHCALIBRATION_MAX_X_TOUCH_POINT - TOUCHCALIBRATION_MIN_X_TOUCH_POINT) / HALSIM_LCD_WIDTH;
+  double rawX = TOUCHCALIBRATION_MAX_Y_TOUCH_POINT - (y + 0.5) * (TOUCHCALIBRATION_MAX_Y_TOUCH_POINT - TOUCHCALIBRATION_MIN_Y_TOUCH_POINT) / HALSIM_LCD_HEIGHT;
+  halSim_touchPress(rawX, rawY, DEFAULT_TOUCH_PRESSURE);
+}
+
+// Executes one script event.
+static void simulator_runEvent(const char *line) {
+  char command[SCRIPT_COMMAND_LENGTH], argument[SCRIPT_LINE_LENGTH];
+  int x, y;
+  double ms;
+  if (sscanf(line, "%lf %63s", &ms, command) != 2) {
+    printf("script line %lu: cannot parse \"%s\".\n\r", (unsigned long) scriptLineNumber, line);
+  } else if (!strcmp(command, "touch") && (sscanf(line, "%*f %*s %d %d", &x, &y) == 2)) {
+    simulator_touchAt(x, y);
+  } else if (!strcmp(command, "release")) {
+    halSim_touchRelease();
+  } else if (!strcmp(command, "buttons") && (sscanf(line, "%*f %*s %255s", argument) == 1)) {
+    halSim_setButtons(strtoul(argument, NULL, 0));
+  } else if (!strcmp(command, "switches") && (sscanf(line, "%*f %*s %255s", argument) == 1)) {
+    halSim_setSwitches(strtoul(argument, NULL, 0));
+  } else if (!strcmp(command, "dump") && (sscanf(line, "%*f %*s %255s", argument) == 1)) {
+    display_flush();  // Make sure the frame buffer (if enabled) has reached the LCD.
+    halSim_lcdDumpPpm(argument);
+  } else {
+    printf("script line %lu: unknown event \"%s\".\n\r", (unsigned long) scriptLineNumber, line);
+  }
+}
+
+// Runs every script event that is due at the current simulated time.
+static void simulator_runScript() {
+  if (!script)
+    return;
+  double nowMs = (double) halSim_getTime() / HALSIM_TICKS_PER_MS;
+  while (true) {
+    if (!scriptLinePending) {
+      if (!fgets(scriptLine, sizeof(scriptLine), script)) {
+        fclose(script);
+        script = NULL;
+        return;
+      }
+      scriptLineNumber++;
+      scriptLine[strcspn(scriptLine, "\r\n")] = '\0';
+      if ((scriptLine[strspn(scriptLine, " \t")] == '#') || (sscanf(scriptLine, "%lf", &scriptLineMs) != 1))
+        continue;  // Comment or blank line.
+      scriptLinePending = true;
+    }
+    if (scriptLineMs > nowMs)
+      return;
+    simulator_runEvent(scriptLine);
+    scriptLinePending = false;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if ((argc < 2) || (argc > 3)) {
+    printf("usage: %s <seconds> [scriptFile]\n\r", argv[0]);
+    return 1;
+  }
+  double seconds = atof(argv[1]);
+  if (argc == 3) {
+    script = fopen(argv[2], "r");
+    if (!script) {
+      printf("could not open script %s.\n\r", argv[2]);
+      return 1;
+    }
+  }
+  uint64_t endTime = seconds * HALSIM_TICKS_PER_SECOND;
+  clock_t hostStart = clock();
+  // Same start-up as the main() of the applications.
+  leds_init(true);
+  interrupts_initAll(true);
+  interrupts_setPrivateTimerLoadValue(simulator_app.tickPeriodSeconds * TIMER_CLOCK_FREQUENCY - 1.0);
+  interrupts_enableTimerGlobalInts();
+  display_enableCommandQueue(true);  // Same as the mains: ticks queue, the loop draws.
+  display_enableTouchInterrupts();   // Same as the mains: the touch ISR reads the samples.
+  if (simulator_app.init)
+    simulator_app.init();
+  display_flush();  // So that the pixel count below only covers the ticks.
+  uint64_t initPixels = halSim_getLcdPixelWriteCount(), ticksStart = halSim_getTime();
+  interrupts_startArmPrivateTimer();
+  interrupts_enableArmInts();
+  uint32_t tickCount = 0;
+  uint64_t maxTickTime = 0;
+  // An interrupt taken right at the end still gets its tick, so that every ISR call has one.
+  while ((halSim_getTime() < endTime) || interrupts_isrFlagGlobal) {
+    simulator_runScript();
+    if (interrupts_isrFlagGlobal) {  // Set by the timer ISR.
+      uint64_t tickStart = halSim_getTime();
+      tickCount++;
+      simulator_app.tick();
+      interrupts_isrFlagGlobal = 0;
+      if (halSim_getTime() - tickStart > maxTickTime)
+        maxTickTime = halSim_getTime() - tickStart;
+    } else if (display_drainQueue(DISPLAY_DRAIN_BUDGET_US)) {
+      halSim_waitForInterrupt();  // Nothing left to draw.
+    }
+  }
+  interrupts_disableArmInts();
+  display_flush();
+  double hostSeconds = (double) (clock() - hostStart) / CLOCKS_PER_SEC;
+  char fileName[SCRIPT_LINE_LENGTH];
+  snprintf(fileName, sizeof(fileName), "%s.ppm", simulator_app.name);
+  halSim_lcdDumpPpm(fileName);
+  printf("%s: %.3f s simulated in %.3f s host time.\n\r", simulator_app.name,
+      (double) halSim_getTime() / HALSIM_TICKS_PER_SECOND, hostSeconds);
+  printf("ticks: %lu, isr invocations: %lu, missed timer interrupts: %lu\n\r", (unsigned long) tickCount,
+      (unsigned long) interrupts_isrInvocationCount(), (unsigned long) halSim_getMissedTimerInterruptCount());
+  printf("longest tick: %.3f ms, LCD bus writes: %lu, HAL accesses: %llu\n\r",
+      (double) maxTickTime / HALSIM_TICKS_PER_MS, (unsigned long) LCD_getBusWriteCount(),
+      (unsigned long long) halSim_getAxiAccessCount());
+  printf("LCD pixels written: %llu by init, then %.0f per second.\n\r",
+      (unsigned long long) initPixels, (double) (halSim_getLcdPixelWriteCount() - initPixels) *
+      HALSIM_TICKS_PER_SECOND / (halSim_getTime() - ticksStart));
+  printf("touch-controller SPI transactions: %llu\n\r", (unsigned long long) halSim_getTouchTransactionCount());
+  display_printCommandQueueStats();
+  printf("address window: %lu register writes skipped (%lu LCD bus writes).\n\r",
+      (unsigned long) lcdDrivers_getSkippedWindowRegisterWrites(), (unsigned long) lcdDrivers_getSavedWindowBusWrites());
+  printf("LCD image written to %s.\n\r", fileName);
+  // Every timer interrupt must have been handled by exactly one tick (see test_Full() in the mains).
+  if (tickCount != interrupts_isrInvocationCount()) {
+    printf("%s: missed ticks, the tick function took longer than the timer period.\n\r", simulator_app.name);
+    return 2;
+  }
+  return 0;
+}
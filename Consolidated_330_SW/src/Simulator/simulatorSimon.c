@@ -0,0 +1,29 @@
+//*****************************************************************************
+// Runs SIMON (src/Simon) in the simulator. Mirrors runGame() in simonMain.c.
+//*****************************************************************************
+
+#include "simulator.h"
+#include "Simon/simonControl.h"
+#include "Simon/buttonHandler.h"
+#include "Simon/flashSequence.h"
+#include "Simon/verifySequence.h"
+#include "supportFiles/display.h"
+
+#define TIMER_PERIOD .01  // 10ms period, same as simonMain.c
+
+static void simulatorSimon_init() {
+  // Make sure all state machines are disabled.
+  buttonHandler_disable();
+  verifySequence_disable();
+  flashSequence_disable();
+  display_init();
+}
+
+static void simulatorSimon_tick() {
+  simonControl_tick();
+  buttonHandler_tick();
+  verifySequence_tick();
+  flashSequence_tick();
+}
+
+const simulator_app_t simulator_app = {"simon", TIMER_PERIOD, simulatorSimon_init, simulatorSimon_tick};
@@ -0,0 +1,12 @@
+//*****************************************************************************
+// Runs Tic Tac Toe (src/TicTacToe) in the simulator. Mirrors test_Full() in ticTacToeMain.c.
+//*****************************************************************************
+
+#include <stddef.h>
+#include "simulator.h"
+#include "TicTacToe/ticTacToeControl.h"
+
+#define TIMER_PERIOD .2  // 200ms period, same as ticTacToeMain.c
+
+// ticTacToeControl_tick() initializes the display itself.
+const simulator_app_t simulator_app = {"ticTacToe", TIMER_PERIOD, NULL, ticTacToeControl_tick};
@@ -0,0 +1,128 @@
+//*****************************************************************************
+// Host test for the SPI transfer engine (spi.c), run on the simulator backend
+// of the HAL, which models the AXI SPI FIFOs, the transmit-empty interrupt and
+// the time bytes take on the wire. Reads touch samples from the STMPE610 FIFO
+// byte by byte with spi_transfer(), with spi_transferBuffer(), and with
+// spi_transferBufferAsync() driven by the SPI interrupt and by polling
+// spi_service(), and prints the SPI register accesses per byte and how much of
+// the transfer time the CPU had for other work. Returns nonzero if a path
+// reads different samples or a blocking transfer runs during an asynchronous
+// one.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "supportFiles/display.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/interrupts.h"
+#include "supportFiles/spi.h"
+#include "supportFiles/Adafruit_STMPE610.h"
+
+#define SPI_TEST_RAW_X 1200
+#define SPI_TEST_RAW_Y 2400
+#define SPI_TEST_Z 40
+#define SPI_TEST_SAMPLES 8  // Samples read by each path.
+#define SPI_TEST_BYTES (SPI_TEST_SAMPLES * STMPE_SAMPLE_BYTES + 2)
+#define TICKS_PER_US (HALSIM_TICKS_PER_SECOND / 1000000)
+
+static uint8_t tx[SPI_TEST_BYTES], rx[SPI_TEST_BYTES];
+static volatile bool transferDone;
+static uint64_t startAccesses, startTime;
+
+// Queues a few more samples than a path reads.
+static void spiTest_fillFifo() {
+  halSim_touchPress(SPI_TEST_RAW_X, SPI_TEST_RAW_Y, SPI_TEST_Z);
+  halSim_advanceTime((SPI_TEST_SAMPLES + 1) * HALSIM_TOUCH_SAMPLE_PERIOD_TICKS);
+  halSim_touchRelease();
+}
+
+// Selects the touch controller and gets the bit order and mode right, as the driver does.
+static void spiTest_begin() {
+  spiTest_fillFifo();
+  memset(rx, 0, sizeof(rx));
+  spi_beginTransaction(SPI_MSBFIRST, SPI_MODE_0);
+  spi_setTouchScreenControllerSlaveSelect();
+  startAccesses = halSim_getAxiAccessCount();
+  startTime = halSim_getTime();
+}
+
+// Called from the SPI interrupt (or spi_service()) at the end of an asynchronous transfer.
+static void spiTest_done(void *context) {
+  spi_clearAllSlaveSelects();
+  *(volatile bool *) context = true;
+}
+
+// Checks the samples (answers start two bytes late) and prints the cost. workUs is the time spent
+// on other work while the transfer ran. Returns the number of bad samples.
+static uint32_t spiTest_end(const char *name, uint64_t workUs) {
+  uint64_t accesses = halSim_getAxiAccessCount() - startAccesses;
+  uint64_t us = (halSim_getTime() - startTime) / TICKS_PER_US;
+  spi_clearAllSlaveSelects();
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < SPI_TEST_SAMPLES; i++) {
+    const uint8_t *data = rx + 2 + i * STMPE_SAMPLE_BYTES;
+    uint16_t x = (data[0] << 4) | (data[1] >> 4), y = ((data[1] & 0x0F) << 8) | data[2];
+    errors += (x != SPI_TEST_RAW_X) || (y != SPI_TEST_RAW_Y) || (data[3] != SPI_TEST_Z);
+  }
+  printf("%-26s %6.1f SPI register accesses/byte %5lu us, %3lu%% of it for other work, %lu bad samples\n\r",
+      name, (double) accesses / SPI_TEST_BYTES, (unsigned long) us,
+      (unsigned long) (us ? 100 * workUs / us : 0), (unsigned long) errors);
+  return errors;
+}
+
+int main() {
+  display_init();
+  interrupts_initAll(false);
+  interrupts_enableArmInts();
+  uint32_t errors = 0;
+  memset(tx, STMPE_TSC_DATA, SPI_TEST_SAMPLES * STMPE_SAMPLE_BYTES);
+
+  spiTest_begin();
+  for (uint32_t i = 0; i < SPI_TEST_BYTES; i++)
+    rx[i] = spi_transfer(tx[i]);
+  errors += spiTest_end("spi_transfer", 0);
+
+  spiTest_begin();
+  spi_transferBuffer(tx, rx, SPI_TEST_BYTES);
+  errors += spiTest_end("spi_transferBuffer", 0);
+
+  // Other work goes on 1 us at a time until the interrupt has finished the transfer.
+  uint64_t workUs = 0;
+  spiTest_begin();
+  transferDone = false;
+  spi_transferBufferAsync(tx, rx, SPI_TEST_BYTES, spiTest_done, (void *) &transferDone);
+  while (!transferDone) {
+    halSim_advanceTime(TICKS_PER_US);
+    workUs++;
+  }
+  errors += spiTest_end("spi_transferBufferAsync", workUs);
+
+  // The same without the interrupt: a tick polls spi_service() every 10 us.
+  interrupts_disableArmInts();
+  workUs = 0;
+  spiTest_begin();
+  transferDone = false;
+  spi_transferBufferAsync(tx, rx, SPI_TEST_BYTES, spiTest_done, (void *) &transferDone);
+  // A blocking transfer is refused while the FIFOs are in use, and leaves this one intact.
+  uint8_t blockedRx[STMPE_SAMPLE_BYTES];
+  if (spi_transferBuffer(tx, blockedRx, sizeof(blockedRx))) {
+    printf("spi_transferBuffer ran during an asynchronous transfer\n\r");
+    errors++;
+  }
+  while (!transferDone) {
+    halSim_advanceTime(10 * TICKS_PER_US);
+    workUs += 10;
+    spi_service();
+  }
+  errors += spiTest_end("spi_service() every 10 us", workUs);
+  interrupts_enableArmInts();
+
+  // The driver on top of it still reads the same pressure.
+  int16_t x, y;
+  uint8_t z;
+  display_clearOldTouchData();
+  spiTest_fillFifo();
+  display_getTouchedPoint(&x, &y, &z);
+  errors += (z != SPI_TEST_Z);
+  return errors != 0;
+}
@@ -0,0 +1,133 @@
+//*****************************************************************************
+// Host test for printing whole strings (Adafruit_GFX::write(buffer, size) and
+// drawTextLine()), run on the simulator backend of the HAL. Prints 400 random
+// strings, with text sizes 1-4, wrap on and off, starts off the screen, '\n'
+// and '\r', opaque and transparent, once a character at a time through
+// write(uint8_t) and once as a whole string, and compares every pixel of the
+// LCD and the final cursor. Also checks that nothing is drawn outside the box
+// getTextBounds() gives. Returns nonzero if anything differs.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "supportFiles/Adafruit_TFTLCD.h"
+#include "supportFiles/display.h"
+#include "supportFiles/halSim.h"
+
+#define TEXT_TEST_STRINGS 400
+#define TEXT_TEST_MAX_LENGTH 80
+#define TEXT_TEST_BG DISPLAY_BLUE  // The screen behind the text.
+
+// Adafruit_TFTLCD with the cursor made visible.
+class TextTestLcd : public Adafruit_TFTLCD {
+ public:
+  int16_t cursorX() { return cursor_x; }
+  int16_t cursorY() { return cursor_y; }
+};
+
+static TextTestLcd lcd;
+static uint16_t perCharacter[HALSIM_LCD_HEIGHT][HALSIM_LCD_WIDTH];  // The LCD after write(uint8_t).
+static uint32_t randomState = 2026;
+
+// xorshift32, so the strings are the same on every host.
+static uint32_t textTest_random() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+// A number from low to high, both included.
+static int16_t textTest_randomRange(int16_t low, int16_t high) {
+  return low + (int16_t) (textTest_random() % (uint32_t) (high - low + 1));
+}
+
+// Mostly printable characters, with line breaks, carriage returns and the rest of the font.
+static size_t textTest_randomString(uint8_t *text) {
+  size_t length = textTest_randomRange(1, TEXT_TEST_MAX_LENGTH);
+  for (size_t i = 0; i < length; i++) {
+    switch (textTest_random() % 10) {
+    case 0:
+      text[i] = '\n';
+      break;
+    case 1:
+      text[i] = '\r';
+      break;
+    case 2:
+      text[i] = textTest_randomRange(1, 255);
+      break;
+    default:
+      text[i] = textTest_randomRange(' ', '~');
+    }
+  }
+  return length;
+}
+
+// Prints text from (x, y) both ways and returns the number of differences.
+static uint32_t textTest_compare(const uint8_t *text, size_t length, int16_t x, int16_t y) {
+  uint32_t wrong = 0, outside = 0;
+  lcd.fillScreen(TEXT_TEST_BG);
+  lcd.setCursor(x, y);
+  for (size_t i = 0; i < length; i++) {
+    lcd.write(text[i]);
+  }
+  int16_t cursorX = lcd.cursorX(), cursorY = lcd.cursorY();
+  for (int16_t j = 0; j < HALSIM_LCD_HEIGHT; j++) {
+    for (int16_t i = 0; i < HALSIM_LCD_WIDTH; i++) {
+      perCharacter[j][i] = halSim_lcdReadPixel(i, j);
+    }
+  }
+
+  // getTextBounds() stops at the first '\0', which the font also draws.
+  char str[TEXT_TEST_MAX_LENGTH + 1];
+  memcpy(str, text, length);
+  str[length] = '\0';
+  int16_t x1, y1;
+  uint16_t w, h;
+  bool measured = strlen(str) == length;
+  if (measured)
+    lcd.getTextBounds(str, x, y, &x1, &y1, &w, &h);
+
+  lcd.fillScreen(TEXT_TEST_BG);
+  lcd.setCursor(x, y);
+  lcd.write(text, length);
+  for (int16_t j = 0; j < HALSIM_LCD_HEIGHT; j++) {
+    for (int16_t i = 0; i < HALSIM_LCD_WIDTH; i++) {
+      uint16_t pixel = halSim_lcdReadPixel(i, j);
+      wrong += pixel != perCharacter[j][i];
+      if (measured && (pixel != TEXT_TEST_BG))
+        outside += (i < x1) || (j < y1) || (i >= x1 + w) || (j >= y1 + h);
+    }
+  }
+  if (wrong || outside || (cursorX != lcd.cursorX()) || (cursorY != lcd.cursorY())) {
+    printf("%u characters from (%d, %d): %lu pixels differ, %lu outside the bounds, cursor (%d, %d) instead of "
+      "(%d, %d)\n\r", (unsigned) length, x, y, (unsigned long) wrong, (unsigned long) outside, lcd.cursorX(),
+      lcd.cursorY(), cursorX, cursorY);
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  uint8_t text[TEXT_TEST_MAX_LENGTH];
+  uint32_t errors = 0;
+  lcd.begin();
+  lcd.setRotation(1);  // Same as display_init().
+  for (uint16_t n = 0; n < TEXT_TEST_STRINGS; n++) {
+    size_t length = textTest_randomString(text);
+    uint8_t size = textTest_randomRange(1, 4);
+    lcd.setTextSize(size);
+    lcd.setTextWrap(textTest_random() % 2);
+    if (textTest_random() % 2)
+      lcd.setTextColor(DISPLAY_YELLOW);  // Transparent.
+    else
+      lcd.setTextColor(DISPLAY_YELLOW, DISPLAY_RED);
+    // Starts up to two characters past each edge.
+    int16_t x = textTest_randomRange(-12 * size, lcd.width() + 6 * size);
+    int16_t y = textTest_randomRange(-16 * size, lcd.height() + 8 * size);
+    errors += textTest_compare(text, length, x, y);
+  }
+  printf("%d strings, %lu differ\n\r", TEXT_TEST_STRINGS, (unsigned long) errors);
+  printf("%s\n\r", errors ? "text test FAILED" : "text test passed");
+  return errors != 0;
+}
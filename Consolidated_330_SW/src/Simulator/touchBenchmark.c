@@ -0,0 +1,87 @@
+//*****************************************************************************
+// Host benchmark for reading the touch controller, run on the simulator
+// backend of the HAL, which models the AXI SPI core and the STMPE610 sample
+// FIFO. Fills the FIFO while the panel is pressed, then prints, per sample,
+// the SPI transactions (slave-select assertions), the SPI register accesses and
+// the simulated time of display_getTouchedPoint(), of display_getTouchedPoints()
+// reading the whole FIFO in one burst, and of draining the FIFO. Returns
+// nonzero if a sample does not decode to the pressed point.
+//*****************************************************************************
+
+#include <stdio.h>
+#include "supportFiles/display.h"
+#include "supportFiles/halSim.h"
+
+#define TOUCH_BENCHMARK_RAW_X 1200
+#define TOUCH_BENCHMARK_RAW_Y 2400
+#define TOUCH_BENCHMARK_Z 40
+#define TOUCH_BENCHMARK_SAMPLES 64  // Samples queued in the FIFO before each measurement.
+#define TICKS_PER_US (HALSIM_TICKS_PER_SECOND / 1000000.0)
+
+static display_touchPoint_t points[TOUCH_BENCHMARK_SAMPLES];
+static uint64_t startTransactions, startAccesses, startTime;
+
+// Releases the panel, throws the old samples away and presses it again until samples are queued.
+static void touchBenchmark_fillFifo(uint32_t samples) {
+  halSim_touchRelease();
+  display_clearOldTouchData();
+  halSim_touchPress(TOUCH_BENCHMARK_RAW_X, TOUCH_BENCHMARK_RAW_Y, TOUCH_BENCHMARK_Z);
+  halSim_advanceTime(samples * HALSIM_TOUCH_SAMPLE_PERIOD_TICKS + HALSIM_TOUCH_SAMPLE_PERIOD_TICKS / 2);
+  halSim_touchRelease();  // No new samples while measuring.
+}
+
+static void touchBenchmark_start() {
+  startTransactions = halSim_getTouchTransactionCount();
+  startAccesses = halSim_getAxiAccessCount();
+  startTime = halSim_getTime();
+}
+
+static void touchBenchmark_print(const char *name, uint32_t samples) {
+  printf("%-26s %6.2f SPI transactions/sample %7.1f SPI register accesses/sample %7.2f us/sample\n\r", name,
+      (double) (halSim_getTouchTransactionCount() - startTransactions) / samples,
+      (double) (halSim_getAxiAccessCount() - startAccesses) / samples,
+      (halSim_getTime() - startTime) / TICKS_PER_US / samples);
+}
+
+// The pressed point in LCD coordinates, as the first sample read decodes it.
+static int16_t pressedX = -1, pressedY = -1;
+
+static bool touchBenchmark_isPressedPoint(int16_t x, int16_t y, uint8_t z) {
+  if (pressedX < 0) {
+    pressedX = x;
+    pressedY = y;
+  }
+  return (x == pressedX) && (y == pressedY) && (z == TOUCH_BENCHMARK_Z);
+}
+
+int main() {
+  display_init();
+  uint32_t errors = 0;
+
+  touchBenchmark_fillFifo(TOUCH_BENCHMARK_SAMPLES);
+  touchBenchmark_start();
+  for (uint32_t i = 0; i < TOUCH_BENCHMARK_SAMPLES; i++) {
+    int16_t x, y;
+    uint8_t z;
+    display_getTouchedPoint(&x, &y, &z);
+    errors += !touchBenchmark_isPressedPoint(x, y, z);
+  }
+  touchBenchmark_print("display_getTouchedPoint", TOUCH_BENCHMARK_SAMPLES);
+
+  touchBenchmark_fillFifo(TOUCH_BENCHMARK_SAMPLES);
+  touchBenchmark_start();
+  uint8_t count = display_getTouchedPoints(points, TOUCH_BENCHMARK_SAMPLES);
+  touchBenchmark_print("display_getTouchedPoints", count);
+  errors += TOUCH_BENCHMARK_SAMPLES - count;
+  for (uint8_t i = 0; i < count; i++)
+    errors += !touchBenchmark_isPressedPoint(points[i].x, points[i].y, points[i].z);
+
+  touchBenchmark_fillFifo(TOUCH_BENCHMARK_SAMPLES);
+  touchBenchmark_start();
+  display_clearOldTouchData();
+  touchBenchmark_print("display_clearOldTouchData", TOUCH_BENCHMARK_SAMPLES);
+
+  if (errors)
+    printf("%lu samples did not decode to the pressed point.\n\r", (unsigned long) errors);
+  return errors != 0;
+}
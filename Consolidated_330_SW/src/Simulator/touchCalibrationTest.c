@@ -0,0 +1,174 @@
+//*****************************************************************************
+// Host test for the fixed-point touch calibration (touchCalibration.c), run on
+// the simulator backend of the HAL. Compares the default matrix with the
+// floating-point mapping display.cpp used before, solves for a skewed and
+// slightly rotated panel from 3 exact and from 5 noisy presses and prints the
+// largest mapping error over the whole panel, then presses the panel in each
+// rotation and checks that the mapped point is the pixel under the finger.
+// Also times the floating-point and the fixed-point mapping on the host.
+// Returns nonzero if an error is larger than allowed.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "supportFiles/display.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/touchCalibration.h"
+
+#define TOUCH_CALIBRATION_TEST_Z 40
+#define TOUCH_CALIBRATION_TEST_NOISE 8        // Raw units of noise on each press for the least-squares fit.
+#define TOUCH_CALIBRATION_TEST_MAPPINGS 10000000  // Mappings timed by the benchmark.
+
+static uint32_t errors = 0;
+
+// The floating-point mapping display.cpp used before the matrix.
+__attribute__((noinline)) static void touchCalibrationTest_floatMap(int16_t *x, int16_t *y) {
+  float lcdX = *y;
+  float lcdY = *x;
+  lcdY = (TOUCHCALIBRATION_MAX_Y_TOUCH_POINT) - lcdY;
+  lcdY = (lcdY / (TOUCHCALIBRATION_MAX_Y_TOUCH_POINT - TOUCHCALIBRATION_MIN_Y_TOUCH_POINT)) * HALSIM_LCD_HEIGHT;
+  lcdX -= TOUCHCALIBRATION_MIN_X_TOUCH_POINT;
+  lcdX = (lcdX / (TOUCHCALIBRATION_MAX_X_TOUCH_POINT - TOUCHCALIBRATION_MIN_X_TOUCH_POINT)) * HALSIM_LCD_WIDTH;
+  *x = lcdX;
+  *y = lcdY;
+}
+
+// A panel glued on a little rotated, with its own scale in each direction: the raw value at LCD
+// (rotation 1) coordinates (x, y). noise adds up to +-noise raw units.
+static touchCalibration_point_t touchCalibrationTest_panel(double x, double y, int32_t noise) {
+  double rawX = 3880 - 15.1 * y + 0.35 * x, rawY = 360 + 11.2 * x + 0.5 * y;
+  if (noise) {
+    rawX += rand() % (2 * noise + 1) - noise;
+    rawY += rand() % (2 * noise + 1) - noise;
+  }
+  touchCalibration_point_t raw = {(int16_t) (rawX + 0.5), (int16_t) (rawY + 0.5)};
+  return raw;
+}
+
+// Largest distance, in pixels along x or y, between where each pixel of the panel is pressed and
+// where the calibration maps the press.
+static int32_t touchCalibrationTest_maxError(const touchCalibration_t *calibration) {
+  int32_t maxError = 0;
+  for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++) {
+    for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++) {
+      touchCalibration_point_t raw = touchCalibrationTest_panel(x + 0.5, y + 0.5, 0);
+      touchCalibration_map(calibration, 1, &raw.x, &raw.y);
+      if (abs(raw.x - x) > maxError)
+        maxError = abs(raw.x - x);
+      if (abs(raw.y - y) > maxError)
+        maxError = abs(raw.y - y);
+    }
+  }
+  return maxError;
+}
+
+// Solves from presses at the first count calibration targets (rotation 1) and prints the error.
+static void touchCalibrationTest_solve(const char *name, uint8_t count, int32_t noise, int32_t allowedError) {
+  static const touchCalibration_point_t lcd[] = {{32, 24}, {288, 24}, {160, 216}, {32, 216}, {288, 216}};
+  touchCalibration_point_t raw[5];
+  for (uint8_t i = 0; i < count; i++)
+    raw[i] = touchCalibrationTest_panel(lcd[i].x + 0.5, lcd[i].y + 0.5, noise);
+  touchCalibration_t calibration;
+  if (!touchCalibration_solve(&calibration, raw, lcd, count)) {
+    printf("%s: no solution\n\r", name);
+    errors++;
+    return;
+  }
+  int32_t maxError = touchCalibrationTest_maxError(&calibration);
+  printf("%-36s largest error %ld px\n\r", name, (long) maxError);
+  errors += maxError > allowedError;
+}
+
+// Presses the skewed panel at LCD (rotation 1) pixel (x1, y1) in the given rotation, draws the
+// mapped point and checks that it lit the pixel under the finger.
+static void touchCalibrationTest_pressInRotation(uint8_t rotation, int16_t x1, int16_t y1) {
+  display_setRotation(rotation);
+  touchCalibration_point_t raw = touchCalibrationTest_panel(x1 + 0.5, y1 + 0.5, 0);
+  display_clearOldTouchData();
+  halSim_touchPress(raw.x, raw.y, TOUCH_CALIBRATION_TEST_Z);
+  halSim_advanceTime(2 * HALSIM_TOUCH_SAMPLE_PERIOD_TICKS);
+  int16_t x, y;
+  uint8_t z;
+  display_getTouchedPoint(&x, &y, &z);
+  halSim_touchRelease();
+  display_fillScreen(DISPLAY_BLACK);
+  display_fillRect(x, y, 1, 1, DISPLAY_WHITE);
+  display_flush();
+  if (halSim_lcdReadPixel(x1, y1) != DISPLAY_WHITE) {
+    printf("rotation %d: pressed (%d, %d) of rotation 1, mapped to (%d, %d)\n\r", rotation, x1, y1, x, y);
+    errors++;
+  }
+}
+
+int main() {
+  touchCalibration_t calibration;
+  touchCalibration_default(&calibration);
+
+  // The default matrix against the floating-point mapping, over all raw values on the panel (off
+  // the panel the floating-point mapping truncated toward 0, the matrix rounds down).
+  int32_t maxDifference = 0, differences = 0, samples = 0;
+  for (int16_t rawX = 0; rawX <= TOUCHCALIBRATION_MAX_Y_TOUCH_POINT; rawX++) {
+    for (int16_t rawY = TOUCHCALIBRATION_MIN_X_TOUCH_POINT; rawY < 4096; rawY++) {
+      int16_t fixedX = rawX, fixedY = rawY, floatX = rawX, floatY = rawY;
+      touchCalibration_map(&calibration, 1, &fixedX, &fixedY);
+      touchCalibrationTest_floatMap(&floatX, &floatY);
+      int32_t difference = abs(fixedX - floatX) > abs(fixedY - floatY) ? abs(fixedX - floatX) : abs(fixedY - floatY);
+      differences += difference != 0;
+      if (difference > maxDifference)
+        maxDifference = difference;
+      samples++;
+    }
+  }
+  printf("%-36s largest difference %ld px, %.3f%% of the points differ\n\r", "default matrix vs. floating point",
+      (long) maxDifference, 100.0 * differences / samples);
+  errors += maxDifference > 1;
+
+  touchCalibrationTest_solve("3 exact presses", 3, 0, 1);
+  srand(1);
+  touchCalibrationTest_solve("3 presses, +-8 raw units of noise", 3, TOUCH_CALIBRATION_TEST_NOISE, 3);
+  srand(1);
+  touchCalibrationTest_solve("5 presses, +-8 raw units of noise", 5, TOUCH_CALIBRATION_TEST_NOISE, 2);
+
+  // Presses on one line do not give a matrix.
+  touchCalibration_point_t lineRaw[3] = {{100, 100}, {200, 200}, {300, 300}}, lineLcd[3] = {{0, 0}, {10, 10}, {20, 20}};
+  if (touchCalibration_solve(&calibration, lineRaw, lineLcd, 3)) {
+    printf("solved for presses on one line\n\r");
+    errors++;
+  }
+
+  // Through the driver, in every rotation.
+  static const touchCalibration_point_t lcd[] = {{32, 24}, {288, 24}, {160, 216}, {32, 216}, {288, 216}};
+  touchCalibration_point_t raw[5];
+  for (uint8_t i = 0; i < 5; i++)
+    raw[i] = touchCalibrationTest_panel(lcd[i].x + 0.5, lcd[i].y + 0.5, 0);
+  touchCalibration_solve(&calibration, raw, lcd, 5);
+  display_init();
+  display_setTouchCalibration(&calibration);
+  for (uint8_t rotation = 0; rotation < 4; rotation++) {
+    touchCalibrationTest_pressInRotation(rotation, 10, 20);
+    touchCalibrationTest_pressInRotation(rotation, 300, 40);
+    touchCalibrationTest_pressInRotation(rotation, 170, 230);
+  }
+  display_setRotation(1);
+
+  // Host time per mapping. The simulator counts HAL accesses but not instructions, so this is
+  // only a relative measure of the arithmetic.
+  volatile int32_t sink = 0;
+  clock_t start = clock();
+  for (uint32_t i = 0; i < TOUCH_CALIBRATION_TEST_MAPPINGS; i++) {
+    int16_t x = i & 0xFFF, y = (i >> 12) & 0xFFF;
+    touchCalibrationTest_floatMap(&x, &y);
+    sink += x + y;
+  }
+  double floatNs = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / TOUCH_CALIBRATION_TEST_MAPPINGS;
+  start = clock();
+  for (uint32_t i = 0; i < TOUCH_CALIBRATION_TEST_MAPPINGS; i++) {
+    int16_t x = i & 0xFFF, y = (i >> 12) & 0xFFF;
+    touchCalibration_map(&calibration, 1, &x, &y);
+    sink += x + y;
+  }
+  double fixedNs = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / TOUCH_CALIBRATION_TEST_MAPPINGS;
+  printf("host time per mapping: %.2f ns floating point, %.2f ns Q16 matrix\n\r", floatNs, fixedNs);
+  return errors != 0;
+}
@@ -0,0 +1,141 @@
+//*****************************************************************************
+// Host test for interrupt-driven touch input (display_enableTouchInterrupts()),
+// run on the simulator backend of the HAL, which models the STMPE610 INT line.
+// Counts the SPI transactions with the touch controller while an app waits for
+// a touch, polling every 10 ms and with the ISR, then presses, drags and
+// releases the panel and checks that the events come out as one down, moves
+// and one up, in order, and that display_isTouched() follows the panel. Then
+// lets a backlog of samples build up with interrupts off and checks that the
+// ISR reads it in several short bursts without losing a sample. Prints the
+// time from the press to the down event and the longest ISR. Returns nonzero
+// on failure.
+//*****************************************************************************
+
+#include <stdio.h>
+#include "supportFiles/display.h"
+#include "supportFiles/globalTimer.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/interrupts.h"
+
+#define TOUCH_EVENT_TEST_RAW_X 1200
+#define TOUCH_EVENT_TEST_RAW_Y 2400
+#define TOUCH_EVENT_TEST_Z 40
+#define TOUCH_EVENT_TEST_MOVES 4           // Points the panel is dragged through.
+#define TOUCH_EVENT_TEST_IDLE_MS 1000      // How long the app waits for a touch.
+#define TOUCH_EVENT_TEST_BACKLOG 30        // Samples taken while interrupts are off (one event slot spare).
+#define TOUCH_EVENT_TEST_MAX_ISR_US 1000   // Longest a touch ISR may run: a tenth of Simon's tick.
+#define TICKS_PER_MS (HALSIM_TICKS_PER_SECOND / 1000)
+#define TICKS_PER_US (HALSIM_TICKS_PER_SECOND / 1000000)
+
+static uint32_t errors = 0;
+
+static void touchEventTest_check(bool ok, const char *what) {
+  if (!ok) {
+    printf("touchEventTest: %s\n\r", what);
+    errors++;
+  }
+}
+
+// An app waiting for a touch: display_isTouched() every 10 ms. Returns the SPI transactions it took.
+static uint64_t touchEventTest_idle() {
+  uint64_t startTransactions = halSim_getTouchTransactionCount();
+  for (uint32_t ms = 0; ms < TOUCH_EVENT_TEST_IDLE_MS; ms += 10) {
+    halSim_advanceTime(10 * TICKS_PER_MS);
+    display_isTouched();
+  }
+  return halSim_getTouchTransactionCount() - startTransactions;
+}
+
+int main() {
+  display_init();
+  interrupts_initAll(false);
+  interrupts_enableArmInts();
+
+  uint64_t polled = touchEventTest_idle();
+  touchEventTest_check(display_enableTouchInterrupts(), "display_enableTouchInterrupts() failed");
+  uint64_t interruptDriven = touchEventTest_idle();
+  printf("Waiting %d ms for a touch: %lu SPI transactions polled, %lu with the touch interrupt\n\r",
+      TOUCH_EVENT_TEST_IDLE_MS, (unsigned long) polled, (unsigned long) interruptDriven);
+  touchEventTest_check(interruptDriven == 0, "SPI traffic while idle with the touch interrupt");
+
+  // Press, then wait for the down event the way an app's main loop would.
+  display_touchEvent_t event;
+  uint64_t pressTime = halSim_getTime();
+  uint64_t pressTimerValue = globalTimer_getTimerValue();
+  halSim_touchPress(TOUCH_EVENT_TEST_RAW_X, TOUCH_EVENT_TEST_RAW_Y, TOUCH_EVENT_TEST_Z);
+  while (!display_getTouchEvent(&event) && halSim_getTime() - pressTime < 100 * TICKS_PER_MS)
+    halSim_advanceTime(TICKS_PER_US);
+  printf("Press to DISPLAY_TOUCH_DOWN: %lu us\n\r", (unsigned long) ((halSim_getTime() - pressTime) / TICKS_PER_US));
+  touchEventTest_check(event.type == DISPLAY_TOUCH_DOWN, "the first event is not a touch-down");
+  touchEventTest_check(event.z == TOUCH_EVENT_TEST_Z, "the touch-down has the wrong pressure");
+  touchEventTest_check(event.time >= pressTimerValue, "the touch-down is time-stamped before the press");
+  touchEventTest_check(display_isTouched(), "display_isTouched() is false while pressed");
+  uint64_t lastTime = event.time;
+  int16_t downX = event.x, downY = event.y;
+
+  // Drag, let a few samples come in at each point, then release and let the up event through.
+  for (uint32_t i = 1; i <= TOUCH_EVENT_TEST_MOVES; i++) {
+    halSim_touchPress(TOUCH_EVENT_TEST_RAW_X + 100 * i, TOUCH_EVENT_TEST_RAW_Y, TOUCH_EVENT_TEST_Z);
+    halSim_advanceTime(3 * HALSIM_TOUCH_SAMPLE_PERIOD_TICKS);
+  }
+  halSim_touchRelease();
+  halSim_advanceTime(10 * TICKS_PER_MS);
+  touchEventTest_check(!display_isTouched(), "display_isTouched() is true after the release");
+
+  uint32_t moves = 0, ups = 0;
+  bool moved = false;
+  while (display_getTouchEvent(&event)) {
+    touchEventTest_check(event.time >= lastTime, "events are out of order");
+    touchEventTest_check(ups == 0, "an event after the touch-up");
+    lastTime = event.time;
+    if (event.type == DISPLAY_TOUCH_MOVE) {
+      moves++;
+      moved |= (event.x != downX) || (event.y != downY);
+    } else if (event.type == DISPLAY_TOUCH_UP) {
+      ups++;
+    } else {
+      touchEventTest_check(false, "a second touch-down");
+    }
+  }
+  printf("%lu moves, %lu ups, %lu events dropped\n\r", (unsigned long) moves, (unsigned long) ups,
+      (unsigned long) display_getDroppedTouchEventCount());
+  touchEventTest_check(moves >= TOUCH_EVENT_TEST_MOVES && moved, "the drag did not produce moves");
+  touchEventTest_check(ups == 1, "not exactly one touch-up");
+  touchEventTest_check(display_getDroppedTouchEventCount() == 0, "events were dropped");
+
+  // Hold interrupts off while samples pile up in the FIFO. The ISR stays pending until it has read
+  // them all, one burst per call, and the simulator calls it once per time step.
+  interrupts_disableArmInts();
+  halSim_touchPress(TOUCH_EVENT_TEST_RAW_X, TOUCH_EVENT_TEST_RAW_Y, TOUCH_EVENT_TEST_Z);
+  halSim_advanceTime(TOUCH_EVENT_TEST_BACKLOG * HALSIM_TOUCH_SAMPLE_PERIOD_TICKS);
+  halSim_touchRelease();
+  uint64_t longestIsrUs = 0, isrCount = 0, startTransactions = halSim_getTouchTransactionCount();
+  uint32_t events = 0;
+  ups = 0;
+  for (bool first = true; !ups && (events <= TOUCH_EVENT_TEST_BACKLOG); first = false) {
+    uint64_t start = halSim_getTime();
+    if (first) {
+      interrupts_enableArmInts();  // Runs the first ISR.
+    } else {
+      halSim_advanceTime(TICKS_PER_US);
+      start += TICKS_PER_US;
+    }
+    uint64_t isrUs = (halSim_getTime() - start) / TICKS_PER_US;
+    if (isrUs) {
+      isrCount++;
+      if (isrUs > longestIsrUs)
+        longestIsrUs = isrUs;
+    }
+    while (display_getTouchEvent(&event)) {
+      events++;
+      ups += (event.type == DISPLAY_TOUCH_UP);
+    }
+  }
+  printf("%d samples behind: %lu events in %lu ISRs (%lu SPI transactions), longest %lu us\n\r",
+      TOUCH_EVENT_TEST_BACKLOG, (unsigned long) events, (unsigned long) isrCount,
+      (unsigned long) (halSim_getTouchTransactionCount() - startTransactions), (unsigned long) longestIsrUs);
+  touchEventTest_check(events == TOUCH_EVENT_TEST_BACKLOG + 1, "samples of the backlog were lost");
+  touchEventTest_check(isrCount > 1, "the backlog was read in one ISR");
+  touchEventTest_check(longestIsrUs <= TOUCH_EVENT_TEST_MAX_ISR_US, "a touch ISR ran too long");
+  return errors != 0;
+}
@@ -0,0 +1,178 @@
+//*****************************************************************************
+// Host test for the touch filter (touchFilter.c) between the STMPE610 FIFO and
+// display_getTouchedPoint(), run on the simulator backend of the HAL. Replays
+// touch traces (touchTraces.txt, or a file given on the command line) into the
+// simulated controller, sample by sample, while an app polls every 1 ms, first
+// with touch input polled and then driven by the touch interrupt. For each
+// touch it prints how long the filter took to settle and how far the settled
+// point is from where the touch ended up, next to reading one raw sample after
+// a fixed 60 ms wait (Simon's old ADC_WAIT), and the jitter of the filtered
+// point next to the raw samples' once settled. Returns nonzero if a firm touch
+// does not settle before the fixed wait would have ended, within 2 pixels and
+// with less jitter than the raw samples, or if a light touch settles at all.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supportFiles/display.h"
+#include "supportFiles/halSim.h"
+#include "supportFiles/interrupts.h"
+#include "supportFiles/touchFilter.h"
+
+#define TOUCH_FILTER_TEST_MAX_SAMPLES 256
+#define TOUCH_FILTER_TEST_NAME_LENGTH 32
+#define TOUCH_FILTER_TEST_LINE_LENGTH 128
+#define TOUCH_FILTER_TEST_FIXED_WAIT_MS 60       // ADC_WAIT was 6 ticks of 10 ms in Simon.
+#define TOUCH_FILTER_TEST_MAX_ERROR 2            // Pixels.
+#define TICKS_PER_MS (HALSIM_TICKS_PER_SECOND / 1000)
+#define SAMPLE_MS (HALSIM_TOUCH_SAMPLE_PERIOD_TICKS / TICKS_PER_MS)
+
+typedef struct {
+  char name[TOUCH_FILTER_TEST_NAME_LENGTH];
+  bool stable;  // The filter must settle on it (or must not).
+  uint32_t count;
+  touchFilter_sample_t samples[TOUCH_FILTER_TEST_MAX_SAMPLES];
+} touchFilterTest_touch_t;
+
+static touchCalibration_t calibration;  // To map the raw samples the same way as the display.
+static uint32_t errors = 0;
+
+// Reads the next touch of the trace file. Returns false at the end.
+static bool touchFilterTest_readTouch(FILE *file, touchFilterTest_touch_t *touch) {
+  char line[TOUCH_FILTER_TEST_LINE_LENGTH], kind[TOUCH_FILTER_TEST_NAME_LENGTH];
+  bool inTouch = false;
+  int x, y, z;
+  while (fgets(line, sizeof(line), file)) {
+    if (!inTouch && (sscanf(line, "touch %31s %31s", touch->name, kind) == 2)) {
+      inTouch = true;
+      touch->stable = !strcmp(kind, "stable");
+      touch->count = 0;
+    } else if (inTouch && !strncmp(line, "release", 7)) {
+      return true;
+    } else if (inTouch && (sscanf(line, "%d %d %d", &x, &y, &z) == 3) &&
+        (touch->count < TOUCH_FILTER_TEST_MAX_SAMPLES)) {
+      touchFilter_sample_t sample = {(int16_t) x, (int16_t) y, (uint8_t) z};
+      touch->samples[touch->count++] = sample;
+    }
+  }
+  return false;
+}
+
+// Distance along x or y, whichever is larger.
+static int32_t touchFilterTest_distance(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  return abs(x0 - x1) > abs(y0 - y1) ? abs(x0 - x1) : abs(y0 - y1);
+}
+
+static int compareInt16(const void *a, const void *b) {
+  return *(const int16_t *) a - *(const int16_t *) b;
+}
+
+// Where the touch ended up: the median of the firm samples in its second half, mapped.
+static void touchFilterTest_settledPoint(const touchFilterTest_touch_t *touch, int16_t *x, int16_t *y) {
+  int16_t xs[TOUCH_FILTER_TEST_MAX_SAMPLES], ys[TOUCH_FILTER_TEST_MAX_SAMPLES];
+  uint32_t count = 0;
+  for (uint32_t i = touch->count / 2; i < touch->count; i++) {
+    if (touch->samples[i].z >= TOUCHFILTER_DEFAULT_MIN_Z) {
+      xs[count] = touch->samples[i].x;
+      ys[count++] = touch->samples[i].y;
+    }
+  }
+  qsort(xs, count, sizeof(int16_t), compareInt16);
+  qsort(ys, count, sizeof(int16_t), compareInt16);
+  *x = count ? xs[count / 2] : 0;
+  *y = count ? ys[count / 2] : 0;
+  touchCalibration_map(&calibration, 1, x, y);
+}
+
+// Replays one touch. The controller queues sample i at (i + 1) sample periods after the press.
+static void touchFilterTest_replay(const char *mode, const touchFilterTest_touch_t *touch) {
+  int16_t settledX, settledY, x, y;
+  uint8_t z;
+  touchFilterTest_settledPoint(touch, &settledX, &settledY);
+  int32_t settleMs = -1, error = 0;
+  int16_t minX = INT16_MAX, maxX = INT16_MIN, minY = INT16_MAX, maxY = INT16_MIN;
+  int16_t rawMinX = INT16_MAX, rawMaxX = INT16_MIN, rawMinY = INT16_MAX, rawMaxY = INT16_MIN;
+  display_clearOldTouchData();  // As the apps do when a touch begins.
+  uint64_t pressTime = halSim_getTime();
+  for (uint32_t i = 0; i < touch->count; i++) {
+    halSim_touchPress(touch->samples[i].x, touch->samples[i].y, touch->samples[i].z);
+    for (uint32_t ms = 0; ms < SAMPLE_MS; ms++) {
+      halSim_advanceTime(TICKS_PER_MS);
+      if ((settleMs < 0) && display_getStableTouchedPoint(&x, &y, &z)) {
+        settleMs = (halSim_getTime() - pressTime) / TICKS_PER_MS;
+        error = touchFilterTest_distance(x, y, settledX, settledY);
+      }
+    }
+    if (settleMs < 0)
+      continue;
+    // Jitter once settled, filtered against raw.
+    display_getTouchedPoint(&x, &y, &z);
+    minX = x < minX ? x : minX;
+    maxX = x > maxX ? x : maxX;
+    minY = y < minY ? y : minY;
+    maxY = y > maxY ? y : maxY;
+    x = touch->samples[i].x;
+    y = touch->samples[i].y;
+    touchCalibration_map(&calibration, 1, &x, &y);
+    rawMinX = x < rawMinX ? x : rawMinX;
+    rawMaxX = x > rawMaxX ? x : rawMaxX;
+    rawMinY = y < rawMinY ? y : rawMinY;
+    rawMaxY = y > rawMaxY ? y : rawMaxY;
+  }
+  halSim_touchRelease();
+  halSim_advanceTime(10 * TICKS_PER_MS);
+
+  printf("%-9s %-6s ", mode, touch->name);
+  if (settleMs < 0) {
+    printf("never settled\n\r");
+    errors += touch->stable;
+    return;
+  }
+  int32_t jitter = (maxX - minX) > (maxY - minY) ? maxX - minX : maxY - minY;
+  int32_t rawJitter = (rawMaxX - rawMinX) > (rawMaxY - rawMinY) ? rawMaxX - rawMinX : rawMaxY - rawMinY;
+  printf("settled in %2ld ms, %ld px off, jitter %ld px (raw %2ld px)", (long) settleMs, (long) error,
+      (long) jitter, (long) rawJitter);
+  uint32_t fixedWaitSample = TOUCH_FILTER_TEST_FIXED_WAIT_MS / SAMPLE_MS - 1;
+  if (fixedWaitSample < touch->count) {
+    x = touch->samples[fixedWaitSample].x;
+    y = touch->samples[fixedWaitSample].y;
+    touchCalibration_map(&calibration, 1, &x, &y);
+    printf("; fixed %d ms wait: %ld px off", TOUCH_FILTER_TEST_FIXED_WAIT_MS,
+        (long) touchFilterTest_distance(x, y, settledX, settledY));
+  }
+  printf("\n\r");
+  if (!touch->stable)
+    errors++;
+  else
+    errors += (settleMs >= TOUCH_FILTER_TEST_FIXED_WAIT_MS) || (error > TOUCH_FILTER_TEST_MAX_ERROR) ||
+        (jitter > rawJitter);
+}
+
+static void touchFilterTest_replayAll(const char *mode, const char *fileName) {
+  static touchFilterTest_touch_t touch;
+  FILE *file = fopen(fileName, "r");
+  if (!file) {
+    printf("could not open %s.\n\r", fileName);
+    errors++;
+    return;
+  }
+  while (touchFilterTest_readTouch(file, &touch))
+    touchFilterTest_replay(mode, &touch);
+  fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+  const char *fileName = (argc > 1) ? argv[1] : "touchTraces.txt";
+  display_init();
+  display_getTouchCalibration(&calibration);
+  interrupts_initAll(false);
+  interrupts_enableArmInts();
+  touchFilterTest_replayAll("polled", fileName);
+  if (!display_enableTouchInterrupts()) {
+    printf("display_enableTouchInterrupts() failed\n\r");
+    return 1;
+  }
+  touchFilterTest_replayAll("interrupt", fileName);
+  return errors != 0;
+}
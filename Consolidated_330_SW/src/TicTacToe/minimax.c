@@ -5,12 +5,54 @@
 //*****************************************************************************
 
 #include <stdio.h>
+#include <string.h>
 #include "minimax.h"
+#ifndef MINIMAX_NO_LOOKUP_TABLE  // Defined when building the table generator itself.
+#include "minimaxTable.h"
+#endif
+
+#if MINIMAX_TOTALSQUARES > 32
+#error "The bitboards hold at most 32 squares."
+#endif
+
+// Scores are kept well inside this range.
+#define MINIMAX_SCORE_INFINITY 32000
+// Estimates of unfinished games stay below this, well away from the winning scores.
+#define MINIMAX_MAX_ESTIMATE (MINIMAX_PLAYER_WINNING_SCORE / 2)
+// Scores at least this far from 0 are wins or losses the search has proven.
+#define MINIMAX_PROVEN_SCORE (MINIMAX_PLAYER_WINNING_SCORE - MINIMAX_TOTALSQUARES)
+
+// Kinds of scores stored in the transposition table.
+#define MINIMAX_BOUND_NONE  0  // Unused entry.
+#define MINIMAX_BOUND_EXACT 1
+#define MINIMAX_BOUND_LOWER 2  // The search failed high, the real score is >= score.
+#define MINIMAX_BOUND_UPPER 3  // The search failed low, the real score is <= score.
+
+// Reading the clock may be slow (the global timer is on the bus), so only look every this many moves.
+#define MINIMAX_CLOCK_CHECK_MASK 0x3F
 
-static int32_t depth = 0; // global variable to track the depth of our recursion
+#define MINIMAX_X_SIDE 0  // Index into lineCounts and zobristKeys.
+#define MINIMAX_O_SIDE 1
+#define MINIMAX_NO_SQUARE 0xFF
+#define MINIMAX_BIT(square) ((minimax_bitboard_t) 1 << (square))
+#define MINIMAX_ALL_SQUARES ((minimax_bitboard_t) (((uint64_t) 1 << MINIMAX_TOTALSQUARES) - 1))
+#define MINIMAX_SQUARE(row, col) ((row) * MINIMAX_BOARD_COLUMNS + (col))
 
-// global variable used to track the next move choice of the AI
-static minimax_move_t choice;
+// Zobrist keys: the hash of a position is the XOR of the keys of its occupied squares.
+static const uint32_t zobristKeys[2][32] = {
+  {0xA1B965F4, 0x8009454F, 0x724C81EC, 0x51A8749B, 0x747EA2EA, 0x1F4532E1, 0xC916AB3C, 0x41C98AC3,  // X
+   0x368CB0A6, 0x3CB13D09, 0x055BDEF6, 0xE0BBDB7B, 0x983AA92F, 0x00CC4D19, 0x971D80AB, 0x75521255,
+   0x2B7F7F86, 0x83914F64, 0x5A4485AC, 0x100B9ED7, 0x1825F10D, 0x0DCA2F6A, 0x7BD2634C, 0xF5407269,
+   0xDB4C4F7B, 0x92233300, 0x7DE1D510, 0xB45C6316, 0x0F4D3872, 0x72F3454F, 0xA8E40225, 0x4963BAB0},
+  {0x111AC529, 0x599DC6F7, 0x93D108C3, 0x81DAA383, 0xB43343A1, 0xCBE531DF, 0x24851729, 0xA792922A,  // O
+   0x918175CE, 0x302278A8, 0x7019E937, 0x52EBF438, 0x0A691E37, 0x763E79AD, 0x743AAE49, 0xB1A1F2E1,
+   0x4F4F52DA, 0xA71A5EB1, 0xB6513356, 0xD4367D77, 0x23CE3C71, 0x0043C714, 0x844F1705, 0xDD9E0EC1,
+   0x82BB9698, 0xCBC87656, 0xA17B3C8F, 0x1D5C5D7B, 0x1CBBF170, 0x29A88F1D, 0xB8BB18FB, 0x6C6AD50E}
+};
+
+// The 4 directions a line can run in: right, down, down-right, down-left.
+static const int8_t rowSteps[4] = {0, 1, 1, 1};
+static const int8_t columnSteps[4] = {1, 0, 1, -1};
 
 /**
  * Helper function that prints out a texual representation of the internal
@@ -42,123 +84,300 @@ void printBoard(minimax_board_t* board) {
 }
 
 /**
- * Recursive MiniMax algorithm that computes the best move at the current call's
- * move depth, based on the player.
- * @param  board  A pointer to a representation of the board to compute scores
- *                on. Note that this may be different than the actual current
- *                board.
- * @param  player Whether to evaluate the board as the player or the opponent.
- * @return        The MAX score if player, or MIN score if Opponent.
+ * Builds the lines (runs of MINIMAX_WIN_LENGTH squares in any of the 4
+ * directions) through each square, and orders the squares so that the ones on
+ * the most lines are tried first. Squares on the same number of lines stay in
+ * row-major order.
  */
-minimax_score_t minimax(minimax_board_t* board, bool player) {
-  // Increment depth at the beginning of this function call
-  depth++;
-
-  // Create 2 arrays (indexed the same) to save moves and their score
-  // at this level of recursion.
-  minimax_move_t moves[MINIMAX_TOTALSQUARES];
-  minimax_score_t scores[MINIMAX_TOTALSQUARES];
-
-  // Recursion base case, there has been a win or a draw.
-  if (minimax_isGameOver(minimax_computeBoardScore(board))) {
-    depth--;  // decrement depth as we return;
+static void minimax_initLines(minimax_search_t* search) {
+  uint8_t line = 0;
+  int direction, row, col, i, j;
+  memset(search->squareLineCount, 0, sizeof(search->squareLineCount));
+  for (direction = 0; direction < 4; direction++) {
+    for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+      for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+        int lastRow = row + (MINIMAX_WIN_LENGTH - 1) * rowSteps[direction];
+        int lastCol = col + (MINIMAX_WIN_LENGTH - 1) * columnSteps[direction];
+        if ((lastRow >= MINIMAX_BOARD_ROWS) || (lastCol < 0) || (lastCol >= MINIMAX_BOARD_COLUMNS)) {
+          continue;  // The run does not fit on the board.
+        }
+        for (i = 0; i < MINIMAX_WIN_LENGTH; i++) {
+          uint8_t square = MINIMAX_SQUARE(row + i * rowSteps[direction], col + i * columnSteps[direction]);
+          search->squareLines[square][search->squareLineCount[square]++] = line;
+        }
+        line++;
+      }
+    }
+  }
+  // Insertion sort, most lines first.
+  for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+    uint8_t square = i;
+    for (j = i; (j > 0) && (search->squareLineCount[search->moveOrder[j - 1]] < search->squareLineCount[square]); j--) {
+      search->moveOrder[j] = search->moveOrder[j - 1];
+    }
+    search->moveOrder[j] = square;
+  }
+}
 
-    // Since this call is the end case, simply return the board's score
-    return minimax_computeBoardScore(board);
+/**
+ * What one line is worth to X: nothing once both sides are on it (nobody can
+ * win there any more), otherwise 4 times as much for every extra piece.
+ */
+static int32_t minimax_lineValue(uint8_t xCount, uint8_t oCount) {
+  if (xCount && oCount) {
+    return 0;
+  }
+  if (xCount) {
+    return (int32_t) 1 << (2 * (xCount - 1));
+  }
+  if (oCount) {
+    return -((int32_t) 1 << (2 * (oCount - 1)));
   }
+  return 0;
+}
 
-  // Otherwise, the recursion is called.
-  // This while-loop will generate all possible boards.
-  int16_t index = 0;  // used to track the number of score/move pairs.
-  int row, col;
-  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {  // For each row
-    for (col = 0; col < MINIMAX_BOARD_ROWS; col++) {  // For each column
-      // Find an empty square
-      if ((*board).squares[row][col] == MINIMAX_EMPTY_SQUARE) {
-        // Assign the square to the player or opponent.
-        if (player) {
-          (*board).squares[row][col] = MINIMAX_PLAYER_SQUARE;
-        }
-        else {
-          (*board).squares[row][col] = MINIMAX_OPPONENT_SQUARE;
-        }
-        // Make the recursive call that determines the MIN or MAX score
-        // based on the player to save to the table.
-        minimax_score_t score = minimax(board, !player);
+/**
+ * Puts a piece of side on square and updates the line counts and the estimate.
+ * @return TRUE if the piece completes a line (side has won).
+ */
+static bool minimax_place(minimax_search_t* search, uint8_t square, uint8_t side) {
+  bool won = false;
+  uint8_t i;
+  for (i = 0; i < search->squareLineCount[square]; i++) {
+    uint8_t line = search->squareLines[square][i];
+    uint8_t* counts = &search->lineCounts[side][line];
+    search->estimate -= minimax_lineValue(search->lineCounts[0][line], search->lineCounts[1][line]);
+    (*counts)++;
+    search->estimate += minimax_lineValue(search->lineCounts[0][line], search->lineCounts[1][line]);
+    if (*counts == MINIMAX_WIN_LENGTH) {
+      won = true;
+    }
+  }
+  return won;
+}
 
-        scores[index] = score;  // Add score to the score table
-        moves[index].row = row; // Add move row to the move table
-        moves[index].column = col;  // Add move column to the move table
+/**
+ * Takes back minimax_place().
+ */
+static void minimax_remove(minimax_search_t* search, uint8_t square, uint8_t side) {
+  uint8_t i;
+  for (i = 0; i < search->squareLineCount[square]; i++) {
+    uint8_t line = search->squareLines[square][i];
+    search->estimate -= minimax_lineValue(search->lineCounts[0][line], search->lineCounts[1][line]);
+    search->lineCounts[side][line]--;
+    search->estimate += minimax_lineValue(search->lineCounts[0][line], search->lineCounts[1][line]);
+  }
+}
 
-        index++;  // Increment the index into the moves/scores table
+// Side to move in the position at depth d of the stack.
+#define MINIMAX_PLAYER_AT(search, d) (((d) & 1) ? !(search)->player : (search)->player)
 
-        // Undo the change to the board (return the square to empty)
-        // prior to next iteration of for-loops.
-        (*board).squares[row][col] = MINIMAX_EMPTY_SQUARE;
-      }
+/**
+ * Returns the next move to try in the position at the top of the stack, or
+ * MINIMAX_NO_SQUARE once all have been tried (or the rest was cut off). The
+ * move remembered in the table comes first. After it, the top of the search
+ * goes through the squares in row-major order, the positions below it in
+ * moveOrder.
+ */
+static uint8_t minimax_nextSquare(minimax_search_t* search, minimax_frame_t* frame) {
+  while (frame->nextIndex < MINIMAX_TOTALSQUARES) {
+    int8_t i = frame->nextIndex++;
+    uint8_t square = (i < 0) ? frame->firstSquare : ((search->top == 0) ? i : search->moveOrder[i]);
+    if ((square == MINIMAX_NO_SQUARE) || (frame->occupied & MINIMAX_BIT(square)) ||
+        ((i >= 0) && (square == frame->firstSquare))) {
+      continue;
     }
+    return square;
   }
+  return MINIMAX_NO_SQUARE;
+}
 
+/**
+ * Sets up the position at the top of the stack to be searched from its first move.
+ */
+static void minimax_initFrame(minimax_search_t* search, minimax_frame_t* frame, minimax_score_t alpha,
+                              minimax_score_t beta, uint8_t firstSquare) {
+  frame->alpha = frame->originalAlpha = alpha;
+  frame->beta = frame->originalBeta = beta;
+  frame->bestScore = MINIMAX_PLAYER_AT(search, search->top) ? -MINIMAX_SCORE_INFINITY : MINIMAX_SCORE_INFINITY;
+  frame->bestSquare = MINIMAX_NO_SQUARE;
+  frame->firstSquare = firstSquare;
+  frame->nextIndex = -1;
+}
+
+/**
+ * Takes back the move being tried at the top of the stack and scores it.
+ * At the top of the search a move is taken if it is strictly better than the
+ * best so far, or as good and earlier in row-major order (see
+ * minimax_tryMove()). Below it this is plain alpha-beta: a move that leaves the
+ * window empty cuts off the rest of the moves.
+ */
+static void minimax_scoreMove(minimax_search_t* search, minimax_score_t score) {
+  minimax_frame_t* frame = &search->stack[search->top];
+  bool player = MINIMAX_PLAYER_AT(search, search->top);
+  minimax_remove(search, frame->square, player ? MINIMAX_X_SIDE : MINIMAX_O_SIDE);
+  if (search->top == 0) {
+    bool earlier = (frame->bestSquare != MINIMAX_NO_SQUARE) && (frame->square < frame->bestSquare);
+    if ((player ? (score > frame->bestScore) : (score < frame->bestScore)) ||
+        (earlier && (score == frame->bestScore))) {
+      frame->bestScore = score;
+      frame->bestSquare = frame->square;
+    }
 #ifdef MINIMAX_DEBUG
-  // Print out Score Matrix at Top Level if DEBUG mode is enabled.
-  // This is useful in visually checking that the score table is correct
-  // after all of the recursive calls have been made.
- if (depth == 0) {
-   printf("Scores:\n\r");
-   int count;
-   for (count = 0; count < index; count++) {
-     printf("Move (%d, %d) Score: %d\n", moves[count].row, moves[count].column, scores[count]);
-   }
- }
- #endif
-
-  // Once here, we have iterated over empty squares at this level.
-  // All of the scores and moves have been computed at this level.
-  minimax_score_t score = 0; // the value of the score to return
-  int16_t tempIndex = 0; // variable used to store the index of the MIN/MAX
-  // Now we return the score based upon whether we are computing min or max.
-  int i;
+    // Moves that are no better than an earlier one only get a bound, not their exact score.
+    printf("Depth %d move (%d, %d) Score: %d\n\r", search->limit, frame->square / MINIMAX_BOARD_COLUMNS,
+           frame->square % MINIMAX_BOARD_COLUMNS, score);
+#endif
+    return;
+  }
   if (player) {
-    // If the player is X, we want to find the MAX score
-    int16_t highScore = scores[0];  // Initialize to the first score.
-    // Iterate over all of the move/score pairs in the table
-    for (i = 0; i < index; i++) {
-      if (scores[i] > highScore) {
-        // Raise the maximum highScore found so far
-        highScore = scores[i];
-        tempIndex = i;
-      }
+    if (score > frame->bestScore) {
+      frame->bestScore = score;
+      frame->bestSquare = frame->square;
+    }
+    if (frame->bestScore > frame->alpha) {
+      frame->alpha = frame->bestScore;
     }
-    choice = moves[tempIndex];  // Get the choice with the MAX score
-    score = scores[tempIndex];  // Return the highest score in the table.
   }
   else {
-    // If we are looking at 'O', we want to find the MIN score
-    int16_t lowScore = scores[0];  // Initialize to the first score.
-    // Iterate over all of the move/score pairs in the table
-    for (i = 0; i < index; i++) {
-      if (scores[i] < lowScore) {
-        // Lower the minimum lowScore found so far
-        lowScore = scores[i];
-        tempIndex = i;
-      }
+    if (score < frame->bestScore) {
+      frame->bestScore = score;
+      frame->bestSquare = frame->square;
+    }
+    if (frame->bestScore < frame->beta) {
+      frame->beta = frame->bestScore;
+    }
+  }
+  if (frame->alpha >= frame->beta) {  // The other side will never allow this position.
+    frame->nextIndex = MINIMAX_TOTALSQUARES;
+  }
+}
+
+/**
+ * Makes the move at the top of the stack. If the game ends there or the
+ * iteration may not look further, the move is scored right away. Otherwise
+ * the position it leads to is looked up in the transposition table and, unless
+ * its score is already known, pushed to be searched. depth (the stack index)
+ * is the number of moves made before this one: a quick win scores higher than
+ * a slow one and a slow loss scores higher than a quick one. When the
+ * iteration's moves run out, the line counts estimate the score.
+ */
+static void minimax_tryMove(minimax_search_t* search, uint8_t square) {
+  uint8_t depth = search->top;
+  minimax_frame_t* frame = &search->stack[depth];
+  bool player = MINIMAX_PLAYER_AT(search, depth);
+  uint8_t side = player ? MINIMAX_X_SIDE : MINIMAX_O_SIDE;
+  uint8_t remaining = search->limit - depth;  // Moves the search may still look ahead, this one included.
+  minimax_bitboard_t occupied = frame->occupied | MINIMAX_BIT(square);
+  frame->square = square;
+  if (minimax_place(search, square, side)) {
+    minimax_scoreMove(search, player ? (MINIMAX_PLAYER_WINNING_SCORE - (depth + 1))
+                                     : (MINIMAX_OPPONENT_WINNING_SCORE + (depth + 1)));
+    return;
+  }
+  if (occupied == MINIMAX_ALL_SQUARES) {
+    minimax_scoreMove(search, MINIMAX_DRAW_SCORE);
+    return;
+  }
+  if (remaining <= 1) {
+    int32_t estimate = search->estimate;
+    if (estimate > MINIMAX_MAX_ESTIMATE) {
+      estimate = MINIMAX_MAX_ESTIMATE;
+    }
+    else if (estimate < -MINIMAX_MAX_ESTIMATE) {
+      estimate = -MINIMAX_MAX_ESTIMATE;
     }
-    choice = moves[tempIndex];  // Get the choice with the MIN score
-    score = scores[tempIndex];  // Return the lowest score in the table.
+    minimax_scoreMove(search, estimate);
+    return;
   }
 
-  // Done with the recursive call, decrement depth as we return
-  depth--;
-  return score;
+  minimax_score_t alpha = frame->alpha, beta = frame->beta;
+  if (depth == 0) {
+    // Searching each move at the top with the best score so far as the bound
+    // proves a move is no better without computing its exact score, and gives
+    // the exact score of any move that is better. Moves before the best one in
+    // row-major order also win ties, so their bound is one point lower. So the
+    // last iteration picks the same move as a full minimax search: the first
+    // best one.
+    bool earlier = (frame->bestSquare != MINIMAX_NO_SQUARE) && (square < frame->bestSquare);
+    if (player) {
+      alpha = earlier ? frame->bestScore - 1 : frame->bestScore;
+      beta = MINIMAX_SCORE_INFINITY;
+    }
+    else {
+      alpha = -MINIMAX_SCORE_INFINITY;
+      beta = earlier ? frame->bestScore + 1 : frame->bestScore;
+    }
+  }
+  search->nodeCount++;
+  uint32_t key = frame->key ^ zobristKeys[side][square];
+  // A position always sits at the same depth within one search (each move adds one piece),
+  // so remembered scores can be used as they are if they looked at least as far ahead.
+  minimax_transpositionEntry_t* entry = &search->table[key & (MINIMAX_TRANSPOSITION_TABLE_ENTRIES - 1)];
+  uint8_t firstSquare = MINIMAX_NO_SQUARE;
+  if ((entry->bound != MINIMAX_BOUND_NONE) && (entry->key == key)) {
+    if ((entry->depth >= remaining - 1) &&
+        ((entry->bound == MINIMAX_BOUND_EXACT) ||
+         ((entry->bound == MINIMAX_BOUND_LOWER) && (entry->score >= beta)) ||
+         ((entry->bound == MINIMAX_BOUND_UPPER) && (entry->score <= alpha)))) {
+      minimax_scoreMove(search, entry->score);
+      return;
+    }
+    firstSquare = entry->bestSquare;
+  }
+  minimax_frame_t* child = &search->stack[++search->top];
+  child->occupied = occupied;
+  child->key = key;
+  minimax_initFrame(search, child, alpha, beta, firstSquare);
 }
 
-void minimax_computeNextMove( minimax_board_t* board,
-                              bool player,
-                              uint8_t* row,
-                              uint8_t* column) {
-  // Initialize the depth
-  depth = MINIMAX_INIT_DEPTH;
+/**
+ * All moves of the position at the top of the stack have been tried: stores
+ * its score in the transposition table and hands it to the move that led
+ * there.
+ */
+static void minimax_popFrame(minimax_search_t* search) {
+  minimax_frame_t* frame = &search->stack[search->top];
+  minimax_transpositionEntry_t* entry = &search->table[frame->key & (MINIMAX_TRANSPOSITION_TABLE_ENTRIES - 1)];
+  entry->key = frame->key;
+  entry->score = frame->bestScore;
+  entry->bestSquare = frame->bestSquare;
+  entry->depth = search->limit - search->top;
+  if (frame->bestScore <= frame->originalAlpha) {
+    entry->bound = MINIMAX_BOUND_UPPER;
+  }
+  else if (frame->bestScore >= frame->originalBeta) {
+    entry->bound = MINIMAX_BOUND_LOWER;
+  }
+  else {
+    entry->bound = MINIMAX_BOUND_EXACT;
+  }
+  search->top--;
+  minimax_scoreMove(search, frame->bestScore);
+}
 
+/**
+ * The top of the search has tried all its moves: the iteration is over. Keeps
+ * its move and starts the next, one move deeper, with that move tried first
+ * (which, with the table, makes the deeper search cheaper). Once a win or loss
+ * is proven, or the iteration looked to the end of the game, looking further
+ * ahead does not change the move.
+ */
+static void minimax_finishIteration(minimax_search_t* search) {
+  minimax_frame_t* root = &search->stack[0];
+  search->bestSquare = root->bestSquare;
+  search->completedDepth = search->limit;
+  if ((root->bestScore >= MINIMAX_PROVEN_SCORE) || (root->bestScore <= -MINIMAX_PROVEN_SCORE) ||
+      (search->limit == search->empties)) {
+    search->done = true;
+    return;
+  }
+  search->limit++;
+  minimax_initFrame(search, root, -MINIMAX_SCORE_INFINITY, MINIMAX_SCORE_INFINITY, search->bestSquare);
+}
+
+void minimax_beginSearch(minimax_search_t* search, const minimax_board_t* board, bool player,
+                         minimax_clock_t readClock, uint64_t deadline) {
 #ifdef MINIMAX_DEBUG
   // If DEBUG mode is enabled, print out board and player information
   if (player) {
@@ -167,33 +386,186 @@ void minimax_computeNextMove( minimax_board_t* board,
   else {
     printf("Player is placing 'O'");
   }
-  printBoard(board);  // Print the current board to the console for debugging
+  printBoard((minimax_board_t*) board);  // Print the current board to the console for debugging
 #endif
 
-  // If the board if empty, just choose any square.
-  // This reduced the worst-case tick function execution time from 367ms
-  // to ~180ms.
-  bool notEmpty = false;
-  int i, j;
-  for (i = 0; i < MINIMAX_BOARD_ROWS; i++) {  // For each row
-    for (j = 0; j < MINIMAX_BOARD_ROWS; j++) {  // For each column
-      if ((*board).squares[i][j] != MINIMAX_EMPTY_SQUARE) {
-        notEmpty = true;
+  memset(search->table, 0, sizeof(search->table));
+  memset(search->lineCounts, 0, sizeof(search->lineCounts));
+  search->estimate = 0;
+  search->readClock = readClock;
+  search->deadline = deadline;
+  search->nodeCount = 0;
+  search->completedDepth = 0;
+  search->player = player;
+  search->done = false;
+  minimax_initLines(search);
+
+  minimax_frame_t* root = &search->stack[0];
+  root->occupied = 0;
+  root->key = 0;
+  bool gameOver = false;
+  uint8_t square;
+  search->empties = 0;
+  search->bestSquare = MINIMAX_NO_SQUARE;
+  for (square = 0; square < MINIMAX_TOTALSQUARES; square++) {
+    uint8_t piece = board->squares[square / MINIMAX_BOARD_COLUMNS][square % MINIMAX_BOARD_COLUMNS];
+    if (piece == MINIMAX_EMPTY_SQUARE) {
+      search->empties++;
+      if (search->bestSquare == MINIMAX_NO_SQUARE) {
+        search->bestSquare = square;
       }
+      continue;
     }
+    uint8_t side = (piece == MINIMAX_PLAYER_SQUARE) ? MINIMAX_X_SIDE : MINIMAX_O_SIDE;
+    gameOver |= minimax_place(search, square, side);
+    root->occupied |= MINIMAX_BIT(square);
+    root->key ^= zobristKeys[side][square];
   }
-  if (notEmpty) {
-    minimax(board, player);
-    *row = choice.row;  // assign the final row choice
-    *column = choice.column;  // assign the final column choice
+  // Nothing to search: answer the first empty square (if any).
+  if (gameOver || !search->empties) {
+    if (search->bestSquare == MINIMAX_NO_SQUARE) {
+      search->bestSquare = 0;
+    }
+    search->done = true;
+    return;
   }
-  else {
-    // If the board is empty, just choose the first square.
-    // In the future, this could be randomized.
-    *row = 0;
-    *column = 0;
+  // Iterative deepening: each iteration looks one move further ahead.
+  search->top = 0;
+  search->limit = 1;
+  minimax_initFrame(search, root, -MINIMAX_SCORE_INFINITY, MINIMAX_SCORE_INFINITY, search->bestSquare);
+}
+
+bool minimax_step(minimax_search_t* search, uint64_t budgetTicks) {
+  uint64_t sliceEnd = budgetTicks;
+  uint32_t sliceStartNodes = search->nodeCount;
+  uint32_t moveCount = 0;
+  if (search->readClock) {
+    uint64_t now = search->readClock();
+    sliceEnd = (budgetTicks > UINT64_MAX - now) ? UINT64_MAX : now + budgetTicks;
+  }
+  while (!search->done) {
+    // Reading the clock may be slow, so only look every few moves. The first
+    // iteration never runs out of time, so there is always a move to return.
+    if (search->readClock) {
+      if (!(++moveCount & MINIMAX_CLOCK_CHECK_MASK)) {
+        uint64_t now = search->readClock();
+        if ((search->completedDepth > 0) && (now >= search->deadline)) {
+          search->done = true;  // Keep the move of the last iteration that finished.
+          break;
+        }
+        if (now >= sliceEnd) {
+          break;
+        }
+      }
+    }
+    else if (search->nodeCount - sliceStartNodes >= budgetTicks) {
+      break;
+    }
+    uint8_t square = minimax_nextSquare(search, &search->stack[search->top]);
+    if (square != MINIMAX_NO_SQUARE) {
+      minimax_tryMove(search, square);
+    }
+    else if (search->top > 0) {
+      minimax_popFrame(search);
+    }
+    else {
+      minimax_finishIteration(search);
+    }
+  }
+  return search->done;
+}
+
+bool minimax_resultReady(const minimax_search_t* search) {
+  return search->done;
+}
+
+void minimax_getResult(const minimax_search_t* search, uint8_t* row, uint8_t* column) {
+  *row = search->bestSquare / MINIMAX_BOARD_COLUMNS;
+  *column = search->bestSquare % MINIMAX_BOARD_COLUMNS;
+}
+
+void minimax_searchNextMove(minimax_search_t* search, const minimax_board_t* board, bool player,
+                            minimax_clock_t readClock, uint64_t deadline, uint8_t* row, uint8_t* column) {
+  minimax_beginSearch(search, board, player, readClock, deadline);
+  minimax_step(search, MINIMAX_UNLIMITED_BUDGET);
+  minimax_getResult(search, row, column);
+}
+
+#ifndef MINIMAX_NO_LOOKUP_TABLE
+bool minimax_lookUpNextMove(const minimax_board_t* board, bool player, uint8_t* row, uint8_t* column) {
+  // The table only covers the side whose turn it is (X moves first).
+  int8_t pieceBalance = 0;
+  int i, s;
+  for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+    uint8_t square = board->squares[i / MINIMAX_BOARD_COLUMNS][i % MINIMAX_BOARD_COLUMNS];
+    if (square == MINIMAX_PLAYER_SQUARE) {
+      pieceBalance++;
+    }
+    else if (square == MINIMAX_OPPONENT_SQUARE) {
+      pieceBalance--;
+    }
+  }
+  if (player != (pieceBalance == 0)) {
+    return false;
+  }
+  // Find the symmetric version of the board with the smallest key, that is the one stored.
+  uint16_t key = 0xFFFF;
+  uint8_t symmetry = 0;
+  for (s = 0; s < MINIMAXTABLE_SYMMETRIES; s++) {
+    uint16_t symmetricKey = 0;
+    for (i = MINIMAX_TOTALSQUARES - 1; i >= 0; i--) {
+      uint8_t source = minimaxTable_squareMaps[s][i];
+      symmetricKey = symmetricKey * 3 + board->squares[source / MINIMAX_BOARD_COLUMNS][source % MINIMAX_BOARD_COLUMNS];
+    }
+    if (symmetricKey < key) {
+      key = symmetricKey;
+      symmetry = s;
+    }
+  }
+  // Binary search of the sorted table.
+  int16_t low = 0, high = minimaxTable_entryCount - 1;
+  while (low <= high) {
+    int16_t middle = (low + high) / 2;
+    if (minimaxTable_entries[middle].key < key) {
+      low = middle + 1;
+    }
+    else if (minimaxTable_entries[middle].key > key) {
+      high = middle - 1;
+    }
+    else {
+      // Map the best moves back to this board and take the first one in row-major order,
+      // which is the move the search picks.
+      uint8_t bestSquare = MINIMAX_NO_SQUARE;
+      for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+        uint8_t square = minimaxTable_squareMaps[symmetry][i];
+        if ((minimaxTable_entries[middle].bestMoves & (1 << i)) && (square < bestSquare)) {
+          bestSquare = square;
+        }
+      }
+      *row = bestSquare / MINIMAX_BOARD_COLUMNS;
+      *column = bestSquare % MINIMAX_BOARD_COLUMNS;
+      return true;
+    }
   }
+  return false;  // Not reachable in a real game (or already over).
+}
+#else
+bool minimax_lookUpNextMove(const minimax_board_t* board, bool player, uint8_t* row, uint8_t* column) {
+  return false;  // No table for this board size.
+}
+#endif
 
+void minimax_computeNextMove( minimax_board_t* board,
+                              bool player,
+                              uint8_t* row,
+                              uint8_t* column) {
+#ifndef MINIMAX_NO_LOOKUP_TABLE
+  if (minimax_lookUpNextMove(board, player, row, column)) {
+    return;
+  }
+#endif
+  minimax_search_t search;  // About 2.5 kB of stack on a 3x3 board, mostly the table.
+  minimax_searchNextMove(&search, board, player, NULL, 0, row, column);
 }
 
 bool minimax_isGameOver(minimax_score_t score) {
@@ -206,108 +578,49 @@ bool minimax_isGameOver(minimax_score_t score) {
   }
 }
 
-int16_t minimax_computeBoardScore(minimax_board_t* board) {
-  bool emptySquaresExist = false; // flag to track whether there are empties
-  // Variables to track the count of symbols in each of the possible
-  // ways to win. I will +1 for player's symbols, and -1 for opponents.
-  int32_t rowCount[MINIMAX_BOARD_ROWS], colCount[MINIMAX_BOARD_COLUMNS];
-  int32_t diag_topleft_bottomright = 0;
-  int32_t diag_topright_bottomleft = 0;
-
-  int row, col;
-  // Init rowCount and colCount to zeros
-  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
-    rowCount[row] = 0;
-  }
-  for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
-    colCount[col] = 0;
-  }
-
-  // This algorithm is designed so that the board is only iterated over ONCE.
-  // If X is in a square, a count in incremented, if O is in a square, the count
-  // is decremented. This way, if there are 3 X in a row, the count will be 3.
-  // Or, if there are 3 Os, the count will be -3. Nothing is added for empty
-  // squares.
-  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
-    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
-      // If player's symbol is found, increment all counts
-      if ((*board).squares[row][col] == MINIMAX_PLAYER_SQUARE) {
-        rowCount[row]++;  // increment the count for the row it is on.
-        colCount[col]++;  // increment the count for the col it is on.
-        if (row == col) { // if square is on topleft to bottomright diag
-          diag_topleft_bottomright++;
+/**
+ * Returns true if piece has MINIMAX_WIN_LENGTH in a row anywhere on the board.
+ */
+static bool minimax_hasRun(const minimax_board_t* board, uint8_t piece) {
+  int direction, row, col, i;
+  for (direction = 0; direction < 4; direction++) {
+    for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+      for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+        int lastRow = row + (MINIMAX_WIN_LENGTH - 1) * rowSteps[direction];
+        int lastCol = col + (MINIMAX_WIN_LENGTH - 1) * columnSteps[direction];
+        if ((lastRow >= MINIMAX_BOARD_ROWS) || (lastCol < 0) || (lastCol >= MINIMAX_BOARD_COLUMNS)) {
+          continue;
         }
-        if (col == (MINIMAX_BOARD_ROWS - row - 1)) {  // if on opposite diag
-          diag_topright_bottomleft++;
+        for (i = 0; i < MINIMAX_WIN_LENGTH; i++) {
+          if (board->squares[row + i * rowSteps[direction]][col + i * columnSteps[direction]] != piece) {
+            break;
+          }
         }
-      }
-      // If it's an opponent symbol, decrement all counts
-      else if ((*board).squares[row][col] == MINIMAX_OPPONENT_SQUARE) {
-        rowCount[row]--;  // decrement the count for the row it is on.
-        colCount[col]--;  // decrement the count for the col it is on.
-        if (row == col) { // if square is on topleft to bottomright diag
-          diag_topleft_bottomright--;
+        if (i == MINIMAX_WIN_LENGTH) {
+          return true;
         }
-        if (col == (MINIMAX_BOARD_ROWS - row - 1)) {  // if on opposite diag
-          diag_topright_bottomleft--;
-        }
-      }
-      else {  // If an empty square was found, update the flag.
-        emptySquaresExist = true;
       }
     }
   }
+  return false;
+}
 
-  // If we reached here, we've checked the whole board Now check all of the
-  // count values. If any of them equal +3, PLAYER wins. If -3, OPPONENT wins.
-  // Note that depth is either added or subtracted in order to allow the AI
-  // to play more intelligently in that it will take the immediate WIN, or it
-  // will try to prolong it's inevitable LOSS as much as possible.
-
-  // Check row counts
-  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
-    // If the 'X' won...
-    if (rowCount[row] == MINIMAX_BOARD_ROWS) {
-      return MINIMAX_PLAYER_WINNING_SCORE - depth;
-    }
-    // If 'O' won...
-    else if (rowCount[row] == (-MINIMAX_BOARD_ROWS)) {
-      return MINIMAX_OPPONENT_WINNING_SCORE + depth;
-    }
-  }
-
-  // Check column counts
-  for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
-    // If the 'X' won...
-    if (colCount[col] == MINIMAX_BOARD_COLUMNS) {
-      return MINIMAX_PLAYER_WINNING_SCORE - depth;
-    }
-    // If 'O' won...
-    else if (colCount[col] == (-MINIMAX_BOARD_COLUMNS)) {
-      return MINIMAX_OPPONENT_WINNING_SCORE + depth;
-    }
-  }
-
-  // Check Diagonal counts
-  // Note that this makes the assumption that # ROWS = # COLUMNS
-  // if 'X' won
-  if (diag_topleft_bottomright == MINIMAX_BOARD_COLUMNS ||
-      diag_topright_bottomleft == MINIMAX_BOARD_COLUMNS) {
-    return MINIMAX_PLAYER_WINNING_SCORE - depth;
+int16_t minimax_computeBoardScore(minimax_board_t* board) {
+  if (minimax_hasRun(board, MINIMAX_PLAYER_SQUARE)) {
+    return MINIMAX_PLAYER_WINNING_SCORE;
   }
-  // If 'O' won...
-  else if ( diag_topleft_bottomright == (-MINIMAX_BOARD_COLUMNS) ||
-            diag_topright_bottomleft == (-MINIMAX_BOARD_COLUMNS)) {
-    return MINIMAX_OPPONENT_WINNING_SCORE + depth;
+  if (minimax_hasRun(board, MINIMAX_OPPONENT_SQUARE)) {
+    return MINIMAX_OPPONENT_WINNING_SCORE;
   }
-
-  if (emptySquaresExist) {
-    return MINIMAX_NOT_ENDGAME;
-  }
-  else {
-    // If none of the players won, and the board is full, it was a draw.
-    return MINIMAX_DRAW_SCORE;
+  int row, col;
+  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+      if (board->squares[row][col] == MINIMAX_EMPTY_SQUARE) {
+        return MINIMAX_NOT_ENDGAME;
+      }
+    }
   }
+  return MINIMAX_DRAW_SCORE;
 }
 
 void minimax_initBoard(minimax_board_t* board) {
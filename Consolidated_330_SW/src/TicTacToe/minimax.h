@@ -12,16 +12,37 @@
 // Uncomment this line to enable DEBUG output
 // #define MINIMAX_DEBUG
 
-// Defines the boundaries of the tic-tac-toe board.
-// Note that for the algorithm to properly check diagonals, The dimension of
-// rows and columns should be the same.
+// Defines the boundaries of the tic-tac-toe board and how many in a row win.
+// They can be overridden from the compiler command line, e.g.,
+// -DMINIMAX_BOARD_ROWS=5 -DMINIMAX_BOARD_COLUMNS=5 -DMINIMAX_WIN_LENGTH=4.
+// The board may have at most 32 squares (one bit per square in a bitboard).
+#ifndef MINIMAX_BOARD_ROWS
 #define MINIMAX_BOARD_ROWS    3
+#endif
+#ifndef MINIMAX_BOARD_COLUMNS
 #define MINIMAX_BOARD_COLUMNS 3
+#endif
+#ifndef MINIMAX_WIN_LENGTH
+#define MINIMAX_WIN_LENGTH    3
+#endif
 
 // Calculates the total number of squares on the board for score calculations
 #define MINIMAX_TOTALSQUARES ((MINIMAX_BOARD_ROWS) * (MINIMAX_BOARD_COLUMNS))
-#define MINIMAX_INIT_DEPTH    -1  // initialize to -1 so that it is 0 at the
-                                  // start of the minimax calls
+
+// Number of ways to win: runs of MINIMAX_WIN_LENGTH squares along rows, columns and both diagonals.
+#define MINIMAX_ROW_RUNS    (MINIMAX_BOARD_COLUMNS - MINIMAX_WIN_LENGTH + 1)
+#define MINIMAX_COLUMN_RUNS (MINIMAX_BOARD_ROWS - MINIMAX_WIN_LENGTH + 1)
+#define MINIMAX_LINE_COUNT ((MINIMAX_BOARD_ROWS * MINIMAX_ROW_RUNS) + (MINIMAX_BOARD_COLUMNS * MINIMAX_COLUMN_RUNS) + \
+                            (2 * MINIMAX_ROW_RUNS * MINIMAX_COLUMN_RUNS))
+// A square lies on at most MINIMAX_WIN_LENGTH lines in each of the 4 directions.
+#define MINIMAX_MAX_LINES_PER_SQUARE (4 * MINIMAX_WIN_LENGTH)
+
+// The precomputed table (minimaxTable.c) only covers the 3x3 game.
+#if (MINIMAX_BOARD_ROWS != 3) || (MINIMAX_BOARD_COLUMNS != 3) || (MINIMAX_WIN_LENGTH != 3)
+#ifndef MINIMAX_NO_LOOKUP_TABLE
+#define MINIMAX_NO_LOOKUP_TABLE
+#endif
+#endif
 
 // These are the values in the board to represent who is occupying what square.
 #define MINIMAX_USED_SQUARE     3  // Not currently used.
@@ -29,9 +50,11 @@
 #define MINIMAX_OPPONENT_SQUARE 1  // Represents an O
 #define MINIMAX_EMPTY_SQUARE    0
 
-// Scoring for minimax.
-#define MINIMAX_PLAYER_WINNING_SCORE    10    // represents that X won
-#define MINIMAX_OPPONENT_WINNING_SCORE  -10   // represents that O won
+// Scoring for minimax. The search takes one point off a win (adds one to a loss) per move
+// it takes, so wins must stay well clear of the line-count estimates used when a search
+// has to stop before the end of the game.
+#define MINIMAX_PLAYER_WINNING_SCORE    10000 // represents that X won
+#define MINIMAX_OPPONENT_WINNING_SCORE  -10000 // represents that O won
 #define MINIMAX_DRAW_SCORE              0     // Draw game
 #define MINIMAX_NOT_ENDGAME             -1    // Not an end-game.
 
@@ -50,11 +73,79 @@ typedef struct {
 // Define a score type.
 typedef int16_t minimax_score_t;
 
+// Internally, the search keeps one bitboard per side: bit (row * MINIMAX_BOARD_COLUMNS + column)
+// is set if that side occupies the square.
+typedef uint32_t minimax_bitboard_t;
+
+// Number of entries in the transposition table (must be a power of 2). Every search state
+// carries its own table, so this also sets how much stack minimax_computeNextMove() uses.
+#ifndef MINIMAX_TRANSPOSITION_TABLE_ENTRIES
+#define MINIMAX_TRANSPOSITION_TABLE_ENTRIES 256
+#endif
+
+// One remembered position. bound says whether score is exact or only a lower/upper bound
+// (0 = unused entry). depth is how many moves deep below the position the score looked.
+typedef struct {
+  uint32_t key;           // Zobrist hash of the position.
+  minimax_score_t score;
+  uint8_t bestSquare;     // Best (or cut-off) move found last time, searched first next time.
+  uint8_t bound : 2;
+  uint8_t depth : 6;
+} minimax_transpositionEntry_t;
+
+// Returns the current time in any unit (e.g., global-timer ticks). Used for search deadlines.
+typedef uint64_t (*minimax_clock_t)();
+
+// Budget for minimax_step() that never pauses the search.
+#define MINIMAX_UNLIMITED_BUDGET UINT64_MAX
+
+// One position on the explicit search stack. Entry 0 is the position the move is searched
+// for, entry d is reached by the moves being tried in entries 0 .. d-1.
+typedef struct {
+  minimax_bitboard_t occupied;  // Squares occupied by either side.
+  uint32_t key;                 // Zobrist hash of the position.
+  minimax_score_t alpha, beta;  // Window, narrowed as the moves are scored.
+  minimax_score_t originalAlpha, originalBeta;
+  minimax_score_t bestScore;
+  uint8_t bestSquare;
+  uint8_t firstSquare;          // Move remembered in the table, tried before the fixed order.
+  uint8_t square;               // Move being tried (its piece is on the lines while the position below is searched).
+  int8_t nextIndex;             // Next entry of the move order to try (-1 = firstSquare).
+} minimax_frame_t;
+
+// Everything one search needs. There is no global state, so searches on different boards
+// (or from different threads) can run at the same time, each with its own minimax_search_t.
+// The search does not recurse: the positions between the board and the one being looked at
+// are kept in stack, so it can stop after any move and carry on later (see minimax_step()).
+typedef struct {
+  minimax_transpositionEntry_t table[MINIMAX_TRANSPOSITION_TABLE_ENTRIES];
+  // The lines through each square, and the squares ordered by how many lines they are on.
+  uint8_t squareLineCount[MINIMAX_TOTALSQUARES];
+  uint8_t squareLines[MINIMAX_TOTALSQUARES][MINIMAX_MAX_LINES_PER_SQUARE];
+  uint8_t moveOrder[MINIMAX_TOTALSQUARES];
+  // Pieces of X ([0]) and O ([1]) on each line, and the resulting estimate of the position,
+  // kept up to date as moves are made and taken back.
+  uint8_t lineCounts[2][MINIMAX_LINE_COUNT];
+  int32_t estimate;
+  minimax_frame_t stack[MINIMAX_TOTALSQUARES];
+  uint8_t top;              // Index of the position being searched in stack.
+  bool player;              // Side the move is searched for.
+  uint8_t empties;          // Empty squares on the board, the deepest an iteration can look.
+  uint8_t limit;            // How many moves deep the current iteration looks.
+  uint8_t bestSquare;       // Move of the last iteration that finished.
+  bool done;                // The result is ready.
+  minimax_clock_t readClock;  // NULL if the search has no deadline.
+  uint64_t deadline;
+  uint32_t nodeCount;       // Positions visited by the search so far (statistics only).
+  uint8_t completedDepth;   // Depth of the last iteration that finished (statistics only).
+} minimax_search_t;
+
 /**
- * This routine itself is not recursive, but will call the recursive minimax
- * function. It computes the row and column of the next move based upon:
+ * Computes the row and column of the next move based upon:
  *   1. The current board
  *   2. The player
+ * The move is looked up in a precomputed table; positions that are not in it
+ * are searched (to the end of the game, without a deadline).
  * @param board  A representation of the current state of the board.
  * @param player TRUE means computer is 'X', FALSE means computer is 'O'
  * @param row    The address of where to store the row of the AI's move.
@@ -62,6 +153,80 @@ typedef int16_t minimax_score_t;
  */
 void minimax_computeNextMove(minimax_board_t* board, bool player, uint8_t* row, uint8_t* column);
 
+/**
+ * Looks the move up in the precomputed table of all reachable positions
+ * (minimaxTable.c, see minimaxTable.h). Gives the same move as
+ * minimax_searchNextMove().
+ * @param board  A representation of the current state of the board.
+ * @param player TRUE means computer is 'X', FALSE means computer is 'O'
+ * @param row    The address of where to store the row of the AI's move.
+ * @param column The address of where to store the col of the AI's move.
+ * @return       FALSE if the table does not have the position (it cannot
+ *               come up in a game where X moves first, or the game is over).
+ *               Always FALSE unless the board is 3x3, 3 in a row.
+ */
+bool minimax_lookUpNextMove(const minimax_board_t* board, bool player, uint8_t* row, uint8_t* column);
+
+/**
+ * Searches for the next move with iterative deepening: alpha-beta searches
+ * 1, 2, 3, ... moves deep (move ordering, transposition table), scoring the
+ * positions where a search stops before the end of the game by counting the
+ * lines each side can still complete. Stops when the search reaches the end
+ * of the game or when readClock() passes deadline, and returns the move of
+ * the deepest search that finished (the 1-move search always finishes).
+ * Without a deadline this is the same move as a full minimax search: the
+ * first best move in row-major order. The board is not modified.
+ * Same as minimax_beginSearch() and minimax_step() with no budget.
+ * @param search    State for this search, does not need to be initialized.
+ * @param board     A representation of the current state of the board.
+ * @param player    TRUE means computer is 'X', FALSE means computer is 'O'
+ * @param readClock Returns the current time, NULL for no deadline.
+ * @param deadline  Time (as returned by readClock) by which to return.
+ * @param row       The address of where to store the row of the AI's move.
+ * @param column    The address of where to store the col of the AI's move.
+ */
+void minimax_searchNextMove(minimax_search_t* search, const minimax_board_t* board, bool player,
+                            minimax_clock_t readClock, uint64_t deadline, uint8_t* row, uint8_t* column);
+
+/**
+ * Starts the search of minimax_searchNextMove() without searching anything
+ * yet. Call minimax_step() until minimax_resultReady(), then
+ * minimax_getResult(). The board is copied, it may change afterwards.
+ * @param search    State for this search, does not need to be initialized.
+ * @param board     A representation of the current state of the board.
+ * @param player    TRUE means computer is 'X', FALSE means computer is 'O'
+ * @param readClock Returns the current time, NULL for no deadline.
+ * @param deadline  Time (as returned by readClock) by which the search must finish.
+ */
+void minimax_beginSearch(minimax_search_t* search, const minimax_board_t* board, bool player,
+                         minimax_clock_t readClock, uint64_t deadline);
+
+/**
+ * Carries the search on until the result is ready or budgetTicks have passed
+ * on the search's clock (positions visited if the search has no clock), then
+ * returns. The clock is only read every few positions, so a step may run over
+ * by up to about 64 positions. The deadline given to minimax_beginSearch()
+ * keeps running between steps.
+ * @param search      A search started by minimax_beginSearch().
+ * @param budgetTicks How long this step may take, MINIMAX_UNLIMITED_BUDGET to finish the search.
+ * @return            minimax_resultReady().
+ */
+bool minimax_step(minimax_search_t* search, uint64_t budgetTicks);
+
+/**
+ * @param search A search started by minimax_beginSearch().
+ * @return       TRUE once the search has finished (or run out of time).
+ */
+bool minimax_resultReady(const minimax_search_t* search);
+
+/**
+ * Returns the move found by a search that is ready (see minimax_resultReady()).
+ * @param search A finished search.
+ * @param row    The address of where to store the row of the AI's move.
+ * @param column The address of where to store the col of the AI's move.
+ */
+void minimax_getResult(const minimax_search_t* search, uint8_t* row, uint8_t* column);
+
 /**
  * Determine whether the game is over by looking at the score.
  * @param  score The current score.
@@ -72,7 +237,9 @@ bool minimax_isGameOver(minimax_score_t score);
 /**
  * Returns the score of the board.
  * @param  board  Representation of the current board.
- * @return        The score of board.
+ * @return        MINIMAX_PLAYER_WINNING_SCORE or MINIMAX_OPPONENT_WINNING_SCORE
+ *                if X or O has MINIMAX_WIN_LENGTH in a row, MINIMAX_DRAW_SCORE
+ *                if the board is full, MINIMAX_NOT_ENDGAME otherwise.
  */
 int16_t minimax_computeBoardScore(minimax_board_t* board);
 
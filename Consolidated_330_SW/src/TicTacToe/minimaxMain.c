@@ -1,7 +1,199 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
 #include "minimax.h"
 
+// The reference engine and the table only cover the 3x3 game; other boards
+// (e.g., "make nxn") get a timed self-play game instead.
+#if (MINIMAX_BOARD_ROWS == 3) && (MINIMAX_BOARD_COLUMNS == 3) && (MINIMAX_WIN_LENGTH == 3)
+#include "minimaxTable.h"
+
+// The original exhaustive minimax (no pruning), kept as the reference the new
+// engine is checked against. depth is passed down instead of kept in a global.
+static minimax_score_t reference_minimax(minimax_board_t* board, bool player, int8_t depth,
+                                         minimax_move_t* choice) {
+  minimax_move_t moves[MINIMAX_TOTALSQUARES];
+  minimax_score_t scores[MINIMAX_TOTALSQUARES];
+  minimax_score_t score = minimax_computeBoardScore(board);  // Wins are +-10000 at depth 0.
+  if (minimax_isGameOver(score)) {
+    if (score == MINIMAX_PLAYER_WINNING_SCORE) {
+      return score - depth;
+    }
+    if (score == MINIMAX_OPPONENT_WINNING_SCORE) {
+      return score + depth;
+    }
+    return score;
+  }
+  int16_t index = 0;
+  int row, col;
+  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+      if (board->squares[row][col] == MINIMAX_EMPTY_SQUARE) {
+        board->squares[row][col] = player ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+        scores[index] = reference_minimax(board, !player, depth + 1, choice);
+        moves[index].row = row;
+        moves[index].column = col;
+        index++;
+        board->squares[row][col] = MINIMAX_EMPTY_SQUARE;
+      }
+    }
+  }
+  int16_t best = 0;
+  int i;
+  for (i = 0; i < index; i++) {
+    if (player ? (scores[i] > scores[best]) : (scores[i] < scores[best])) {
+      best = i;
+    }
+  }
+  *choice = moves[best];
+  return scores[best];
+}
+
+static void reference_computeNextMove(minimax_board_t* board, bool player, uint8_t* row, uint8_t* column) {
+  minimax_move_t choice = {0, 0};
+  bool notEmpty = false;
+  int i, j;
+  for (i = 0; i < MINIMAX_BOARD_ROWS; i++) {
+    for (j = 0; j < MINIMAX_BOARD_COLUMNS; j++) {
+      if (board->squares[i][j] != MINIMAX_EMPTY_SQUARE) {
+        notEmpty = true;
+      }
+    }
+  }
+  if (notEmpty) {
+    reference_minimax(board, player, 0, &choice);
+  }
+  *row = choice.row;
+  *column = choice.column;
+}
+
+// Statistics gathered over all reachable positions.
+static uint32_t positionCount = 0;
+static uint32_t mismatchCount = 0;
+static uint64_t totalNodes = 0;
+static double totalSeconds = 0, referenceSeconds = 0;
+static double worstSeconds = 0, worstReferenceSeconds = 0;
+static uint32_t worstNodes = 0;
+static uint32_t slicedMismatchCount = 0, worstSteps = 0;
+
+#define SLICE_POSITIONS 16  // Positions per minimax_step() in the sliced search.
+
+// Runs the search a few positions at a time and checks it ends on the same move as in one go.
+static void compareSlicedSearch(minimax_board_t* board, bool player, uint8_t row, uint8_t column) {
+  minimax_search_t search;
+  uint8_t slicedRow, slicedColumn;
+  uint32_t steps = 1;
+  minimax_beginSearch(&search, board, player, NULL, 0);
+  while (!minimax_step(&search, SLICE_POSITIONS)) {
+    steps++;
+  }
+  minimax_getResult(&search, &slicedRow, &slicedColumn);
+  if (steps > worstSteps) worstSteps = steps;
+  if ((slicedRow != row) || (slicedColumn != column)) {
+    slicedMismatchCount++;
+    printf("sliced mismatch (player %d): (%d, %d) instead of (%d, %d)\n", player, slicedRow, slicedColumn, row, column);
+  }
+}
+
+// Times one call of the new engine and of the reference on board and compares their moves.
+static void compareEngines(minimax_board_t* board, bool player) {
+  minimax_search_t search;
+  uint8_t row, column, referenceRow, referenceColumn;
+  clock_t start = clock();
+  minimax_searchNextMove(&search, board, player, NULL, 0, &row, &column);
+  double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  reference_computeNextMove(board, player, &referenceRow, &referenceColumn);
+  double reference = (double) (clock() - start) / CLOCKS_PER_SEC;
+  positionCount++;
+  totalNodes += search.nodeCount;
+  totalSeconds += seconds;
+  referenceSeconds += reference;
+  if (seconds > worstSeconds) worstSeconds = seconds;
+  if (reference > worstReferenceSeconds) worstReferenceSeconds = reference;
+  if (search.nodeCount > worstNodes) worstNodes = search.nodeCount;
+  if ((row != referenceRow) || (column != referenceColumn)) {
+    mismatchCount++;
+    printf("mismatch (player %d): (%d, %d) instead of (%d, %d)\n", player, row, column, referenceRow, referenceColumn);
+  }
+  compareSlicedSearch(board, player, row, column);
+}
+
+#define LOOKUP_REPEATS 100  // A single lookup is too quick for clock().
+static uint32_t lookUpCount = 0, lookUpMismatchCount = 0;
+static double lookUpSeconds = 0, worstLookUpSeconds = 0;
+
+// Checks the table against the reference for the side that is to move on board.
+static void checkLookUp(minimax_board_t* board, bool player) {
+  uint8_t row = 0, column = 0, referenceRow, referenceColumn;
+  bool found = false;
+  int i;
+  clock_t start = clock();
+  for (i = 0; i < LOOKUP_REPEATS; i++) {
+    found = minimax_lookUpNextMove(board, player, &row, &column);
+  }
+  double seconds = (double) (clock() - start) / CLOCKS_PER_SEC / LOOKUP_REPEATS;
+  reference_computeNextMove(board, player, &referenceRow, &referenceColumn);
+  lookUpCount++;
+  lookUpSeconds += seconds;
+  if (seconds > worstLookUpSeconds) worstLookUpSeconds = seconds;
+  if (!found || (row != referenceRow) || (column != referenceColumn)) {
+    lookUpMismatchCount++;
+    printf("table mismatch (player %d): found %d, (%d, %d) instead of (%d, %d)\n", player, found, row, column,
+           referenceRow, referenceColumn);
+  }
+}
+
+// Visits every position reachable from board (X moves first), each once, and compares the
+// engines for both players in every position where the game is not over yet.
+static void visitPositions(minimax_board_t* board, bool xToMove, uint8_t visited[]) {
+  int index = 0, row, col;
+  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {  // Base-3 number of the position.
+    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+      index = index * 3 + board->squares[row][col];
+    }
+  }
+  if (visited[index]) {
+    return;
+  }
+  visited[index] = 1;
+  if (minimax_isGameOver(minimax_computeBoardScore(board))) {
+    return;
+  }
+  compareEngines(board, true);
+  compareEngines(board, false);
+  checkLookUp(board, xToMove);
+  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+      if (board->squares[row][col] == MINIMAX_EMPTY_SQUARE) {
+        board->squares[row][col] = xToMove ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+        visitPositions(board, !xToMove, visited);
+        board->squares[row][col] = MINIMAX_EMPTY_SQUARE;
+      }
+    }
+  }
+}
+
+// Checks the engine and the table against the reference on all reachable positions and
+// prints a benchmark.
+static void minimax_runEquivalenceTest() {
+  static uint8_t visited[19683];  // 3^9 possible boards.
+  minimax_board_t board;
+  minimax_initBoard(&board);
+  visitPositions(&board, true, visited);
+  printf("equivalence: %lu searches, %lu mismatches\n", (unsigned long) positionCount, (unsigned long) mismatchCount);
+  printf("engine:    %.0f nodes/s, %.1f nodes/search, worst %lu nodes, worst %.3f ms, total %.3f s\n",
+         totalNodes / totalSeconds, (double) totalNodes / positionCount, (unsigned long) worstNodes,
+         worstSeconds * 1000, totalSeconds);
+  printf("sliced:    %lu mismatches, worst %lu steps of %d positions\n", (unsigned long) slicedMismatchCount,
+         (unsigned long) worstSteps, SLICE_POSITIONS);
+  printf("reference: worst %.3f ms, total %.3f s\n", worstReferenceSeconds * 1000, referenceSeconds);
+  printf("table:     %d entries, %lu bytes, %lu lookups, %lu mismatches, average %.3f us, worst %.3f us\n",
+         minimaxTable_entryCount, (unsigned long) (minimaxTable_entryCount * sizeof(minimaxTable_entry_t) +
+         sizeof(minimaxTable_squareMaps)), (unsigned long) lookUpCount, (unsigned long) lookUpMismatchCount,
+         lookUpSeconds / lookUpCount * 1e6, worstLookUpSeconds * 1e6);
+}
+
 int main() {
   minimax_board_t board1;  // Board 1 is the main example in the web-tutorial that I use on the web-site.
   board1.squares[0][0] = MINIMAX_OPPONENT_SQUARE;
@@ -112,5 +304,60 @@ int main() {
   minimax_computeNextMove(&board6, false, &row, &column);
   printf("next move for board9: (%d, %d)\n\n\n", row, column);
 
+  minimax_runEquivalenceTest();
+
  return 0;
 }
+
+#else
+
+#define SELF_PLAY_BUDGET_MS 50  // Time each side gets per move.
+
+static uint64_t hostClock() {
+  return clock();
+}
+
+// Plays one game of the engine against itself with a deadline on every move and reports
+// how deep each search got and whether any went over its budget.
+int main() {
+  minimax_search_t search;
+  minimax_board_t board;
+  minimax_initBoard(&board);
+  bool player = true;
+  double worstMs = 0;
+  uint64_t totalNodes = 0;
+  printf("%dx%d board, %d in a row, %d ms per move\n", MINIMAX_BOARD_ROWS, MINIMAX_BOARD_COLUMNS,
+         MINIMAX_WIN_LENGTH, SELF_PLAY_BUDGET_MS);
+  while (!minimax_isGameOver(minimax_computeBoardScore(&board))) {
+    uint8_t row, column;
+    clock_t start = clock();
+    minimax_searchNextMove(&search, &board, player, hostClock, start + SELF_PLAY_BUDGET_MS * (CLOCKS_PER_SEC / 1000),
+                           &row, &column);
+    double ms = (double) (clock() - start) * 1000 / CLOCKS_PER_SEC;
+    printf("%c plays (%d, %d): depth %d, %lu nodes, %.3f ms\n", player ? 'X' : 'O', row, column,
+           search.completedDepth, (unsigned long) search.nodeCount, ms);
+    if (board.squares[row][column] != MINIMAX_EMPTY_SQUARE) {
+      printf("illegal move\n");
+      return 1;
+    }
+    board.squares[row][column] = player ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+    if (ms > worstMs) worstMs = ms;
+    totalNodes += search.nodeCount;
+    player = !player;
+  }
+  int r, c;
+  for (r = 0; r < MINIMAX_BOARD_ROWS; r++) {
+    for (c = 0; c < MINIMAX_BOARD_COLUMNS; c++) {
+      printf("%c ", (board.squares[r][c] == MINIMAX_PLAYER_SQUARE) ? 'X' :
+             ((board.squares[r][c] == MINIMAX_OPPONENT_SQUARE) ? 'O' : '-'));
+    }
+    printf("\n");
+  }
+  minimax_score_t score = minimax_computeBoardScore(&board);
+  printf("result: %s, %llu nodes, worst move %.3f ms of %d ms\n", (score == MINIMAX_DRAW_SCORE) ? "draw" :
+         ((score == MINIMAX_PLAYER_WINNING_SCORE) ? "X wins" : "O wins"), (unsigned long long) totalNodes,
+         worstMs, SELF_PLAY_BUDGET_MS);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,127 @@
+//*****************************************************************************
+// Generated by minimaxTableGen.c ("make table"), do not edit.
+// Best moves for the 627 canonical positions where a move is still to be made.
+//*****************************************************************************
+
+#include "minimaxTable.h"
+
+const uint8_t minimaxTable_squareMaps[MINIMAXTABLE_SYMMETRIES][9] = {
+  {0, 1, 2, 3, 4, 5, 6, 7, 8},
+  {2, 5, 8, 1, 4, 7, 0, 3, 6},
+  {8, 7, 6, 5, 4, 3, 2, 1, 0},
+  {6, 3, 0, 7, 4, 1, 8, 5, 2},
+  {2, 1, 0, 5, 4, 3, 8, 7, 6},
+  {8, 5, 2, 7, 4, 1, 6, 3, 0},
+  {6, 7, 8, 3, 4, 5, 0, 1, 2},
+  {0, 3, 6, 1, 4, 7, 2, 5, 8}
+};
+
+const minimaxTable_entry_t minimaxTable_entries[] = {
+  {    0, 0x1FF}, {    2, 0x010}, {    5, 0x058}, {    6, 0x095}, {    7, 0x158}, {   11, 0x148},
+  {   17, 0x120}, {   23, 0x010}, {   33, 0x011}, {   35, 0x004}, {   44, 0x010}, {   45, 0x111},
+  {   47, 0x002}, {   50, 0x110}, {   51, 0x001}, {   52, 0x040}, {   61, 0x0B0}, {   63, 0x001},
+  {   65, 0x040}, {   68, 0x040}, {   69, 0x100}, {   70, 0x010}, {   73, 0x030}, {   75, 0x010},
+  {   76, 0x030}, {   83, 0x1EE}, {   87, 0x16D}, {   89, 0x004}, {   98, 0x040}, {  101, 0x002},
+  {  104, 0x080}, {  116, 0x004}, {  128, 0x002}, {  132, 0x001}, {  141, 0x045}, {  142, 0x100},
+  {  146, 0x040}, {  150, 0x040}, {  152, 0x040}, {  153, 0x0C3}, {  154, 0x100}, {  156, 0x080},
+  {  158, 0x080}, {  160, 0x100}, {  162, 0x145}, {  163, 0x1EE}, {  165, 0x16D}, {  167, 0x100},
+  {  169, 0x080}, {  173, 0x100}, {  176, 0x100}, {  178, 0x080}, {  194, 0x100}, {  195, 0x080},
+  {  196, 0x080}, {  200, 0x100}, {  204, 0x080}, {  206, 0x1E0}, {  207, 0x040}, {  208, 0x040},
+  {  210, 0x040}, {  212, 0x1E0}, {  214, 0x040}, {  225, 0x020}, {  226, 0x020}, {  228, 0x020},
+  {  230, 0x1E0}, {  232, 0x1E0}, {  238, 0x1E0}, {  278, 0x004}, {  290, 0x002}, {  297, 0x1D7},
+  {  299, 0x040}, {  302, 0x040}, {  303, 0x041}, {  304, 0x194}, {  308, 0x040}, {  312, 0x100},
+  {  314, 0x100}, {  315, 0x041}, {  316, 0x1D2}, {  318, 0x040}, {  320, 0x040}, {  322, 0x0D0},
+  {  380, 0x040}, {  384, 0x001}, {  386, 0x1C4}, {  395, 0x040}, {  396, 0x001}, {  398, 0x1C2},
+  {  401, 0x040}, {  402, 0x001}, {  403, 0x100}, {  434, 0x100}, {  438, 0x080}, {  440, 0x1C4},
+  {  449, 0x180}, {  452, 0x1C2}, {  455, 0x140}, {  459, 0x145}, {  460, 0x186}, {  462, 0x041},
+  {  464, 0x1C4}, {  466, 0x080}, {  468, 0x100}, {  470, 0x100}, {  473, 0x140}, {  474, 0x100},
+  {  475, 0x080}, {  478, 0x040}, {  480, 0x040}, {  481, 0x040}, {  541, 0x010}, {  543, 0x010},
+  {  544, 0x010}, {  550, 0x010}, {  554, 0x1D0}, {  556, 0x010}, {  621, 0x1C7}, {  622, 0x100},
+  {  624, 0x080}, {  626, 0x080}, {  628, 0x100}, {  632, 0x040}, {  635, 0x040}, {  637, 0x1C0},
+  {  746, 0x010}, {  747, 0x101}, {  749, 0x002}, {  752, 0x100}, {  753, 0x001}, {  754, 0x008},
+  {  776, 0x002}, {  780, 0x001}, {  798, 0x010}, {  800, 0x010}, {  801, 0x130}, {  802, 0x020},
+  {  804, 0x020}, {  806, 0x080}, {  808, 0x100}, {  830, 0x002}, {  834, 0x001}, {  882, 0x183},
+  {  884, 0x002}, {  887, 0x080}, {  888, 0x001}, {  889, 0x100}, {  902, 0x100}, {  906, 0x080},
+  {  908, 0x1A8}, {  909, 0x101}, {  910, 0x008}, {  912, 0x120}, {  914, 0x100}, {  916, 0x008},
+  {  935, 0x180}, {  936, 0x001}, {  938, 0x1A2}, {  941, 0x100}, {  942, 0x001}, {  960, 0x1A1},
+  {  961, 0x0A0}, {  964, 0x020}, {  966, 0x020}, {  967, 0x020}, {  980, 0x004}, {  992, 0x002},
+  {  996, 0x001}, { 1028, 0x104}, { 1032, 0x194}, { 1034, 0x004}, { 1043, 0x190}, { 1044, 0x193},
+  { 1046, 0x002}, { 1049, 0x190}, { 1050, 0x001}, { 1051, 0x190}, { 1115, 0x004}, { 1127, 0x002},
+  { 1131, 0x001}, { 1136, 0x100}, { 1140, 0x080}, { 1142, 0x18C}, { 1151, 0x180}, { 1154, 0x18A},
+  { 1157, 0x100}, { 1158, 0x189}, { 1159, 0x080}, { 1169, 0x184}, { 1181, 0x102}, { 1185, 0x081},
+  { 1190, 0x100}, { 1193, 0x100}, { 1194, 0x080}, { 1195, 0x080}, { 1199, 0x100}, { 1203, 0x080},
+  { 1205, 0x100}, { 1206, 0x183}, { 1207, 0x182}, { 1209, 0x181}, { 1211, 0x100}, { 1213, 0x080},
+  { 1217, 0x100}, { 1220, 0x110}, { 1221, 0x101}, { 1222, 0x008}, { 1226, 0x010}, { 1230, 0x010},
+  { 1232, 0x010}, { 1234, 0x100}, { 1238, 0x100}, { 1240, 0x008}, { 1244, 0x104}, { 1248, 0x001},
+  { 1250, 0x004}, { 1259, 0x010}, { 1260, 0x100}, { 1262, 0x192}, { 1265, 0x100}, { 1266, 0x001},
+  { 1270, 0x010}, { 1272, 0x010}, { 1274, 0x010}, { 1276, 0x010}, { 1278, 0x010}, { 1280, 0x010},
+  { 1283, 0x010}, { 1284, 0x010}, { 1285, 0x010}, { 1288, 0x192}, { 1290, 0x191}, { 1291, 0x110},
+  { 1298, 0x004}, { 1302, 0x004}, { 1304, 0x004}, { 1316, 0x18A}, { 1319, 0x100}, { 1320, 0x189},
+  { 1321, 0x100}, { 1331, 0x004}, { 1343, 0x102}, { 1347, 0x101}, { 1352, 0x004}, { 1355, 0x184},
+  { 1356, 0x004}, { 1357, 0x184}, { 1368, 0x100}, { 1369, 0x100}, { 1371, 0x100}, { 1373, 0x080},
+  { 1375, 0x100}, { 1378, 0x008}, { 1382, 0x18C}, { 1384, 0x008}, { 1388, 0x18A}, { 1391, 0x108},
+  { 1392, 0x189}, { 1393, 0x088}, { 1396, 0x008}, { 1399, 0x108}, { 1406, 0x100}, { 1409, 0x100},
+  { 1410, 0x001}, { 1415, 0x100}, { 1419, 0x080}, { 1421, 0x180}, { 1422, 0x001}, { 1425, 0x100},
+  { 1427, 0x100}, { 1477, 0x010}, { 1479, 0x010}, { 1480, 0x010}, { 1506, 0x010}, { 1508, 0x010},
+  { 1510, 0x010}, { 1557, 0x0AA}, { 1558, 0x100}, { 1560, 0x080}, { 1562, 0x080}, { 1564, 0x100},
+  { 1589, 0x1A0}, { 1590, 0x020}, { 1591, 0x1A0}, { 1703, 0x008}, { 1706, 0x008}, { 1707, 0x010},
+  { 1708, 0x090}, { 1712, 0x008}, { 1716, 0x100}, { 1718, 0x100}, { 1720, 0x010}, { 1722, 0x010},
+  { 1724, 0x198}, { 1726, 0x010}, { 1730, 0x010}, { 1734, 0x010}, { 1736, 0x010}, { 1745, 0x190},
+  { 1746, 0x010}, { 1748, 0x010}, { 1751, 0x010}, { 1752, 0x010}, { 1753, 0x010}, { 1758, 0x001},
+  { 1762, 0x100}, { 1770, 0x100}, { 1771, 0x100}, { 1774, 0x010}, { 1776, 0x191}, { 1777, 0x010},
+  { 1784, 0x008}, { 1788, 0x008}, { 1790, 0x008}, { 1799, 0x008}, { 1802, 0x008}, { 1805, 0x008},
+  { 1806, 0x008}, { 1807, 0x188}, { 1842, 0x001}, { 1843, 0x100}, { 1851, 0x001}, { 1854, 0x001},
+  { 1855, 0x100}, { 1857, 0x001}, { 1861, 0x100}, { 1866, 0x004}, { 1868, 0x18C}, { 1870, 0x18C},
+  { 1874, 0x100}, { 1877, 0x108}, { 1878, 0x100}, { 1879, 0x080}, { 1892, 0x186}, { 1895, 0x104},
+  { 1896, 0x185}, { 1897, 0x084}, { 1901, 0x100}, { 1905, 0x080}, { 1907, 0x100}, { 1920, 0x185},
+  { 1921, 0x004}, { 1927, 0x182}, { 1929, 0x001}, { 1933, 0x100}, { 1948, 0x004}, { 1954, 0x002},
+  { 1958, 0x008}, { 1960, 0x090}, { 1966, 0x198}, { 1974, 0x104}, { 1976, 0x110}, { 1978, 0x194},
+  { 1982, 0x190}, { 1985, 0x100}, { 1986, 0x190}, { 1987, 0x080}, { 1990, 0x192}, { 1992, 0x191},
+  { 1993, 0x110}, { 2002, 0x004}, { 2008, 0x002}, { 2010, 0x001}, { 2030, 0x080}, { 2032, 0x100},
+  { 2036, 0x008}, { 2039, 0x008}, { 2040, 0x189}, { 2041, 0x100}, { 2044, 0x100}, { 2047, 0x100},
+  { 2054, 0x186}, { 2057, 0x080}, { 2058, 0x104}, { 2059, 0x100}, { 2063, 0x182}, { 2067, 0x181},
+  { 2069, 0x180}, { 2071, 0x100}, { 2073, 0x100}, { 2075, 0x080}, { 2077, 0x100}, { 2082, 0x080},
+  { 2083, 0x184}, { 2089, 0x182}, { 2091, 0x001}, { 2095, 0x100}, { 2101, 0x180}, { 2110, 0x004},
+  { 2116, 0x002}, { 2136, 0x004}, { 2137, 0x004}, { 2143, 0x002}, { 2145, 0x001}, { 2147, 0x100},
+  { 2149, 0x080}, { 2490, 0x001}, { 2492, 0x154}, { 2501, 0x040}, { 2504, 0x152}, { 2507, 0x040},
+  { 2508, 0x001}, { 2509, 0x150}, { 2573, 0x044}, { 2585, 0x042}, { 2589, 0x001}, { 2627, 0x104},
+  { 2639, 0x142}, { 2652, 0x100}, { 2653, 0x144}, { 2657, 0x140}, { 2661, 0x100}, { 2663, 0x100},
+  { 2665, 0x040}, { 2667, 0x040}, { 2669, 0x140}, { 2671, 0x040}, { 2730, 0x010}, { 2732, 0x010},
+  { 2734, 0x010}, { 2738, 0x152}, { 2741, 0x050}, { 2743, 0x010}, { 2814, 0x140}, { 2815, 0x100},
+  { 2819, 0x040}, { 2825, 0x040}, { 3233, 0x002}, { 3237, 0x001}, { 3341, 0x102}, { 3392, 0x100},
+  { 3395, 0x100}, { 3398, 0x100}, { 3399, 0x100}, { 3400, 0x100}, { 3410, 0x100}, { 3419, 0x118},
+  { 3422, 0x100}, { 3425, 0x100}, { 3427, 0x100}, { 3437, 0x004}, { 3449, 0x102}, { 3453, 0x101},
+  { 3461, 0x010}, { 3462, 0x100}, { 3463, 0x010}, { 3467, 0x010}, { 3471, 0x010}, { 3473, 0x110},
+  { 3475, 0x110}, { 3477, 0x110}, { 3479, 0x110}, { 3481, 0x100}, { 3491, 0x004}, { 3503, 0x102},
+  { 3543, 0x105}, { 3545, 0x104}, { 3557, 0x102}, { 3561, 0x100}, { 3562, 0x100}, { 3569, 0x108},
+  { 3571, 0x008}, { 3575, 0x108}, { 3581, 0x100}, { 3583, 0x108}, { 3587, 0x100}, { 3589, 0x108},
+  { 3597, 0x105}, { 3599, 0x100}, { 3608, 0x100}, { 3611, 0x100}, { 3614, 0x100}, { 3615, 0x101},
+  { 3908, 0x11A}, { 3911, 0x018}, { 3913, 0x010}, { 3939, 0x011}, { 3967, 0x010}, { 3989, 0x00A},
+  { 4047, 0x001}, { 4048, 0x100}, { 4136, 0x010}, { 4138, 0x014}, { 4142, 0x008}, { 4145, 0x008},
+  { 4147, 0x118}, { 4150, 0x11A}, { 4153, 0x110}, { 4163, 0x010}, { 4164, 0x004}, { 4165, 0x004},
+  { 4169, 0x112}, { 4173, 0x111}, { 4175, 0x110}, { 4177, 0x110}, { 4181, 0x010}, { 4183, 0x110},
+  { 4195, 0x010}, { 4201, 0x010}, { 4207, 0x010}, { 4219, 0x100}, { 4223, 0x008}, { 4229, 0x008},
+  { 4231, 0x100}, { 4237, 0x100}, { 4245, 0x004}, { 4247, 0x004}, { 4256, 0x100}, { 4259, 0x002},
+  { 4263, 0x101}, { 4264, 0x100}, { 4273, 0x100}, { 4281, 0x001}, { 4282, 0x100}, { 4285, 0x102},
+  { 4303, 0x008}, { 4307, 0x108}, { 4309, 0x008}, { 4325, 0x104}, { 4327, 0x004}, { 4331, 0x100},
+  { 4334, 0x100}, { 4335, 0x101}, { 4336, 0x100}, { 4924, 0x002}, { 5005, 0x142}, { 5009, 0x040},
+  { 5011, 0x140}, { 5600, 0x010}, { 5603, 0x010}, { 5605, 0x010}, { 5608, 0x008}, { 5611, 0x100},
+  { 5633, 0x010}, { 5639, 0x100}, { 5659, 0x010}, { 5665, 0x110}, { 5689, 0x100}, { 5693, 0x100},
+  { 5695, 0x108}, { 5717, 0x102}, { 5720, 0x100}, { 5743, 0x100}, { 5746, 0x100}, { 5761, 0x00A},
+  { 5765, 0x108}, { 5773, 0x008}, { 5792, 0x100}, { 6367, 0x110}, { 6421, 0x100}, { 6448, 0x100},
+  { 7310, 0x002}, { 7361, 0x0B0}, { 7364, 0x080}, { 7367, 0x080}, { 7369, 0x0B0}, { 7445, 0x002},
+  { 7469, 0x080}, { 7472, 0x080}, { 7475, 0x080}, { 7499, 0x002}, { 7523, 0x0A0}, { 7525, 0x020},
+  { 7529, 0x080}, { 7531, 0x080}, { 7607, 0x002}, { 7769, 0x080}, { 7772, 0x080}, { 7774, 0x080},
+  { 7841, 0x010}, { 7847, 0x090}, { 7853, 0x080}, { 7931, 0x080}, { 7934, 0x080}, { 8038, 0x010},
+  { 8042, 0x0B8}, { 8044, 0x010}, { 8069, 0x010}, { 8071, 0x010}, { 8120, 0x0AA}, { 8123, 0x008},
+  { 8282, 0x09A}, { 8285, 0x018}, { 8287, 0x010}, { 8309, 0x012}, { 8335, 0x010}, { 8341, 0x010},
+  { 8363, 0x00A}, { 8516, 0x008}, { 8519, 0x008}, { 8521, 0x010}, { 8543, 0x092}, { 8549, 0x090},
+  { 8555, 0x010}, { 8557, 0x010}, { 8575, 0x010}, { 8581, 0x010}, { 8597, 0x008}, { 8603, 0x008},
+  { 8609, 0x080}, { 8630, 0x080}, { 8633, 0x002}, { 8636, 0x080}, { 8681, 0x008}, { 8683, 0x088},
+  { 8705, 0x082}, { 8708, 0x080}, { 8710, 0x080}, {10469, 0x01A}, {10528, 0x010}, {10709, 0x008},
+  {10715, 0x010}, {10736, 0x010}, {10739, 0x012}, {10742, 0x010}, {10744, 0x010}, {10762, 0x010},
+  {10768, 0x010}, {10790, 0x008}, {10793, 0x002}, {10820, 0x002}, {10868, 0x008}, {12220, 0x010},
+  {14711, 0x0A0}, {14873, 0x010}, {17060, 0x010},
+};
+
+const uint16_t minimaxTable_entryCount = 627;
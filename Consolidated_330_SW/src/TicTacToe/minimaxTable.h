@@ -0,0 +1,28 @@
+//*****************************************************************************
+// Precomputed moves for every reachable TicTacToe position. The table itself
+// (minimaxTable.c) is generated by minimaxTableGen.c: run "make table".
+//*****************************************************************************
+#ifndef MINIMAXTABLE_H_
+#define MINIMAXTABLE_H_
+
+#include <stdint.h>
+
+// Number of board symmetries (4 rotations, each also mirrored).
+#define MINIMAXTABLE_SYMMETRIES 8
+
+// One position where the side to move (X if both sides have the same number of pieces,
+// otherwise O) still has a move to make. Only one position out of each group of symmetric
+// positions is stored: the one with the smallest key.
+typedef struct {
+  uint16_t key;        // sum over the squares of square value * 3^(row * 3 + column).
+  uint16_t bestMoves;  // Bit (row * 3 + column) is set for every move with the best minimax score.
+} minimaxTable_entry_t;
+
+// squareMaps[s][i] is the square of the original board that lands on square i under symmetry s.
+extern const uint8_t minimaxTable_squareMaps[MINIMAXTABLE_SYMMETRIES][9];
+
+// Sorted by key.
+extern const minimaxTable_entry_t minimaxTable_entries[];
+extern const uint16_t minimaxTable_entryCount;
+
+#endif /* MINIMAXTABLE_H_ */
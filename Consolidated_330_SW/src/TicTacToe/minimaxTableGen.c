@@ -0,0 +1,181 @@
+//*****************************************************************************
+// Host program that solves every reachable TicTacToe position and writes the
+// lookup table used by minimax_computeNextMove() (minimaxTable.c).
+// Build and run it with "make table". Not part of the board build.
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "minimax.h"
+#include "minimaxTable.h"
+
+#define BOARD_COUNT 19683  // 3^9 possible boards.
+#define TABLE_FILE "minimaxTable.c"
+
+static uint8_t squareMaps[MINIMAXTABLE_SYMMETRIES][MINIMAX_TOTALSQUARES];
+static uint8_t visited[BOARD_COUNT];
+static uint16_t bestMoves[BOARD_COUNT];  // Indexed by canonical key, 0 = not stored.
+static uint32_t positionCount = 0;
+
+// Builds the 8 symmetries: rotations by 0, 90, 180 and 270 degrees, without and with a mirror.
+static void buildSquareMaps() {
+  int s, row, col;
+  for (s = 0; s < MINIMAXTABLE_SYMMETRIES; s++) {
+    for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+      for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+        int r = row, c = (s >= 4) ? (MINIMAX_BOARD_COLUMNS - 1 - col) : col;  // Mirror first.
+        int turn;
+        for (turn = 0; turn < s % 4; turn++) {  // Then rotate.
+          int t = r;
+          r = c;
+          c = MINIMAX_BOARD_ROWS - 1 - t;
+        }
+        squareMaps[s][row * MINIMAX_BOARD_COLUMNS + col] = r * MINIMAX_BOARD_COLUMNS + c;
+      }
+    }
+  }
+}
+
+// Base-3 key, square 0 is the lowest digit.
+static uint16_t boardKey(const minimax_board_t* board, int symmetry) {
+  uint16_t key = 0;
+  int i;
+  for (i = MINIMAX_TOTALSQUARES - 1; i >= 0; i--) {
+    uint8_t source = squareMaps[symmetry][i];
+    key = key * 3 + board->squares[source / MINIMAX_BOARD_COLUMNS][source % MINIMAX_BOARD_COLUMNS];
+  }
+  return key;
+}
+
+// Full minimax with the scoring rules of minimax.c. depth counts the moves made since the
+// position being solved.
+static minimax_score_t solve(minimax_board_t* board, bool player, int8_t depth) {
+  minimax_score_t score = minimax_computeBoardScore(board);  // Wins are +-10000 at depth 0.
+  if (minimax_isGameOver(score)) {
+    if (score == MINIMAX_PLAYER_WINNING_SCORE) {
+      return score - depth;
+    }
+    if (score == MINIMAX_OPPONENT_WINNING_SCORE) {
+      return score + depth;
+    }
+    return score;
+  }
+  minimax_score_t best = player ? -MINIMAX_PLAYER_WINNING_SCORE - 1 : MINIMAX_PLAYER_WINNING_SCORE + 1;
+  int square;
+  for (square = 0; square < MINIMAX_TOTALSQUARES; square++) {
+    uint8_t* s = &board->squares[square / MINIMAX_BOARD_COLUMNS][square % MINIMAX_BOARD_COLUMNS];
+    if (*s == MINIMAX_EMPTY_SQUARE) {
+      *s = player ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+      score = solve(board, !player, depth + 1);
+      *s = MINIMAX_EMPTY_SQUARE;
+      if (player ? (score > best) : (score < best)) {
+        best = score;
+      }
+    }
+  }
+  return best;
+}
+
+// Stores the best moves of board (seen on its canonical form) if it is not stored yet.
+static void storePosition(minimax_board_t* board, bool xToMove) {
+  int s, canonical = 0;
+  uint16_t key = boardKey(board, 0);
+  for (s = 1; s < MINIMAXTABLE_SYMMETRIES; s++) {
+    if (boardKey(board, s) < key) {
+      key = boardKey(board, s);
+      canonical = s;
+    }
+  }
+  if (bestMoves[key]) {
+    return;
+  }
+  // Score every move; bit i of the mask is move i of the canonical board.
+  minimax_score_t scores[MINIMAX_TOTALSQUARES];
+  minimax_score_t best = xToMove ? -MINIMAX_PLAYER_WINNING_SCORE - 1 : MINIMAX_PLAYER_WINNING_SCORE + 1;
+  int i;
+  for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+    uint8_t source = squareMaps[canonical][i];
+    uint8_t* square = &board->squares[source / MINIMAX_BOARD_COLUMNS][source % MINIMAX_BOARD_COLUMNS];
+    scores[i] = 0x7FFF;
+    if (*square == MINIMAX_EMPTY_SQUARE) {
+      *square = xToMove ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+      scores[i] = solve(board, !xToMove, 1);
+      *square = MINIMAX_EMPTY_SQUARE;
+      if (xToMove ? (scores[i] > best) : (scores[i] < best)) {
+        best = scores[i];
+      }
+    }
+  }
+  for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+    if (scores[i] == best) {
+      bestMoves[key] |= 1 << i;
+    }
+  }
+  positionCount++;
+}
+
+// Visits every position reachable from board (X moves first).
+static void visitPositions(minimax_board_t* board, bool xToMove) {
+  uint16_t key = boardKey(board, 0);
+  if (visited[key]) {
+    return;
+  }
+  visited[key] = 1;
+  if (minimax_isGameOver(minimax_computeBoardScore(board))) {
+    return;
+  }
+  storePosition(board, xToMove);
+  int row, col;
+  for (row = 0; row < MINIMAX_BOARD_ROWS; row++) {
+    for (col = 0; col < MINIMAX_BOARD_COLUMNS; col++) {
+      if (board->squares[row][col] == MINIMAX_EMPTY_SQUARE) {
+        board->squares[row][col] = xToMove ? MINIMAX_PLAYER_SQUARE : MINIMAX_OPPONENT_SQUARE;
+        visitPositions(board, !xToMove);
+        board->squares[row][col] = MINIMAX_EMPTY_SQUARE;
+      }
+    }
+  }
+}
+
+int main() {
+  buildSquareMaps();
+  minimax_board_t board;
+  minimax_initBoard(&board);
+  visitPositions(&board, true);
+
+  FILE* file = fopen(TABLE_FILE, "w");
+  if (!file) {
+    printf("could not write %s\n", TABLE_FILE);
+    return 1;
+  }
+  fprintf(file, "//*****************************************************************************\n");
+  fprintf(file, "// Generated by minimaxTableGen.c (\"make table\"), do not edit.\n");
+  fprintf(file, "// Best moves for the %lu canonical positions where a move is still to be made.\n",
+          (unsigned long) positionCount);
+  fprintf(file, "//*****************************************************************************\n\n");
+  fprintf(file, "#include \"minimaxTable.h\"\n\n");
+  fprintf(file, "const uint8_t minimaxTable_squareMaps[MINIMAXTABLE_SYMMETRIES][9] = {\n");
+  int s, i, count = 0;
+  for (s = 0; s < MINIMAXTABLE_SYMMETRIES; s++) {
+    fprintf(file, "  {");
+    for (i = 0; i < MINIMAX_TOTALSQUARES; i++) {
+      fprintf(file, "%d%s", squareMaps[s][i], (i < MINIMAX_TOTALSQUARES - 1) ? ", " : "");
+    }
+    fprintf(file, "}%s\n", (s < MINIMAXTABLE_SYMMETRIES - 1) ? "," : "");
+  }
+  fprintf(file, "};\n\n");
+  fprintf(file, "const minimaxTable_entry_t minimaxTable_entries[] = {");
+  for (i = 0; i < BOARD_COUNT; i++) {
+    if (bestMoves[i]) {
+      fprintf(file, "%s{%5d, 0x%03X},", (count % 6) ? " " : "\n  ", i, bestMoves[i]);
+      count++;
+    }
+  }
+  fprintf(file, "\n};\n\n");
+  fprintf(file, "const uint16_t minimaxTable_entryCount = %d;\n", count);
+  fclose(file);
+  printf("%s: %d entries, %lu bytes\n", TABLE_FILE, count,
+         (unsigned long) (count * sizeof(minimaxTable_entry_t) + sizeof(squareMaps)));
+  return 0;
+}
@@ -0,0 +1,37 @@
+//*****************************************************************************
+// Messages between the TicTacToe control SM on CPU0 and the AI search on CPU1
+// (AMP mode, see supportFiles/amp.h and src/Amp/ampCpu1Main.c).
+//*****************************************************************************
+
+#ifndef TICTACTOEAMP_H_
+#define TICTACTOEAMP_H_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "supportFiles/amp.h"
+#include "minimax.h"
+
+#define TICTACTOEAMP_SEARCH_REQUEST (AMP_MESSAGE_USER + 0)  // CPU0 -> CPU1: ticTacToeAmp_searchRequest_t.
+#define TICTACTOEAMP_SEARCH_RESULT  (AMP_MESSAGE_USER + 1)  // CPU1 -> CPU0: ticTacToeAmp_searchResult_t.
+
+// Search board for player's move, for at most searchMs.
+typedef struct {
+  minimax_board_t board;
+  bool player;
+  uint16_t searchMs;
+} ticTacToeAmp_searchRequest_t;
+
+typedef struct {
+  uint8_t row;
+  uint8_t column;
+} ticTacToeAmp_searchResult_t;
+
+// Each must fit in one ring slot (amp_send() refuses longer payloads).
+static_assert(sizeof(minimax_board_t) <= AMPRING_PAYLOAD_BYTES, "minimax_board_t does not fit in an AMP message");
+static_assert(sizeof(ticTacToeAmp_searchRequest_t) <= AMPRING_PAYLOAD_BYTES,
+              "ticTacToeAmp_searchRequest_t does not fit in an AMP message");
+static_assert(sizeof(ticTacToeAmp_searchResult_t) <= AMPRING_PAYLOAD_BYTES,
+              "ticTacToeAmp_searchResult_t does not fit in an AMP message");
+
+#endif /* TICTACTOEAMP_H_ */
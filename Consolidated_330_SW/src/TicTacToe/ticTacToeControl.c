@@ -11,8 +11,13 @@
 #include "ticTacToeDisplay.h"
 #include "supportFiles/display.h"
 #include "supportFiles/arduinoTypes.h"
+#include "supportFiles/globalTimer.h"
 #include "minimax.h"
 #include "buttons.h"
+#ifdef TICTACTOECONTROL_USE_AMP
+#include <string.h>
+#include "ticTacToeAmp.h"
+#endif
 
 // States for the controller state machine.
 enum ticTacToeControl_st {
@@ -20,10 +25,11 @@ enum ticTacToeControl_st {
   show_instructions_st, // Initial screen to show player instructions
   instruction_wait_st,  // Wait while displaying instructions
   first_move_st,        // Wait for user to go, or let AI go
-  ad_timer_running_st,  // Wait for touch ADC to settle
+  wait_for_release_st,  // Wait for the release; the touch filter settles on the point meanwhile
   game_over_st,         // Wait for a restart
   player_turn_st,       // Wait for touch
-  computer_turn_st      // Have AI make their move
+  computer_turn_st,     // Have AI make their move
+  computer_search_st    // AI searches for their move, one slice per tick
 } currentState = init_st; // Initialize to init_st
 
 /**
@@ -53,8 +59,8 @@ void ticTacToeControl_debugStatePrint() {
       case first_move_st:
         printf("first_move_st\n\r");
         break;
-      case ad_timer_running_st:
-        printf("ad_timer_running_st\n\r");
+      case wait_for_release_st:
+        printf("wait_for_release_st\n\r");
         break;
       case game_over_st:
         printf("game_over_st\n\r");
@@ -65,6 +71,9 @@ void ticTacToeControl_debugStatePrint() {
       case computer_turn_st:
         printf("computer_turn_st\n\r");
         break;
+      case computer_search_st:
+        printf("computer_search_st\n\r");
+        break;
       default:
         printf("Shouldn't have hit this default case\n");
         break;
@@ -72,6 +81,62 @@ void ticTacToeControl_debugStatePrint() {
   }
 }
 
+// Global-timer ticks the AI may spend searching in one tick, and on one move.
+#define TICTACTOECONTROL_SEARCH_SLICE_TICKS \
+  ((uint64_t) TICTACTOECONTROL_SEARCH_SLICE_MS * (GLOBAL_TIMER_TICKS_PER_SECOND / 1000))
+#define TICTACTOECONTROL_SEARCH_TIME_TICKS \
+  ((uint64_t) TICTACTOECONTROL_SEARCH_TIME_MS * (GLOBAL_TIMER_TICKS_PER_SECOND / 1000))
+
+#ifdef TICTACTOECONTROL_USE_AMP
+// The AI searches on CPU1 (see ticTacToeAmp.h), CPU0 only sends the board and waits for the move.
+static void ticTacToeControl_beginSearch(const minimax_board_t* board, bool player) {
+  ticTacToeAmp_searchRequest_t request;
+  request.board = *board;
+  request.player = player;
+  request.searchMs = TICTACTOECONTROL_SEARCH_TIME_MS;
+  // Only one search is ever pending, so there is always room in the ring.
+  amp_send(TICTACTOEAMP_SEARCH_REQUEST, &request, sizeof(request));
+}
+
+// Returns TRUE and the move once CPU1 has sent it back.
+static bool ticTacToeControl_continueSearch(uint8_t* row, uint8_t* column) {
+  ampRing_message_t message;
+  while (amp_receive(&message)) {
+    if (message.type == TICTACTOEAMP_SEARCH_RESULT) {
+      ticTacToeAmp_searchResult_t result;
+      memcpy(&result, message.payload, sizeof(result));
+      *row = result.row;
+      *column = result.column;
+      return true;
+    }
+  }
+  return false;
+}
+#else
+// Kept out of the stack, it holds the transposition table. It also has to live
+// from one tick to the next while the search is spread over several.
+static minimax_search_t search;
+
+// Clock for the search deadline.
+static uint64_t ticTacToeControl_readClock() {
+  return globalTimer_getTimerValue();
+}
+
+static void ticTacToeControl_beginSearch(const minimax_board_t* board, bool player) {
+  minimax_beginSearch(&search, board, player, ticTacToeControl_readClock,
+                      ticTacToeControl_readClock() + TICTACTOECONTROL_SEARCH_TIME_TICKS);
+}
+
+// Searches for one slice. Returns TRUE and the move once the search is done.
+static bool ticTacToeControl_continueSearch(uint8_t* row, uint8_t* column) {
+  if (!minimax_step(&search, TICTACTOECONTROL_SEARCH_SLICE_TICKS)) {
+    return false;
+  }
+  minimax_getResult(&search, row, column);
+  return true;
+}
+#endif
+
 /**
  * Helper function that updates the internal variable representing the board
  * and draws the corresponding value to the screen.
@@ -95,24 +160,37 @@ void ticTacToeControl_updateBoard(minimax_board_t* board, uint8_t row, uint8_t c
   }
 }
 
+// True once the touch filter has settled on the touched point.
+static bool ticTacToeControl_isTouchStable() {
+  int16_t x, y;
+  uint8_t pressure;
+  return display_getStableTouchedPoint(&x, &y, &pressure);
+}
+
 void ticTacToeControl_tick() {
   // Uncomment the line below to visually see state transitions in console.
   //ticTacToeControl_debugStatePrint();
 
   // Variables representing the timers that will be used
-  static uint32_t adTimer = 0; // Time to wait for touch-controller ADC to settle.
   static uint32_t firstMoveTimer = 0;  // Time to give the user before AI moves.
   static uint32_t instructionTimer = 0; // Time to show instructions before showing board
 
   static uint8_t row, column;   // Variables to track rows/columns
   static minimax_board_t board; // Variable to store the current play board
   static bool player_first;     // Variable to show who is set to make the first move
+  static bool searching;        // The AI's move was not in the table, it is being searched.
+  static bool searchDone;       // The search has found the AI's move.
 
   /////////////////////////////////
   // Perform state action first. //
   /////////////////////////////////
   switch(currentState) {
     case init_st:
+      globalTimer_startTimer(false);  // Times the AI's searches.
+#ifdef TICTACTOECONTROL_USE_AMP
+      amp_init((void (*)()) AMP_CPU1_START_ADDRESS);
+      display_enableAmpRendering();  // CPU1 draws from now on, the main loop sends it the queue.
+#endif
       break;
     case show_instructions_st:
       // Initialize the display and print the instructions to the screen
@@ -143,8 +221,8 @@ void ticTacToeControl_tick() {
       // Increment counter to wait for player to make a move.
       firstMoveTimer++;
       break;
-    case ad_timer_running_st: // increment adTimer
-      adTimer++;
+    case wait_for_release_st:
+      // Do nothing
       break;
     case game_over_st:
       firstMoveTimer = 0;
@@ -153,10 +231,20 @@ void ticTacToeControl_tick() {
       // Do nothing
       break;
     case computer_turn_st: // set rateTimer to 0
-      // Have the AI make it's move
-      minimax_computeNextMove(&board, !player_first, &row, &column);  // compute move
-      // Update the screen and variables with the AI's move.
-      ticTacToeControl_updateBoard(&board, row, column, !player_first); // record move
+      // Have the AI make it's move from the table if it has the position. Otherwise
+      // start a search, computer_search_st carries it on a slice per tick so that
+      // no tick runs over the timer period.
+      searching = !minimax_lookUpNextMove(&board, !player_first, &row, &column);
+      if (searching) {
+        ticTacToeControl_beginSearch(&board, !player_first);
+      }
+      else {
+        // Update the screen and variables with the AI's move.
+        ticTacToeControl_updateBoard(&board, row, column, !player_first); // record move
+      }
+      break;
+    case computer_search_st:
+      searchDone = ticTacToeControl_continueSearch(&row, &column);
       break;
      default: // Shouldn't hit this state ever.
       printf("ticTacToeControl_tick state action: hit default\n\r");
@@ -184,10 +272,10 @@ void ticTacToeControl_tick() {
       }
       break;
     case first_move_st:  // wait to determine player or AI first
-      // If the display is touched, move on to let ADC settle
+      // If the display is touched, wait for the release
       if (display_isTouched()) {  // player wants to move first
         display_clearOldTouchData();  // clear old data to read current coordinates
-        currentState = ad_timer_running_st;
+        currentState = wait_for_release_st;
         player_first = true;  // player will be playing X
       }
       // Otherwise, if player never touches the screen, have AI go first
@@ -199,15 +287,25 @@ void ticTacToeControl_tick() {
         currentState = first_move_st; // Otherwise keep waiting here
       }
       break;
-    case ad_timer_running_st: // increment adTimer
-      // The display must be let go after ADC settles before action is taken
-      if (!display_isTouched() && adTimer >= TICTACTOECONTROL_ADC_WAIT) {
-        // Get the touched point after waiting
+    case wait_for_release_st:
+      // The display must be let go before action is taken
+      if (!display_isTouched()) {
+        // Ignore a tap too light or short for the touch filter to settle on a point.
+        if (!ticTacToeControl_isTouchStable()) {
+          currentState = player_turn_st;
+          break;
+        }
+        // Get the filtered point of the touch
         ticTacToeDisplay_touchScreenComputeBoardRowColumn(&row, &column);
+        // Only update the board if it was an empty spot, otherwise wait for another touch.
+        if (board.squares[row][column] != MINIMAX_EMPTY_SQUARE) {
+          currentState = player_turn_st;
+          break;
+        }
         // Register the touch and update the board.
         ticTacToeControl_updateBoard(&board, row, column, player_first);
         // If that was the final move, go to gameover.
-        if (minimax_isGameOver(minimax_computeBoardScore(&board, player_first))) {
+        if (minimax_isGameOver(minimax_computeBoardScore(&board))) {
           currentState = game_over_st;
         }
         // Otherwise, let the computer have its turn.
@@ -217,7 +315,7 @@ void ticTacToeControl_tick() {
       }
       // Otherwise, stay in this state
       else {
-        currentState = ad_timer_running_st;
+        currentState = wait_for_release_st;
       }
       break;
     case game_over_st: // wait for user to push BTN 0 to reset
@@ -238,16 +336,15 @@ void ticTacToeControl_tick() {
         ticTacToeDisplay_init();  // Initialize the board
       }
       // Or, the the game is over, go to game_over_st
-      else if (minimax_isGameOver(minimax_computeBoardScore(&board, player_first))) {
+      else if (minimax_isGameOver(minimax_computeBoardScore(&board))) {
         currentState = game_over_st;
       }
       // Otherwise, allow the player to make his/her move.
       else if (display_isTouched()) {
-        ticTacToeDisplay_touchScreenComputeBoardRowColumn(&row, &column);
-        // Only update the board if it was an empty spot
-        if (board.squares[row][column] == MINIMAX_EMPTY_SQUARE) {
-          currentState = ad_timer_running_st; // Let ADC settle then process input
-        }
+        // The samples of the previous touch are still in the controller's FIFO, read
+        // from this touch only (as in first_move_st).
+        display_clearOldTouchData();
+        currentState = wait_for_release_st; // Process the input on release
       }
       else {
         currentState = player_turn_st;  // wait for user to make a move
@@ -255,10 +352,26 @@ void ticTacToeControl_tick() {
       break;
     case computer_turn_st: // set rateTimer to 0
       // Moore action is performed to determine the AI's move, so we can
-      // directly move on to the player's turn. Note that the player_turn_st
+      // directly move on to the player's turn, unless the move has to be
+      // searched for over the next ticks. Note that the player_turn_st
       // takes care of checking whether the AI's move puts the board in a
       // game over state.
-      currentState = player_turn_st;
+      if (searching) {
+        currentState = computer_search_st;
+      }
+      else {
+        currentState = player_turn_st;
+      }
+      break;
+    case computer_search_st:
+      // Once the search is done, update the screen and variables with the AI's move.
+      if (searchDone) {
+        ticTacToeControl_updateBoard(&board, row, column, !player_first); // record move
+        currentState = player_turn_st;
+      }
+      else {
+        currentState = computer_search_st;  // Search some more next tick.
+      }
       break;
      default: // should never hit this case.
       printf("ticTacToeControl_tick state update: hit default\n\r");
@@ -12,8 +12,14 @@
 // Constants that control how long the SM waits in various states.
 #define TICTACTOECONTROL_INSTRUCTIONTIME  20 // # of ticks to show instructions
 #define TICTACTOECONTROL_FIRSTMOVE_WAIT   20 // # of ticks before AI moves.
-#define TICTACTOECONTROL_ADC_WAIT          0 // # of additional ticks to wait
-                                             // for the ADC to settle
+#define TICTACTOECONTROL_SEARCH_SLICE_MS  50 // Longest the AI may search in one
+                                             // tick (the tick period is 200 ms).
+#define TICTACTOECONTROL_SEARCH_TIME_MS 1000 // Longest the AI may search for one
+                                             // move, spread over several ticks.
+
+// Uncomment to have the AI search and the drawing on CPU1 (AMP, see ticTacToeAmp.h).
+// CPU1 must run src/Amp/ampCpu1Main.c.
+// #define TICTACTOECONTROL_USE_AMP
 
 /**
  * Tick function that controls the state machine for TIC-TAC-TOE.
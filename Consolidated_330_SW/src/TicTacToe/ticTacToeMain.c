@@ -42,6 +42,10 @@ void test_Full() {
   interrupts_enableTimerGlobalInts();
   // Initialization of the clock display is not time-dependent, do it outside of the state machine.
   //ticTacToeDisplay_init();
+  // Ticks only queue their drawing, the loop below sends it to the LCD between ticks.
+  display_enableCommandQueue(true);
+  // Touch samples come in through the touch controller's interrupt, idle ticks do no SPI (polled if it is not wired).
+  display_enableTouchInterrupts();
   // Keep track of your personal interrupt count. Want to make sure that you don't miss any interrupts.
   int32_t personalInterruptCount = 0;
   // Start the private ARM timer running.
@@ -77,9 +81,14 @@ void test_Full() {
       intervalTimer_resetAll();
 
       interrupts_isrFlagGlobal = 0;
+    } else {
+      // Draw what the ticks queued while waiting for the next one (also flushes the frame buffer).
+      display_drainQueue(DISPLAY_DRAIN_BUDGET_US);
     }
   }
   interrupts_disableArmInts();
+  display_flush();
+  display_printCommandQueueStats();
   printf("isr invocation count: %ld\n\r", interrupts_isrInvocationCount());
   printf("internal interrupt count: %ld\n\r", personalInterruptCount);
 
@@ -35,6 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "glcdfont.c"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include "arduinoTypes.h"
 #include "xgpio.h"
 
@@ -126,6 +127,7 @@ void Adafruit_GFX::drawCircleHelper( int16_t x0, int16_t y0,
   }
 }
 
+#ifdef ADAFRUIT_GFX_SCANLINE_FILLS
 void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r,
 			      uint16_t color) {
   drawFastVLine(x0, y0-r, 2*r+1, color);
@@ -162,8 +164,83 @@ void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
     }
   }
 }
+#else
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r,
+			      uint16_t color) {
+  fillCircleColumns(x0, x0, y0, r, 3, 0, true, color);
+}
+
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
+    uint8_t cornername, int16_t delta, uint16_t color) {
+  fillCircleColumns(x0, x0, y0, r, cornername, delta, false, color);
+}
+
+// Draws the columns first..last (distance from the center columns) of every selected corner,
+// each covering y0-halfHeight..y0+halfHeight+delta. With center set, the center columns
+// xLeft..xRight are drawn too, in the same rectangle as the corner columns on both sides.
+void Adafruit_GFX::fillColumnRun(int16_t xLeft, int16_t xRight, int16_t y0, uint8_t cornername,
+    int16_t delta, bool center, int16_t first, int16_t last, int16_t halfHeight, uint16_t color) {
+  int16_t h = 2*halfHeight+1+delta;
+  if (center) {
+    int16_t x1 = (cornername & 0x2) ? xLeft-last : xLeft;
+    int16_t x2 = (cornername & 0x1) ? xRight+last : xRight;
+    fillRect(x1, y0-halfHeight, x2-x1+1, h, color);
+    return;
+  }
+  if (cornername & 0x1)
+    fillRect(xRight+first, y0-halfHeight, last-first+1, h, color);
+  if (cornername & 0x2)
+    fillRect(xLeft-last, y0-halfHeight, last-first+1, h, color);
+}
+
+// Same midpoint circle as the scanline version, which draws column x with half height y and
+// column y with half height x on every step. The x columns come out left to right with
+// shrinking heights, so each run of equal heights becomes one rectangle; a y column is done
+// once y moves on, with the height of its last (tallest) step.
+void Adafruit_GFX::fillCircleColumns(int16_t xLeft, int16_t xRight, int16_t y0, int16_t r,
+    uint8_t cornername, int16_t delta, bool center, uint16_t color) {
+  int16_t f     = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x     = 0;
+  int16_t y     = r;
+  int16_t runFirst;  // Columns runFirst..x-1 are all runHeight high, 0 is the center.
+  int16_t runHeight = r;
+
+  if (xLeft > xRight)  // A round rect narrower than 2*r has no center columns.
+    center = false;
+  runFirst = center ? 0 : 1;
+
+  while (x<y) {
+    if (f >= 0) {
+      if (x > 0)
+        fillColumnRun(xLeft, xRight, y0, cornername, delta, false, y, y, x, color);
+      y--;
+      ddF_y += 2;
+      f     += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f     += ddF_x;
+
+    if (y != runHeight) {
+      if (runFirst < x)
+        fillColumnRun(xLeft, xRight, y0, cornername, delta, runFirst == 0, runFirst, x-1,
+          runHeight, color);
+      runFirst = x;
+      runHeight = y;
+    }
+  }
+  if (runFirst <= x)
+    fillColumnRun(xLeft, xRight, y0, cornername, delta, runFirst == 0, runFirst, x, runHeight,
+      color);
+  if (x > 0)
+    fillColumnRun(xLeft, xRight, y0, cornername, delta, false, y, y, x, color);
+}
+#endif
 
 // Bresenham's algorithm - thx wikpedia
+#ifdef ADAFRUIT_GFX_PIXEL_LINES
 void Adafruit_GFX::drawLine(int16_t x0, int16_t y0,
 			    int16_t x1, int16_t y1,
 			    uint16_t color) {
@@ -204,6 +281,85 @@ void Adafruit_GFX::drawLine(int16_t x0, int16_t y0,
     }
   }
 }
+#else
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0,
+			    int16_t x1, int16_t y1,
+			    uint16_t color) {
+  drawThickLine(x0, y0, x1, y1, 1, color);
+}
+#endif
+
+// Same Bresenham steps as the one-pixel drawLine(), but the pixels are not plotted one by one:
+// each run along the major axis that keeps the same minor coordinate is drawn as one fillRect(),
+// thickness pixels across the minor axis. The part before the screen is skipped in one jump and
+// the loop stops once the line has left the screen.
+void Adafruit_GFX::drawThickLine(int16_t x0, int16_t y0,
+				 int16_t x1, int16_t y1,
+				 int16_t thickness, uint16_t color) {
+  if (thickness <= 0)
+    return;
+  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    swap(x0, y0);
+    swap(x1, y1);
+  }
+
+  if (x0 > x1) {
+    swap(x0, x1);
+    swap(y0, y1);
+  }
+
+  int16_t majorLast = (steep ? _height : _width) - 1;
+  int16_t minorLast = (steep ? _width : _height) - 1;
+  if ((x1 < 0) || (x0 > majorLast))
+    return;
+
+  int16_t dx, dy;
+  dx = x1 - x0;
+  dy = abs(y1 - y0);
+
+  int32_t err = dx / 2;
+  int16_t ystep;
+
+  if (y0 < y1) {
+    ystep = 1;
+  } else {
+    ystep = -1;
+  }
+
+  if (x0 < 0) {
+    // After k steps err has dropped by k*dy and has had dx added back just often enough to
+    // stay at or above 0, once for every step of y.
+    int32_t drop = (int32_t) -x0 * dy - err;
+    int32_t ysteps = (drop > 0) ? (drop + dx - 1) / dx : 0;
+    err += ysteps * dx - (int32_t) -x0 * dy;
+    y0 += ystep * ysteps;
+    x0 = 0;
+  }
+  if (x1 > majorLast)
+    x1 = majorLast;
+
+  int16_t before = (thickness - 1) / 2;  // Pixels on the low side of the line.
+  int16_t runStart = x0;
+  for (; x0<=x1; x0++) {
+    err -= dy;
+    if ((err < 0) || (x0 == x1)) {
+      if (steep) {
+        fillRect(y0 - before, runStart, thickness, x0 - runStart + 1, color);
+      } else {
+        fillRect(runStart, y0 - before, x0 - runStart + 1, thickness, color);
+      }
+      runStart = x0 + 1;
+    }
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+      if (((ystep > 0) && (y0 - before > minorLast)) ||
+          ((ystep < 0) && (y0 - before + thickness - 1 < 0)))
+        return;
+    }
+  }
+}
 
 // Draw a rectangle
 void Adafruit_GFX::drawRect(int16_t x, int16_t y,
@@ -218,13 +374,26 @@ void Adafruit_GFX::drawRect(int16_t x, int16_t y,
 void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y,
 				 int16_t h, uint16_t color) {
   // Update in subclasses if desired!
+#ifdef ADAFRUIT_GFX_PIXEL_LINES
   drawLine(x, y, x, y+h-1, color);
+#else
+  // Not through drawLine(), which now draws with fillRect().
+  for (int16_t j=y; j<y+h; j++) {
+    drawPixel(x, j, color);
+  }
+#endif
 }
 
 void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y,
 				 int16_t w, uint16_t color) {
   // Update in subclasses if desired!
+#ifdef ADAFRUIT_GFX_PIXEL_LINES
   drawLine(x, y, x+w-1, y, color);
+#else
+  for (int16_t i=x; i<x+w; i++) {
+    drawPixel(i, y, color);
+  }
+#endif
 }
 
 void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
@@ -255,6 +424,7 @@ void Adafruit_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w,
 }
 
 // Fill a rounded rectangle
+#ifdef ADAFRUIT_GFX_SCANLINE_FILLS
 void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w,
 				 int16_t h, int16_t r, uint16_t color) {
   // smarter version
@@ -264,6 +434,13 @@ void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w,
   fillCircleHelper(x+w-r-1, y+r, r, 1, h-2*r-1, color);
   fillCircleHelper(x+r    , y+r, r, 2, h-2*r-1, color);
 }
+#else
+void Adafruit_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w,
+				 int16_t h, int16_t r, uint16_t color) {
+  // The middle is the tallest run of columns of both corners.
+  fillCircleColumns(x+r, x+w-r-1, y+r, r, 3, h-2*r-1, true, color);
+}
+#endif
 
 // Draw a triangle
 void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0,
@@ -275,11 +452,29 @@ void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0,
 }
 
 // Fill a triangle
+#ifdef ADAFRUIT_GFX_SCANLINE_FILLS
+#define FILL_TRIANGLE_SPAN(a, b, y) drawFastHLine(a, y, b-a+1, color)
+#else
+// Rows runFirst..y-1 all span runA..runB; they become one fillRect() once a row differs.
+#define FILL_TRIANGLE_SPAN(a, b, y) {                               \
+    if (((a) != runA) || ((b) != runB)) {                           \
+      if ((y) > runFirst)                                           \
+        fillRect(runA, runFirst, runB-runA+1, (y)-runFirst, color); \
+      runA = (a);                                                   \
+      runB = (b);                                                   \
+      runFirst = (y);                                               \
+    }                                                               \
+  }
+#endif
+
 void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
 				  int16_t x1, int16_t y1,
 				  int16_t x2, int16_t y2, uint16_t color) {
 
   int16_t a, b, y, last;
+#ifndef ADAFRUIT_GFX_SCANLINE_FILLS
+  int16_t runA = 0, runB = -1, runFirst;  // Nothing yet.
+#endif
 
   // Sort coordinates by Y order (y2 >= y1 >= y0)
   if (y0 > y1) {
@@ -291,6 +486,9 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
   if (y0 > y1) {
     swap(y0, y1); swap(x0, x1);
   }
+#ifndef ADAFRUIT_GFX_SCANLINE_FILLS
+  runFirst = y0;
+#endif
 
   if(y0 == y2) { // Handle awkward all-on-same-line case as its own thing
     a = b = x0;
@@ -331,7 +529,7 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    FILL_TRIANGLE_SPAN(a, b, y);
   }
 
   // For lower part of triangle, find scanline crossings for segments
@@ -348,9 +546,13 @@ void Adafruit_GFX::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    FILL_TRIANGLE_SPAN(a, b, y);
   }
+#ifndef ADAFRUIT_GFX_SCANLINE_FILLS
+  FILL_TRIANGLE_SPAN(0, -1, y);  // Draws the last run.
+#endif
 }
+#undef FILL_TRIANGLE_SPAN
 
 void Adafruit_GFX::drawBitmap(int16_t x, int16_t y,
 			      const uint8_t *bitmap, int16_t w, int16_t h,
@@ -390,6 +592,121 @@ void Adafruit_GFX::write(uint8_t c) {
 #endif
 }
 
+size_t Adafruit_GFX::write(const uint8_t *buffer, size_t size) {
+  adafruitGfx_textLine_t line;
+  size_t position = 0;
+  while (nextTextLine(buffer, size, &position, &cursor_x, &cursor_y, textsize, wrap, &line))
+    drawTextLine(line.x, line.y, buffer + line.start, line.length, textcolor, textbgcolor,
+      textsize);
+  return size;
+}
+
+bool Adafruit_GFX::nextTextLine(const uint8_t *text, size_t size, size_t *position,
+    int16_t *x, int16_t *y, uint8_t textSize, bool textWrap, adafruitGfx_textLine_t *line) {
+  line->length = 0;
+  while (*position < size) {
+    uint8_t c = text[(*position)++];
+    if (c == '\n') {
+      *y += textSize*8;
+      *x  = 0;
+      if (line->length)
+        return true;
+    } else if (c == '\r') {
+      if (line->length)
+        line->length++;
+    } else {
+      if (!line->length) {
+        line->x = *x;
+        line->y = *y;
+        line->start = *position - 1;
+      }
+      line->length++;
+      *x += textSize*6;
+      if (textWrap && (*x > (_width - textSize*6))) {
+        *y += textSize*8;
+        *x = 0;
+        return true;
+      }
+    }
+  }
+  return line->length != 0;
+}
+
+size_t Adafruit_GFX::textLineGlyphs(const uint8_t *text, size_t length) {
+  size_t glyphs = 0;
+  while (length--)
+    if (*text++ != '\r')
+      glyphs++;
+  return glyphs;
+}
+
+void Adafruit_GFX::getTextBounds(const char *str, int16_t x, int16_t y,
+    int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  getTextBounds(str, x, y, textsize, wrap, x1, y1, w, h);
+}
+
+void Adafruit_GFX::getTextBounds(const char *str, int16_t x, int16_t y, uint8_t size, bool wrap,
+    int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  const uint8_t *text = (const uint8_t *) str;
+  adafruitGfx_textLine_t line;
+  size_t position = 0;
+  int16_t minX = x, minY = y, maxX = x - 1, maxY = y - 1;  // Empty.
+  bool empty = true;
+  if (size == 0)
+    size = 1;  // Same as setTextSize().
+  while (nextTextLine(text, strlen(str), &position, &x, &y, size, wrap, &line)) {
+    int16_t right = line.x + size*6*textLineGlyphs(text + line.start, line.length) - 1;
+    int16_t bottom = line.y + size*8 - 1;
+    if (empty || (line.x < minX)) minX = line.x;
+    if (empty || (line.y < minY)) minY = line.y;
+    if (empty || (right > maxX))  maxX = right;
+    if (empty || (bottom > maxY)) maxY = bottom;
+    empty = false;
+  }
+  *x1 = minX;
+  *y1 = minY;
+  *w  = maxX - minX + 1;
+  *h  = maxY - minY + 1;
+}
+
+void Adafruit_GFX::drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length,
+    uint16_t color, uint16_t bg, uint8_t size) {
+  if (bg != color) {
+    for (; length--; text++) {
+      if (*text == '\r')
+        continue;
+      drawChar(x, y, *text, color, bg, size);
+      x += size*6;
+    }
+    return;
+  }
+  // Transparent: only the dots that are set, and each row of dots that touch (also across
+  // neighboring characters) is one fillRect().
+  if ((y >= _height) || (y + 8*size - 1 < 0))
+    return;
+  for (uint8_t j = 0; j < 8; j++) {
+    int16_t runX = 0, runDots = 0, dotX = x;
+    const uint8_t *c = text;
+    for (size_t n = length; n--; c++) {
+      if (*c == '\r')
+        continue;
+      for (uint8_t i = 0; i < 6; i++, dotX += size) {
+        if (glyphColumn(*c, i) & (1 << j)) {
+          if (!runDots++)
+            runX = dotX;
+        } else if (runDots) {
+          fillRect(runX, y + j*size, runDots*size, size, color);
+          runDots = 0;
+        }
+      }
+      if (dotX >= _width)
+        break;
+    }
+    if (runDots)
+      fillRect(runX, y + j*size, runDots*size, size, color);
+  }
+}
+
 // Draw a character
 void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
 			    uint16_t color, uint16_t bg, uint8_t size) {
@@ -401,11 +718,7 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     return;
 
   for (int8_t i=0; i<6; i++ ) {
-    uint8_t line;
-    if (i == 5) 
-      line = 0x0;
-    else 
-      line = pgm_read_byte(font+(c*5)+i);
+    uint8_t line = glyphColumn(c, i);
     for (int8_t j = 0; j<8; j++) {
       if (line & 0x1) {
         if (size == 1) // default size
@@ -425,6 +738,12 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
   }
 }
 
+uint8_t Adafruit_GFX::glyphColumn(unsigned char c, uint8_t i) {
+  if (i == 5)
+    return 0x0;
+  return pgm_read_byte(font+(c*5)+i);
+}
+
 void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
   cursor_x = x;
   cursor_y = y;
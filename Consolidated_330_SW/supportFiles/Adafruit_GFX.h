@@ -15,6 +15,22 @@
 
 #define swap(a, b) { int16_t t = a; a = b; b = t; }
 
+// One run of characters that write() puts side by side on one text line: text[start] up to
+// text[start+length-1], drawn from (x, y). It may contain '\r', which takes no space.
+typedef struct {
+  int16_t x, y;
+  size_t  start, length;
+} adafruitGfx_textLine_t;
+
+// fillCircle(), fillRoundRect() and fillTriangle() normally merge neighboring columns (or rows)
+// of the same length into one fillRect(), so a shape takes far fewer address windows. Define
+// this to get the original one drawFastVLine()/drawFastHLine() per column or row instead.
+//#define ADAFRUIT_GFX_SCANLINE_FILLS
+
+// drawLine() normally draws each straight run of a sloped line with one fillRect(). Define this
+// to get the original one drawPixel() per pixel instead.
+//#define ADAFRUIT_GFX_PIXEL_LINES
+
 class Adafruit_GFX : public Print {
 
  public:
@@ -33,7 +49,9 @@ class Adafruit_GFX : public Print {
     drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color),
     fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color),
     fillScreen(uint16_t color),
-    invertDisplay(bool i);
+    invertDisplay(bool i),
+    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint16_t bg, uint8_t size);
 
   // These exist only with Adafruit_GFX (no subclass overrides)
   void
@@ -43,6 +61,9 @@ class Adafruit_GFX : public Print {
     fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color),
     fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
       int16_t delta, uint16_t color),
+    // A line thickness pixels wide, measured along x for steep lines and along y otherwise.
+    drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+      int16_t thickness, uint16_t color),
     drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
       int16_t x2, int16_t y2, uint16_t color),
     fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
@@ -53,8 +74,6 @@ class Adafruit_GFX : public Print {
       int16_t radius, uint16_t color),
     drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
       int16_t w, int16_t h, uint16_t color),
-    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
-      uint16_t bg, uint8_t size),
     setCursor(int16_t x, int16_t y),
     setTextColor(uint16_t c),
     setTextColor(uint16_t c, uint16_t bg),
@@ -67,6 +86,23 @@ class Adafruit_GFX : public Print {
 #else
   virtual void   write(uint8_t);
 #endif
+  using Print::write;
+  // Prints a whole string. Lays it out the way write(uint8_t) moves the cursor (wrap, '\n',
+  // '\r', text size), then hands each text line to drawTextLine() instead of each character to
+  // drawChar(). The pixels are the same.
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  // Draws a run of characters side by side from (x, y), skipping '\r'. Transparent text
+  // (bg == color) is drawn as horizontal runs of dots; opaque text one drawChar() at a time,
+  // which subclasses may replace with something that streams the whole band.
+  virtual void drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length,
+    uint16_t color, uint16_t bg, uint8_t size);
+  // The box that printing str at (x, y) with the current (or the given) text size and wrap
+  // would draw into. w and h are 0 if it draws no characters.
+  void
+    getTextBounds(const char *str, int16_t x, int16_t y,
+      int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h),
+    getTextBounds(const char *str, int16_t x, int16_t y, uint8_t size, bool wrap,
+      int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
 
   int16_t
     height(void),
@@ -74,7 +110,29 @@ class Adafruit_GFX : public Print {
 
   uint8_t getRotation(void);
 
+  // Column i (0-5) of character c in the built-in font, bit 0 is the top row.
+  // Column 5 is the blank spacing column.
+  static uint8_t glyphColumn(unsigned char c, uint8_t i);
+
  protected:
+  // Moves *x, *y over text from *position the way write(uint8_t) moves the cursor, stopping at
+  // the end of the next text line. Returns false when no characters are left to draw.
+  bool nextTextLine(const uint8_t *text, size_t size, size_t *position, int16_t *x, int16_t *y,
+    uint8_t textSize, bool textWrap, adafruitGfx_textLine_t *line);
+  // Number of characters on a text line that take up space.
+  static size_t textLineGlyphs(const uint8_t *text, size_t length);
+
+#ifndef ADAFRUIT_GFX_SCANLINE_FILLS
+  // Fills the corner columns of fillCircleHelper(), plus the columns xLeft..xRight when center
+  // is set, with runs of equally tall columns merged into one fillRect().
+  void
+    fillCircleColumns(int16_t xLeft, int16_t xRight, int16_t y0, int16_t r,
+      uint8_t cornername, int16_t delta, bool center, uint16_t color),
+    fillColumnRun(int16_t xLeft, int16_t xRight, int16_t y0, uint8_t cornername,
+      int16_t delta, bool center, int16_t first, int16_t last, int16_t halfHeight,
+      uint16_t color);
+#endif
+
   const int16_t
     WIDTH, HEIGHT;   // This is the 'raw' display w/h - never changes
   int16_t
@@ -23,6 +23,7 @@
 #include "Adafruit_STMPE610.h"
 #include "spi.h"
 #include <stdio.h>
+#include <string.h>
 
 uint8_t SPCRbackup;
 uint8_t mySPCR;
@@ -172,34 +173,75 @@ uint16_t Adafruit_STMPE610::getVersion() {
 /*****************************/
 
 void Adafruit_STMPE610::readData(int16_t *x, int16_t *y, uint8_t *z) {
-  uint8_t data[4];
-
-  for (uint8_t i=0; i<4; i++) {
-    data[i] = readRegister8(0xD7); //SPI.transfer(0x00); 0xD7 is non-auto-increment mode.
-   // Serial.print("0x"); Serial.print(data[i], HEX); Serial.print(" / ");
-  }
-  *x = data[0];
-  *x <<= 4;
-  *x |= (data[1] >> 4);
-  *y = data[1] & 0x0F;
-  *y <<= 8;
-  *y |= data[2];
-  *z = data[3];
-
-  if (bufferEmpty())
+  TS_Point point;
+  if (readSamples(&point, 1))
     writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
+  *x = point.x;
+  *y = point.y;
+  *z = point.z;
 }
 
 // BLH: I wrote this and it does not seem to work correctly as of yet. (OK, kind of works now).
 void Adafruit_STMPE610::clearOldTouchData() {
-  int i;
-  int16_t xDummy, yDummy;
-  uint8_t zDummy;
-  int dataSetSize = bufferSize();
+  uint8_t dataSetSize = bufferSize();
 //  printf("buffer size: %d\n\r", dataSetSize);
-  for (i=0; i<dataSetSize; i++) {
-    readData(&xDummy, &yDummy, &zDummy);  // Just ignore the data.
+  if (dataSetSize && readSamples(NULL, dataSetSize))  // Just ignore the data.
+    writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
+}
+
+uint8_t Adafruit_STMPE610::readBurst(TS_Point *points, uint8_t maxPoints) {
+  uint8_t count = bufferSize();
+  if (count > maxPoints)
+    count = maxPoints;
+  if (count && readSamples(points, count))
+    writeRegister8(STMPE_INT_STA, 0xFF); // reset all ints
+  return count;
+}
+
+// The status is acknowledged before the samples are read: whatever happens after that (a release,
+// another sample) raises INT again instead of being acknowledged unseen.
+uint8_t Adafruit_STMPE610::serviceInterrupt(TS_Point *points, uint8_t maxPoints, bool *touched) {
+  uint8_t tx[5] = {0x80 | STMPE_INT_STA, 0x80 | STMPE_TSC_CTRL, 0x80 | STMPE_FIFO_SIZE, 0x00, 0x00}, rx[5];
+  spiBegin();
+  spi_transferBuffer(tx, rx, sizeof(tx));
+  spiEnd();
+  uint8_t status = rx[2], count = rx[4];
+  *touched = rx[3] & 0x80;
+  if (count > maxPoints) {
+    count = maxPoints;  // The rest on the next call; INT stays asserted until the status is cleared.
+    *touched = true;    // The touch is not over until its last sample has been read.
+  } else if (status)
+    writeRegister8(STMPE_INT_STA, status);
+  if (count)
+    readSamples(points, count);
+  return count;
+}
+
+// Buffers for readSamples(): the addresses sent and the answers, for a full FIFO.
+static uint8_t sampleTx[STMPE_FIFO_DEPTH * STMPE_SAMPLE_BYTES + 3];
+static uint8_t sampleRx[STMPE_FIFO_DEPTH * STMPE_SAMPLE_BYTES + 3];
+
+// Reads count samples from the FIFO in a single transaction. The data register is addressed once
+// per byte, and FIFO_STA right after the last one: the controller answers each address two bytes
+// later, so the status comes back in the same transaction. Stores the samples in points (unless
+// it is NULL) and returns true if the FIFO is empty afterwards.
+bool Adafruit_STMPE610::readSamples(TS_Point *points, uint8_t count) {
+  uint16_t bytes = count * STMPE_SAMPLE_BYTES;
+  memset(sampleTx, STMPE_TSC_DATA, bytes);
+  sampleTx[bytes] = 0x80 | STMPE_FIFO_STA;
+  sampleTx[bytes + 1] = sampleTx[bytes + 2] = 0x00;
+  spiBegin();
+  spi_transferBuffer(sampleTx, sampleRx, bytes + 3);
+  spiEnd();
+  if (points) {
+    const uint8_t *data = sampleRx + 2;  // Nothing was addressed yet during the first two bytes.
+    for (uint8_t i = 0; i < count; i++, data += STMPE_SAMPLE_BYTES) {
+      points[i].x = (data[0] << 4) | (data[1] >> 4);
+      points[i].y = ((data[1] & 0x0F) << 8) | data[2];
+      points[i].z = data[3];
+    }
   }
+  return sampleRx[bytes + 2] & STMPE_FIFO_STA_EMPTY;
 }
 
 TS_Point Adafruit_STMPE610::getPoint(void) {
@@ -219,10 +261,8 @@ uint8_t Adafruit_STMPE610::spiIn() {
 //    return d;
 //#elif defined (__arm__)
 //    SPI.setClockDivider(84);
-    spi_setClockDivider(84);
 //    SPI.setDataMode(m_spiMode);
-    spi_setBitOrder(SPI_MSBFIRST);  // wasn't included in the original code. added by BLH.8
-    spi_setTransmissionMode(m_spiMode);
+    // The bit order (MSB first, added by BLH) and the mode are set once per transaction, in spiBegin().
     uint8_t d = spi_transfer(0);
 //    uint8_t d = SPI.transfer(0);
     return d;
@@ -241,18 +281,26 @@ void Adafruit_STMPE610::spiOut(uint8_t x) {
 //    SPCR = SPCRbackup;
 //#elif defined (__arm__)
 //    SPI.setClockDivider(84);
-	spi_setClockDivider(84);
-    spi_setBitOrder(SPI_MSBFIRST);  // wasn't included in the original code. added by BLH.
 //    SPI.setDataMode(m_spiMode);
-	spi_setTransmissionMode(m_spiMode);
 //    SPI.transfer(x);
-	spi_transfer(x);
+	spi_transfer(x);  // See spiIn().
 //#endif
 //  }
 //  else
 //    shiftOut(_MOSI, _CLK, MSBFIRST, x);
 }
 
+// The clock divider is fixed in hardware (see spi_setClockDivider()), so only the bit order and the
+// mode are set, once for the whole transaction rather than before every byte.
+void Adafruit_STMPE610::spiBegin() {
+  spi_beginTransaction(SPI_MSBFIRST, m_spiMode);
+  spi_setTouchScreenControllerSlaveSelect();  // Assert the slave select for the touch-screen controller.
+}
+
+void Adafruit_STMPE610::spiEnd() {
+  spi_clearAllSlaveSelects();
+}
+
 uint8_t Adafruit_STMPE610::readRegister8(uint8_t reg) {
   uint8_t x ;
 //  if (_CS == -1) {
@@ -269,12 +317,12 @@ uint8_t Adafruit_STMPE610::readRegister8(uint8_t reg) {
 //    //Serial.print(": 0x"); Serial.println(x, HEX);
 //  } else {
 //    digitalWrite(_CS, LOW);
-    spi_setTouchScreenControllerSlaveSelect();  // Assert the slave select for the touch-screen controller.
-    spiOut(0x80 | reg);
-    spiOut(0x00);
-    x = spiIn();
+    uint8_t tx[3] = {(uint8_t) (0x80 | reg), 0x00, 0x00}, rx[3];
+    spiBegin();
+    spi_transferBuffer(tx, rx, sizeof(tx));  // Was spiOut(0x80 | reg), spiOut(0x00), spiIn().
+    x = rx[2];
 //    digitalWrite(_CS, HIGH);
-    spi_clearAllSlaveSelects();
+    spiEnd();
 //
 //  }
 
@@ -296,14 +344,14 @@ uint16_t Adafruit_STMPE610::readRegister16(uint8_t reg) {
 //  } if (_CLK == -1) {
 //    // hardware SPI
 //    digitalWrite(_CS, LOW);
-      spi_setTouchScreenControllerSlaveSelect();
+      spiBegin();
       spiOut(0x80 | reg);
       spiOut(0x00);
       x = spiIn();
       x<<=8;
       x |= spiIn();
 //    digitalWrite(_CS, HIGH);
-      spi_clearAllSlaveSelects();
+      spiEnd();
 //  }
 //
 //  //Serial.print("$"); Serial.print(reg, HEX);
@@ -320,11 +368,11 @@ void Adafruit_STMPE610::writeRegister8(uint8_t reg, uint8_t val) {
 //    Wire.endTransmission();
 //  } else {
 //    digitalWrite(_CS, LOW);
-	spi_setTouchScreenControllerSlaveSelect();
-    spiOut(reg);
-    spiOut(val);
+    uint8_t tx[2] = {reg, val};
+    spiBegin();
+    spi_transferBuffer(tx, NULL, sizeof(tx));  // Was spiOut(reg), spiOut(val).
 //    digitalWrite(_CS, HIGH);
-    spi_clearAllSlaveSelects();
+    spiEnd();
 //  }
 }
 
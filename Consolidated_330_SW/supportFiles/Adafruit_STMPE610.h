@@ -53,6 +53,7 @@
 
 #define STMPE_INT_STA 0x0B
 #define STMPE_INT_STA_TOUCHDET 0x01
+#define STMPE_INT_STA_FIFOTH 0x02
 
 #define STMPE_ADC_CTRL1 0x20
 #define STMPE_ADC_CTRL1_12BIT 0x08
@@ -103,6 +104,9 @@
 #define STMPE_TSC_DATA_X 0x4D
 #define STMPE_TSC_DATA_Y 0x4F
 #define STMPE_TSC_FRACTION_Z 0x56
+#define STMPE_TSC_DATA 0xD7  // Read address of the FIFO data (0x57), without auto-increment.
+#define STMPE_FIFO_DEPTH 128 // Samples the FIFO holds.
+#define STMPE_SAMPLE_BYTES 4 // x (12 bits), y (12 bits), z (8 bits).
 
 #define STMPE_GPIO_SET_PIN 0x10
 #define STMPE_GPIO_CLR_PIN 0x11
@@ -138,10 +142,23 @@ class Adafruit_STMPE610{
   uint8_t bufferSize(void);
   TS_Point getPoint(void);
   void clearOldTouchData();  // Removes all current touch data from the FIFO.
+  // Reads up to maxPoints of the queued samples, oldest first, in one SPI transaction.
+  // Returns the number of points stored.
+  uint8_t readBurst(TS_Point *points, uint8_t maxPoints);
+  // For an INT-line ISR: reads the interrupt status, touch state and FIFO size in one transaction,
+  // acknowledges the interrupts it saw and reads up to maxPoints samples like readBurst(). If more
+  // than maxPoints are waiting, the interrupts are left pending, so that the (level-sensitive) INT
+  // line calls the ISR again for the rest once any other interrupt has been served.
+  // Sets touched to the touch state (still true while samples are left). Returns the number of
+  // points stored.
+  uint8_t serviceInterrupt(TS_Point *points, uint8_t maxPoints, bool *touched);
 
  private:
   uint8_t spiIn();
   void spiOut(uint8_t x);
+  void spiBegin();  // Configures the SPI core and selects the controller, once per transaction.
+  void spiEnd();
+  bool readSamples(TS_Point *points, uint8_t count);
 
   int8_t  _CS, _MOSI, _MISO, _CLK;
   uint8_t _i2caddr;
@@ -34,6 +34,8 @@
 
 #include "registers.h"
 #include "lcd.h"
+#include "glyphCache.h"
+#include "lcdDrivers.h"
 
 // Constructor for breakout board (configurable LCD control lines).
 // Can still use this w/shield, but parameters are ignored.
@@ -91,6 +93,8 @@
 
 // Constructor for shield (fixed LCD control lines)
 Adafruit_TFTLCD::Adafruit_TFTLCD(void) : Adafruit_GFX(TFTWIDTH, TFTHEIGHT) {
+  driver    = ID_UNKNOWN;
+  driverOps = &genericDriver;
   LCD_init();
   init();
 }
@@ -256,6 +260,7 @@ void Adafruit_TFTLCD::begin(uint16_t id) {
     uint16_t a, d;
     driver = ID_9341;
 //     CS_ACTIVE;  // BLH: CS is always asserted.
+    lcdDrivers_invalidateWindow();  // The reset clears the window registers.
     writeRegister8(ILI9341_SOFTRESET, 0);
     LCD_delay(50);
     writeRegister8(ILI9341_DISPLAYOFF, 0);
@@ -275,6 +280,7 @@ void Adafruit_TFTLCD::begin(uint16_t id) {
     LCD_delay(150);
     writeRegister8(ILI9341_DISPLAYON, 0);
     LCD_delay(500);
+    selectDriver();
     setAddrWindow(0, 0, TFTWIDTH-1, TFTHEIGHT-1);
 
   } else if(id == 0x7575) {
@@ -334,7 +340,7 @@ void Adafruit_TFTLCD::reset(void) {
 // Sets the LCD address window (and address counter, on 932X).
 // Relevant to rect/screen fills and H/V lines.  Input coordinates are
 // assumed pre-sorted (e.g. x2 >= x1).
-void Adafruit_TFTLCD::setAddrWindow(int x1, int y1, int x2, int y2) {
+void Adafruit_TFTLCD::genericSetAddrWindow(int x1, int y1, int x2, int y2) {
 
 //  CS_ACTIVE;  // BLH: CS is always asserted.
   if(driver == ID_932X) {
@@ -406,6 +412,7 @@ void Adafruit_TFTLCD::setAddrWindow(int x1, int y1, int x2, int y2) {
     t <<= 16;
     t |= y2;
     writeRegister32(ILI9341_PAGEADDRSET, t);
+    lcdDrivers_invalidateWindow();  // Written behind the specialized driver's back.
 
   }
 //  CS_IDLE;  // BLH: CS is always asserted.
@@ -428,10 +435,6 @@ void Adafruit_TFTLCD::setLR(void) {
 // Requires setAddrWindow() has previously been called to set the fill
 // bounds.  'len' is inclusive, MUST be >= 1.
 void Adafruit_TFTLCD::flood(uint16_t color, uint32_t len) {
-  uint16_t blocks;
-  uint8_t  i, hi = color >> 8,
-              lo = color;
-
 //  CS_ACTIVE;
 //  CD_COMMAND;
   LCD_setCommandMode();  // BLH
@@ -444,49 +447,14 @@ void Adafruit_TFTLCD::flood(uint16_t color, uint32_t len) {
     write8(0x22); // Write data to GRAM
   }
 
-  // Write first pixel normally, decrement counter by 1
 //  CD_DATA;
   LCD_setDataMode();  // BLH
-  write8(hi);
-  write8(lo);
-  len--;
-
-  blocks = (uint16_t)(len / 64); // 64 pixels/block
-  if(hi == lo) {
-    // High and low bytes are identical.  Leave prior data
-    // on the port(s) and just toggle the write strobe.
-    while(blocks--) {
-      i = 16; // 64 pixels/block / 4 pixels/pass
-      do {
-//        WR_STROBE; WR_STROBE; WR_STROBE; WR_STROBE; // 2 bytes/pixel
-//        WR_STROBE; WR_STROBE; WR_STROBE; WR_STROBE; // x 4 pixels
-    	  LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine();
-    	  LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine(); LCD_strobeWriteLine();
-      } while(--i);
-    }
-    // Fill any remaining pixels (1 to 64)
-    for(i = (uint8_t)len & 63; i--; ) {
-//      WR_STROBE;
-//      WR_STROBE;
-    	LCD_strobeWriteLine(); LCD_strobeWriteLine();
-    }
-  } else {
-    while(blocks--) {
-      i = 16; // 64 pixels/block / 4 pixels/pass
-      do {
-        write8(hi); write8(lo); write8(hi); write8(lo);
-        write8(hi); write8(lo); write8(hi); write8(lo);
-      } while(--i);
-    }
-    for(i = (uint8_t)len & 63; i--; ) {
-      write8(hi);
-      write8(lo);
-    }
-  }
+  // The bus layer strobes WR without touching the data pins when hi == lo.
+  LCD_writeRepeated(color, len);
 //  CS_IDLE;
 }
 
-void Adafruit_TFTLCD::drawFastHLine(int16_t x, int16_t y, int16_t length,
+void Adafruit_TFTLCD::genericDrawFastHLine(int16_t x, int16_t y, int16_t length,
   uint16_t color)
 {
   int16_t x2;
@@ -511,7 +479,7 @@ void Adafruit_TFTLCD::drawFastHLine(int16_t x, int16_t y, int16_t length,
   else                  setLR();
 }
 
-void Adafruit_TFTLCD::drawFastVLine(int16_t x, int16_t y, int16_t length,
+void Adafruit_TFTLCD::genericDrawFastVLine(int16_t x, int16_t y, int16_t length,
   uint16_t color)
 {
   int16_t y2;
@@ -535,7 +503,7 @@ void Adafruit_TFTLCD::drawFastVLine(int16_t x, int16_t y, int16_t length,
   else                  setLR();
 }
 
-void Adafruit_TFTLCD::fillRect(int16_t x1, int16_t y1, int16_t w, int16_t h,
+void Adafruit_TFTLCD::genericFillRect(int16_t x1, int16_t y1, int16_t w, int16_t h,
   uint16_t fillcolor) {
   int16_t  x2, y2;
 
@@ -566,7 +534,7 @@ void Adafruit_TFTLCD::fillRect(int16_t x1, int16_t y1, int16_t w, int16_t h,
   else                  setLR();
 }
 
-void Adafruit_TFTLCD::fillScreen(uint16_t color) {
+void Adafruit_TFTLCD::genericFillScreen(uint16_t color) {
 
   if(driver == ID_932X) {
 
@@ -600,7 +568,7 @@ void Adafruit_TFTLCD::fillScreen(uint16_t color) {
   flood(color, (long)TFTWIDTH * (long)TFTHEIGHT);
 }
 
-void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
+void Adafruit_TFTLCD::genericDrawPixel(int16_t x, int16_t y, uint16_t color) {
 
   // Clip
   if((x < 0) || (y < 0) || (x >= _width) || (y >= _height)) return;
@@ -676,19 +644,224 @@ void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
     write8(0x2C);
 //    CD_DATA;
     LCD_setDataMode();
-    write8(color >> 8); write8(color);
+    LCD_writeWordStrobe(color);
   }
 
 //  CS_IDLE;
 }
 
+// Draws a character with a single address window and one GRAM write instead of one
+// drawPixel()/fillRect() per font dot. The expanded glyph normally comes from the glyph cache;
+// if the cache cannot hold it, each scanline of the (clipped) glyph is expanded on the fly.
+// Transparent text (bg == color) must leave the pixels between the dots alone, so it still goes
+// through the generic Adafruit_GFX version.
+void Adafruit_TFTLCD::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size) {
+  int16_t  x1, y1, x2, y2, px, py;
+  uint8_t  columns[6];
+  uint16_t row[TFTHEIGHT]; // One glyph scanline, no wider than the screen.
+  const uint16_t *line = row;
+
+  if((bg == color) || (size == 0)) {
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+    return;
+  }
+
+  // The glyph is 6x8 font dots, each size x size pixels. Clip it to the screen.
+  x1 = x;
+  y1 = y;
+  x2 = x + GLYPHCACHE_GLYPH_WIDTH(size) - 1;
+  y2 = y + GLYPHCACHE_GLYPH_HEIGHT(size) - 1;
+  if((x1 >= _width) || (y1 >= _height) || (x2 < 0) || (y2 < 0)) return;
+  if(x1 < 0)        x1 = 0;
+  if(y1 < 0)        y1 = 0;
+  if(x2 >= _width)  x2 = _width  - 1;
+  if(y2 >= _height) y2 = _height - 1;
+
+  const uint16_t *glyph = glyphCache_get(c, color, bg, size);
+  if(!glyph)
+    for(uint8_t i=0; i<6; i++) columns[i] = glyphColumn(c, i);
+
+  setAddrWindow(x1, y1, x2, y2);
+  for(py = y1; py <= y2; py++) {
+    if(glyph) {
+      line = &glyph[(py - y) * GLYPHCACHE_GLYPH_WIDTH(size) + (x1 - x)];
+    } else if((py == y1) || (((py - y) % size) == 0)) {
+      // Only expand a new scanline when moving on to the next font row.
+      uint8_t mask = 1 << ((py - y) / size);
+      for(px = x1; px <= x2; px++)
+        row[px - x1] = (columns[(px - x) / size] & mask) ? color : bg;
+    }
+    pushColors(line, x2 - x1 + 1, py == y1);
+  }
+  driverOps->restoreAddrWindow(this);
+}
+
+void Adafruit_TFTLCD::drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length,
+  uint16_t color, uint16_t bg, uint8_t size) {
+  int16_t  x1, y1, x2, y2, px, py;
+  uint8_t  glyphs[TFTHEIGHT / 6 + 2];  // The characters that show, partly cut off ones too.
+  uint16_t row[TFTHEIGHT];         // One band scanline, no wider than the screen.
+  size_t   count = 0;
+
+  if((bg == color) || (size == 0)) {
+    Adafruit_GFX::drawTextLine(x, y, text, length, color, bg, size);
+    return;
+  }
+
+  // Clip the band to the screen and keep only the characters that show.
+  x1 = x;
+  y1 = y;
+  y2 = y + GLYPHCACHE_GLYPH_HEIGHT(size) - 1;
+  if((y1 >= _height) || (y2 < 0)) return;
+  for(; length--; text++) {
+    if(*text == '\r') continue;
+    if(x1 + GLYPHCACHE_GLYPH_WIDTH(size) > 0) {
+      if(x1 >= _width) break;
+      if(!count) x = x1;  // Left edge of the first character that shows.
+      glyphs[count++] = *text;
+    }
+    x1 += GLYPHCACHE_GLYPH_WIDTH(size);
+  }
+  if(!count) return;
+  x2 = x + count * GLYPHCACHE_GLYPH_WIDTH(size) - 1;
+  x1 = (x < 0) ? 0 : x;
+  if(y1 < 0)        y1 = 0;
+  if(x2 >= _width)  x2 = _width  - 1;
+  if(y2 >= _height) y2 = _height - 1;
+
+  setAddrWindow(x1, y1, x2, y2);
+  for(py = y1; py <= y2; py++) {
+    if((py == y1) || (((py - y) % size) == 0)) {
+      // Only expand a new scanline when moving on to the next font row.
+      uint8_t mask = 1 << ((py - y) / size);
+      for(px = x1; px <= x2; px++) {
+        int16_t dot = (px - x) / size;
+        row[px - x1] = (glyphColumn(glyphs[dot / 6], dot % 6) & mask) ? color : bg;
+      }
+    }
+    pushColors(row, x2 - x1 + 1, py == y1);
+  }
+  driverOps->restoreAddrWindow(this);
+}
+
+void Adafruit_TFTLCD::blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels,
+  blit_format_t format, const uint16_t *palette) {
+  int16_t  x1, y1, x2, y2, py;
+  uint16_t row[TFTHEIGHT]; // One visible scanline, no wider than the screen.
+  blit_source_t source;
+
+  // Same clipping as fillRect().
+  if( (w           <= 0     ) ||  (h            <= 0      ) ||
+      (x           >= _width) ||  (y            >= _height) ||
+     ((x2 = x+w-1) <  0     ) || ((y2  = y+h-1) <  0      )) return;
+  x1 = (x < 0) ? 0 : x;
+  y1 = (y < 0) ? 0 : y;
+  if(x2 >= _width)  x2 = _width  - 1;
+  if(y2 >= _height) y2 = _height - 1;
+
+  blit_begin(&source, pixels, format, palette, w);
+  blit_read(&source, NULL, (uint32_t)(y1 - y) * w);  // Rows above the screen.
+  setAddrWindow(x1, y1, x2, y2);
+  for(py = y1; py <= y2; py++) {
+    blit_read(&source, NULL, x1 - x);
+    blit_read(&source, row, x2 - x1 + 1);
+    blit_read(&source, NULL, x + w - 1 - x2);
+    pushColors(row, x2 - x1 + 1, py == y1);
+  }
+  driverOps->restoreAddrWindow(this);
+}
+
+// Puts the address window back the way the generic drawing calls expect it.
+void Adafruit_TFTLCD::genericRestoreAddrWindow(void) {
+  if(driver == ID_932X) setAddrWindow(0, 0, _width - 1, _height - 1);
+  else                  setLR();
+}
+
+// Called whenever the controller or the rotation changes.
+void Adafruit_TFTLCD::selectDriver(void) {
+#ifndef ADAFRUIT_TFTLCD_GENERIC_DRIVERS
+  if(driver == ID_9341) {
+    driverOps = lcdDrivers_ili9341[rotation & 3];
+    return;
+  }
+#endif
+  driverOps = &genericDriver;
+}
+
+// Adapts the generic member functions to the adafruitTftlcd_driver_t table.
+class GenericLcdDriver {
+ public:
+  static void drawPixel(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, uint16_t color) {
+    lcd->genericDrawPixel(x, y, color);
+  }
+  static void drawFastHLine(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t w, uint16_t color) {
+    lcd->genericDrawFastHLine(x, y, w, color);
+  }
+  static void drawFastVLine(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t h, uint16_t color) {
+    lcd->genericDrawFastVLine(x, y, h, color);
+  }
+  static void fillRect(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    lcd->genericFillRect(x, y, w, h, color);
+  }
+  static void fillScreen(Adafruit_TFTLCD *lcd, uint16_t color) {
+    lcd->genericFillScreen(color);
+  }
+  static void setAddrWindow(Adafruit_TFTLCD *lcd, int x1, int y1, int x2, int y2) {
+    lcd->genericSetAddrWindow(x1, y1, x2, y2);
+  }
+  static void pushColors(Adafruit_TFTLCD *lcd, const uint16_t *data, uint32_t len, bool first) {
+    lcd->genericPushColors(data, len, first);
+  }
+  static void restoreAddrWindow(Adafruit_TFTLCD *lcd) {
+    lcd->genericRestoreAddrWindow();
+  }
+};
+
+const adafruitTftlcd_driver_t Adafruit_TFTLCD::genericDriver = {
+  GenericLcdDriver::drawPixel,
+  GenericLcdDriver::drawFastHLine,
+  GenericLcdDriver::drawFastVLine,
+  GenericLcdDriver::fillRect,
+  GenericLcdDriver::fillScreen,
+  GenericLcdDriver::setAddrWindow,
+  GenericLcdDriver::pushColors,
+  GenericLcdDriver::restoreAddrWindow
+};
+
+// The public primitives go straight to the selected driver.
+void Adafruit_TFTLCD::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  driverOps->drawPixel(this, x, y, color);
+}
+
+void Adafruit_TFTLCD::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  driverOps->drawFastHLine(this, x, y, w, color);
+}
+
+void Adafruit_TFTLCD::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  driverOps->drawFastVLine(this, x, y, h, color);
+}
+
+void Adafruit_TFTLCD::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  driverOps->fillRect(this, x, y, w, h, color);
+}
+
+void Adafruit_TFTLCD::fillScreen(uint16_t color) {
+  driverOps->fillScreen(this, color);
+}
+
+void Adafruit_TFTLCD::setAddrWindow(int x1, int y1, int x2, int y2) {
+  driverOps->setAddrWindow(this, x1, y1, x2, y2);
+}
+
+void Adafruit_TFTLCD::pushColors(const uint16_t *data, uint32_t len, bool first) {
+  driverOps->pushColors(this, data, len, first);
+}
+
 // Issues 'raw' an array of 16-bit color values to the LCD; used
 // externally by BMP examples.  Assumes that setWindowAddr() has
-// previously been set to define the bounds.  Max 255 pixels at
-// a time (BMP examples read in small chunks due to limited RAM).
-void Adafruit_TFTLCD::pushColors(uint16_t *data, uint8_t len, bool first) {
-  uint16_t color;
-  uint8_t  hi, lo;
+// previously been set to define the bounds.
+void Adafruit_TFTLCD::genericPushColors(const uint16_t *data, uint32_t len, bool first) {
 //  CS_ACTIVE;
   if(first == true) { // Issue GRAM write command only on first call
 //    CD_COMMAND;
@@ -702,16 +875,40 @@ void Adafruit_TFTLCD::pushColors(uint16_t *data, uint8_t len, bool first) {
   }
 //  CD_DATA;
   LCD_setDataMode();
-  while(len--) {
-    color = *data++;
-    hi    = color >> 8; // Don't simplify or merge these
-    lo    = color;      // lines, there's macro shenanigans
-    write8(hi);         // going on.
-    write8(lo);
-  }
+  while(len--)
+    LCD_writeWordStrobe(*data++);
 //  CS_IDLE;
 }
 
+void Adafruit_TFTLCD::setScrollArea(uint16_t topFixed, uint16_t bottomFixed) {
+  if(driver != ID_9341) return;
+  uint16_t scrollLines = TFTHEIGHT - topFixed - bottomFixed;
+  LCD_setCommandMode();
+  write8(ILI9341_VERTSCROLLDEF);
+  LCD_setDataMode();
+  write8(topFixed >> 8);
+  write8(topFixed);
+  write8(scrollLines >> 8);
+  write8(scrollLines);
+  write8(bottomFixed >> 8);
+  write8(bottomFixed);
+}
+
+void Adafruit_TFTLCD::scrollTo(uint16_t firstLine) {
+  if(driver != ID_9341) return;
+  LCD_setCommandMode();
+  write8(ILI9341_VERTSCROLLSTART);
+  LCD_setDataMode();
+  write8(firstLine >> 8);
+  write8(firstLine);
+}
+
+void Adafruit_TFTLCD::endScroll(void) {
+  if(driver != ID_9341) return;
+  LCD_setCommandMode();
+  write8(ILI9341_NORMALDISP);
+}
+
 void Adafruit_TFTLCD::setRotation(uint8_t x) {
 
   // Call parent rotation func first -- sets up rotation flags, etc.
@@ -767,6 +964,7 @@ void Adafruit_TFTLCD::setRotation(uint8_t x) {
     break;
   }
    writeRegister8(ILI9341_MADCTL, t ); // MADCTL
+   selectDriver();
    // For 9341, init default full-screen address window:
    setAddrWindow(0, 0, _width - 1, _height - 1); // CS_IDLE happens here
   }
@@ -920,7 +1118,7 @@ uint16_t Adafruit_TFTLCD::color565(uint8_t r, uint8_t g, uint8_t b) {
 #ifndef write8
 void Adafruit_TFTLCD::write8(uint8_t value) {
 //  write8inline(value);
-  LCD_write8(value);
+  LCD_writeByteStrobe(value);
 }
 #endif
 
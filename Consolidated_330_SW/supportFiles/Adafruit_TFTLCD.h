@@ -14,14 +14,36 @@
 #include <stdbool.h>
 #include "arduinoTypes.h"
 #include "Adafruit_GFX.h"
+#include "blit.h"
 
 // **** IF USING THE LCD BREAKOUT BOARD, COMMENT OUT THIS NEXT LINE. ****
 // **** IF USING THE LCD SHIELD, LEAVE THE LINE ENABLED:             ****
 
 //#define USE_ADAFRUIT_SHIELD_PINOUT 1
 
+// Uncomment to always use the generic drawing code, which tests the controller type and rotation
+// on every call. Otherwise the ILI9341 uses the compile-time specialized drivers in lcdDrivers.h.
+//#define ADAFRUIT_TFTLCD_GENERIC_DRIVERS
+
+class Adafruit_TFTLCD;
+
+// The primitives that depend on the controller and rotation. begin() and setRotation() point
+// Adafruit_TFTLCD at one of these tables.
+typedef struct {
+  void (*drawPixel)(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, uint16_t color);
+  void (*drawFastHLine)(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t w, uint16_t color);
+  void (*drawFastVLine)(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t h, uint16_t color);
+  void (*fillRect)(Adafruit_TFTLCD *lcd, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void (*fillScreen)(Adafruit_TFTLCD *lcd, uint16_t color);
+  void (*setAddrWindow)(Adafruit_TFTLCD *lcd, int x1, int y1, int x2, int y2);
+  void (*pushColors)(Adafruit_TFTLCD *lcd, const uint16_t *data, uint32_t len, bool first);
+  void (*restoreAddrWindow)(Adafruit_TFTLCD *lcd);  // After a drawing call that moved the window.
+} adafruitTftlcd_driver_t;
+
 class Adafruit_TFTLCD : public Adafruit_GFX {
 
+  friend class GenericLcdDriver;
+
  public:
 
   Adafruit_TFTLCD(uint8_t cs, uint8_t cd, uint8_t wr, uint8_t rd, uint8_t rst);
@@ -34,13 +56,28 @@ class Adafruit_TFTLCD : public Adafruit_GFX {
   void     drawFastVLine(int16_t x0, int16_t y0, int16_t h, uint16_t color);
   void     fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c);
   void     fillScreen(uint16_t color);
+  void     drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                    uint16_t bg, uint8_t size);
+  // Opaque text lines go through one address window for the whole band.
+  void     drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length,
+                        uint16_t color, uint16_t bg, uint8_t size);
   void     reset(void);
   void     setRegisters8(uint8_t *ptr, uint8_t n);
   void     setRegisters16(uint16_t *ptr, uint8_t n);
   void     setRotation(uint8_t x);
+  // ILI9341 hardware vertical scrolling, along the 320 panel lines (screen rows in rotations 0
+  // and 2, columns in 1 and 3). The lines between the fixed areas are shown starting from GRAM
+  // line firstLine, wrapping around; endScroll() goes back to normal display mode. These do
+  // nothing on the other controllers.
+  void     setScrollArea(uint16_t topFixed, uint16_t bottomFixed);
+  void     scrollTo(uint16_t firstLine);
+  void     endScroll(void);
        // These methods are public in order for BMP examples to work:
   void     setAddrWindow(int x1, int y1, int x2, int y2);
-  void     pushColors(uint16_t *data, uint8_t len, bool first);
+  void     pushColors(const uint16_t *data, uint32_t len, bool first);
+  // Streams a w x h image (see blit.h for the formats) through one address window.
+  void     blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels,
+                blit_format_t format, const uint16_t *palette);
 
   uint16_t color565(uint8_t r, uint8_t g, uint8_t b),
            readPixel(int16_t x, int16_t y),
@@ -72,8 +109,20 @@ class Adafruit_TFTLCD : public Adafruit_GFX {
            writeRegisterPair(uint8_t aH, uint8_t aL, uint16_t d),
 #endif
            setLR(void),
-           flood(uint16_t color, uint32_t len);
+           flood(uint16_t color, uint32_t len),
+           selectDriver(void),
+           // The generic versions of the primitives in adafruitTftlcd_driver_t.
+           genericDrawPixel(int16_t x, int16_t y, uint16_t color),
+           genericDrawFastHLine(int16_t x0, int16_t y0, int16_t w, uint16_t color),
+           genericDrawFastVLine(int16_t x0, int16_t y0, int16_t h, uint16_t color),
+           genericFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c),
+           genericFillScreen(uint16_t color),
+           genericSetAddrWindow(int x1, int y1, int x2, int y2),
+           genericPushColors(const uint16_t *data, uint32_t len, bool first),
+           genericRestoreAddrWindow(void);
   uint8_t  driver;
+  const adafruitTftlcd_driver_t *driverOps;  // Selected by selectDriver().
+  static const adafruitTftlcd_driver_t genericDriver;
 
 #ifndef read8
   uint8_t  read8fn(void);
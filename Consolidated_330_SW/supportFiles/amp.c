@@ -0,0 +1,70 @@
+/*
+ * amp.c
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "amp.h"
+#include "hal.h"
+
+static_assert(sizeof(amp_shared_t) <= HAL_AMP_SHARED_MEMORY_BYTES, "the AMP rings do not fit in the shared memory");
+
+// Each CPU keeps its own pointer (on the host the two are threads of one program).
+static amp_shared_t *amp_shared = NULL;      // CPU0.
+static amp_shared_t *amp_cpu1Shared = NULL;  // CPU1.
+
+// Builds a message. Returns false if the payload does not fit in a slot.
+static bool amp_makeMessage(ampRing_message_t *message, uint32_t type, const void *payload, uint32_t payloadBytes) {
+  if (payloadBytes > AMPRING_PAYLOAD_BYTES)
+    return false;
+  message->type = type;
+  if (payloadBytes)
+    memcpy(message->payload, payload, payloadBytes);
+  return true;
+}
+
+// ********************************** CPU0 **********************************
+
+void amp_init(void (*cpu1Main)()) {
+  amp_shared = (amp_shared_t *) hal_ampSharedMemory();
+  ampRing_init(&amp_shared->toCpu1);
+  ampRing_init(&amp_shared->toCpu0);
+  hal_ampStartCpu1(cpu1Main);
+}
+
+bool amp_send(uint32_t type, const void *payload, uint32_t payloadBytes) {
+  ampRing_message_t message;
+  return amp_makeMessage(&message, type, payload, payloadBytes) && ampRing_push(&amp_shared->toCpu1, &message);
+}
+
+bool amp_receive(ampRing_message_t *message) {
+  return ampRing_pop(&amp_shared->toCpu0, message);
+}
+
+// ********************************** CPU1 **********************************
+
+void amp_cpu1Run(amp_handler_t handler) {
+  // CPU0 has set up the rings before starting this CPU.
+  amp_cpu1Shared = (amp_shared_t *) hal_ampSharedMemory();
+  ampRing_message_t message;
+  while (true) {
+    if (!ampRing_pop(&amp_cpu1Shared->toCpu1, &message)) {
+      hal_ampIdle();  // Nothing else to do on this CPU.
+      continue;
+    }
+    if (message.type == AMP_MESSAGE_STOP) {
+      amp_cpu1Reply(AMP_MESSAGE_STOPPED, NULL, 0);
+      return;
+    }
+    handler(&message);
+  }
+}
+
+bool amp_cpu1Reply(uint32_t type, const void *payload, uint32_t payloadBytes) {
+  ampRing_message_t message;
+  if (!amp_makeMessage(&message, type, payload, payloadBytes))
+    return false;
+  while (!ampRing_push(&amp_cpu1Shared->toCpu0, &message))
+    hal_ampIdle();  // CPU0 takes results once per tick, wait for it.
+  return true;
+}
@@ -0,0 +1,62 @@
+/*
+ * amp.h
+ */
+
+#ifndef AMP_H_
+#define AMP_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+#include "ampRing.h"
+
+// AMP (asymmetric multiprocessing) on the two Cortex-A9s. CPU0 runs the usual application: the
+// ISRs and the state machines. CPU1 runs its own program (src/Amp/ampCpu1Main.c) that draws on
+// the LCD for CPU0 (see display_enableAmpRendering() in display.h) and runs its AI searches, one
+// message at a time, so drawing waits while CPU1 searches. The two only talk through two ampRing_t
+// in memory that both CPUs see uncached (hal_ampSharedMemory()): CPU0 sends requests to CPU1 on
+// one, CPU1 sends results back on the other. On the host, CPU1 is a thread (see halSim.c).
+//
+// CPU1 needs its own SDK application on a ps7_cortexa9_1 BSP built with -DUSE_AMP=1, linked
+// to run from AMP_CPU1_START_ADDRESS. CPU0's program stays below that address (src/lscript.ld).
+
+#define AMP_CPU1_START_ADDRESS 0x10000000
+
+// Message types. Types from AMP_MESSAGE_USER on belong to the applications (e.g., the TicTacToe
+// search request in ticTacToeAmp.h).
+enum {
+  AMP_MESSAGE_STOP,             // CPU0 -> CPU1: return from amp_cpu1Run() (host tests only).
+  AMP_MESSAGE_STOPPED,          // CPU1 -> CPU0: amp_cpu1Run() has seen AMP_MESSAGE_STOP.
+  AMP_MESSAGE_DISPLAY_COMMAND,  // CPU0 -> CPU1: a displayQueue_command_t, for display_runAmpCommand().
+  AMP_MESSAGE_USER = 0x100
+};
+
+// Layout of the shared memory.
+typedef struct {
+  ampRing_t toCpu1;  // CPU0 produces, CPU1 consumes.
+  ampRing_t toCpu0;  // CPU1 produces, CPU0 consumes.
+} amp_shared_t;
+
+// ********************************** CPU0 **********************************
+// Empties both rings and starts CPU1 (on the board, its program must already be loaded at
+// AMP_CPU1_START_ADDRESS; on the host, cpu1Main runs as a thread).
+void amp_init(void (*cpu1Main)());
+
+// Sends a message to CPU1. Returns false (nothing is sent) if the ring is full or the payload is
+// longer than AMPRING_PAYLOAD_BYTES.
+bool amp_send(uint32_t type, const void *payload, uint32_t payloadBytes);
+
+// Takes the oldest message CPU1 has sent back. Returns false if there is none.
+bool amp_receive(ampRing_message_t *message);
+
+// ********************************** CPU1 **********************************
+// Called for every message CPU1 takes from its ring.
+typedef void (*amp_handler_t)(const ampRing_message_t *message);
+
+// Takes messages from CPU0 and hands each to handler, forever (until AMP_MESSAGE_STOP).
+void amp_cpu1Run(amp_handler_t handler);
+
+// Sends a message back to CPU0, waiting for room if its ring is full. Returns false (nothing is
+// sent) if the payload is longer than AMPRING_PAYLOAD_BYTES.
+bool amp_cpu1Reply(uint32_t type, const void *payload, uint32_t payloadBytes);
+
+#endif /* AMP_H_ */
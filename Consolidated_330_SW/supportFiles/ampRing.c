@@ -0,0 +1,38 @@
+/*
+ * ampRing.c
+ */
+
+#include <string.h>
+#include "ampRing.h"
+
+// The __atomic builtins give the barriers the ARM needs (dmb) and tell ThreadSanitizer about
+// the ordering on the host. Each index is stored by one side only, so that side can read its
+// own index without ordering.
+#define ampRing_loadAcquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ampRing_storeRelease(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+void ampRing_init(ampRing_t *ring) {
+  memset(ring, 0, sizeof(*ring));
+}
+
+bool ampRing_push(ampRing_t *ring, const ampRing_message_t *message) {
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  if (head - ampRing_loadAcquire(&ring->tail) >= AMPRING_SLOTS)
+    return false;  // Full.
+  memcpy(&ring->slots[head & (AMPRING_SLOTS - 1)], message, sizeof(*message));
+  ampRing_storeRelease(&ring->head, head + 1);
+  return true;
+}
+
+bool ampRing_pop(ampRing_t *ring, ampRing_message_t *message) {
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  if (ampRing_loadAcquire(&ring->head) == tail)
+    return false;  // Empty.
+  memcpy(message, &ring->slots[tail & (AMPRING_SLOTS - 1)], sizeof(*message));
+  ampRing_storeRelease(&ring->tail, tail + 1);
+  return true;
+}
+
+uint32_t ampRing_count(ampRing_t *ring) {
+  return ampRing_loadAcquire(&ring->head) - ampRing_loadAcquire(&ring->tail);
+}
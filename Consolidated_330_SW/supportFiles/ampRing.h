@@ -0,0 +1,49 @@
+/*
+ * ampRing.h
+ */
+
+#ifndef AMPRING_H_
+#define AMPRING_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// Lock-free single-producer/single-consumer ring of fixed-size messages. One side only ever
+// pushes and the other only ever pops, so no lock is needed: the producer alone writes head,
+// the consumer alone writes tail. A message is copied into its slot before head is published
+// (release), and the consumer reads head (acquire) before it reads the slot. The same holds
+// for tail in the other direction, so a slot is never reused while it is being read.
+// The ring works between the two Cortex-A9s (in memory both see uncached, see amp.h) as well
+// as between two threads on a host, or between an ISR and the main loop (the touch events in
+// display.cpp).
+
+#define AMPRING_SLOTS 32            // Must be a power of 2.
+#define AMPRING_PAYLOAD_BYTES 36    // Enough for a 32-square board and a few more bytes.
+#define AMPRING_CACHE_LINE_BYTES 32 // Cortex-A9 L1 line; head and tail each get their own.
+
+typedef struct {
+  uint32_t type;                            // What the payload holds (see amp.h).
+  uint8_t payload[AMPRING_PAYLOAD_BYTES];
+} ampRing_message_t;
+
+typedef struct {
+  uint32_t head;  // Messages pushed so far (wraps). Only the producer writes it.
+  uint8_t headPadding[AMPRING_CACHE_LINE_BYTES - sizeof(uint32_t)];
+  uint32_t tail;  // Messages popped so far (wraps). Only the consumer writes it.
+  uint8_t tailPadding[AMPRING_CACHE_LINE_BYTES - sizeof(uint32_t)];
+  ampRing_message_t slots[AMPRING_SLOTS];
+} ampRing_t;
+
+// Empties the ring. Only call it while neither side is using the ring.
+void ampRing_init(ampRing_t *ring);
+
+// Producer side. Copies message into the ring. Returns false (and drops nothing) if the ring is full.
+bool ampRing_push(ampRing_t *ring, const ampRing_message_t *message);
+
+// Consumer side. Copies the oldest message out of the ring. Returns false if the ring is empty.
+bool ampRing_pop(ampRing_t *ring, ampRing_message_t *message);
+
+// Number of messages waiting. Exact only on the consumer side (the producer may add more meanwhile).
+uint32_t ampRing_count(ampRing_t *ring);
+
+#endif /* AMPRING_H_ */
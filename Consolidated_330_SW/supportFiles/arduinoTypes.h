@@ -12,6 +12,10 @@
 
 #include "xil_types.h"
 
+#ifdef HOST_BUILD
+// Host (Linux) builds: xil_types.h makes s32/u32 a 64-bit long there, so take the standard types instead.
+#include <stdint.h>
+#else
 typedef s32 int32_t;
 typedef u32 uint32_t;
 typedef s16 int16_t;
@@ -19,6 +23,7 @@ typedef u16 uint16_t;
 typedef u8 uint8_t;
 //typedef s8 int8_t;
 typedef signed char int8_t;  // Should be compatible with Xilinx and avoids conflict in stdint.h
+#endif
 #define pgm_read_byte(addr) (*(const unsigned char *)(addr))
 
 #endif /* ARDUINOTYPES_H_ */
@@ -0,0 +1,72 @@
+/*
+ * blit.cpp
+ */
+
+#include "blit.h"
+
+void blit_begin(blit_source_t *source, const void *pixels, blit_format_t format,
+  const uint16_t *palette, int16_t width) {
+  source->format = format;
+  source->bytes = (const uint8_t *) pixels;
+  source->words = (const uint16_t *) pixels;
+  source->palette = palette;
+  source->width = width;
+  source->column = 0;
+  source->bitOffset = 0;
+  source->runLength = 0;
+  source->runColor = 0;
+  switch (format) {
+  case BLIT_FORMAT_MASK1:  source->bitsPerPixel = 1; break;
+  case BLIT_FORMAT_INDEX4: source->bitsPerPixel = 4; break;
+  default:                 source->bitsPerPixel = 8; break;
+  }
+}
+
+// MASK1, INDEX4 and INDEX8 only differ in the number of bits per palette index.
+static void blit_readIndexed(blit_source_t *source, uint16_t *out, uint32_t count) {
+  uint8_t bits = source->bitsPerPixel;
+  uint8_t mask = (1 << bits) - 1;
+  for (uint32_t i = 0; i < count; i++) {
+    if (out)
+      out[i] = source->palette[(*source->bytes >> (8 - bits - source->bitOffset)) & mask];
+    source->bitOffset += bits;
+    if (++source->column == source->width) {
+      source->column = 0;
+      if (source->bitOffset)
+        source->bitOffset = 8;  // Rows start on a byte boundary.
+    }
+    if (source->bitOffset == 8) {
+      source->bytes++;
+      source->bitOffset = 0;
+    }
+  }
+}
+
+static void blit_readRle(blit_source_t *source, uint16_t *out, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    while (!source->runLength) {
+      source->runLength = *source->words++;
+      source->runColor = *source->words++;
+    }
+    if (out)
+      out[i] = source->runColor;
+    source->runLength--;
+  }
+}
+
+void blit_read(blit_source_t *source, uint16_t *out, uint32_t count) {
+  switch (source->format) {
+  case BLIT_FORMAT_RGB565:
+    if (out)
+      for (uint32_t i = 0; i < count; i++)
+        out[i] = source->words[i];
+    source->words += count;
+    break;
+  case BLIT_FORMAT_RLE565:
+    blit_readRle(source, out, count);
+    break;
+  default:
+    blit_readIndexed(source, out, count);
+    break;
+  }
+}
@@ -0,0 +1,43 @@
+/*
+ * blit.h
+ */
+
+#ifndef BLIT_H_
+#define BLIT_H_
+
+#include "arduinoTypes.h"
+
+// Source formats for display_blit(). Every format is converted to RGB565 as it is streamed to the
+// LCD (or the frame buffer), so an image can be stored in whichever format is smallest for it.
+// Images are stored row by row, top to bottom.
+typedef enum {
+  BLIT_FORMAT_RGB565,  // One uint16_t per pixel.
+  BLIT_FORMAT_MASK1,   // 1 bit per pixel, MSB first, rows padded to a byte. palette[0] = bg, palette[1] = fg.
+  BLIT_FORMAT_INDEX4,  // 4 bits per pixel, high nibble first, rows padded to a byte. 16-entry palette.
+  BLIT_FORMAT_INDEX8,  // 1 byte per pixel. 256-entry palette (or as many as the image uses).
+  BLIT_FORMAT_RLE565   // uint16_t pairs: run length, RGB565 color. Runs may continue on the next row.
+} blit_format_t;
+
+// Where a conversion is in the source image.
+typedef struct {
+  blit_format_t   format;
+  const uint8_t  *bytes;      // MASK1, INDEX4, INDEX8.
+  const uint16_t *words;      // RGB565, RLE565.
+  const uint16_t *palette;
+  int16_t         width;
+  int16_t         column;     // Column of the next pixel.
+  uint8_t         bitsPerPixel;
+  uint8_t         bitOffset;  // Bits of *bytes already used.
+  uint16_t        runLength;  // RLE565: pixels left in the current run.
+  uint16_t        runColor;
+} blit_source_t;
+
+// Starts reading pixels at the top-left corner of an image that is width pixels wide.
+void blit_begin(blit_source_t *source, const void *pixels, blit_format_t format,
+  const uint16_t *palette, int16_t width);
+
+// Converts the next count pixels to RGB565 into out, continuing on the next row at the end of a
+// row. With out == NULL the pixels are skipped (used for clipping).
+void blit_read(blit_source_t *source, uint16_t *out, uint32_t count);
+
+#endif /* BLIT_H_ */
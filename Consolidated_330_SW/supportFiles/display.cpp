@@ -8,7 +8,24 @@
 #include "display.h"
 #include "Adafruit_TFTLCD.h"
 #include "Adafruit_STMPE610.h"
+#include "frameBuffer.h"
+#include "displayQueue.h"
+#include "lcd.h"
+#include "globalTimer.h"
+#include "amp.h"
+#include "hal.h"
+#include "touchFilter.h"
+#include "utils.h"
+#include <string.h>
 #include <stdbool.h>
+#include <stdio.h>
+
+// ****************** These #defines enable/disable certain functionality ********************************
+
+//#define DISPLAY_ENABLE_FRAME_BUFFER  // Uncomment to draw into RAM; the app must then call display_flush().
+//#define DISPLAY_ENABLE_COMMAND_QUEUE  // Uncomment to queue drawing; the app must then call display_drainQueue().
+
+// ****************** end of #define enable/disable section **********************************************
 
 // Just define these values here. They won't change in practice and I want to avoid
 // too much tangling between the LCD control code and the touch-controller code.
@@ -24,107 +41,338 @@
 #define TOUCH_SCREEN_MAX_X 3950.0  // This is where the touch-screen maxes out in X.
 #define TOUCH_SCREEN_MAX_Y 4095.0
 
-bool initFlag = false;  // Only allow init to be called once.
-static Adafruit_TFTLCD lcdDisplay = Adafruit_TFTLCD();  // Handle to the LCD display.
+// Only allow init to be called once: the apps call display_init() from each of their inits, and
+// display_enableTouchInterrupts() calls it too. A second touchController.begin() would turn the
+// touch interrupts off again and reset the calibration.
+static bool initFlag = false;
+static touchCalibration_t touchCalibration;  // Raw touch-controller coordinates to LCD (rotation 1), set by display_init().
+static touchFilter_t touchFilter;            // Between the FIFO and display_getTouchedPoint(), set up by display_init().
+#ifdef DISPLAY_ENABLE_FRAME_BUFFER
+static frameBuffer_pixel_t frameBufferPixels[FRAMEBUFFER_STORAGE_SIZE];  // Only reserved when buffering is compiled in.
+static FrameBuffer lcdDisplay(frameBufferPixels);  // Handle to the LCD display.
+#else
+static FrameBuffer lcdDisplay;  // Handle to the LCD display (draws straight through, buffering is compiled out).
+#endif
 static Adafruit_STMPE610 touchController = Adafruit_STMPE610();
+#ifdef DISPLAY_ENABLE_COMMAND_QUEUE
+static bool commandQueueEnabled = true;
+#else
+static bool commandQueueEnabled = false;  // Drawing goes to lcdDisplay right away.
+#endif
+// A queued fill of more pixels than this that goes straight to the LCD is drawn a band of rows at a
+// time, so that display_drainQueue() can stop between bands (a full-screen fill takes about 30 ms).
+#define DISPLAY_DRAIN_BAND_PIXELS 2560
+static struct {
+  int16_t x, y, w, h;  // What is left of the fill being drawn in bands (none while h is 0).
+  uint16_t color;
+} drainFill;
+// The text size and wrap as of the last call, which queued commands may not have set yet.
+static uint8_t textSize = 1;
+static bool textWrap = true;
+// With AMP rendering, CPU1 alone drives the LCD and CPU0's lcdDisplay only keeps the rotation (for
+// display_width(), display_height(), display_measureText() and the touch mapping).
+static bool ampRendering = false;
+// A command display_drainQueue() took from the queue but could not send yet, CPU1's ring was full.
+static bool ampUnsent = false;
+static displayQueue_command_t ampUnsentCommand;
+static_assert(sizeof(displayQueue_command_t) <= AMPRING_PAYLOAD_BYTES, "a display command does not fit in an AMP message");
+// CPU1's handle to the LCD with AMP rendering (CPU1 has no frame buffer). CPU0 never uses it.
+static FrameBuffer cpu1Lcd;
+static bool cpu1LcdInitialized = false;
 
 // Will only execute the body once.
 void display_init() {
   if (!initFlag) {
-    lcdDisplay.begin();
-    lcdDisplay.setRotation(1);
+    if (ampRendering) {
+      display_setRotation(1);  // CPU1 has set up the LCD.
+    } else {
+      lcdDisplay.begin();
+      lcdDisplay.setRotation(1);
+    }
     touchController.begin();
+    touchCalibration_default(&touchCalibration);
+    touchFilter_init(&touchFilter, TOUCHFILTER_DEFAULT_MIN_Z);
+#ifdef DISPLAY_ENABLE_FRAME_BUFFER
+    lcdDisplay.enable(true);
+#endif
+    initFlag = true;
+  }
+}
+
+// Queues a command with up to DISPLAYQUEUE_MAX_ARGS arguments (see displayQueue.h for the order).
+static void display_queue(uint8_t op, int16_t a0 = 0, int16_t a1 = 0, int16_t a2 = 0, int16_t a3 = 0,
+    int16_t a4 = 0, int16_t a5 = 0, int16_t a6 = 0) {
+  displayQueue_command_t command;
+  command.op = op;
+  command.length = 0;
+  command.args[0] = a0;
+  command.args[1] = a1;
+  command.args[2] = a2;
+  command.args[3] = a3;
+  command.args[4] = a4;
+  command.args[5] = a5;
+  command.args[6] = a6;
+  displayQueue_push(&command);
+}
+
+// Runs a queued command on lcd (lcdDisplay, or cpu1Lcd on CPU1).
+static void display_runCommand(FrameBuffer &lcd, const displayQueue_command_t *command) {
+  const int16_t *a = command->args;
+  switch (command->op) {
+  case DISPLAYQUEUE_DRAW_LINE:       lcd.drawLine(a[0], a[1], a[2], a[3], a[4]); break;
+  case DISPLAYQUEUE_DRAW_THICK_LINE: lcd.drawThickLine(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+  case DISPLAYQUEUE_DRAW_FAST_VLINE: lcd.drawFastVLine(a[0], a[1], a[2], a[3]); break;
+  case DISPLAYQUEUE_DRAW_FAST_HLINE: lcd.drawFastHLine(a[0], a[1], a[2], a[3]); break;
+  case DISPLAYQUEUE_DRAW_RECT:       lcd.drawRect(a[0], a[1], a[2], a[3], a[4]); break;
+  case DISPLAYQUEUE_FILL_RECT:       lcd.fillRect(a[0], a[1], a[2], a[3], a[4]); break;
+  case DISPLAYQUEUE_FILL_SCREEN:     lcd.fillScreen(a[0]); break;
+  case DISPLAYQUEUE_DRAW_CIRCLE:     lcd.drawCircle(a[0], a[1], a[2], a[3]); break;
+  case DISPLAYQUEUE_FILL_CIRCLE:     lcd.fillCircle(a[0], a[1], a[2], a[3]); break;
+  case DISPLAYQUEUE_DRAW_TRIANGLE:   lcd.drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); break;
+  case DISPLAYQUEUE_FILL_TRIANGLE:   lcd.fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); break;
+  case DISPLAYQUEUE_DRAW_ROUND_RECT: lcd.drawRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+  case DISPLAYQUEUE_FILL_ROUND_RECT: lcd.fillRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+  case DISPLAYQUEUE_DRAW_CHAR:       lcd.drawChar(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+  case DISPLAYQUEUE_SET_CURSOR:      lcd.setCursor(a[0], a[1]); break;
+  case DISPLAYQUEUE_SET_TEXT_COLOR:  lcd.setTextColor(a[0], a[1]); break;
+  case DISPLAYQUEUE_SET_TEXT_SIZE:   lcd.setTextSize(a[0]); break;
+  case DISPLAYQUEUE_SET_TEXT_WRAP:   lcd.setTextWrap(a[0]); break;
+  case DISPLAYQUEUE_INVERT_DISPLAY:  lcd.invertDisplay(a[0]); break;
+  case DISPLAYQUEUE_SET_ROTATION:    lcd.setRotation(a[0]); break;
+  case DISPLAYQUEUE_DRAW_BITMAP:
+    lcd.drawBitmap(command->bitmap.x, command->bitmap.y, command->bitmap.pixels,
+      command->bitmap.w, command->bitmap.h, command->bitmap.color);
+    break;
+  case DISPLAYQUEUE_BLIT:
+    lcd.blit(command->blit.x, command->blit.y, command->blit.w, command->blit.h,
+      command->blit.pixels, (blit_format_t) command->length, command->blit.palette);
+    break;
+  case DISPLAYQUEUE_PRINT:
+    lcd.write((const uint8_t *) command->text, command->length);
+    break;
   }
 }
 
+// Formats print output with the same Print code the LCD uses and queues the characters as
+// DISPLAYQUEUE_PRINT commands, so the queued text is exactly what would have been drawn.
+class QueuedText : public Print {
+ public:
+  QueuedText() {
+    command.op = DISPLAYQUEUE_PRINT;
+    command.length = 0;
+  }
+  size_t write(uint8_t c) {
+    command.text[command.length++] = c;
+    if (command.length == DISPLAYQUEUE_TEXT_BYTES)
+      send();
+    return 1;
+  }
+  // Queues whatever is left over.
+  void send() {
+    if (command.length)
+      displayQueue_push(&command);
+    command.length = 0;
+  }
+ private:
+  displayQueue_command_t command;
+};
+
 // These are functions related to display. Functionality comes from Adafruit_GFX.
 void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
-  lcdDisplay.drawLine(x0, y0, x1, y1, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_LINE, x0, y0, x1, y1, color);
+  else
+    lcdDisplay.drawLine(x0, y0, x1, y1, color);
+}
+
+void display_drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t thickness,
+  uint16_t color) {
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_THICK_LINE, x0, y0, x1, y1, thickness, color);
+  else
+    lcdDisplay.drawThickLine(x0, y0, x1, y1, thickness, color);
 }
 
 void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-  lcdDisplay.drawFastVLine(x, y, h, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_FAST_VLINE, x, y, h, color);
+  else
+    lcdDisplay.drawFastVLine(x, y, h, color);
 }
 
 void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-  lcdDisplay.drawFastHLine(x, y, w, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_FAST_HLINE, x, y, w, color);
+  else
+    lcdDisplay.drawFastHLine(x, y, w, color);
 }
 
 void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-  lcdDisplay.drawRect(x, y, w, h, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_RECT, x, y, w, h, color);
+  else
+    lcdDisplay.drawRect(x, y, w, h, color);
 }
 
 void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-  lcdDisplay.fillRect(x, y, w, h, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_FILL_RECT, x, y, w, h, color);
+  else
+    lcdDisplay.fillRect(x, y, w, h, color);
 }
 
 void display_fillScreen(uint16_t color) {
-  lcdDisplay.fillScreen(color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_FILL_SCREEN, color);
+  else
+    lcdDisplay.fillScreen(color);
 }
 
 void display_invertDisplay(bool i) {
-  lcdDisplay.invertDisplay(i);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_INVERT_DISPLAY, i);
+  else
+    lcdDisplay.invertDisplay(i);
 }
 
 void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
-  lcdDisplay.drawCircle(x0, y0, r, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_CIRCLE, x0, y0, r, color);
+  else
+    lcdDisplay.drawCircle(x0, y0, r, color);
 }
 
 void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
-  lcdDisplay.fillCircle(x0, y0, r, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_FILL_CIRCLE, x0, y0, r, color);
+  else
+    lcdDisplay.fillCircle(x0, y0, r, color);
 }
 
 void display_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 int16_t x2, int16_t y2, uint16_t color) {
-  lcdDisplay.drawTriangle(x0, y0, x1, y1, x2, y2, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_TRIANGLE, x0, y0, x1, y1, x2, y2, color);
+  else
+    lcdDisplay.drawTriangle(x0, y0, x1, y1, x2, y2, color);
 }
 
 void display_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 int16_t x2, int16_t y2, uint16_t color) {
-  lcdDisplay.fillTriangle(x0, y0, x1, y1, x2, y2, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_FILL_TRIANGLE, x0, y0, x1, y1, x2, y2, color);
+  else
+    lcdDisplay.fillTriangle(x0, y0, x1, y1, x2, y2, color);
 }
 
 void display_drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
 int16_t radius, uint16_t color) {
-  lcdDisplay.drawRoundRect(x0, y0, w, h, radius, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_ROUND_RECT, x0, y0, w, h, radius, color);
+  else
+    lcdDisplay.drawRoundRect(x0, y0, w, h, radius, color);
 }
 
 void display_fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
 int16_t radius, uint16_t color) {
-  lcdDisplay.fillRoundRect(x0, y0, w, h, radius, color);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_FILL_ROUND_RECT, x0, y0, w, h, radius, color);
+  else
+    lcdDisplay.fillRoundRect(x0, y0, w, h, radius, color);
 }
 
 void display_drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
 int16_t w, int16_t h, uint16_t color) {
-  lcdDisplay.drawBitmap(x, y, bitmap, w, h, color);
+  if (commandQueueEnabled) {
+    displayQueue_command_t command;
+    command.op = DISPLAYQUEUE_DRAW_BITMAP;
+    command.length = 0;
+    command.bitmap.x = x;
+    command.bitmap.y = y;
+    command.bitmap.w = w;
+    command.bitmap.h = h;
+    command.bitmap.color = color;
+    command.bitmap.pixels = bitmap;
+    displayQueue_push(&command);
+  } else {
+    lcdDisplay.drawBitmap(x, y, bitmap, w, h, color);
+  }
+}
+
+void display_blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels,
+  blit_format_t format, const uint16_t *palette) {
+  if (commandQueueEnabled) {
+    displayQueue_command_t command;
+    command.op = DISPLAYQUEUE_BLIT;
+    command.length = format;
+    command.blit.x = x;
+    command.blit.y = y;
+    command.blit.w = w;
+    command.blit.h = h;
+    command.blit.pixels = pixels;
+    command.blit.palette = palette;
+    displayQueue_push(&command);
+  } else {
+    lcdDisplay.blit(x, y, w, h, pixels, format, palette);
+  }
 }
 
 void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
 uint16_t bg, uint8_t size) {
-  lcdDisplay.drawChar(x, y, c, color, bg, size);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_DRAW_CHAR, x, y, c, color, bg, size);
+  else
+    lcdDisplay.drawChar(x, y, c, color, bg, size);
 }
 
 void display_setCursor(int16_t x, int16_t y) {
-  lcdDisplay.setCursor(x, y);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_SET_CURSOR, x, y);
+  else
+    lcdDisplay.setCursor(x, y);
 }
 
 void display_setTextColor(uint16_t c) {
-  lcdDisplay.setTextColor(c);
+  display_setTextColor(c, c);  // Same as Adafruit_GFX: bg == color means a transparent background.
 }
 
 void display_setTextColor(uint16_t c, uint16_t bg) {
-  lcdDisplay.setTextColor(c, bg);
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_SET_TEXT_COLOR, c, bg);
+  else
+    lcdDisplay.setTextColor(c, bg);
 }
 
 void display_setTextSize(uint8_t s) {
-  lcdDisplay.setTextSize(s);
+  textSize = s;
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_SET_TEXT_SIZE, s);
+  else
+    lcdDisplay.setTextSize(s);
+}
+
+void display_measureText(const char *str, int16_t x, int16_t y,
+  int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+  lcdDisplay.getTextBounds(str, x, y, textSize, textWrap, x1, y1, w, h);
 }
 
 void display_setTextWrap(bool w) {
-  lcdDisplay.setTextWrap(w);
+  textWrap = w;
+  if (commandQueueEnabled)
+    display_queue(DISPLAYQUEUE_SET_TEXT_WRAP, w);
+  else
+    lcdDisplay.setTextWrap(w);
 }
 
+// Not queued: width() and height() must answer for the new rotation right away. With AMP
+// rendering CPU0 only takes the new width and height, and CPU1 turns the LCD in turn.
 void display_setRotation(uint8_t r) {
+  if (ampRendering) {
+    lcdDisplay.Adafruit_GFX::setRotation(r);
+    display_queue(DISPLAYQUEUE_SET_ROTATION, r);
+    return;
+  }
+  display_drainQueue(DISPLAY_DRAIN_ALL);
   lcdDisplay.setRotation(r);
 }
 
@@ -141,86 +389,645 @@ uint16_t display_color565(uint8_t r, uint8_t g, uint8_t b) {
   return lcdDisplay.color565(r, g, b);
 }
 
+void display_enableFrameBuffer(bool enable) {
+  if (ampRendering)
+    return;  // CPU1 draws straight to the LCD.
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  lcdDisplay.enable(enable);
+}
+
+bool display_isFrameBufferEnabled() {
+  return lcdDisplay.isEnabled();
+}
+
+void display_flush() {
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+}
+
+// Not queued, but runs the queue first: a queued fillScreen() frees the palette entries.
+int16_t display_getPaletteIndex(uint16_t color) {
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  if (lcdDisplay.isEnabled())
+    return lcdDisplay.paletteIndex(color);
+#endif
+  return -1;
+}
+
+void display_setPaletteColor(int16_t index, uint16_t color) {
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  if (index >= 0)
+    lcdDisplay.setPaletteColor(index, color);
+#endif
+}
+
+void display_enableCommandQueue(bool enable) {
+  if (ampRendering)
+    return;  // The queue is how drawing reaches CPU1.
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  commandQueueEnabled = enable;
+  if (enable)
+    globalTimer_startTimer(false);  // Times display_drainQueue(). Leaves the counter alone if it is already running.
+}
+
+bool display_isCommandQueueEnabled() {
+  return commandQueueEnabled;
+}
+
+// Draws the next band of drainFill.
+static void display_drainFillBand() {
+  int16_t rows = DISPLAY_DRAIN_BAND_PIXELS / drainFill.w;
+  if (rows < 1)
+    rows = 1;
+  if (rows > drainFill.h)
+    rows = drainFill.h;
+  lcdDisplay.fillRect(drainFill.x, drainFill.y, drainFill.w, rows, drainFill.color);
+  drainFill.y += rows;
+  drainFill.h -= rows;
+}
+
+// Runs a queued command, or draws the first band of it if it is a large fill going straight to the LCD.
+static void display_drainCommand(const displayQueue_command_t *command) {
+  const int16_t *a = command->args;
+  if (!lcdDisplay.isEnabled() && (command->op == DISPLAYQUEUE_FILL_SCREEN)) {
+    drainFill.x = drainFill.y = 0;
+    drainFill.w = lcdDisplay.width();
+    drainFill.h = lcdDisplay.height();
+    drainFill.color = a[0];
+  } else if (!lcdDisplay.isEnabled() && (command->op == DISPLAYQUEUE_FILL_RECT) && (a[2] > 0) && (a[3] > 0) &&
+      ((int32_t) a[2] * a[3] > DISPLAY_DRAIN_BAND_PIXELS)) {
+    drainFill.x = a[0];
+    drainFill.y = a[1];
+    drainFill.w = a[2];
+    drainFill.h = a[3];
+    drainFill.color = a[4];
+  } else {
+    display_runCommand(lcdDisplay, command);
+    return;
+  }
+  display_drainFillBand();
+}
+
+// Sends queued commands to CPU1 until the queue is empty or CPU1's ring is full (with
+// DISPLAY_DRAIN_ALL, waits for room instead). Sending is quick, so there is no budget to keep.
+static bool display_sendQueueToCpu1(uint32_t budgetUs) {
+  while (ampUnsent || displayQueue_pop(&ampUnsentCommand)) {
+    ampUnsent = !amp_send(AMP_MESSAGE_DISPLAY_COMMAND, &ampUnsentCommand, sizeof(ampUnsentCommand));
+    if (ampUnsent && (budgetUs != DISPLAY_DRAIN_ALL))
+      return false;
+    if (ampUnsent)
+      hal_ampIdle();  // CPU1 is still drawing.
+  }
+  return true;
+}
+
+bool display_drainQueue(uint32_t budgetUs) {
+  if (ampRendering)
+    return display_sendQueueToCpu1(budgetUs);
+  displayQueue_command_t command;
+  uint64_t start = (budgetUs == DISPLAY_DRAIN_ALL) ? 0 : globalTimer_getTimerValue();
+  uint64_t budgetTicks = (uint64_t) budgetUs * (GLOBAL_TIMER_TICKS_PER_SECOND / 1000000);
+  while (true) {
+    if (drainFill.h > 0)
+      display_drainFillBand();
+    else if (displayQueue_pop(&command))
+      display_drainCommand(&command);
+    else
+      break;
+    if ((budgetUs != DISPLAY_DRAIN_ALL) && (globalTimer_getTimerValue() - start >= budgetTicks))
+      break;
+  }
+  if ((drainFill.h > 0) || displayQueue_count())
+    return false;
+  lcdDisplay.flush();
+  return true;
+}
+
+void display_enableAmpRendering() {
+  if (ampRendering)
+    return;
+  // Whatever CPU0 still has to draw goes out first; from now on it stays off the LCD bus.
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  lcdDisplay.enable(false);
+  commandQueueEnabled = true;
+  ampRendering = true;
+  // CPU1 starts from the state CPU0 leaves.
+  display_queue(DISPLAYQUEUE_SET_ROTATION, lcdDisplay.getRotation());
+  display_queue(DISPLAYQUEUE_SET_TEXT_SIZE, textSize);
+  display_queue(DISPLAYQUEUE_SET_TEXT_WRAP, textWrap);
+}
+
+bool display_isAmpRenderingEnabled() {
+  return ampRendering;
+}
+
+// Runs on CPU1. Sets up the LCD the first time, as display_init() does on CPU0.
+void display_runAmpCommand(const ampRing_message_t *message) {
+  displayQueue_command_t command;
+  memcpy(&command, message->payload, sizeof(command));
+  if (!cpu1LcdInitialized) {
+    cpu1Lcd.begin();
+    cpu1Lcd.setRotation(1);
+    cpu1LcdInitialized = true;
+  }
+  display_runCommand(cpu1Lcd, &command);
+}
+
+void display_printCommandQueueStats() {
+  printf("display queue: %lu commands, high-water mark %u of %u, %lu merged, %lu dropped.\n\r",
+    (unsigned long) displayQueue_getEnqueuedCount(), (unsigned) displayQueue_getHighWaterMark(),
+    (unsigned) DISPLAYQUEUE_CAPACITY, (unsigned long) displayQueue_getMergedCount(),
+    (unsigned long) displayQueue_getDroppedCount());
+}
+
+// Text console state. The console runs in rotation 0, where the panel's vertical scroll axis is
+// the screen's y axis. Each text line owns a band ("slot") of lineHeight panel lines in the scroll
+// area; slot k covers panel lines k * lineHeight.. and, as panel line 0 is at the bottom of the
+// screen in rotation 0, sits at screen y = height - (k + 1) * lineHeight when not scrolled.
+static struct {
+  bool active;
+  uint8_t textSize;
+  uint16_t color, bg;
+  uint8_t lineHeight;
+  uint16_t lines, columns;  // Text lines on the screen and characters per line.
+  uint32_t line;            // Lines started so far (the current line's number).
+  uint16_t column;          // Characters on the current line.
+  uint8_t savedRotation;
+  bool savedFrameBuffer, savedCommandQueue;
+} console;
+
+// Screen y of the current line's slot in the unscrolled GRAM.
+static int16_t display_consoleLineY() {
+  uint16_t slot = (console.lines - 1) - (console.line % console.lines);
+  return lcdDisplay.height() - (slot + 1) * console.lineHeight;
+}
+
+void display_consoleBegin(uint8_t textSize, uint16_t color, uint16_t bg) {
+  if (ampRendering)
+    return;  // The console needs the LCD on CPU0.
+  display_drainQueue(DISPLAY_DRAIN_ALL);
+  if (console.active)
+    display_consoleEnd();
+  console.savedCommandQueue = commandQueueEnabled;
+  console.savedFrameBuffer = lcdDisplay.isEnabled();
+  console.savedRotation = lcdDisplay.getRotation();
+  commandQueueEnabled = false;
+  lcdDisplay.enable(false);
+  lcdDisplay.setRotation(0);
+  console.textSize = textSize ? textSize : 1;
+  console.color = color;
+  console.bg = bg;
+  console.lineHeight = 8 * console.textSize;
+  console.lines = lcdDisplay.height() / console.lineHeight;
+  console.columns = lcdDisplay.width() / (6 * console.textSize);
+  console.line = 0;
+  console.column = 0;
+  lcdDisplay.fillScreen(bg);
+  // The panel lines left over at the top of the screen stay fixed.
+  lcdDisplay.setScrollArea(0, lcdDisplay.height() - console.lines * console.lineHeight);
+  lcdDisplay.scrollTo(0);
+  console.active = true;
+}
+
+void display_consoleEnd() {
+  if (!console.active)
+    return;
+  console.active = false;
+  lcdDisplay.endScroll();
+  lcdDisplay.setRotation(console.savedRotation);
+  lcdDisplay.fillScreen(DISPLAY_BLACK);
+  lcdDisplay.enable(console.savedFrameBuffer);
+  commandQueueEnabled = console.savedCommandQueue;
+}
+
+bool display_isConsoleActive() {
+  return console.active;
+}
+
+// Starts a new line. Once the screen is full, the slot of the oldest line is cleared and the
+// scroll start moved so that it becomes the bottom line: nothing else is redrawn.
+static void display_consoleNewLine() {
+  console.line++;
+  console.column = 0;
+  if (console.line < console.lines)
+    return;
+  int16_t y = display_consoleLineY();
+  lcdDisplay.fillRect(0, y, lcdDisplay.width(), console.lineHeight, console.bg);
+  lcdDisplay.scrollTo(((console.lines - 1) - (console.line % console.lines)) * console.lineHeight);
+}
+
+// Draws the run of characters [start, end) at the end of the current line.
+static void display_consoleDrawRun(const char *start, const char *end) {
+  if (end > start)
+    lcdDisplay.drawTextLine(console.column * 6 * console.textSize, display_consoleLineY(),
+      (const uint8_t *) start, end - start, console.color, console.bg, console.textSize);
+  console.column += end - start;
+}
+
+size_t display_consolePrint(const char *str) {
+  if (!console.active)
+    return 0;
+  const char *p = str, *run = str;
+  for (; *p; p++) {
+    if ((*p == '\n') || (*p == '\r') || (console.column + (p - run) == console.columns)) {
+      display_consoleDrawRun(run, p);
+      run = p + 1;
+      if (*p == '\r')
+        continue;
+      display_consoleNewLine();
+      if (*p != '\n')
+        run = p;  // Wrapped: the character starts the new line.
+    }
+  }
+  display_consoleDrawRun(run, p);
+  return p - str;
+}
+
+size_t display_consolePrintln(const char *str) {
+  size_t length = display_consolePrint(str);
+  return length + display_consolePrint("\n");
+}
+
+// Where print output goes: straight to the LCD, or into text when the queue is enabled.
+static inline Print &display_textTarget(QueuedText *text) {
+  return commandQueueEnabled ? (Print &) *text : (Print &) lcdDisplay;
+}
+
+// Queues whatever was printed into text (nothing when it went to the LCD) and returns length,
+// the number of characters printed.
+static inline size_t display_sendText(QueuedText *text, size_t length) {
+  text->send();
+  return length;
+}
+
 size_t display_println(const char str[]) {
-  return lcdDisplay.println(str);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(str));
 }
 
 size_t display_println(char c) {
-  return lcdDisplay.println(c);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(c));
 }
 
 size_t display_println(unsigned char c, int base) {
-  return lcdDisplay.println(c, base);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(c, base));
 }
 
 size_t display_println(int num, int base) {
-  return lcdDisplay.println(num, base);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(num, base));
 }
 
 size_t display_println(unsigned int num, int base) {
-  return lcdDisplay.println(num, base);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(num, base));
 }
 
 size_t display_println(long num, int base) {
-  return lcdDisplay.println(num, base);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(num, base));
 }
 
 size_t display_println(unsigned long num, int base) {
-  return lcdDisplay.println(num, base);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(num, base));
 }
 
 size_t display_println(double num, int fieldWidth) {
-  return lcdDisplay.println(num, fieldWidth);
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println(num, fieldWidth));
 }
 
 size_t display_println(void) {
-  return lcdDisplay.println();
+  QueuedText text;
+  return display_sendText(&text, display_textTarget(&text).println());
 }
 
 
 // These are functions related to the touch-pad.
 
+// When polled, the touch functions feed the filter whatever is in the FIFO; with interrupts, the
+// ISR feeds it.
+static touchFilter_sample_t touchFilterSamples[STMPE_FIFO_DEPTH];
+static TS_Point touchSamples[STMPE_FIFO_DEPTH];  // Raw samples read when polled.
+static TS_Point touchLastSample;                  // Raw, the last one read when polled.
+
+// State kept by the touch ISR (see display_enableTouchInterrupts()).
+static volatile bool touchInterruptsEnabled = false;
+static volatile bool touchIsTouched = false;   // As of the last interrupt.
+static bool touchDown = false;                 // A down event was queued, the up event was not.
+static volatile int16_t touchLatestX = 0, touchLatestY = 0;  // Raw, the latest sample.
+static volatile uint8_t touchLatestZ = 0;
+static volatile int16_t touchFilteredX = 0, touchFilteredY = 0;  // Raw, the filter's point.
+static volatile uint8_t touchFilteredZ = 0;
+static volatile bool touchFilteredValid = false, touchFilteredStable = false;
+static volatile uint32_t touchLatestSequence = 0;  // Incremented after each update of the latest sample.
+static ampRing_t touchEvents;                  // The ISR produces, the app consumes. Raw coordinates.
+static uint32_t droppedTouchEventCount = 0;
+// With touch interrupts, the FIFO-threshold interrupt fires once this many samples are waiting, so
+// the ISR reads them in one burst instead of one transaction per sample (the touch-detect interrupt
+// still catches a short tap). An ISR reads no more than DISPLAY_TOUCH_ISR_MAX_SAMPLES (about 0.6 ms
+// of SPI at 1 MHz) and leaves the rest for the next one, so a full FIFO does not hold off the timer.
+#define DISPLAY_TOUCH_FIFO_THRESHOLD 4
+#define DISPLAY_TOUCH_ISR_MAX_SAMPLES 16
+static TS_Point touchIsrSamples[DISPLAY_TOUCH_ISR_MAX_SAMPLES];
+
 // True if the display is being touched.
 bool display_isTouched(void) {
+  if (touchInterruptsEnabled)
+    return touchIsTouched;
   return touchController.touched();
 }
 
-// These min and max values correspond to the edges of the LCD panel.
-// x runs from the min value at the bottom, max value at the top.
-// y runs from the min value at the left, max value at the right.
-#define MIN_Y_TOUCH_POINT 280.0
-#define MAX_Y_TOUCH_POINT 3900.0
-#define MIN_X_TOUCH_POINT 350.0
-#define MAX_X_TOUCH_POINT 3950.0
-// Maps the touch-screen coordinates back to the LCD coordinate space.
+// Maps the touch-screen coordinates back to the LCD coordinate space of the current rotation.
 void display_mapToLcdCoordinates(int16_t *x, int16_t *y) {
-    // Swap incoming x and y to match with the LCD panel.
-	float lcdX = *y;
-	float lcdY = *x;
-    // Flip y so min is at top, max is at bottom.
-	lcdY = (MAX_Y_TOUCH_POINT) - lcdY;
-	// Scale y.
-	lcdY = (lcdY / (MAX_Y_TOUCH_POINT - MIN_Y_TOUCH_POINT)) * LCD_HEIGHT;
-	// Subtract off the minimum - you want to go negative on the left of the LCD
-	// and offset the maximum value so it matches the max LCD coordinate at the far right
-	// of the LCD.
-	lcdX -= MIN_X_TOUCH_POINT;
-    // x is within the LCD, scale by the full width of the LCD.
-	lcdX = (lcdX /(MAX_X_TOUCH_POINT - MIN_X_TOUCH_POINT)) * LCD_WIDTH;
-	// Make the final assignment back to the arguments.
-    *x = lcdX;
-    *y = lcdY;
+  touchCalibration_map(&touchCalibration, lcdDisplay.getRotation(), x, y);
+}
+
+// Copies the latest sample the ISR read. Tries again if the ISR updated it in the middle.
+static void display_getLatestTouchSample(int16_t *x, int16_t *y, uint8_t *z) {
+  uint32_t sequence;
+  do {
+    sequence = touchLatestSequence;
+    *x = touchLatestX;
+    *y = touchLatestY;
+    *z = touchLatestZ;
+  } while (sequence != touchLatestSequence);
+}
+
+// The touched point in raw touch-controller coordinates.
+static void display_getRawTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
+  if (touchInterruptsEnabled)
+    display_getLatestTouchSample(x, y, z);
+  else
+    touchController.readData(x, y, z);
+}
+
+static void display_filterTouchSamples(const TS_Point *samples, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    touchFilterSamples[i].x = samples[i].x;
+    touchFilterSamples[i].y = samples[i].y;
+    touchFilterSamples[i].z = samples[i].z;
+  }
+  touchFilter_addSamples(&touchFilter, touchFilterSamples, count);
+}
+
+// Polled: moves everything in the FIFO into the filter, a burst at a time.
+static void display_readTouchFifo() {
+  uint8_t count;
+  do {
+    count = touchController.readBurst(touchSamples, STMPE_FIFO_DEPTH);
+    if (count)
+      touchLastSample = touchSamples[count - 1];
+    display_filterTouchSamples(touchSamples, count);
+  } while (count == STMPE_FIFO_DEPTH);
+}
+
+// The filter's point in raw coordinates, and whether the filter has converged. Returns false if
+// the filter has no point (no sample firm enough since the touch began).
+static bool display_getFilteredTouchedPoint(int16_t *x, int16_t *y, uint8_t *z, bool *stable) {
+  if (!touchInterruptsEnabled) {
+    display_readTouchFifo();
+    *stable = touchFilter_isConverged(&touchFilter);
+    return touchFilter_getPoint(&touchFilter, x, y, z);
+  }
+  uint32_t sequence;
+  bool valid;
+  do {
+    sequence = touchLatestSequence;
+    *x = touchFilteredX;
+    *y = touchFilteredY;
+    *z = touchFilteredZ;
+    valid = touchFilteredValid;
+    *stable = touchFilteredStable;
+  } while (sequence != touchLatestSequence);
+  return valid;
 }
 
 // Returns the x-y coordinate of the touched point and the pressure (z).
 void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
-  touchController.readData(x, y, z);
+  bool stable;
+  if (!display_getFilteredTouchedPoint(x, y, z, &stable)) {
+    // Nothing firm enough: the last raw sample, as before the filter.
+    if (touchInterruptsEnabled)
+      display_getLatestTouchSample(x, y, z);
+    else {
+      *x = touchLastSample.x;
+      *y = touchLastSample.y;
+      *z = touchLastSample.z;
+    }
+  }
+  display_mapToLcdCoordinates(x, y);
+}
+
+bool display_getStableTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
+  bool stable;
+  if (!display_getFilteredTouchedPoint(x, y, z, &stable) || !stable)
+    return false;
   display_mapToLcdCoordinates(x, y);
+  return true;
+}
+
+void display_setTouchMinPressure(uint8_t z) {
+  display_init();
+  touchFilter.minZ = z;
+}
+
+// Reads the samples raw in one burst, then maps them. The filter sees them too.
+uint8_t display_getTouchedPoints(display_touchPoint_t *points, uint8_t maxPoints) {
+  if (touchInterruptsEnabled) {
+    if (!maxPoints || !touchIsTouched)
+      return 0;
+    display_getTouchedPoint(&points[0].x, &points[0].y, &points[0].z);
+    return 1;
+  }
+  if (maxPoints > STMPE_FIFO_DEPTH)
+    maxPoints = STMPE_FIFO_DEPTH;
+  uint8_t count = touchController.readBurst(touchSamples, maxPoints);
+  if (count)
+    touchLastSample = touchSamples[count - 1];
+  display_filterTouchSamples(touchSamples, count);
+  for (uint8_t i = 0; i < count; i++) {
+    points[i].x = touchSamples[i].x;
+    points[i].y = touchSamples[i].y;
+    points[i].z = touchSamples[i].z;
+    display_mapToLcdCoordinates(&points[i].x, &points[i].y);
+  }
+  return count;
 }
 
-// Throws away all previous touch data.
+// Throws away all previous touch data, and starts the filter on a new touch.
 void display_clearOldTouchData() {
+  if (touchInterruptsEnabled)  // The ISR keeps the FIFO empty and restarts the filter on each touch.
+    return;
   touchController.clearOldTouchData();
+  touchFilter_reset(&touchFilter);
+}
+
+// Queues an event with the raw coordinates; display_getTouchEvent() maps them (no floating point
+// in the ISR).
+static void display_queueTouchEvent(display_touchEventType_t type, const TS_Point *point, uint64_t time) {
+  static_assert(sizeof(display_touchEvent_t) <= AMPRING_PAYLOAD_BYTES, "a touch event does not fit in a ring slot");
+  ampRing_message_t message;
+  display_touchEvent_t event = {type, point->x, point->y, (uint8_t) point->z, time};
+  message.type = type;
+  memcpy(message.payload, &event, sizeof(event));
+  if (!ampRing_push(&touchEvents, &message))
+    droppedTouchEventCount++;
+}
+
+// The touch controller's INT line: touch detected (pressed or released) or a sample in the FIFO.
+// Events carry the raw samples (lowest latency); the filter's point is kept for
+// display_getTouchedPoint().
+static void display_touchIsr(void *callBackRef) {
+  bool touched;
+  uint8_t count = touchController.serviceInterrupt(touchIsrSamples, DISPLAY_TOUCH_ISR_MAX_SAMPLES, &touched);
+  uint64_t time = globalTimer_getTimerValue();
+  // A new touch. The filter keeps the point of the last one until then.
+  bool newTouch = !touchDown && (touched || count);
+  if (newTouch)
+    touchFilter_reset(&touchFilter);
+  for (uint8_t i = 0; i < count; i++) {
+    display_queueTouchEvent(touchDown ? DISPLAY_TOUCH_MOVE : DISPLAY_TOUCH_DOWN, &touchIsrSamples[i], time);
+    touchDown = true;
+  }
+  if (count) {
+    display_filterTouchSamples(touchIsrSamples, count);
+    touchLatestX = touchIsrSamples[count - 1].x;
+    touchLatestY = touchIsrSamples[count - 1].y;
+    touchLatestZ = touchIsrSamples[count - 1].z;
+  }
+  if (count || newTouch) {
+    int16_t x = 0, y = 0;
+    uint8_t z = 0;
+    touchFilteredValid = touchFilter_getPoint(&touchFilter, &x, &y, &z);
+    touchFilteredX = x;
+    touchFilteredY = y;
+    touchFilteredZ = z;
+    touchFilteredStable = touchFilter_isConverged(&touchFilter);
+    touchLatestSequence++;
+  }
+  if (!touched && touchDown) {
+    TS_Point latest(touchLatestX, touchLatestY, touchLatestZ);
+    display_queueTouchEvent(DISPLAY_TOUCH_UP, &latest, time);
+    touchDown = false;
+  }
+  touchIsTouched = touched;
+}
+
+// Also enables the FIFO-threshold interrupt, at DISPLAY_TOUCH_FIFO_THRESHOLD samples instead of the
+// one sample Adafruit_STMPE610::begin() sets.
+bool display_enableTouchInterrupts() {
+  display_init();
+  if (touchInterruptsEnabled)
+    return true;
+  ampRing_init(&touchEvents);
+  touchDown = false;
+  touchController.clearOldTouchData();
+  touchFilter_reset(&touchFilter);
+  touchFilteredValid = touchFilteredStable = false;
+  touchController.writeRegister8(STMPE_FIFO_TH, DISPLAY_TOUCH_FIFO_THRESHOLD);
+  touchController.writeRegister8(STMPE_INT_EN, STMPE_INT_EN_TOUCHDET | STMPE_INT_EN_FIFOTH);
+  touchController.writeRegister8(STMPE_INT_STA, 0xFF);  // Start from a clean slate.
+  touchIsTouched = touchController.touched();
+  globalTimer_startTimer(false);  // Event time stamps. Leaves the counter alone if it is already running.
+  touchInterruptsEnabled = true;
+  if (hal_interruptsConnectTouch(display_touchIsr) != HAL_STATUS_OK) {
+    touchInterruptsEnabled = false;
+    touchController.writeRegister8(STMPE_INT_EN, STMPE_INT_EN_TOUCHDET);
+    touchController.writeRegister8(STMPE_FIFO_TH, 1);
+    return false;
+  }
+  return true;
+}
+
+bool display_isTouchInterruptEnabled() {
+  return touchInterruptsEnabled;
+}
+
+bool display_getTouchEvent(display_touchEvent_t *event) {
+  ampRing_message_t message;
+  if (!ampRing_pop(&touchEvents, &message))
+    return false;
+  memcpy(event, message.payload, sizeof(*event));
+  display_mapToLcdCoordinates(&event->x, &event->y);
+  return true;
+}
+
+uint32_t display_getDroppedTouchEventCount() {
+  return droppedTouchEventCount;
+}
+
+// Targets in thousandths of the width and height: spread out, and never three on one line.
+static const touchCalibration_point_t touchCalibrationTargets[DISPLAY_TOUCH_CALIBRATION_MAX_POINTS] = {
+  {100, 100}, {900, 100}, {500, 900}, {100, 900}, {900, 900}
+};
+#define DISPLAY_TOUCH_CALIBRATION_CROSS_HAIR 10  // Half the length of a cross-hair line, in pixels.
+#define DISPLAY_TOUCH_CALIBRATION_SAMPLES 16     // Samples averaged per press.
+#define DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS 10
+
+// Waits for a press and release, and averages the raw samples taken while pressed. What comes in
+// during the first DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS is thrown away: the ADC has not settled yet.
+static touchCalibration_point_t display_readCalibrationPress() {
+  int32_t sumX = 0, sumY = 0, count = 0;
+  int16_t x, y;
+  uint8_t z;
+  while (display_isTouched())  // Still pressed from the last target.
+    utils_msDelay(DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS);
+  display_clearOldTouchData();
+  while (count == 0) {
+    while (!display_isTouched())
+      utils_msDelay(DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS);
+    utils_msDelay(DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS);
+    display_clearOldTouchData();
+    while (display_isTouched()) {
+      utils_msDelay(DISPLAY_TOUCH_CALIBRATION_SAMPLE_MS);
+      display_getRawTouchedPoint(&x, &y, &z);
+      if (count < DISPLAY_TOUCH_CALIBRATION_SAMPLES) {
+        sumX += x;
+        sumY += y;
+        count++;
+      }
+    }
+  }
+  touchCalibration_point_t point = {(int16_t) (sumX / count), (int16_t) (sumY / count)};
+  return point;
+}
+
+bool display_calibrateTouch(uint8_t count) {
+  touchCalibration_point_t raw[DISPLAY_TOUCH_CALIBRATION_MAX_POINTS], lcd[DISPLAY_TOUCH_CALIBRATION_MAX_POINTS];
+  if ((count < 3) || (count > DISPLAY_TOUCH_CALIBRATION_MAX_POINTS))
+    return false;
+  display_init();
+  uint8_t rotation = lcdDisplay.getRotation();
+  for (uint8_t i = 0; i < count; i++) {
+    int16_t x = (int32_t) display_width() * touchCalibrationTargets[i].x / 1000;
+    int16_t y = (int32_t) display_height() * touchCalibrationTargets[i].y / 1000;
+    display_fillScreen(DISPLAY_BLACK);
+    display_drawFastHLine(x - DISPLAY_TOUCH_CALIBRATION_CROSS_HAIR, y, 2 * DISPLAY_TOUCH_CALIBRATION_CROSS_HAIR + 1,
+        DISPLAY_WHITE);
+    display_drawFastVLine(x, y - DISPLAY_TOUCH_CALIBRATION_CROSS_HAIR, 2 * DISPLAY_TOUCH_CALIBRATION_CROSS_HAIR + 1,
+        DISPLAY_WHITE);
+    display_flush();
+    raw[i] = display_readCalibrationPress();
+    touchCalibration_toRotation1(rotation, &x, &y);  // The matrix maps to rotation 1.
+    lcd[i].x = x;
+    lcd[i].y = y;
+  }
+  display_fillScreen(DISPLAY_BLACK);
+  display_flush();
+  return touchCalibration_solve(&touchCalibration, raw, lcd, count);
+}
+
+void display_getTouchCalibration(touchCalibration_t *calibration) {
+  *calibration = touchCalibration;
+}
+
+void display_setTouchCalibration(const touchCalibration_t *calibration) {
+  touchCalibration = *calibration;
 }
 
 // Display test routines, just adapted from the original Adafruit code.
@@ -228,6 +1035,19 @@ void display_clearOldTouchData() {
 // quick hack for min - to be used for these test functions only.
 #define min(x, y) ((x) < (y) ? (x) : (y))
 
+// Timing for the tests that return microseconds. The queue and frame buffer are flushed before
+// the time is read, so queued or buffered drawing is counted too.
+static u64 display_testStartTime() {
+  globalTimer_startTimer(false);  // Leaves the counter alone if it is already running.
+  display_flush();
+  return globalTimer_getTimerValue();
+}
+
+static unsigned long display_testMicroseconds(u64 startTime) {
+  display_flush();
+  return (unsigned long) ((globalTimer_getTimerValue() - startTime) * 1000000 / GLOBAL_TIMER_TICKS_PER_SECOND);
+}
+
 unsigned long display_testLines(uint16_t color) {
   int           x1, y1, x2, y2,
                 w = display_width(),
@@ -313,12 +1133,13 @@ unsigned long display_testFilledCircles(uint8_t radius, uint16_t color) {
   int x, y, w = display_width(), h = display_height(), r2 = radius * 2;
 
   display_fillScreen(DISPLAY_BLACK);
+  u64 start = display_testStartTime();
   for(x=radius; x<w; x+=r2) {
     for(y=radius; y<h; y+=r2) {
       display_fillCircle(x, y, radius, color);
     }
   }
-  return 0;
+  return display_testMicroseconds(start);
 }
 
 unsigned long display_testCircles(uint8_t radius, uint16_t color) {
@@ -356,14 +1177,19 @@ unsigned long display_testFilledTriangles() {
   int           i, cx = display_width()  / 2 - 1,
                    cy = display_height() / 2 - 1;
 
+  unsigned long t = 0;
+
   display_fillScreen(DISPLAY_BLACK);
   for(i=min(cx,cy); i>10; i-=5) {
+    u64 start = display_testStartTime();
     display_fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
       display_color565(0, i, i));
+    t += display_testMicroseconds(start);
+    // Outlines are not included in timing results
     display_drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
       display_color565(i, i, 0));
   }
-  return 0;
+  return t;
 }
 
 unsigned long display_testRoundRects() {
@@ -386,11 +1212,12 @@ unsigned long display_testFilledRoundRects() {
                 cy = display_height() / 2 - 1;
 
   display_fillScreen(DISPLAY_BLACK);
+  u64 start = display_testStartTime();
   for(i=min(display_width(), display_height()); i>20; i-=6) {
     i2 = i / 2;
     display_fillRoundRect(cx-i2, cy-i2, i, i, i/8, display_color565(0, i, 0));
   }
-  return 0;
+  return display_testMicroseconds(start);
 }
 
 unsigned long display_testFillScreen() {
@@ -428,8 +1255,99 @@ unsigned long display_testText() {
   return 0;
 }
 
+// Scene for display_testFrameBuffer(): a row of changing clock-sized digits plus a few small shapes.
+#define DISPLAY_TEST_FRAME_BUFFER_PASSES 10
+#define DISPLAY_TEST_FRAME_BUFFER_DIGITS 6
+static void display_drawFrameBufferTestScene(uint8_t pass) {
+  for (uint8_t i = 0; i < DISPLAY_TEST_FRAME_BUFFER_DIGITS; i++)
+    display_drawChar(20 + i * 48, 80, '0' + (pass + i) % 10, DISPLAY_GREEN, DISPLAY_BLACK, 4);
+  display_drawLine(0, 0, pass * 30, display_height() - 1, DISPLAY_YELLOW);
+  display_fillCircle(15 + pass * 30, 200, 10, DISPLAY_RED);
+  display_drawRect(pass * 30, 150, 25, 25, DISPLAY_CYAN);
+}
 
+unsigned long display_testFrameBuffer() {
+  bool wasEnabled = lcdDisplay.isEnabled();
+  bool queueWasEnabled = commandQueueEnabled;
+  uint32_t directWrites, bufferedWrites;
 
+  display_enableCommandQueue(false);  // The bus writes are counted as the drawing calls are made.
+  lcdDisplay.enable(false);
+  display_fillScreen(DISPLAY_BLACK);
+  LCD_clearBusWriteCount();
+  for (uint8_t pass = 0; pass < DISPLAY_TEST_FRAME_BUFFER_PASSES; pass++)
+    display_drawFrameBufferTestScene(pass);
+  directWrites = LCD_getBusWriteCount();
+
+  lcdDisplay.enable(true);  // Starts black, flush it so both runs start from the same screen.
+  if (!lcdDisplay.isEnabled()) {
+    display_enableCommandQueue(queueWasEnabled);
+    printf("frame buffer test: DISPLAY_ENABLE_FRAME_BUFFER is not defined.\n\r");
+    return 0;
+  }
+  lcdDisplay.flush();
+  LCD_clearBusWriteCount();
+  for (uint8_t pass = 0; pass < DISPLAY_TEST_FRAME_BUFFER_PASSES; pass++) {
+    display_drawFrameBufferTestScene(pass);
+    display_flush();
+  }
+  bufferedWrites = LCD_getBusWriteCount();
+  lcdDisplay.enable(wasEnabled);
+  display_enableCommandQueue(queueWasEnabled);
 
+  printf("frame buffer test: %lu bus writes direct, %lu buffered.\n\r",
+    (unsigned long) directWrites, (unsigned long) bufferedWrites);
+  return bufferedWrites;
+}
 
+#define DISPLAY_TEST_GLYPH_MAX_SIZE 6
+// The generic Adafruit_GFX::drawChar() is still reachable with a qualified call, which gives the
+// per-dot cost to compare against the batched Adafruit_TFTLCD::drawChar().
+unsigned long display_testGlyphBusWrites() {
+  bool wasEnabled = lcdDisplay.isEnabled();
+  bool queueWasEnabled = commandQueueEnabled;
+  uint32_t perDotWrites, batchedWrites, totalBatchedWrites = 0;
 
+  display_enableCommandQueue(false);
+  lcdDisplay.enable(false);
+  display_fillScreen(DISPLAY_BLACK);
+  for (uint8_t size = 1; size <= DISPLAY_TEST_GLYPH_MAX_SIZE; size++) {
+    LCD_clearBusWriteCount();
+    lcdDisplay.Adafruit_GFX::drawChar(0, 0, '8', DISPLAY_GREEN, DISPLAY_BLACK, size);
+    perDotWrites = LCD_getBusWriteCount();
+    LCD_clearBusWriteCount();
+    display_drawChar(0, 0, '8', DISPLAY_GREEN, DISPLAY_BLACK, size);
+    batchedWrites = LCD_getBusWriteCount();
+    totalBatchedWrites += batchedWrites;
+    printf("glyph size %d: %lu bus writes per-dot, %lu batched.\n\r", size,
+      (unsigned long) perDotWrites, (unsigned long) batchedWrites);
+  }
+  lcdDisplay.enable(wasEnabled);
+  display_enableCommandQueue(queueWasEnabled);
+  return totalBatchedWrites;
+}
+
+// A solid fill (hi == lo) and a two-byte color, since the bus layer fills those differently.
+unsigned long display_testFillScreenTransactions() {
+  static const uint16_t colors[] = {DISPLAY_BLACK, DISPLAY_BLUE};
+  bool wasEnabled = lcdDisplay.isEnabled();
+  bool queueWasEnabled = commandQueueEnabled;
+  uint32_t total = 0;
+
+  display_enableCommandQueue(false);
+  lcdDisplay.enable(false);
+  for (uint8_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+    LCD_clearTransactionCounts();
+    display_fillScreen(colors[i]);
+    printf("fillScreen(0x%04x): %lu GPIO transactions (control %lu, byte %lu, word %lu, repeated %lu).\n\r",
+      colors[i], (unsigned long) LCD_getTotalTransactionCount(),
+      (unsigned long) LCD_getTransactionCount(LCD_PRIMITIVE_CONTROL),
+      (unsigned long) LCD_getTransactionCount(LCD_PRIMITIVE_WRITE_BYTE),
+      (unsigned long) LCD_getTransactionCount(LCD_PRIMITIVE_WRITE_WORD),
+      (unsigned long) LCD_getTransactionCount(LCD_PRIMITIVE_WRITE_REPEATED));
+    total += LCD_getTotalTransactionCount();
+  }
+  lcdDisplay.enable(wasEnabled);
+  display_enableCommandQueue(queueWasEnabled);
+  return total;
+}
@@ -10,6 +10,9 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include "ampRing.h"
+#include "blit.h"
+#include "touchCalibration.h"
 
 #define DISPLAY_DEC 10
 #define DISPLAY_HEX 16
@@ -35,6 +38,9 @@ void display_init();
 // The functionality for these functions comes from Adafruit_GFX.cpp and Adafruit_TFTLCD.cpp.
 void
   display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color),
+  // thickness pixels wide, measured along x for steep lines and along y otherwise.
+  display_drawThickLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t thickness,
+  uint16_t color),
   display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
   display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
   display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color),
@@ -61,10 +67,71 @@ void
   display_setTextSize(uint8_t s),
   display_setTextWrap(bool w),
   display_setRotation(uint8_t r);
+  // Draws a w x h image in one burst: one address window, converted to RGB565 on the fly.
+  // palette is used by the BLIT_FORMAT_MASK1 ({bg, fg}), INDEX4 and INDEX8 formats (see blit.h).
+  void display_blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels,
+    blit_format_t format, const uint16_t *palette = NULL);
+  // The box that display_println(str) at cursor (x, y) would draw into, with the text size and
+  // wrap last set (queued or not); w and h are 0 if str has no printable characters. Used to
+  // center text: display_setCursor((display_width() - w) / 2, ...).
+  void display_measureText(const char *str, int16_t x, int16_t y,
+    int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
   int16_t display_height();
   int16_t display_width();
   uint16_t display_color565(uint8_t r, uint8_t g, uint8_t b);  // Packs r,g,b into 16 bits.
 
+  // Optional RAM frame buffer (see frameBuffer.h). While it is enabled, drawing only updates RAM
+  // and nothing reaches the LCD until display_flush() sends the regions that changed. Its RAM is
+  // only reserved with DISPLAY_ENABLE_FRAME_BUFFER (display.cpp); without it enabling does nothing.
+  void display_enableFrameBuffer(bool enable);
+  bool display_isFrameBufferEnabled();
+  void display_flush();  // Runs all queued commands, then sends the frame buffer (if enabled).
+  // Palette animation, with FRAMEBUFFER_INDEXED_BITS (frameBuffer.h) and the frame buffer enabled.
+  // display_getPaletteIndex() returns the entry that color is drawn with (-1 without a palette).
+  // display_setPaletteColor() changes what that entry shows: the next flush sends only the rows its
+  // pixels are on, e.g. to flash a button that was drawn once. fillScreen() frees the entries.
+  int16_t display_getPaletteIndex(uint16_t color);
+  void display_setPaletteColor(int16_t index, uint16_t color);
+
+  // Optional command queue (see displayQueue.h). While it is enabled, the drawing, text and
+  // print calls above only queue a command, and the main loop runs them with display_drainQueue()
+  // while it waits for the next tick. display_setRotation() and the enable calls run the whole
+  // queue first. Bitmaps are not copied: they must stay valid until their command has run.
+  #define DISPLAY_DRAIN_ALL UINT32_MAX
+  #define DISPLAY_DRAIN_BUDGET_US 1000  // Drawing a main loop does before it checks for a tick again.
+  void display_enableCommandQueue(bool enable);
+  bool display_isCommandQueueEnabled();
+  // Runs queued commands until budgetUs microseconds have passed (DISPLAY_DRAIN_ALL: until the
+  // queue is empty). Large fills are drawn a band of rows at a time, so a call overruns its budget
+  // by at most one command or band, about 1 ms. Once the queue is empty it also flushes the frame
+  // buffer. Returns true if the queue is empty.
+  bool display_drainQueue(uint32_t budgetUs);
+  // Prints the queue high-water mark and the merged and dropped command counts.
+  void display_printCommandQueueStats();
+
+  // Rendering on CPU1 (AMP, see amp.h). Once enabled, CPU1 alone drives the LCD: the command
+  // queue stays on and display_drainQueue() sends the queued commands to CPU1 over the AMP ring
+  // (AMP_MESSAGE_DISPLAY_COMMAND) instead of drawing them; it only waits for room in the ring
+  // with DISPLAY_DRAIN_ALL. CPU1 (src/Amp/ampCpu1Main.c) hands each of them to
+  // display_runAmpCommand(). Call it once after amp_init(); it cannot be turned off. The frame
+  // buffer, the palette, the console and the display_test routines are not available then, and
+  // bitmaps and blit pixels must be in memory CPU1 can read as well.
+  void display_enableAmpRendering();
+  bool display_isAmpRenderingEnabled();
+  void display_runAmpCommand(const ampRing_message_t *message);  // CPU1 only.
+
+  // Scrolling text console (ILI9341 only). display_consoleBegin() switches to portrait (rotation 0),
+  // clears the screen to bg and uses the controller's vertical scrolling, so that once the screen
+  // is full a new line only clears and draws its own band instead of redrawing every line.
+  // '\n' starts a new line, '\r' is ignored and long lines wrap. While the console is active, the
+  // other drawing calls must not be used; display_consoleEnd() clears the screen to black and
+  // restores the rotation, frame buffer and command queue.
+  void display_consoleBegin(uint8_t textSize, uint16_t color, uint16_t bg);
+  void display_consoleEnd();
+  bool display_isConsoleActive();
+  size_t display_consolePrint(const char *str);  // Returns the number of characters consumed.
+  size_t display_consolePrintln(const char *str);
+
   // Print routines
   size_t display_println(const char str[]);
   size_t display_println(char c);
@@ -81,22 +148,76 @@ void
   unsigned long display_testFastLines(uint16_t color1, uint16_t color2);
   unsigned long display_testRects(uint16_t color);
   unsigned long display_testFilledRects(uint16_t color1, uint16_t color2);
-  unsigned long display_testFilledCircles(uint8_t radius, uint16_t color);
+  unsigned long display_testFilledCircles(uint8_t radius, uint16_t color);  // Returns microseconds.
   unsigned long display_testCircles(uint8_t radius, uint16_t color);
   unsigned long display_testTriangles();
-  unsigned long display_testFilledTriangles();
+  unsigned long display_testFilledTriangles();  // Returns microseconds spent in the fills.
   unsigned long display_testRoundRects();
-  unsigned long display_testFilledRoundRects();
+  unsigned long display_testFilledRoundRects();  // Returns microseconds.
   unsigned long display_testFillScreen();
   unsigned long display_testText();
+  unsigned long display_testFrameBuffer();  // Prints LCD bus writes for the same scene, direct vs. buffered.
+  unsigned long display_testGlyphBusWrites();  // Prints LCD bus writes per glyph at sizes 1-6, per-dot vs. batched.
+  unsigned long display_testFillScreenTransactions();  // Prints GPIO transactions per fillScreen, by bus primitive.
 
 // The functionality for these routines comes from Adafruit_STMPE610 (touch controller).
 // True if the display is being touched.
 bool display_isTouched(void);
-// Returns the x-y coordinate point and the pressure (z).
+// Returns the x-y coordinate point and the pressure (z). The samples go through a filter first
+// (touchFilter.h): light samples are rejected, a median and an IIR smooth the rest. Until a sample
+// firm enough has come in, this is the last raw sample.
 void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z);
-// Throws away all previous touch data.
+// Returns true, with the point, once the filter has settled on the current touch (a few ms of
+// samples on a firm press; it stays settled after the release until the next touch begins). Use it
+// instead of waiting a fixed time for the touch controller's ADC to settle.
+bool display_getStableTouchedPoint(int16_t *x, int16_t *y, uint8_t *z);
+// Samples with a lower pressure (z) are thrown away (TOUCHFILTER_DEFAULT_MIN_Z to begin with).
+void display_setTouchMinPressure(uint8_t z);
+// A touched point in LCD coordinates and its pressure.
+typedef struct {
+  int16_t x, y;
+  uint8_t z;
+} display_touchPoint_t;
+// Reads up to maxPoints of the queued touch samples, oldest first, in one burst.
+// Returns the number of points stored.
+uint8_t display_getTouchedPoints(display_touchPoint_t *points, uint8_t maxPoints);
+// Throws away all previous touch data. Call it when a touch begins.
 void display_clearOldTouchData();
 
+// Interrupt-driven touch input. Once enabled, an ISR on the touch controller's INT line reads the
+// samples a few at a time as they arrive and queues touch-down/move/up events; display_isTouched(),
+// display_getTouchedPoint() and display_getTouchedPoints() then answer from what the ISR saw
+// (the latest point) without SPI traffic, and display_clearOldTouchData() has nothing to do.
+// Call it after interrupts_initAll(). Returns false, and touch input stays polled, if the INT line
+// is not routed to the interrupt controller.
+bool display_enableTouchInterrupts();
+bool display_isTouchInterruptEnabled();
+typedef enum {
+  DISPLAY_TOUCH_DOWN,  // First sample of a touch.
+  DISPLAY_TOUCH_MOVE,  // Every later sample.
+  DISPLAY_TOUCH_UP     // Released, at the last sample's point.
+} display_touchEventType_t;
+typedef struct {
+  display_touchEventType_t type;
+  int16_t x, y;        // LCD coordinates.
+  uint8_t z;
+  uint64_t time;       // globalTimer_getTimerValue() when the ISR read the sample.
+} display_touchEvent_t;
+// Pops the oldest event. Returns false if there is none.
+bool display_getTouchEvent(display_touchEvent_t *event);
+// Events lost because the queue was full.
+uint32_t display_getDroppedTouchEventCount();
+
+// Touch calibration (see touchCalibration.h). display_init() sets the calibration the board has
+// always used; the mapping follows display_setRotation(). display_calibrateTouch() shows a cross
+// hair at each of count targets (3 to DISPLAY_TOUCH_CALIBRATION_MAX_POINTS) in turn, waits for a
+// press and release on each, and solves for the matrix (least squares for more than 3). It blocks
+// and leaves the screen black. Returns false, and keeps the old calibration, if the presses do not
+// fit an affine mapping. Save the matrix with display_getTouchCalibration() to skip it next time.
+#define DISPLAY_TOUCH_CALIBRATION_MAX_POINTS 5
+bool display_calibrateTouch(uint8_t count);
+void display_getTouchCalibration(touchCalibration_t *calibration);
+void display_setTouchCalibration(const touchCalibration_t *calibration);
+
 
 #endif /* DISPLAY_H_ */
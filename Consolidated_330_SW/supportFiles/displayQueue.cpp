@@ -0,0 +1,135 @@
+/*
+ * displayQueue.cpp
+ */
+
+#include "displayQueue.h"
+#include <stdint.h>
+
+#define DISPLAYQUEUE_INDEX(i) ((i) % DISPLAYQUEUE_CAPACITY)
+
+static displayQueue_command_t commands[DISPLAYQUEUE_CAPACITY];
+static uint16_t head = 0;   // Oldest command.
+static uint16_t count = 0;  // Commands waiting, starting at head.
+static uint16_t highWaterMark = 0;
+static uint32_t enqueuedCount = 0;
+static uint32_t mergedCount = 0;
+static uint32_t droppedCount = 0;
+
+// True for the commands whose only effect is pixels on the screen.
+static bool displayQueue_onlyDrawsPixels(uint8_t op) {
+  return op <= DISPLAYQUEUE_DRAW_CHAR;
+}
+
+// Computes the inclusive rectangle a command draws into. Returns false for commands that are
+// not simple to bound, they are then never merged into a fillRect.
+static bool displayQueue_getBounds(const displayQueue_command_t *command,
+    int16_t *x1, int16_t *y1, int16_t *x2, int16_t *y2) {
+  const int16_t *args = command->args;
+  int16_t w, h;
+  switch (command->op) {
+  case DISPLAYQUEUE_DRAW_FAST_VLINE:
+    w = 1;
+    h = args[2];
+    break;
+  case DISPLAYQUEUE_DRAW_FAST_HLINE:
+    w = args[2];
+    h = 1;
+    break;
+  case DISPLAYQUEUE_DRAW_RECT:
+  case DISPLAYQUEUE_FILL_RECT:
+  case DISPLAYQUEUE_DRAW_ROUND_RECT:
+  case DISPLAYQUEUE_FILL_ROUND_RECT:
+  case DISPLAYQUEUE_BLIT:  // blit.x, y, w, h overlay args[0..3].
+    w = args[2];
+    h = args[3];
+    break;
+  case DISPLAYQUEUE_DRAW_CHAR:
+    w = 6 * args[5];
+    h = 8 * args[5];
+    break;
+  default:
+    return false;
+  }
+  if ((w <= 0) || (h <= 0))
+    return false;
+  *x1 = args[0];
+  *y1 = args[1];
+  *x2 = args[0] + w - 1;
+  *y2 = args[1] + h - 1;
+  return true;
+}
+
+// A fillScreen paints over everything before it: keep only the commands that do more than draw.
+static void displayQueue_mergeFillScreen() {
+  uint16_t kept = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    displayQueue_command_t *command = &commands[DISPLAYQUEUE_INDEX(head + i)];
+    if (displayQueue_onlyDrawsPixels(command->op))
+      mergedCount++;
+    else
+      commands[DISPLAYQUEUE_INDEX(head + kept++)] = *command;
+  }
+  count = kept;
+}
+
+// A fillRect paints over the newest commands as long as each one lies inside it.
+static void displayQueue_mergeFillRect(const displayQueue_command_t *fill) {
+  int16_t x1, y1, x2, y2;
+  displayQueue_getBounds(fill, &x1, &y1, &x2, &y2);
+  while (count) {
+    const displayQueue_command_t *last = &commands[DISPLAYQUEUE_INDEX(head + count - 1)];
+    int16_t lastX1, lastY1, lastX2, lastY2;
+    if (!displayQueue_onlyDrawsPixels(last->op) || !displayQueue_getBounds(last, &lastX1, &lastY1, &lastX2, &lastY2))
+      return;
+    if ((lastX1 < x1) || (lastY1 < y1) || (lastX2 > x2) || (lastY2 > y2))
+      return;
+    count--;
+    mergedCount++;
+  }
+}
+
+bool displayQueue_push(const displayQueue_command_t *command) {
+  if (command->op == DISPLAYQUEUE_FILL_SCREEN)
+    displayQueue_mergeFillScreen();
+  else if ((command->op == DISPLAYQUEUE_FILL_RECT) && (command->args[2] > 0) && (command->args[3] > 0))
+    displayQueue_mergeFillRect(command);
+  if (count == DISPLAYQUEUE_CAPACITY) {
+    droppedCount++;
+    return false;
+  }
+  commands[DISPLAYQUEUE_INDEX(head + count)] = *command;
+  count++;
+  enqueuedCount++;
+  if (count > highWaterMark)
+    highWaterMark = count;
+  return true;
+}
+
+bool displayQueue_pop(displayQueue_command_t *command) {
+  if (!count)
+    return false;
+  *command = commands[head];
+  head = DISPLAYQUEUE_INDEX(head + 1);
+  count--;
+  return true;
+}
+
+uint16_t displayQueue_count() {
+  return count;
+}
+
+uint16_t displayQueue_getHighWaterMark() {
+  return highWaterMark;
+}
+
+uint32_t displayQueue_getEnqueuedCount() {
+  return enqueuedCount;
+}
+
+uint32_t displayQueue_getMergedCount() {
+  return mergedCount;
+}
+
+uint32_t displayQueue_getDroppedCount() {
+  return droppedCount;
+}
@@ -0,0 +1,91 @@
+/*
+ * displayQueue.h
+ */
+
+#ifndef DISPLAYQUEUE_H_
+#define DISPLAYQUEUE_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// A fixed-size ring of encoded drawing commands. While the command queue is enabled (see
+// display_enableCommandQueue() in display.h), the display_* drawing calls only append a command
+// here; display_drainQueue() runs them later from the main loop, between ticks. Nothing is
+// allocated: a full queue drops the new command and counts it.
+//
+// Two merges are done on the way in, both only when the result on the LCD is the same:
+// - fillScreen removes every queued command that only draws pixels (text keeps its place
+//   because it moves the cursor).
+// - fillRect removes the most recently queued commands while they lie completely inside it.
+
+// Number of commands in the ring (can be overridden from the compiler command line).
+#ifndef DISPLAYQUEUE_CAPACITY
+#define DISPLAYQUEUE_CAPACITY 128
+#endif
+#define DISPLAYQUEUE_MAX_ARGS 7     // drawTriangle/fillTriangle need x0,y0,x1,y1,x2,y2,color.
+#define DISPLAYQUEUE_TEXT_BYTES 24  // Longer text is split over several DISPLAYQUEUE_PRINT commands.
+
+typedef enum {
+  // These only draw pixels.
+  DISPLAYQUEUE_DRAW_LINE,         // x0, y0, x1, y1, color
+  DISPLAYQUEUE_DRAW_THICK_LINE,   // x0, y0, x1, y1, thickness, color
+  DISPLAYQUEUE_DRAW_FAST_VLINE,   // x, y, h, color
+  DISPLAYQUEUE_DRAW_FAST_HLINE,   // x, y, w, color
+  DISPLAYQUEUE_DRAW_RECT,         // x, y, w, h, color
+  DISPLAYQUEUE_FILL_RECT,         // x, y, w, h, color
+  DISPLAYQUEUE_FILL_SCREEN,       // color
+  DISPLAYQUEUE_DRAW_CIRCLE,       // x0, y0, r, color
+  DISPLAYQUEUE_FILL_CIRCLE,       // x0, y0, r, color
+  DISPLAYQUEUE_DRAW_TRIANGLE,     // x0, y0, x1, y1, x2, y2, color
+  DISPLAYQUEUE_FILL_TRIANGLE,     // x0, y0, x1, y1, x2, y2, color
+  DISPLAYQUEUE_DRAW_ROUND_RECT,   // x, y, w, h, radius, color
+  DISPLAYQUEUE_FILL_ROUND_RECT,   // x, y, w, h, radius, color
+  DISPLAYQUEUE_DRAW_BITMAP,       // bitmap.x, y, w, h, color, pixels
+  DISPLAYQUEUE_BLIT,              // blit.x, y, w, h, pixels, palette; format in length
+  DISPLAYQUEUE_DRAW_CHAR,         // x, y, c, color, bg, size
+  // These change state that later commands depend on, so they are never merged away.
+  DISPLAYQUEUE_PRINT,             // text[0..length-1], drawn at the cursor
+  DISPLAYQUEUE_SET_CURSOR,        // x, y
+  DISPLAYQUEUE_SET_TEXT_COLOR,    // color, bg
+  DISPLAYQUEUE_SET_TEXT_SIZE,     // size
+  DISPLAYQUEUE_SET_TEXT_WRAP,     // wrap
+  DISPLAYQUEUE_INVERT_DISPLAY,    // invert
+  DISPLAYQUEUE_SET_ROTATION       // rotation (only queued with AMP rendering, see display.h)
+} displayQueue_op_t;
+
+typedef struct {
+  uint8_t op;      // displayQueue_op_t
+  uint8_t length;  // Text bytes for DISPLAYQUEUE_PRINT, blit_format_t for DISPLAYQUEUE_BLIT.
+  union {
+    int16_t args[DISPLAYQUEUE_MAX_ARGS];
+    char    text[DISPLAYQUEUE_TEXT_BYTES];
+    struct {
+      int16_t x, y, w, h;
+      uint16_t color;
+      const uint8_t *pixels;  // Not copied, must stay valid until the command has run.
+    } bitmap;
+    struct {
+      int16_t x, y, w, h;
+      const void *pixels;       // Not copied either, nor is the palette.
+      const uint16_t *palette;
+    } blit;
+  };
+} displayQueue_command_t;
+
+// Appends a command, merging it with queued commands where possible.
+// Returns false if the queue was full and the command was dropped.
+bool displayQueue_push(const displayQueue_command_t *command);
+
+// Removes the oldest command into *command. Returns false if the queue is empty.
+bool displayQueue_pop(displayQueue_command_t *command);
+
+// Number of commands waiting.
+uint16_t displayQueue_count();
+
+// Statistics.
+uint16_t displayQueue_getHighWaterMark();  // Most commands that were ever waiting at once.
+uint32_t displayQueue_getEnqueuedCount();  // Commands accepted by displayQueue_push().
+uint32_t displayQueue_getMergedCount();    // Queued commands removed by a later fillScreen/fillRect.
+uint32_t displayQueue_getDroppedCount();   // Commands lost because the queue was full.
+
+#endif /* DISPLAYQUEUE_H_ */
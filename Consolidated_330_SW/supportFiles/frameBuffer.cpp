@@ -0,0 +1,417 @@
+/*
+ * frameBuffer.cpp
+ */
+
+#include "frameBuffer.h"
+#include "glyphCache.h"
+#include <string.h>
+
+// Number of pixels covered by a rectangle.
+static int32_t frameBuffer_area(const frameBuffer_rect_t *r) {
+  return (int32_t)(r->x2 - r->x1 + 1) * (int32_t)(r->y2 - r->y1 + 1);
+}
+
+// Smallest rectangle that covers both a and b.
+static frameBuffer_rect_t frameBuffer_union(const frameBuffer_rect_t *a, const frameBuffer_rect_t *b) {
+  frameBuffer_rect_t u;
+  u.x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+  u.y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+  u.x2 = a->x2 > b->x2 ? a->x2 : b->x2;
+  u.y2 = a->y2 > b->y2 ? a->y2 : b->y2;
+  return u;
+}
+
+// Pixels that would be sent needlessly if a and b were flushed as one rectangle.
+static int32_t frameBuffer_mergeWaste(const frameBuffer_rect_t *a, const frameBuffer_rect_t *b) {
+  frameBuffer_rect_t u = frameBuffer_union(a, b);
+  int32_t overlap = 0;
+  int16_t ox1 = a->x1 > b->x1 ? a->x1 : b->x1;
+  int16_t oy1 = a->y1 > b->y1 ? a->y1 : b->y1;
+  int16_t ox2 = a->x2 < b->x2 ? a->x2 : b->x2;
+  int16_t oy2 = a->y2 < b->y2 ? a->y2 : b->y2;
+  if ((ox1 <= ox2) && (oy1 <= oy2))
+    overlap = (int32_t)(ox2 - ox1 + 1) * (int32_t)(oy2 - oy1 + 1);
+  return frameBuffer_area(&u) - frameBuffer_area(a) - frameBuffer_area(b) + overlap;
+}
+
+FrameBuffer::FrameBuffer(frameBuffer_pixel_t *pixels) : Adafruit_TFTLCD() {
+  this->pixels = pixels;
+  dirtyCount = 0;
+  enabled    = false;
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  paletteReset(0);
+#endif
+}
+
+#ifdef FRAMEBUFFER_INDEXED_BITS
+
+// Squared distance between two RGB565 colors, with the 5-bit components scaled to 6 bits.
+static int32_t frameBuffer_colorDistance(uint16_t a, uint16_t b) {
+  int32_t r = ((a >> 11) - (b >> 11)) * 2;
+  int32_t g = ((a >> 5) & 0x3F) - ((b >> 5) & 0x3F);
+  int32_t bl = ((a & 0x1F) - (b & 0x1F)) * 2;
+  return r * r + g * g + bl * bl;
+}
+
+// Frees all palette entries but entry 0, which is set to color.
+void FrameBuffer::paletteReset(uint16_t color) {
+  palette[0] = paletteColors[0] = color;
+  paletteCount = 1;
+  memset(paletteHint, 0, sizeof(paletteHint));
+}
+
+frameBuffer_pixel_t FrameBuffer::toPixel(uint16_t color) {
+  uint8_t hash = color ^ (color >> 8);
+  uint8_t index = paletteHint[hash];
+  if ((index < paletteCount) && (paletteColors[index] == color))
+    return index;
+  uint16_t i;
+  for (i = 0; (i < paletteCount) && (paletteColors[i] != color); i++)
+    ;
+  if (i == paletteCount) {
+    if (paletteCount < FRAMEBUFFER_PALETTE_SIZE) {
+      palette[i] = paletteColors[i] = color;
+      paletteCount++;
+    } else {
+      // Full: draw with the closest color, which is what the entry shows now.
+      i = 0;
+      for (uint16_t j = 1; j < paletteCount; j++)
+        if (frameBuffer_colorDistance(palette[j], color) < frameBuffer_colorDistance(palette[i], color))
+          i = j;
+      return i;
+    }
+  }
+  paletteHint[hash] = i;
+  return i;
+}
+
+#if FRAMEBUFFER_INDEXED_BITS == 4
+frameBuffer_pixel_t FrameBuffer::getPixel(int32_t i) {
+  return (pixels[i >> 1] >> ((i & 1) << 2)) & 0x0F;
+}
+
+void FrameBuffer::setPixel(int32_t i, frameBuffer_pixel_t value) {
+  uint8_t shift = (i & 1) << 2;
+  pixels[i >> 1] = (pixels[i >> 1] & ~(0x0F << shift)) | (value << shift);
+}
+#else
+frameBuffer_pixel_t FrameBuffer::getPixel(int32_t i) {
+  return pixels[i];
+}
+
+void FrameBuffer::setPixel(int32_t i, frameBuffer_pixel_t value) {
+  pixels[i] = value;
+}
+#endif
+
+uint8_t FrameBuffer::paletteIndex(uint16_t color) {
+  return toPixel(color);
+}
+
+void FrameBuffer::setPaletteColor(uint8_t index, uint16_t color) {
+  if ((index >= paletteCount) || (palette[index] == color))
+    return;
+  palette[index] = color;
+  if (!enabled)
+    return;
+  // One dirty span per row; rows with the same span merge into one rectangle.
+  for (int16_t y = 0; y < _height; y++) {
+    int32_t row = (int32_t)y * _width;
+    int16_t minX = _width, maxX = -1;
+    for (int16_t x = 0; x < _width; x++) {
+      if (getPixel(row + x) == index) {
+        if (x < minX) minX = x;
+        maxX = x;
+      }
+    }
+    if (maxX >= 0)
+      markDirty(minX, y, maxX, y);
+  }
+}
+
+#else
+
+frameBuffer_pixel_t FrameBuffer::toPixel(uint16_t color) {
+  return color;
+}
+
+frameBuffer_pixel_t FrameBuffer::getPixel(int32_t i) {
+  return pixels[i];
+}
+
+void FrameBuffer::setPixel(int32_t i, frameBuffer_pixel_t value) {
+  pixels[i] = value;
+}
+
+#endif
+
+void FrameBuffer::enable(bool enable) {
+  if ((enable == enabled) || (enable && !pixels))
+    return;
+  if (enable) {
+    // The LCD contents cannot be read back from the 9341, so start from a known (black) image.
+#ifdef FRAMEBUFFER_INDEXED_BITS
+    paletteReset(0);
+#endif
+    memset(pixels, 0, FRAMEBUFFER_PIXEL_BYTES);
+    dirtyCount = 0;
+    enabled    = true;
+    markDirty(0, 0, _width - 1, _height - 1);
+  } else {
+    flush();
+    enabled = false;
+  }
+}
+
+bool FrameBuffer::isEnabled(void) {
+  return enabled;
+}
+
+uint8_t FrameBuffer::dirtyRectCount(void) {
+  return dirtyCount;
+}
+
+// Records a changed region. Rectangles are coalesced whenever sending them together costs no more
+// than the address window it saves. When the list is full, the oldest rectangle is sent to the LCD
+// right away; the pixels are already in RAM so sending early is always safe.
+void FrameBuffer::markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+  frameBuffer_rect_t r = {x1, y1, x2, y2};
+  uint8_t i = 0;
+  while (i < dirtyCount) {
+    if (frameBuffer_mergeWaste(&dirty[i], &r) <= FRAMEBUFFER_MERGE_SLACK_PIXELS) {
+      // Absorb dirty[i] and look again, the bigger rectangle may now overlap others.
+      r = frameBuffer_union(&dirty[i], &r);
+      removeDirty(i);
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+  if (dirtyCount == FRAMEBUFFER_MAX_DIRTY_RECTS) {
+    pushRect(&dirty[0]);
+    removeDirty(0);
+  }
+  dirty[dirtyCount++] = r;
+}
+
+// Removes dirty[index], keeping the rest in oldest-first order.
+void FrameBuffer::removeDirty(uint8_t index) {
+  dirtyCount--;
+  for (uint8_t i = index; i < dirtyCount; i++)
+    dirty[i] = dirty[i + 1];
+}
+
+// Writes color into the (already clipped) region and marks only the part that actually changed.
+void FrameBuffer::fillBuffer(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+  int16_t minX = x2 + 1, maxX = x1 - 1, minY = y2 + 1, maxY = y1 - 1;
+  frameBuffer_pixel_t value = toPixel(color);
+  for (int16_t y = y1; y <= y2; y++) {
+    int32_t row = (int32_t)y * _width;
+    bool rowChanged = false;
+    for (int16_t x = x1; x <= x2; x++) {
+      if (getPixel(row + x) != value) {
+        setPixel(row + x, value);
+        if (x < minX) minX = x;
+        if (x > maxX) maxX = x;
+        rowChanged = true;
+      }
+    }
+    if (rowChanged) {
+      if (y < minY) minY = y;
+      maxY = y;
+    }
+  }
+  if (minY <= maxY)
+    markDirty(minX, minY, maxX, maxY);
+}
+
+// Copies pixels (srcStride pixels per source row) into the (already clipped) region and marks only
+// the part that actually changed.
+void FrameBuffer::copyBuffer(int16_t x1, int16_t y1, int16_t x2, int16_t y2, const uint16_t *src,
+  int16_t srcStride) {
+  int16_t minX = x2 + 1, maxX = x1 - 1, minY = y2 + 1, maxY = y1 - 1;
+  for (int16_t y = y1; y <= y2; y++, src += srcStride) {
+    int32_t row = (int32_t)y * _width;
+    bool rowChanged = false;
+    for (int16_t x = x1; x <= x2; x++) {
+      frameBuffer_pixel_t value = toPixel(src[x - x1]);
+      if (getPixel(row + x) != value) {
+        setPixel(row + x, value);
+        if (x < minX) minX = x;
+        if (x > maxX) maxX = x;
+        rowChanged = true;
+      }
+    }
+    if (rowChanged) {
+      if (y < minY) minY = y;
+      maxY = y;
+    }
+  }
+  if (minY <= maxY)
+    markDirty(minX, minY, maxX, maxY);
+}
+
+void FrameBuffer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (!enabled) {
+    Adafruit_TFTLCD::drawPixel(x, y, color);
+    return;
+  }
+  if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height)) return;
+  int32_t i = (int32_t)y * _width + x;
+  frameBuffer_pixel_t value = toPixel(color);
+  if (getPixel(i) == value)
+    return;
+  setPixel(i, value);
+  markDirty(x, y, x, y);
+}
+
+void FrameBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (!enabled) {
+    Adafruit_TFTLCD::drawFastHLine(x, y, w, color);
+    return;
+  }
+  fillRect(x, y, w, 1, color);
+}
+
+void FrameBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (!enabled) {
+    Adafruit_TFTLCD::drawFastVLine(x, y, h, color);
+    return;
+  }
+  fillRect(x, y, 1, h, color);
+}
+
+void FrameBuffer::fillRect(int16_t x1, int16_t y1, int16_t w, int16_t h, uint16_t color) {
+  if (!enabled) {
+    Adafruit_TFTLCD::fillRect(x1, y1, w, h, color);
+    return;
+  }
+  int16_t x2, y2;
+  // Same clipping as Adafruit_TFTLCD::fillRect().
+  if( (w            <= 0     ) ||  (h             <= 0      ) ||
+      (x1           >= _width) ||  (y1            >= _height) ||
+     ((x2 = x1+w-1) <  0     ) || ((y2  = y1+h-1) <  0      )) return;
+  if (x1 < 0) x1 = 0;
+  if (y1 < 0) y1 = 0;
+  if (x2 >= _width) x2 = _width - 1;
+  if (y2 >= _height) y2 = _height - 1;
+  fillBuffer(x1, y1, x2, y2, color);
+}
+
+void FrameBuffer::fillScreen(uint16_t color) {
+  if (!enabled) {
+    Adafruit_TFTLCD::fillScreen(color);
+    return;
+  }
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  paletteReset(color);  // Nothing else is left on the screen.
+  memset(pixels, 0, FRAMEBUFFER_PIXEL_BYTES);
+#else
+  for (uint32_t i = 0; i < FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT; i++)
+    pixels[i] = color;
+#endif
+  dirtyCount = 0;
+  markDirty(0, 0, _width - 1, _height - 1);
+}
+
+// While buffering, a cached glyph is copied into RAM in one go. Glyphs the cache will not take
+// go dot by dot through the generic version; the batched LCD version would bypass RAM.
+void FrameBuffer::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (!enabled) {
+    Adafruit_TFTLCD::drawChar(x, y, c, color, bg, size);
+    return;
+  }
+  int16_t x1 = x, y1 = y;
+  int16_t x2 = x + GLYPHCACHE_GLYPH_WIDTH(size) - 1, y2 = y + GLYPHCACHE_GLYPH_HEIGHT(size) - 1;
+  if ((x1 >= _width) || (y1 >= _height) || (x2 < 0) || (y2 < 0)) return;
+  const uint16_t *glyph = glyphCache_get(c, color, bg, size);
+  if (!glyph) {
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+    return;
+  }
+  if (x1 < 0) x1 = 0;
+  if (y1 < 0) y1 = 0;
+  if (x2 >= _width) x2 = _width - 1;
+  if (y2 >= _height) y2 = _height - 1;
+  copyBuffer(x1, y1, x2, y2, &glyph[(y1 - y) * GLYPHCACHE_GLYPH_WIDTH(size) + (x1 - x)],
+    GLYPHCACHE_GLYPH_WIDTH(size));
+}
+
+// Text lines go through drawChar() while buffering, which copies cached glyphs into RAM.
+void FrameBuffer::drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length,
+  uint16_t color, uint16_t bg, uint8_t size) {
+  if (enabled)
+    Adafruit_GFX::drawTextLine(x, y, text, length, color, bg, size);
+  else
+    Adafruit_TFTLCD::drawTextLine(x, y, text, length, color, bg, size);
+}
+
+// While buffering, each visible row is converted and copied into RAM.
+void FrameBuffer::blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels,
+  blit_format_t format, const uint16_t *palette) {
+  if (!enabled) {
+    Adafruit_TFTLCD::blit(x, y, w, h, pixels, format, palette);
+    return;
+  }
+  int16_t x1, y1, x2, y2;
+  uint16_t row[FRAMEBUFFER_WIDTH];
+  blit_source_t source;
+  // Same clipping as Adafruit_TFTLCD::blit().
+  if ((w <= 0) || (h <= 0) || (x >= _width) || (y >= _height) ||
+      ((x2 = x + w - 1) < 0) || ((y2 = y + h - 1) < 0)) return;
+  x1 = (x < 0) ? 0 : x;
+  y1 = (y < 0) ? 0 : y;
+  if (x2 >= _width) x2 = _width - 1;
+  if (y2 >= _height) y2 = _height - 1;
+  blit_begin(&source, pixels, format, palette, w);
+  blit_read(&source, NULL, (uint32_t)(y1 - y) * w);
+  for (int16_t py = y1; py <= y2; py++) {
+    blit_read(&source, NULL, x1 - x);
+    blit_read(&source, row, x2 - x1 + 1);
+    blit_read(&source, NULL, x + w - 1 - x2);
+    copyBuffer(x1, py, x2, py, row, 0);
+  }
+}
+
+// The buffer holds the image in display coordinates, so a new rotation repaints it in the new
+// orientation on the next flush.
+void FrameBuffer::setRotation(uint8_t r) {
+  Adafruit_TFTLCD::setRotation(r);
+  if (enabled) {
+    dirtyCount = 0;
+    markDirty(0, 0, _width - 1, _height - 1);
+  }
+}
+
+// Sends one rectangle from RAM to the LCD: one address window, one GRAM write.
+void FrameBuffer::pushRect(const frameBuffer_rect_t *r) {
+  setAddrWindow(r->x1, r->y1, r->x2, r->y2);
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  // Each row is expanded to RGB565 through the palette on its way out.
+  uint16_t row[FRAMEBUFFER_WIDTH];
+  int16_t w = r->x2 - r->x1 + 1;
+  for (int16_t y = r->y1; y <= r->y2; y++) {
+    int32_t i = (int32_t)y * _width + r->x1;
+    for (int16_t x = 0; x < w; x++)
+      row[x] = palette[getPixel(i + x)];
+    pushColors(row, w, y == r->y1);
+  }
+#else
+  if ((r->x1 == 0) && (r->x2 == _width - 1)) {
+    // Full-width rows are contiguous in RAM: one push for the whole rectangle.
+    pushColors(&pixels[(int32_t)r->y1 * _width], (uint32_t)_width * (r->y2 - r->y1 + 1), true);
+    return;
+  }
+  // Only the first push issues the GRAM write command.
+  for (int16_t y = r->y1; y <= r->y2; y++)
+    pushColors(&pixels[(int32_t)y * _width + r->x1], r->x2 - r->x1 + 1, y == r->y1);
+#endif
+}
+
+void FrameBuffer::flush(void) {
+  if (!enabled)
+    return;
+  for (uint8_t i = 0; i < dirtyCount; i++)
+    pushRect(&dirty[i]);
+  dirtyCount = 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * frameBuffer.h
+ */
+
+#ifndef FRAMEBUFFER_H_
+#define FRAMEBUFFER_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+#include "Adafruit_TFTLCD.h"
+
+// A RAM copy of the LCD (320x240, RGB565 or palette indexes) that sits between Adafruit_GFX and the LCD controller.
+// When enabled, drawing only touches RAM and records which rectangles changed. flush() then sends
+// each changed rectangle to the LCD with a single address window and one long GRAM write.
+// When disabled, every call goes straight to Adafruit_TFTLCD as before.
+
+#define FRAMEBUFFER_WIDTH  320
+#define FRAMEBUFFER_HEIGHT 240
+
+// Uncomment to store a palette index per pixel instead of RGB565: 8 bits (75 KB) or 4 bits
+// (37.5 KB) instead of 16 (150 KB). Each color gets a palette entry the first time it is drawn and
+// flush() expands the indexes back to RGB565. Once all entries are used, new colors are drawn with
+// the closest color in the palette. fillScreen() frees every entry but its own.
+//#define FRAMEBUFFER_INDEXED_BITS 8
+
+#ifdef FRAMEBUFFER_INDEXED_BITS
+#define FRAMEBUFFER_BITS_PER_PIXEL FRAMEBUFFER_INDEXED_BITS
+#define FRAMEBUFFER_PALETTE_SIZE (1 << FRAMEBUFFER_INDEXED_BITS)
+typedef uint8_t frameBuffer_pixel_t;   // A palette index (two per byte with 4 bits).
+#else
+#define FRAMEBUFFER_BITS_PER_PIXEL 16
+typedef uint16_t frameBuffer_pixel_t;  // RGB565.
+#endif
+#define FRAMEBUFFER_PIXEL_BYTES (FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT * FRAMEBUFFER_BITS_PER_PIXEL / 8)
+// Size of the pixel array handed to the constructor.
+#define FRAMEBUFFER_STORAGE_SIZE (FRAMEBUFFER_PIXEL_BYTES / sizeof(frameBuffer_pixel_t))
+#define FRAMEBUFFER_MAX_DIRTY_RECTS 8  // Dirty rectangles tracked before the oldest is sent early.
+
+// Cost model used to decide when two dirty rectangles are better sent as one.
+// Opening an address window on the 9341 costs CASET (1+4) + PASET (1+4) + RAMWR (1) = 11 bus writes.
+#define FRAMEBUFFER_WINDOW_SETUP_BUS_WRITES 11
+#define FRAMEBUFFER_BUS_WRITES_PER_PIXEL 2
+// Two rectangles merge when the extra pixels sent cost no more than the window that is saved.
+#define FRAMEBUFFER_MERGE_SLACK_PIXELS \
+  (FRAMEBUFFER_WINDOW_SETUP_BUS_WRITES / FRAMEBUFFER_BUS_WRITES_PER_PIXEL)
+
+// Inclusive corners of a dirty region, in current (rotated) display coordinates.
+typedef struct {
+  int16_t x1, y1, x2, y2;
+} frameBuffer_rect_t;
+
+class FrameBuffer : public Adafruit_TFTLCD {
+
+ public:
+
+  // pixels (FRAMEBUFFER_STORAGE_SIZE entries) holds the RAM copy. The storage is not part of the
+  // object, so a build that never buffers reserves none: without it enable(true) does nothing.
+  FrameBuffer(frameBuffer_pixel_t *pixels = NULL);
+
+  // Adafruit_GFX/Adafruit_TFTLCD primitives, redirected to RAM while enabled.
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillScreen(uint16_t color);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+  void drawTextLine(int16_t x, int16_t y, const uint8_t *text, size_t length, uint16_t color,
+    uint16_t bg, uint8_t size);
+  void blit(int16_t x, int16_t y, int16_t w, int16_t h, const void *pixels, blit_format_t format,
+            const uint16_t *palette);
+  void setRotation(uint8_t r);
+
+  // Turns buffering on or off (on only with storage). Turning it on clears the buffer to black and marks the whole
+  // screen dirty so the next flush makes the LCD match the buffer. Turning it off flushes first.
+  void enable(bool enable);
+  bool isEnabled(void);
+  // Sends all dirty rectangles to the LCD, one address window each. Does nothing when disabled.
+  void flush(void);
+  // Number of dirty rectangles waiting for the next flush.
+  uint8_t dirtyRectCount(void);
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  // The palette entry that color is drawn with (allocated if need be).
+  uint8_t paletteIndex(uint16_t color);
+  // Palette animation: every pixel drawn with entry index shows color from now on, and only the
+  // rows those pixels are on are sent at the next flush. Drawing with the entry's original color
+  // still uses the entry.
+  void setPaletteColor(uint8_t index, uint16_t color);
+#endif
+
+ private:
+
+  void markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+  void removeDirty(uint8_t index);
+  void pushRect(const frameBuffer_rect_t *r);
+  void fillBuffer(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  void copyBuffer(int16_t x1, int16_t y1, int16_t x2, int16_t y2, const uint16_t *src, int16_t srcStride);
+  frameBuffer_pixel_t toPixel(uint16_t color);
+  frameBuffer_pixel_t getPixel(int32_t i);
+  void setPixel(int32_t i, frameBuffer_pixel_t value);
+
+  frameBuffer_pixel_t *pixels;
+#ifdef FRAMEBUFFER_INDEXED_BITS
+  void paletteReset(uint16_t color);
+  uint16_t           palette[FRAMEBUFFER_PALETTE_SIZE];      // What each entry shows.
+  uint16_t           paletteColors[FRAMEBUFFER_PALETTE_SIZE];  // The color drawn to get each entry.
+  uint16_t           paletteCount;
+  uint8_t            paletteHint[256];  // Entry last found for each color hash, checked before searching.
+#endif
+  frameBuffer_rect_t dirty[FRAMEBUFFER_MAX_DIRTY_RECTS];
+  uint8_t            dirtyCount;
+  bool               enabled;
+};
+
+#endif /* FRAMEBUFFER_H_ */
@@ -7,7 +7,6 @@
 // Convenience functions for accessing the global timer in the ZYNQ ARM core.
 
 #include <stdio.h>
-#include "xil_io.h"  // Used for low-level input and output.
 #include "globalTimer.h"
 
 // Define register offsets below from ARM manual
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include "xparameters.h"
 #include "xil_types.h"
+#include "hal.h"
 
 // These defines are used to compute seconds, minutes, etc., from the global timer values.
 // The global timer clock is 1/2 the processor frequency (650 MHz for ZYBO board
@@ -18,10 +19,10 @@
 #define GLOBAL_TIMER_TICKS_PER_SECOND GLOBAL_TIMER_CLOCK_FREQUENCY
 
 #define globalTimer_readRegister(registerOffset) \
- Xil_In32(XPAR_GLOBAL_TMR_BASEADDR + registerOffset)
+ hal_globalTimerReadRegister(registerOffset)
 
 #define globalTimer_writeRegister(registerOffset, registerValue) \
-  Xil_Out32((XPAR_GLOBAL_TMR_BASEADDR + registerOffset), (registerValue))
+  hal_globalTimerWriteRegister((registerOffset), (registerValue))
 
 // These functions are available to the user.
 
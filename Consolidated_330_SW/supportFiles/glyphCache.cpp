@@ -0,0 +1,84 @@
+/*
+ * glyphCache.cpp
+ */
+
+#include "glyphCache.h"
+#include "Adafruit_GFX.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define GLYPHCACHE_POOL_PIXELS (GLYPHCACHE_MEMORY_BUDGET_BYTES / sizeof(uint16_t))
+
+// Packs the lookup key into one value so a lookup is a single compare per entry.
+#define GLYPHCACHE_KEY(c, size, color, bg) \
+  (((uint64_t)(c) << 40) | ((uint64_t)(size) << 32) | ((uint64_t)(color) << 16) | (uint64_t)(bg))
+
+typedef struct {
+  uint64_t  key;
+  uint16_t *pixels;
+} glyphCache_entry_t;
+
+static uint16_t pool[GLYPHCACHE_POOL_PIXELS];          // Glyph pixels, handed out front to back.
+static uint32_t poolUsed = 0;                          // Pixels of the pool in use.
+static glyphCache_entry_t entries[GLYPHCACHE_MAX_GLYPHS];
+static uint8_t  entryCount = 0;
+static uint32_t hitCount = 0;
+static uint32_t missCount = 0;
+
+// Expands character c into pixels, one font dot becomes a size x size block.
+static void glyphCache_expand(uint16_t *pixels, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  uint16_t width = GLYPHCACHE_GLYPH_WIDTH(size);
+  for (uint8_t j = 0; j < 8; j++) {
+    uint16_t *row = &pixels[(uint32_t)j * size * width];
+    for (uint8_t i = 0; i < 6; i++) {
+      uint16_t dotColor = (Adafruit_GFX::glyphColumn(c, i) & (1 << j)) ? color : bg;
+      for (uint8_t k = 0; k < size; k++)
+        row[i * size + k] = dotColor;
+    }
+    // The remaining size-1 scanlines of this font row are copies of the first.
+    for (uint8_t k = 1; k < size; k++)
+      for (uint16_t x = 0; x < width; x++)
+        row[(uint32_t)k * width + x] = row[x];
+  }
+}
+
+const uint16_t *glyphCache_get(unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if ((bg == color) || (size == 0))
+    return NULL;
+  uint64_t key = GLYPHCACHE_KEY(c, size, color, bg);
+  for (uint8_t i = 0; i < entryCount; i++) {
+    if (entries[i].key == key) {
+      hitCount++;
+      return entries[i].pixels;
+    }
+  }
+  missCount++;
+  uint32_t glyphPixels = (uint32_t)GLYPHCACHE_GLYPH_WIDTH(size) * GLYPHCACHE_GLYPH_HEIGHT(size);
+  if (glyphPixels > GLYPHCACHE_POOL_PIXELS)
+    return NULL;  // Would never fit.
+  if ((poolUsed + glyphPixels > GLYPHCACHE_POOL_PIXELS) || (entryCount == GLYPHCACHE_MAX_GLYPHS))
+    glyphCache_clear();  // Start over with the glyphs the current screen is using.
+  glyphCache_entry_t *entry = &entries[entryCount++];
+  entry->key = key;
+  entry->pixels = &pool[poolUsed];
+  poolUsed += glyphPixels;
+  glyphCache_expand(entry->pixels, c, color, bg, size);
+  return entry->pixels;
+}
+
+void glyphCache_clear() {
+  entryCount = 0;
+  poolUsed = 0;
+}
+
+uint32_t glyphCache_getHitCount() {
+  return hitCount;
+}
+
+uint32_t glyphCache_getMissCount() {
+  return missCount;
+}
+
+uint32_t glyphCache_getBytesUsed() {
+  return poolUsed * sizeof(uint16_t);
+}
@@ -0,0 +1,40 @@
+/*
+ * glyphCache.h
+ */
+
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include "arduinoTypes.h"
+
+// Keeps fully expanded RGB565 copies of the glyphs a screen uses (e.g., the clock digits), keyed by
+// (character, size, foreground, background). A glyph is expanded the first time it is drawn and
+// after that is streamed straight from RAM. Only opaque text (bg != color) is cached.
+// Adafruit_TFTLCD::drawChar() and FrameBuffer::drawChar() use it, so display_drawChar() and
+// display_println() pick it up without any changes to the callers.
+
+// All glyph pixels share this much RAM (can be overridden from the compiler command line). When a
+// new glyph does not fit, the whole cache is emptied and refilled with whatever the current screen
+// draws next.
+#ifndef GLYPHCACHE_MEMORY_BUDGET_BYTES
+#define GLYPHCACHE_MEMORY_BUDGET_BYTES (32 * 1024)
+#endif
+#define GLYPHCACHE_MAX_GLYPHS 64
+
+#define GLYPHCACHE_GLYPH_WIDTH(size)  (6 * (size))
+#define GLYPHCACHE_GLYPH_HEIGHT(size) (8 * (size))
+
+// Returns the expanded glyph, GLYPHCACHE_GLYPH_WIDTH(size) x GLYPHCACHE_GLYPH_HEIGHT(size) pixels
+// in row-major order. Returns NULL if the glyph cannot be cached (transparent, or too large for the
+// budget); the caller then draws it the uncached way. The pointer is only good until the next call.
+const uint16_t *glyphCache_get(unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+// Throws away all cached glyphs.
+void glyphCache_clear();
+
+// Statistics.
+uint32_t glyphCache_getHitCount();
+uint32_t glyphCache_getMissCount();
+uint32_t glyphCache_getBytesUsed();
+
+#endif /* GLYPHCACHE_H_ */
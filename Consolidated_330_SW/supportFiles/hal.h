@@ -0,0 +1,111 @@
+/*
+ * hal.h
+ */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// Hardware-abstraction layer. The drivers in supportFiles (lcd, spi, leds, mio, interrupts,
+// globalTimer) and src/Drivers (buttons, switches) reach the hardware only through these calls.
+// Two implementations exist; link exactly one of them:
+//   halZybo.c - the ZYBO board (Xilinx drivers, AXI registers). This is what the SDK builds.
+//   halSim.c  - a Linux simulator (build with -DHOST_BUILD). It models the LCD controller, the
+//               touch controller behind the SPI core, the buttons, switches, LEDs and the private
+//               and global timers. See halSim.h for the calls that drive it.
+
+#define HAL_STATUS_OK   0
+#define HAL_STATUS_FAIL 1
+
+// ********************************** AXI GPIO **********************************
+// The AXI GPIO blocks in the programmable logic. Only channel 1 of each block is used.
+typedef enum {
+  HAL_GPIO_TFT_CONTROL,    // RD, WR and DCX pins for the LCD controller (see lcd.h).
+  HAL_GPIO_TFT_DATA_BUS,   // 8-bit data bus to the LCD controller.
+  HAL_GPIO_LEDS,           // LD3 - LD0.
+  HAL_GPIO_PUSH_BUTTONS,   // BTN3 - BTN0.
+  HAL_GPIO_SLIDE_SWITCHES, // SW3 - SW0.
+  HAL_GPIO_COUNT
+} hal_gpio_t;
+
+// Returns HAL_STATUS_OK if the GPIO block could be initialized.
+int hal_gpioInit(hal_gpio_t gpio);
+// Bits set in inputMask are inputs, cleared bits are outputs (same sense as the GPIO tri-state register).
+void hal_gpioSetDataDirection(hal_gpio_t gpio, uint32_t inputMask);
+uint32_t hal_gpioRead(hal_gpio_t gpio);
+void hal_gpioWrite(hal_gpio_t gpio, uint32_t value);
+
+// ********************************** MIO (PS GPIO) **********************************
+// Returns HAL_STATUS_OK if the PS GPIO could be initialized.
+int hal_mioInit();
+// direction: 1 = output, 0 = input.
+void hal_mioSetDirectionPin(uint8_t pin, uint8_t direction);
+void hal_mioSetOutputEnablePin(uint8_t pin, uint8_t enable);
+void hal_mioWritePin(uint8_t pin, uint8_t value);
+uint8_t hal_mioReadPin(uint8_t pin);
+void hal_mioWriteBank(uint8_t bank, uint32_t value);
+
+// ********************************** Memory-mapped cores **********************************
+// Registers of the AXI SPI core, offsets are defined in spi.h.
+uint32_t hal_spiReadRegister(uint32_t regOffset);
+void hal_spiWriteRegister(uint32_t regOffset, uint32_t value);
+
+// Registers of the ARM global timer, offsets are defined in globalTimer.c.
+uint32_t hal_globalTimerReadRegister(uint32_t regOffset);
+void hal_globalTimerWriteRegister(uint32_t regOffset, uint32_t value);
+
+// ********************************** Interrupts **********************************
+typedef void (*hal_isr_t)(void *callBackRef);
+
+// Sets up the interrupt controller, the ARM private timer and the XADC and connects the two ISRs.
+// Enables the interrupts at the controller, but not at the devices or the ARM.
+// Returns HAL_STATUS_OK if everything could be initialized.
+int hal_interruptsInit(hal_isr_t timerIsr, hal_isr_t sysMonIsr, bool printFailedStatusFlag);
+void hal_interruptsEnableArm();
+void hal_interruptsDisableArm();
+// Connects the ISR of the AXI SPI core and enables it at the interrupt controller (call it after
+// hal_interruptsInit()). Returns HAL_STATUS_FAIL if the hardware design does not route the SPI
+// interrupt to the controller; on the board that is opted into with HAL_SPI_INTERRUPT_ID (halZybo.c).
+int hal_interruptsConnectSpi(hal_isr_t spiIsr);
+// The same for the INT line of the STMPE610 touch controller (HAL_TOUCH_INTERRUPT_ID).
+int hal_interruptsConnectTouch(hal_isr_t touchIsr);
+
+// ARM private timer.
+void hal_privateTimerStart();
+void hal_privateTimerStop();
+void hal_privateTimerEnableInterrupt();
+void hal_privateTimerDisableInterrupt();
+void hal_privateTimerClearInterruptStatus();
+void hal_privateTimerSetLoadValue(uint32_t loadValue);
+void hal_privateTimerSetPrescaler(uint8_t prescaler);
+uint32_t hal_privateTimerGetCounterValue();
+
+// XADC (SysMon).
+void hal_sysMonEnableGlobalInterrupts();
+void hal_sysMonDisableGlobalInterrupts();
+void hal_sysMonEnableEocInterrupts();
+void hal_sysMonDisableEocInterrupts();
+// Clears all pending XADC interrupts. Returns true if an end-of-conversion was among them.
+bool hal_sysMonAcknowledgeInterrupts();
+// Latest conversion result from aux. channel 14 (16-bit, 12 significant bits at the top).
+uint16_t hal_sysMonGetAdcData();
+
+// ********************************** AMP **********************************
+// Memory that both Cortex-A9s see uncached (32 KB of the OCM from 0xFFFF0000 on the board), used by amp.c.
+// Returns its address; on the board the first call also makes it uncached for the calling CPU.
+#define HAL_AMP_SHARED_MEMORY_BYTES 0x8000
+void *hal_ampSharedMemory();
+// Starts CPU1 at entry. On the board CPU1's program must already be in memory there; on the
+// simulator entry runs in a thread of its own.
+void hal_ampStartCpu1(void (*entry)());
+// Called while a CPU waits for the other one. The board just spins; the simulator lets the
+// other thread run.
+void hal_ampIdle();
+
+// ********************************** Time **********************************
+// Blocks for roughly msDelay milliseconds (timer interrupts keep running).
+void hal_msDelay(long msDelay);
+
+#endif /* HAL_H_ */
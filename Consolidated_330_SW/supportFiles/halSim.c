@@ -0,0 +1,929 @@
+/*
+ * halSim.c
+ */
+
+// Linux simulator implementation of hal.h. See halSim.h for what is modelled and how time passes.
+// Build with -DHOST_BUILD and link this file in place of halZybo.c. Excluded from the SDK build.
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "hal.h"
+#include "halSim.h"
+#include "lcd.h"
+#include "spi.h"
+#include "registers.h"
+#include "Adafruit_STMPE610.h"
+
+// ********************************** Time **********************************
+
+static uint64_t simTime = 0;         // Simulated time in ticks.
+static uint64_t axiAccessCount = 0;  // HAL register accesses so far.
+
+static void halSim_access();
+
+// ********************************** ILI9341 model **********************************
+
+#define LCD_GRAM_COLUMNS 240  // Physical panel, portrait.
+#define LCD_GRAM_ROWS    320
+#define ILI9341_MEMORYWRITECONTINUE 0x3C
+
+static uint16_t lcdGram[LCD_GRAM_COLUMNS * LCD_GRAM_ROWS];
+static uint32_t lcdControlPins = 0;    // Last value written to the control GPIO.
+static uint32_t lcdDataBusOut = 0;     // Last value written to the data-bus GPIO.
+static uint32_t lcdDataBusInputs = 0;  // Data-bus tri-state register (1 = input).
+static uint8_t  lcdCommand = 0;        // Command that the following parameter bytes belong to.
+static uint8_t  lcdParameterCount = 0; // Parameter bytes received for lcdCommand.
+static uint32_t lcdParameters = 0;     // CASET/PASET parameters, shifted in MSB first.
+static uint8_t  lcdMadctl = 0;         // Memory access control (rotation).
+static uint16_t lcdStartColumn = 0, lcdEndColumn = LCD_GRAM_COLUMNS - 1;
+static uint16_t lcdStartPage = 0, lcdEndPage = LCD_GRAM_ROWS - 1;
+static uint16_t lcdColumn = 0, lcdPage = 0;  // GRAM address counter (logical, before MADCTL).
+static bool     lcdHighBytePending = false;
+static uint8_t  lcdHighByte = 0;
+static bool     lcdScrolling = false;      // Vertical scroll mode (VSCRSADD until NORON).
+static uint16_t lcdScrollTopFixed = 0;     // VSCRDEF: panel lines that do not scroll at the top,
+static uint16_t lcdScrollLines = LCD_GRAM_ROWS;  // lines that scroll,
+static uint16_t lcdScrollStart = 0;        // VSCRSADD: GRAM line shown first in the scroll area.
+static uint64_t lcdPixelWriteCount = 0;    // Pixels written to GRAM so far.
+
+static void lcdModel_reset() {
+  lcdMadctl = 0;
+  lcdStartColumn = 0;
+  lcdEndColumn = LCD_GRAM_COLUMNS - 1;
+  lcdStartPage = 0;
+  lcdEndPage = LCD_GRAM_ROWS - 1;
+  lcdScrolling = false;
+  lcdScrollTopFixed = 0;
+  lcdScrollLines = LCD_GRAM_ROWS;
+  lcdScrollStart = 0;
+}
+
+// GRAM line that the panel shows on line displayLine (vertical scrolling).
+static int16_t lcdModel_shownLine(int16_t displayLine) {
+  if (!lcdScrolling || (displayLine < lcdScrollTopFixed) ||
+      (displayLine >= lcdScrollTopFixed + lcdScrollLines) || !lcdScrollLines)
+    return displayLine;
+  return lcdScrollTopFixed +
+      (displayLine - lcdScrollTopFixed + lcdScrollStart - lcdScrollTopFixed + lcdScrollLines) % lcdScrollLines;
+}
+
+// Stores one pixel at the address counter and advances it through the window.
+static void lcdModel_writePixel(uint16_t color) {
+  lcdPixelWriteCount++;
+  int16_t physicalColumn = lcdColumn, physicalRow = lcdPage;
+  if (lcdMadctl & ILI9341_MADCTL_MV) {  // Row/column exchange.
+    physicalColumn = lcdPage;
+    physicalRow = lcdColumn;
+  }
+  if (lcdMadctl & ILI9341_MADCTL_MX)
+    physicalColumn = LCD_GRAM_COLUMNS - 1 - physicalColumn;
+  if (lcdMadctl & ILI9341_MADCTL_MY)
+    physicalRow = LCD_GRAM_ROWS - 1 - physicalRow;
+  if ((physicalColumn >= 0) && (physicalColumn < LCD_GRAM_COLUMNS) &&
+      (physicalRow >= 0) && (physicalRow < LCD_GRAM_ROWS))
+    lcdGram[physicalRow * LCD_GRAM_COLUMNS + physicalColumn] = color;
+  if (++lcdColumn > lcdEndColumn) {
+    lcdColumn = lcdStartColumn;
+    if (++lcdPage > lcdEndPage)
+      lcdPage = lcdStartPage;
+  }
+}
+
+// Handles one byte latched on a WR rising edge. dataMode is the DCX pin (0 = command).
+static void lcdModel_writeByte(bool dataMode, uint8_t value) {
+  if (!dataMode) {
+    lcdCommand = value;
+    lcdParameterCount = 0;
+    lcdParameters = 0;
+    lcdHighBytePending = false;
+    if (value == ILI9341_MEMORYWRITE) {
+      lcdColumn = lcdStartColumn;
+      lcdPage = lcdStartPage;
+    } else if (value == ILI9341_SOFTRESET) {
+      lcdModel_reset();
+    } else if (value == ILI9341_NORMALDISP) {
+      lcdScrolling = false;
+    }
+    return;
+  }
+  switch (lcdCommand) {
+  case ILI9341_COLADDRSET:
+  case ILI9341_PAGEADDRSET:
+    lcdParameters = (lcdParameters << 8) | value;
+    if (++lcdParameterCount == 4) {
+      if (lcdCommand == ILI9341_COLADDRSET) {
+        lcdStartColumn = lcdParameters >> 16;
+        lcdEndColumn = lcdParameters & 0xFFFF;
+      } else {
+        lcdStartPage = lcdParameters >> 16;
+        lcdEndPage = lcdParameters & 0xFFFF;
+      }
+    }
+    break;
+  case ILI9341_MADCTL:
+    if (lcdParameterCount++ == 0)
+      lcdMadctl = value;
+    break;
+  case ILI9341_VERTSCROLLDEF:  // TFA, VSA, BFA, 16 bits each.
+    lcdParameters = (lcdParameters << 8) | value;
+    if (++lcdParameterCount == 2)
+      lcdScrollTopFixed = lcdParameters & 0xFFFF;
+    else if (lcdParameterCount == 4)
+      lcdScrollLines = lcdParameters & 0xFFFF;
+    break;
+  case ILI9341_VERTSCROLLSTART:
+    lcdParameters = (lcdParameters << 8) | value;
+    if (++lcdParameterCount == 2) {
+      lcdScrollStart = lcdParameters & 0xFFFF;
+      lcdScrolling = true;
+    }
+    break;
+  case ILI9341_MEMORYWRITE:
+  case ILI9341_MEMORYWRITECONTINUE:
+    if (!lcdHighBytePending) {  // 16-bit pixels arrive high byte first (pixel format 0x55).
+      lcdHighByte = value;
+      lcdHighBytePending = true;
+    } else {
+      lcdHighBytePending = false;
+      lcdModel_writePixel((lcdHighByte << 8) | value);
+    }
+    break;
+  default:  // Power, gamma, etc. have no visible effect here.
+    break;
+  }
+}
+
+// The controller latches the data bus on the rising edge of WR.
+static void lcdModel_writeControlPins(uint32_t value) {
+  bool wrRisingEdge = !(lcdControlPins & LCD_WR_BIT_MASK) && (value & LCD_WR_BIT_MASK);
+  lcdControlPins = value;
+  if (wrRisingEdge && !lcdDataBusInputs)
+    lcdModel_writeByte(value & LCD_DCX_BIT_MASK, lcdDataBusOut);
+}
+
+uint16_t halSim_lcdReadPixel(int16_t x, int16_t y) {
+  if ((x < 0) || (y < 0) || (x >= HALSIM_LCD_WIDTH) || (y >= HALSIM_LCD_HEIGHT))
+    return 0;
+  // Inverse of the MADCTL mapping for rotation 1 (MX | MY | MV), then vertical scrolling.
+  return lcdGram[lcdModel_shownLine(LCD_GRAM_ROWS - 1 - x) * LCD_GRAM_COLUMNS + (LCD_GRAM_COLUMNS - 1 - y)];
+}
+
+uint64_t halSim_getLcdPixelWriteCount() {
+  return lcdPixelWriteCount;
+}
+
+int halSim_lcdDumpPpm(const char *fileName) {
+  FILE *file = fopen(fileName, "wb");
+  if (!file) {
+    printf("halSim_lcdDumpPpm: could not open %s.\n\r", fileName);
+    return 1;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", HALSIM_LCD_WIDTH, HALSIM_LCD_HEIGHT);
+  for (int16_t y = 0; y < HALSIM_LCD_HEIGHT; y++) {
+    for (int16_t x = 0; x < HALSIM_LCD_WIDTH; x++) {
+      uint16_t color = halSim_lcdReadPixel(x, y);
+      uint8_t r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+      uint8_t rgb[3] = {(uint8_t)((r << 3) | (r >> 2)), (uint8_t)((g << 2) | (g >> 4)),
+                        (uint8_t)((b << 3) | (b >> 2))};
+      fwrite(rgb, 1, sizeof(rgb), file);
+    }
+  }
+  fclose(file);
+  return 0;
+}
+
+// ********************************** STMPE610 model **********************************
+
+#define STMPE_CHIP_ID_VALUE 0x0811
+#define STMPE_ID_VER 0x02
+#define STMPE_TSC_CTRL_STA 0x80      // Touch detected (read-only).
+#define STMPE_TSC_DATA_XYZ 0x57      // FIFO data (the driver reads it as 0xD7 = read bit + 0x57).
+
+static uint8_t  touchRegisters[256] = {STMPE_CHIP_ID_VALUE >> 8, STMPE_CHIP_ID_VALUE & 0xFF, STMPE_ID_VER};  // Power-on values.
+static uint8_t  touchFifo[STMPE_FIFO_DEPTH][STMPE_SAMPLE_BYTES];
+static uint8_t  touchFifoHead = 0, touchFifoCount = 0;
+static uint8_t  touchFifoByte = 0;   // Next byte of the head sample to be read.
+static bool     touchFifoOverflow = false;
+static bool     touched = false;
+static uint16_t touchX = 0, touchY = 0;
+static uint8_t  touchZ = 0;
+static uint64_t nextTouchSampleTime = 0;
+
+// SPI session state: the STMPE610 answers a read one byte late, i.e. the register addressed by
+// byte n comes back while byte n+2 is shifted (this is why readRegister8() sends a dummy byte).
+static uint8_t  touchSessionByte = 0;  // Bytes shifted in since slave select was asserted.
+static bool     touchSessionRead = false;
+static uint8_t  touchSessionAddress = 0;
+static uint8_t  touchReadPipeline[2];
+static uint64_t touchSessionCount = 0;  // Slave-select assertions, i.e., SPI transactions.
+
+static void touchModel_reset() {
+  memset(touchRegisters, 0, sizeof(touchRegisters));
+  touchRegisters[0x00] = STMPE_CHIP_ID_VALUE >> 8;
+  touchRegisters[0x01] = STMPE_CHIP_ID_VALUE & 0xFF;
+  touchRegisters[0x02] = STMPE_ID_VER;
+  touchFifoHead = touchFifoCount = touchFifoByte = 0;
+  touchFifoOverflow = false;
+}
+
+static bool touchModel_isEnabled() {
+  return (touchRegisters[STMPE_TSC_CTRL] & STMPE_TSC_CTRL_EN) &&
+         !(touchRegisters[STMPE_FIFO_STA] & STMPE_FIFO_STA_RESET);
+}
+
+static void touchModel_pushSample() {
+  if (touchFifoCount == STMPE_FIFO_DEPTH) {
+    touchFifoOverflow = true;
+    return;
+  }
+  uint8_t *sample = touchFifo[(touchFifoHead + touchFifoCount) % STMPE_FIFO_DEPTH];
+  sample[0] = touchX >> 4;
+  sample[1] = ((touchX & 0x0F) << 4) | ((touchY >> 8) & 0x0F);
+  sample[2] = touchY & 0xFF;
+  sample[3] = touchZ;
+  touchFifoCount++;
+  uint8_t threshold = touchRegisters[STMPE_FIFO_TH];
+  if (threshold && (touchFifoCount >= threshold))
+    touchRegisters[STMPE_INT_STA] |= STMPE_INT_STA_FIFOTH;
+}
+
+// Adds the samples the controller would have taken since the last call.
+static void touchModel_update() {
+  while (touched && (simTime >= nextTouchSampleTime)) {
+    if (touchModel_isEnabled())
+      touchModel_pushSample();
+    nextTouchSampleTime += HALSIM_TOUCH_SAMPLE_PERIOD_TICKS;
+  }
+}
+
+static uint8_t touchModel_readRegister(uint8_t address) {
+  switch (address) {
+  case STMPE_TSC_CTRL:
+    return touchRegisters[address] | ((touched && touchModel_isEnabled()) ? STMPE_TSC_CTRL_STA : 0);
+  case STMPE_FIFO_STA: {
+    uint8_t status = touchRegisters[address] & STMPE_FIFO_STA_RESET;
+    uint8_t threshold = touchRegisters[STMPE_FIFO_TH];
+    if (!touchFifoCount) status |= STMPE_FIFO_STA_EMPTY;
+    if (touchFifoCount == STMPE_FIFO_DEPTH) status |= STMPE_FIFO_STA_FULL;
+    if (touchFifoOverflow) status |= STMPE_FIFO_STA_OFLOW;
+    if (threshold && (touchFifoCount >= threshold)) status |= STMPE_FIFO_STA_THTRIG;
+    return status;
+  }
+  case STMPE_FIFO_SIZE:
+    return touchFifoCount;
+  case STMPE_TSC_DATA_XYZ: {
+    if (!touchFifoCount)
+      return 0;
+    uint8_t value = touchFifo[touchFifoHead][touchFifoByte];
+    if (++touchFifoByte == STMPE_SAMPLE_BYTES) {  // Whole sample read, pop it.
+      touchFifoByte = 0;
+      touchFifoHead = (touchFifoHead + 1) % STMPE_FIFO_DEPTH;
+      touchFifoCount--;
+    }
+    return value;
+  }
+  default:
+    return touchRegisters[address];
+  }
+}
+
+static void touchModel_writeRegister(uint8_t address, uint8_t value) {
+  switch (address) {
+  case STMPE_SYS_CTRL1:
+    if (value & STMPE_SYS_CTRL1_RESET)
+      touchModel_reset();
+    break;
+  case STMPE_INT_STA:  // Write 1 to clear.
+    touchRegisters[address] &= ~value;
+    break;
+  case STMPE_FIFO_STA:
+    touchRegisters[address] = value & STMPE_FIFO_STA_RESET;
+    if (value & STMPE_FIFO_STA_RESET) {
+      touchFifoHead = touchFifoCount = touchFifoByte = 0;
+      touchFifoOverflow = false;
+    }
+    break;
+  case 0x00:
+  case 0x01:
+  case 0x02:
+  case STMPE_FIFO_SIZE:  // Read-only.
+    break;
+  default:
+    touchRegisters[address] = value;
+    break;
+  }
+}
+
+// Shifts one byte in and returns the byte shifted out at the same time.
+static uint8_t touchModel_transfer(uint8_t value) {
+  uint8_t result = touchReadPipeline[0];
+  touchReadPipeline[0] = touchReadPipeline[1];
+  touchReadPipeline[1] = 0;
+  if (touchSessionByte == 0) {
+    touchSessionRead = value & 0x80;
+    touchSessionAddress = value & 0x7F;
+    if (touchSessionRead)
+      touchReadPipeline[1] = touchModel_readRegister(touchSessionAddress);
+  } else if (touchSessionRead) {
+    if (value & 0x80)  // Another read address; 0x00 just clocks data out.
+      touchReadPipeline[1] = touchModel_readRegister(value & 0x7F);
+  } else {
+    touchModel_writeRegister(touchSessionAddress++, value);
+  }
+  if (touchSessionByte < 0xFF)
+    touchSessionByte++;
+  return result;
+}
+
+// The INT pin (level, active high as the driver sets it up): an enabled interrupt is pending.
+static bool touchModel_interruptAsserted() {
+  return (touchRegisters[STMPE_INT_CTRL] & STMPE_INT_CTRL_ENABLE) &&
+         (touchRegisters[STMPE_INT_STA] & touchRegisters[STMPE_INT_EN]);
+}
+
+// When the next sample can raise the FIFO-threshold interrupt, or never (0).
+static uint64_t touchModel_nextInterruptTime() {
+  if (touched && touchModel_isEnabled() && (touchRegisters[STMPE_INT_CTRL] & STMPE_INT_CTRL_ENABLE) &&
+      (touchRegisters[STMPE_INT_EN] & STMPE_INT_EN_FIFOTH) && touchRegisters[STMPE_FIFO_TH])
+    return nextTouchSampleTime;
+  return 0;
+}
+
+static void touchModel_select() {
+  touchSessionCount++;
+  touchSessionByte = 0;
+  touchReadPipeline[0] = touchReadPipeline[1] = 0;
+}
+
+void halSim_touchPress(uint16_t x, uint16_t y, uint8_t z) {
+  touchX = x & 0x0FFF;
+  touchY = y & 0x0FFF;
+  touchZ = z;
+  if (!touched) {
+    touched = true;
+    touchRegisters[STMPE_INT_STA] |= STMPE_INT_STA_TOUCHDET;
+    nextTouchSampleTime = simTime + HALSIM_TOUCH_SAMPLE_PERIOD_TICKS;  // First sample after settling.
+  }
+}
+
+void halSim_touchRelease() {
+  if (touched) {
+    touched = false;
+    touchRegisters[STMPE_INT_STA] |= STMPE_INT_STA_TOUCHDET;
+  }
+}
+
+uint64_t halSim_getTouchTransactionCount() {
+  return touchSessionCount;
+}
+
+// ********************************** AXI SPI model **********************************
+
+#define SPI_CNTRL_REG_RESET_VALUE 0x180  // Master transactions inhibited, manual slave select.
+
+static uint32_t spiControl = SPI_CNTRL_REG_RESET_VALUE;
+static uint32_t spiSlaveSelect = 0xFFFFFFFF;
+static uint8_t  spiTxFifo[SPI_FIFO_DEPTH], spiTxHead = 0, spiTxCount = 0;
+static uint8_t  spiRxFifo[SPI_FIFO_DEPTH], spiRxHead = 0, spiRxCount = 0;
+static bool     spiShifting = false;     // A byte is on the wire.
+static uint64_t spiByteDoneTime = 0;     // When it is done.
+static uint32_t spiGlobalInterruptEnable = 0, spiInterruptStatus = 0, spiInterruptEnable = 0;
+
+static bool spiModel_touchSelected() {
+  return !(spiSlaveSelect & SPI_TOUCH_SCREEN_CONTROLLER_SLAVE_SELECT_MASK);
+}
+
+static bool spiModel_canShift() {
+  uint32_t enabled = SPI_CNTRL_SPE_MASK | SPI_CNTRL_MASTER_MASK;
+  return ((spiControl & enabled) == enabled) && !(spiControl & SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK);
+}
+
+static bool spiModel_interruptAsserted() {
+  return (spiGlobalInterruptEnable & SPI_GLOBAL_INT_ENABLE_MASK) && (spiInterruptStatus & spiInterruptEnable);
+}
+
+// Finishes the bytes whose time has come. A byte leaves the TX FIFO when it has been shifted, and
+// the answer goes to the RX FIFO at the same time. Setting the inhibit bit stops after the current byte.
+static void spiModel_update() {
+  while (spiShifting && (simTime >= spiByteDoneTime)) {
+    uint8_t sent = spiTxFifo[spiTxHead];
+    spiTxHead = (spiTxHead + 1) % SPI_FIFO_DEPTH;
+    spiTxCount--;
+    uint8_t received = spiModel_touchSelected() ? touchModel_transfer(sent) : 0xFF;
+    if (spiRxCount < SPI_FIFO_DEPTH)
+      spiRxFifo[(spiRxHead + spiRxCount++) % SPI_FIFO_DEPTH] = received;
+    if (!spiTxCount)
+      spiInterruptStatus |= SPI_INT_TX_EMPTY_MASK;
+    if (spiTxCount && spiModel_canShift())
+      spiByteDoneTime += HALSIM_SPI_BYTE_TICKS;
+    else
+      spiShifting = false;
+  }
+}
+
+// Starts shifting if there is something to send while the master is enabled and not inhibited.
+static void spiModel_run() {
+  if (!spiShifting && spiTxCount && spiModel_canShift()) {
+    spiShifting = true;
+    spiByteDoneTime = simTime + HALSIM_SPI_BYTE_TICKS;
+  }
+}
+
+// When the TX FIFO will have run empty, if it is shifting.
+static uint64_t spiModel_txEmptyTime() {
+  return spiByteDoneTime + (uint64_t)(spiTxCount - 1) * HALSIM_SPI_BYTE_TICKS;
+}
+
+static void spiModel_reset() {
+  spiControl = SPI_CNTRL_REG_RESET_VALUE;
+  spiSlaveSelect = 0xFFFFFFFF;
+  spiTxHead = spiTxCount = spiRxHead = spiRxCount = 0;
+  spiShifting = false;
+  spiGlobalInterruptEnable = spiInterruptStatus = spiInterruptEnable = 0;
+}
+
+uint32_t hal_spiReadRegister(uint32_t regOffset) {
+  halSim_access();
+  switch (regOffset) {
+  case SPI_CNTRL_REG_OFFSET:
+    return spiControl;
+  case SPI_GLOBAL_INT_ENABLE_REG_OFFSET:
+    return spiGlobalInterruptEnable;
+  case SPI_INT_STATUS_REG_OFFSET:
+    return spiInterruptStatus;
+  case SPI_INT_ENABLE_REG_OFFSET:
+    return spiInterruptEnable;
+  case SPI_STATUS_REG_OFFET: {
+    uint32_t status = 0;
+    if (!spiRxCount) status |= SPI_STATUS_REG_RX_EMPTY_MASK;
+    if (spiRxCount == SPI_FIFO_DEPTH) status |= SPI_STATUS_REG_RX_FULL_MASK;
+    if (!spiTxCount) status |= SPI_STATUS_REG_TX_EMPTY_MASK;
+    if (spiTxCount == SPI_FIFO_DEPTH) status |= SPI_STATUS_REG_TX_FULL_MASK;
+    return status;
+  }
+  case SPI_DATA_RECEIVE_REG_OFFSET: {
+    if (!spiRxCount)
+      return 0;
+    uint8_t value = spiRxFifo[spiRxHead];
+    spiRxHead = (spiRxHead + 1) % SPI_FIFO_DEPTH;
+    spiRxCount--;
+    return value;
+  }
+  case SPI_SLAVE_SELECT_REG_OFFSET:
+    return spiSlaveSelect;
+  case SPI_TRANSMIT_FIFO_OCC_REG_OFFSET:  // Occupancy registers hold the count minus one.
+    return spiTxCount ? spiTxCount - 1 : 0;
+  case SPI_RECEIVE_FIFO_OCC_REG_OFFSET:
+    return spiRxCount ? spiRxCount - 1 : 0;
+  default:
+    return 0;
+  }
+}
+
+void hal_spiWriteRegister(uint32_t regOffset, uint32_t value) {
+  halSim_access();
+  switch (regOffset) {
+  case SPI_RESET_REG_OFFSET:
+    if (value == SPI_RESET_REG_MASK)
+      spiModel_reset();
+    break;
+  case SPI_CNTRL_REG_OFFSET:
+    if (value & SPI_CNTRL_REG_TX_FIFO_RESET_MASK) {
+      spiTxHead = spiTxCount = 0;
+      spiShifting = false;
+    }
+    if (value & SPI_CNTRL_REG_RX_FIFO_RESET_MASK)
+      spiRxHead = spiRxCount = 0;
+    spiControl = value & ~(SPI_CNTRL_REG_TX_FIFO_RESET_MASK | SPI_CNTRL_REG_RX_FIFO_RESET_MASK);
+    spiModel_run();
+    break;
+  case SPI_DATA_TRANSMIT_REG_OFFSET:
+    if (spiTxCount < SPI_FIFO_DEPTH)
+      spiTxFifo[(spiTxHead + spiTxCount++) % SPI_FIFO_DEPTH] = value;
+    spiModel_run();
+    break;
+  case SPI_GLOBAL_INT_ENABLE_REG_OFFSET:
+    spiGlobalInterruptEnable = value & SPI_GLOBAL_INT_ENABLE_MASK;
+    break;
+  case SPI_INT_STATUS_REG_OFFSET:  // Toggle on write.
+    spiInterruptStatus ^= value;
+    break;
+  case SPI_INT_ENABLE_REG_OFFSET:
+    spiInterruptEnable = value;
+    break;
+  case SPI_SLAVE_SELECT_REG_OFFSET: {
+    bool wasSelected = spiModel_touchSelected();
+    spiSlaveSelect = value;
+    if (!wasSelected && spiModel_touchSelected())
+      touchModel_select();
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+// ********************************** GPIO and MIO **********************************
+
+#define MIO_PIN_COUNT 118  // 54 MIO + 64 EMIO.
+
+static uint32_t gpioOutputs[HAL_GPIO_COUNT];
+static uint32_t gpioInputs[HAL_GPIO_COUNT];
+static uint8_t  mioPins[MIO_PIN_COUNT];
+
+int hal_gpioInit(hal_gpio_t gpio) {
+  halSim_access();
+  return HAL_STATUS_OK;
+}
+
+void hal_gpioSetDataDirection(hal_gpio_t gpio, uint32_t inputMask) {
+  halSim_access();
+  if (gpio == HAL_GPIO_TFT_DATA_BUS)
+    lcdDataBusInputs = inputMask;
+}
+
+uint32_t hal_gpioRead(hal_gpio_t gpio) {
+  halSim_access();
+  switch (gpio) {
+  case HAL_GPIO_PUSH_BUTTONS:
+  case HAL_GPIO_SLIDE_SWITCHES:
+    return gpioInputs[gpio];
+  case HAL_GPIO_TFT_DATA_BUS:
+    return lcdDataBusInputs ? 0 : gpioOutputs[gpio];  // LCD reads are not modelled.
+  default:
+    return gpioOutputs[gpio];
+  }
+}
+
+void hal_gpioWrite(hal_gpio_t gpio, uint32_t value) {
+  halSim_access();
+  gpioOutputs[gpio] = value;
+  if (gpio == HAL_GPIO_TFT_CONTROL)
+    lcdModel_writeControlPins(value);
+  else if (gpio == HAL_GPIO_TFT_DATA_BUS)
+    lcdDataBusOut = value & 0xFF;
+}
+
+int hal_mioInit() {
+  halSim_access();
+  return HAL_STATUS_OK;
+}
+
+void hal_mioSetDirectionPin(uint8_t pin, uint8_t direction) {
+  halSim_access();
+}
+
+void hal_mioSetOutputEnablePin(uint8_t pin, uint8_t enable) {
+  halSim_access();
+}
+
+void hal_mioWritePin(uint8_t pin, uint8_t value) {
+  halSim_access();
+  if (pin < MIO_PIN_COUNT)
+    mioPins[pin] = value & 0x1;
+}
+
+uint8_t hal_mioReadPin(uint8_t pin) {
+  halSim_access();
+  return pin < MIO_PIN_COUNT ? mioPins[pin] : 0;
+}
+
+void hal_mioWriteBank(uint8_t bank, uint32_t value) {
+  halSim_access();
+  if (bank != 0)
+    return;
+  for (uint8_t pin = 0; pin < 32; pin++)  // Bank 0 is MIO[31:0].
+    mioPins[pin] = (value >> pin) & 0x1;
+}
+
+void halSim_setButtons(uint32_t buttons) {
+  gpioInputs[HAL_GPIO_PUSH_BUTTONS] = buttons & 0xF;
+}
+
+void halSim_setSwitches(uint32_t switches) {
+  gpioInputs[HAL_GPIO_SLIDE_SWITCHES] = switches & 0xF;
+}
+
+void halSim_setMioPin(uint8_t pin, uint8_t value) {
+  if (pin < MIO_PIN_COUNT)
+    mioPins[pin] = value & 0x1;
+}
+
+uint32_t halSim_getLeds() {
+  return gpioOutputs[HAL_GPIO_LEDS] & 0xF;
+}
+
+uint8_t halSim_getMioPin(uint8_t pin) {
+  return pin < MIO_PIN_COUNT ? mioPins[pin] : 0;
+}
+
+// ********************************** Global timer **********************************
+
+// Same offsets and bits as globalTimer.c.
+#define GLOBAL_TIMER_LOWER_COUNTER_REGISTER 0x0
+#define GLOBAL_TIMER_UPPER_COUNTER_REGISTER 0x4
+#define GLOBAL_TIMER_CONTROL_REGISTER 0x8
+#define GLOBAL_TIMER_TIMER_ENABLE_MASK 0x1
+
+static uint32_t globalTimerControl = 0;
+static uint64_t globalTimerStoppedValue = 0;  // Counter value while the timer is stopped.
+static uint64_t globalTimerStartTime = 0;     // Running counter = simTime - globalTimerStartTime.
+
+static uint64_t globalTimerModel_counter() {
+  if (globalTimerControl & GLOBAL_TIMER_TIMER_ENABLE_MASK)
+    return simTime - globalTimerStartTime;
+  return globalTimerStoppedValue;
+}
+
+uint32_t hal_globalTimerReadRegister(uint32_t regOffset) {
+  halSim_access();
+  switch (regOffset) {
+  case GLOBAL_TIMER_LOWER_COUNTER_REGISTER:
+    return globalTimerModel_counter() & 0xFFFFFFFF;
+  case GLOBAL_TIMER_UPPER_COUNTER_REGISTER:
+    return globalTimerModel_counter() >> 32;
+  case GLOBAL_TIMER_CONTROL_REGISTER:
+    return globalTimerControl;
+  default:
+    return 0;
+  }
+}
+
+void hal_globalTimerWriteRegister(uint32_t regOffset, uint32_t value) {
+  halSim_access();
+  uint64_t counter = globalTimerModel_counter();
+  switch (regOffset) {
+  case GLOBAL_TIMER_LOWER_COUNTER_REGISTER:  // The counter can only be written while stopped.
+    if (!(globalTimerControl & GLOBAL_TIMER_TIMER_ENABLE_MASK))
+      globalTimerStoppedValue = (globalTimerStoppedValue & 0xFFFFFFFF00000000ULL) | value;
+    break;
+  case GLOBAL_TIMER_UPPER_COUNTER_REGISTER:
+    if (!(globalTimerControl & GLOBAL_TIMER_TIMER_ENABLE_MASK))
+      globalTimerStoppedValue = (globalTimerStoppedValue & 0xFFFFFFFF) | ((uint64_t)value << 32);
+    break;
+  case GLOBAL_TIMER_CONTROL_REGISTER:
+    if ((value ^ globalTimerControl) & GLOBAL_TIMER_TIMER_ENABLE_MASK) {
+      if (value & GLOBAL_TIMER_TIMER_ENABLE_MASK)
+        globalTimerStartTime = simTime - counter;  // Continue from where it stopped.
+      else
+        globalTimerStoppedValue = counter;
+    }
+    globalTimerControl = value;
+    break;
+  default:
+    break;
+  }
+}
+
+// ********************************** Private timer and interrupts **********************************
+
+#define PRIVATE_TIMER_PRESCALER_DEFAULT 0
+#define PRIVATE_TIMER_LOAD_VALUE_DEFAULT 3249
+
+static hal_isr_t timerIsr = NULL;
+static hal_isr_t spiIsr = NULL;
+static hal_isr_t touchIsr = NULL;
+static bool     armInterruptsEnabled = false;
+static bool     inInterrupt = false;
+static bool     timerRunning = false;
+static bool     timerInterruptEnabled = false;
+static bool     timerInterruptPending = false;
+static uint32_t timerLoadValue = PRIVATE_TIMER_LOAD_VALUE_DEFAULT;
+static uint8_t  timerPrescaler = PRIVATE_TIMER_PRESCALER_DEFAULT;
+static uint64_t timerNextExpiry = 0;
+static uint32_t missedTimerInterruptCount = 0;
+
+static uint64_t privateTimerModel_period() {
+  return (uint64_t)(timerLoadValue + 1) * (timerPrescaler + 1);
+}
+
+// Calls the timer ISR while an enabled interrupt is pending. Interrupts do not nest.
+static void privateTimerModel_serviceInterrupts() {
+  if (inInterrupt || !timerIsr)
+    return;
+  while (timerInterruptPending && timerInterruptEnabled && armInterruptsEnabled) {
+    inInterrupt = true;
+    timerIsr(NULL);
+    inInterrupt = false;
+    if (timerInterruptPending)  // The ISR did not clear it; don't spin here forever.
+      break;
+  }
+}
+
+// Calls the SPI ISR while its interrupt is asserted, after any timer interrupt (the timer has the
+// higher priority on the GIC).
+static void spiModel_serviceInterrupts() {
+  if (inInterrupt || !spiIsr)
+    return;
+  while (spiModel_interruptAsserted() && armInterruptsEnabled) {
+    inInterrupt = true;
+    spiIsr(NULL);
+    inInterrupt = false;
+    if (spiModel_interruptAsserted())  // The ISR did not clear it; don't spin here forever.
+      break;
+  }
+}
+
+// Calls the touch-controller ISR while its INT line is asserted, after the other interrupts.
+static void touchModel_serviceInterrupts() {
+  if (inInterrupt || !touchIsr)
+    return;
+  while (touchModel_interruptAsserted() && armInterruptsEnabled) {
+    inInterrupt = true;
+    touchIsr(NULL);
+    inInterrupt = false;
+    if (touchModel_interruptAsserted())  // The ISR did not clear it; don't spin here forever.
+      break;
+  }
+}
+
+// Auto reload is always on (hal_interruptsInit() turns it on for the board too).
+static void privateTimerModel_update() {
+  if (timerRunning && (simTime >= timerNextExpiry)) {
+    uint64_t period = privateTimerModel_period();
+    uint64_t expiries = (simTime - timerNextExpiry) / period + 1;
+    missedTimerInterruptCount += expiries - (timerInterruptPending ? 0 : 1);
+    timerInterruptPending = true;
+    timerNextExpiry += expiries * period;
+  }
+  privateTimerModel_serviceInterrupts();
+}
+
+int hal_interruptsInit(hal_isr_t timerIsrArg, hal_isr_t sysMonIsr, bool printFailedStatusFlag) {
+  timerIsr = timerIsrArg;  // There is no XADC model, so sysMonIsr is never called.
+  timerLoadValue = PRIVATE_TIMER_LOAD_VALUE_DEFAULT;
+  timerPrescaler = PRIVATE_TIMER_PRESCALER_DEFAULT;
+  return HAL_STATUS_OK;
+}
+
+int hal_interruptsConnectSpi(hal_isr_t spiIsrArg) {
+  spiIsr = spiIsrArg;
+  return HAL_STATUS_OK;
+}
+
+int hal_interruptsConnectTouch(hal_isr_t touchIsrArg) {
+  touchIsr = touchIsrArg;
+  return HAL_STATUS_OK;
+}
+
+void hal_interruptsEnableArm() {
+  armInterruptsEnabled = true;
+  privateTimerModel_serviceInterrupts();
+  spiModel_serviceInterrupts();
+  touchModel_serviceInterrupts();
+}
+
+void hal_interruptsDisableArm() {
+  armInterruptsEnabled = false;
+}
+
+void hal_privateTimerStart() {
+  halSim_access();
+  if (!timerRunning)
+    timerNextExpiry = simTime + privateTimerModel_period();
+  timerRunning = true;
+}
+
+void hal_privateTimerStop() {
+  halSim_access();
+  timerRunning = false;
+}
+
+void hal_privateTimerEnableInterrupt() {
+  halSim_access();
+  timerInterruptEnabled = true;
+}
+
+void hal_privateTimerDisableInterrupt() {
+  halSim_access();
+  timerInterruptEnabled = false;
+}
+
+void hal_privateTimerClearInterruptStatus() {
+  timerInterruptPending = false;
+  halSim_access();
+}
+
+// Writing the load register also reloads the counter.
+void hal_privateTimerSetLoadValue(uint32_t loadValue) {
+  halSim_access();
+  timerLoadValue = loadValue;
+  timerNextExpiry = simTime + privateTimerModel_period();
+}
+
+void hal_privateTimerSetPrescaler(uint8_t prescaler) {
+  halSim_access();
+  timerPrescaler = prescaler;
+}
+
+uint32_t hal_privateTimerGetCounterValue() {
+  halSim_access();
+  if (!timerRunning || (simTime >= timerNextExpiry))
+    return 0;
+  return (timerNextExpiry - simTime) / (timerPrescaler + 1);
+}
+
+void hal_sysMonEnableGlobalInterrupts() {
+}
+
+void hal_sysMonDisableGlobalInterrupts() {
+}
+
+void hal_sysMonEnableEocInterrupts() {
+}
+
+void hal_sysMonDisableEocInterrupts() {
+}
+
+bool hal_sysMonAcknowledgeInterrupts() {
+  return false;
+}
+
+uint16_t hal_sysMonGetAdcData() {
+  return 0;
+}
+
+// ********************************** AMP **********************************
+
+// Stands in for the OCM. CPU1 is a host thread, so the time model above does not cover it:
+// only amp.c/ampRing.c may be used from that thread, none of the modelled hardware, except the
+// LCD once CPU0 has handed it over (display_enableAmpRendering()). CPU0 must then leave the
+// modelled hardware and the time alone until CPU1 has stopped (the host tests only).
+static uint64_t ampSharedMemory[HAL_AMP_SHARED_MEMORY_BYTES / sizeof(uint64_t)];
+
+void *hal_ampSharedMemory() {
+  return ampSharedMemory;
+}
+
+static void *halSim_cpu1Thread(void *entry) {
+  ((void (*)()) entry)();
+  return NULL;
+}
+
+void hal_ampStartCpu1(void (*entry)()) {
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, halSim_cpu1Thread, (void *) entry)) {
+    printf("hal_ampStartCpu1: could not start the CPU1 thread.\n\r");
+    return;
+  }
+  pthread_detach(thread);
+}
+
+void hal_ampIdle() {
+  sched_yield();
+}
+
+// ********************************** Time **********************************
+
+// Every register access takes a little time.
+static void halSim_access() {
+  axiAccessCount++;
+  halSim_advanceTime(HALSIM_AXI_ACCESS_TICKS);
+}
+
+void hal_msDelay(long msDelay) {
+  if (msDelay > 0)
+    halSim_advanceTime((uint64_t)msDelay * HALSIM_TICKS_PER_MS);
+}
+
+uint64_t halSim_getTime() {
+  return simTime;
+}
+
+void halSim_advanceTime(uint64_t ticks) {
+  simTime += ticks;
+  touchModel_update();
+  spiModel_update();
+  privateTimerModel_update();
+  spiModel_serviceInterrupts();
+  touchModel_serviceInterrupts();
+}
+
+void halSim_waitForInterrupt() {
+  bool timerCanInterrupt = timerRunning && timerInterruptEnabled && armInterruptsEnabled && !inInterrupt;
+  bool spiCanInterrupt = spiShifting && spiIsr && armInterruptsEnabled && !inInterrupt &&
+      (spiGlobalInterruptEnable & SPI_GLOBAL_INT_ENABLE_MASK) && (spiInterruptEnable & SPI_INT_TX_EMPTY_MASK);
+  bool touchCanInterrupt = touchIsr && armInterruptsEnabled && !inInterrupt && touchModel_nextInterruptTime();
+  if (timerCanInterrupt || spiCanInterrupt || touchCanInterrupt) {
+    uint64_t next = UINT64_MAX;
+    if (timerCanInterrupt)
+      next = timerNextExpiry;
+    if (spiCanInterrupt && (spiModel_txEmptyTime() < next))
+      next = spiModel_txEmptyTime();
+    if (touchCanInterrupt && (touchModel_nextInterruptTime() < next))
+      next = touchModel_nextInterruptTime();
+    halSim_advanceTime((simTime < next) ? next - simTime : 0);
+  } else {
+    halSim_advanceTime(HALSIM_TICKS_PER_MS);
+  }
+}
+
+uint64_t halSim_getAxiAccessCount() {
+  return axiAccessCount;
+}
+
+uint32_t halSim_getMissedTimerInterruptCount() {
+  return missedTimerInterruptCount;
+}
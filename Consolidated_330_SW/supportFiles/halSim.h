@@ -0,0 +1,88 @@
+/*
+ * halSim.h
+ */
+
+#ifndef HALSIM_H_
+#define HALSIM_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+#include "xparameters.h"
+
+// Controls for the Linux simulator backend of hal.h (halSim.c). The drivers do not know about
+// any of this; a simulator main (see src/Simulator) uses these calls to feed inputs, let time
+// pass and look at the LCD.
+//
+// What is modelled:
+//   - ILI9341 LCD controller on the TFT GPIO pins: commands are decoded on WR rising edges.
+//     CASET/PASET/RAMWR/RAMWRC/MADCTL, vertical scrolling (VSCRDEF/VSCRSADD/NORON) and the
+//     320x240 RGB565 GRAM are modelled.
+//   - AXI SPI core (FIFOs, status, manual slave select, the transmit-empty interrupt; bytes take
+//     HALSIM_SPI_BYTE_TICKS to shift) with an STMPE610 touch controller behind slave select 1:
+//     chip id, TSC control/status, the sample FIFO and its status, and the INT line (touch
+//     detect and FIFO threshold).
+//   - Push buttons, slide switches, LEDs and the MIO pins (LD4, BTN4, BTN5).
+//   - ARM private timer (load, prescaler, auto reload, interrupt) and the global timer.
+// Nothing else (XADC conversions, LCD reads) is modelled, those return 0.
+//
+// Time only moves when the program touches the hardware: every HAL access costs
+// HALSIM_AXI_ACCESS_TICKS, hal_msDelay() lets its delay pass, and halSim_waitForInterrupt()
+// skips ahead to the next timer interrupt. Timer interrupts are taken at the first HAL access
+// after they fall due. Because idle time is skipped, the simulator runs faster than real time.
+
+// Simulated time is kept in global-timer ticks (1/2 the CPU clock, the private timer runs at the same rate).
+#define HALSIM_TICKS_PER_SECOND (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define HALSIM_TICKS_PER_MS (HALSIM_TICKS_PER_SECOND / 1000)
+
+// Rough cost of one AXI-lite register access from the ARM (about 100 ns).
+#define HALSIM_AXI_ACCESS_TICKS 33
+
+// Time to shift one byte over SPI: 8 clocks at 1 MHz, the fastest the STMPE610 allows.
+#define HALSIM_SPI_BYTE_TICKS (8 * (HALSIM_TICKS_PER_SECOND / 1000000))
+
+// The touch controller adds a sample to its FIFO this often while the panel is touched.
+#define HALSIM_TOUCH_SAMPLE_PERIOD_TICKS (2 * HALSIM_TICKS_PER_MS)
+
+// The LCD image, as seen with the rotation display_init() selects (1, landscape).
+#define HALSIM_LCD_WIDTH  320
+#define HALSIM_LCD_HEIGHT 240
+
+// ********************************** Time **********************************
+// Current simulated time in ticks.
+uint64_t halSim_getTime();
+// Lets ticks of simulated time pass, taking any timer interrupts that fall due.
+void halSim_advanceTime(uint64_t ticks);
+// Idles until the next private-timer, SPI or touch-controller interrupt has been taken (like the ARM WFI instruction).
+// If no interrupt can happen, just lets 1 ms pass.
+void halSim_waitForInterrupt();
+// Number of HAL register accesses since start-up.
+uint64_t halSim_getAxiAccessCount();
+// Timer interrupts that fell due while the previous one was still pending (they are lost on the board too).
+uint32_t halSim_getMissedTimerInterruptCount();
+
+// ********************************** Inputs **********************************
+// Presses the touch panel at raw 12-bit touch-controller coordinates with pressure z.
+// Calling it again while pressed moves the touch point.
+void halSim_touchPress(uint16_t x, uint16_t y, uint8_t z);
+void halSim_touchRelease();
+// SPI transactions (slave-select assertions) with the touch controller since start-up.
+uint64_t halSim_getTouchTransactionCount();
+// Lower 4 bits: bit3 = BTN3 ... bit0 = BTN0 (1 = pressed).
+void halSim_setButtons(uint32_t buttons);
+// Lower 4 bits: bit3 = SW3 ... bit0 = SW0 (1 = on).
+void halSim_setSwitches(uint32_t switches);
+// Drives an MIO input pin (e.g., MIO_BTN4_MIO_PIN).
+void halSim_setMioPin(uint8_t pin, uint8_t value);
+
+// ********************************** Outputs **********************************
+// Lower 4 bits: LD3 - LD0.
+uint32_t halSim_getLeds();
+uint8_t halSim_getMioPin(uint8_t pin);
+// Returns the RGB565 color at (x, y) of the LCD image (what the panel shows, so scrolled).
+uint16_t halSim_lcdReadPixel(int16_t x, int16_t y);
+// Pixels written to the LCD's GRAM so far (RAMWR/RAMWRC data), to compare how much apps redraw.
+uint64_t halSim_getLcdPixelWriteCount();
+// Writes the LCD image to a binary PPM (P6) file. Returns 0 on success.
+int halSim_lcdDumpPpm(const char *fileName);
+
+#endif /* HALSIM_H_ */
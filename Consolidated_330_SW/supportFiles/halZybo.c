@@ -0,0 +1,390 @@
+/*
+ * halZybo.c
+ */
+
+// ZYBO implementation of hal.h. This is the only file in supportFiles that talks to the Xilinx
+// drivers and the memory-mapped registers directly.
+
+#include <stdio.h>
+#include "hal.h"
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xil_exception.h"
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+#include "xgpio.h"
+#include "xgpiops.h"
+#include "xscugic.h"                  // Includes for the interrupt controller.
+#include "xscutimer.h"                // Includes for the private timer of the ARM.
+#include "xsysmon.h"                  // Includes for the system monitor (contains the XADC).
+
+// ********************************** AXI GPIO **********************************
+
+// Indexed by hal_gpio_t.
+static const u16 gpioDeviceIds[HAL_GPIO_COUNT] = {
+  XPAR_AXI_GPIO_TFT_CONTROL_DEVICE_ID,
+  XPAR_AXI_GPIO_TFT_DATA_BUS_DEVICE_ID,
+  XPAR_GPIO_LEDS_DEVICE_ID,
+  XPAR_GPIO_PUSH_BUTTONS_DEVICE_ID,
+  XPAR_GPIO_SLIDE_SWITCHES_DEVICE_ID,
+};
+static XGpio gpios[HAL_GPIO_COUNT];  // One Xilinx GPIO driver instance per block.
+
+int hal_gpioInit(hal_gpio_t gpio) {
+  int status = XGpio_Initialize(&gpios[gpio], gpioDeviceIds[gpio]);  // Xilinx GPIO init call.
+  return status == XST_SUCCESS ? HAL_STATUS_OK : HAL_STATUS_FAIL;
+}
+
+void hal_gpioSetDataDirection(hal_gpio_t gpio, uint32_t inputMask) {
+  XGpio_SetDataDirection(&gpios[gpio], 1, inputMask);
+}
+
+uint32_t hal_gpioRead(hal_gpio_t gpio) {
+  return XGpio_DiscreteRead(&gpios[gpio], 1);
+}
+
+void hal_gpioWrite(hal_gpio_t gpio, uint32_t value) {
+  XGpio_DiscreteWrite(&gpios[gpio], 1, value);
+}
+
+// ********************************** MIO (PS GPIO) **********************************
+
+static XGpioPs_Config *mioConfigPtr;  // Handle to the mio config handle.
+static XGpioPs mioGpio;               // The driver instance for GPIO Device.
+
+int hal_mioInit() {
+  mioConfigPtr = XGpioPs_LookupConfig(XPAR_XGPIOPS_0_DEVICE_ID);  // Lookup the config info for the MIO GPIO device.
+  int status = XGpioPs_CfgInitialize(&mioGpio, mioConfigPtr, mioConfigPtr->BaseAddr);  // Initialize it..
+  return status == XST_SUCCESS ? HAL_STATUS_OK : HAL_STATUS_FAIL;
+}
+
+void hal_mioSetDirectionPin(uint8_t pin, uint8_t direction) {
+  XGpioPs_SetDirectionPin(&mioGpio, pin, direction);
+}
+
+void hal_mioSetOutputEnablePin(uint8_t pin, uint8_t enable) {
+  XGpioPs_SetOutputEnablePin(&mioGpio, pin, enable);
+}
+
+void hal_mioWritePin(uint8_t pin, uint8_t value) {
+  XGpioPs_WritePin(&mioGpio, pin, value);
+}
+
+uint8_t hal_mioReadPin(uint8_t pin) {
+  return XGpioPs_ReadPin(&mioGpio, pin);
+}
+
+void hal_mioWriteBank(uint8_t bank, uint32_t value) {
+  XGpioPs_Write(&mioGpio, bank, value);
+}
+
+// ********************************** Memory-mapped cores **********************************
+
+uint32_t hal_spiReadRegister(uint32_t regOffset) {
+  return Xil_In32(XPAR_SPI_0_BASEADDR + regOffset);
+}
+
+void hal_spiWriteRegister(uint32_t regOffset, uint32_t value) {
+  Xil_Out32(XPAR_SPI_0_BASEADDR + regOffset, value);
+}
+
+uint32_t hal_globalTimerReadRegister(uint32_t regOffset) {
+  return Xil_In32(XPAR_GLOBAL_TMR_BASEADDR + regOffset);
+}
+
+void hal_globalTimerWriteRegister(uint32_t regOffset, uint32_t value) {
+  Xil_Out32(XPAR_GLOBAL_TMR_BASEADDR + regOffset, value);
+}
+
+// ********************************** Interrupts **********************************
+
+#define PRIVATE_TIMER_PRESCALER_DEFAULT 0
+#define PRIVATE_TIMER_LOAD_VALUE_DEFAULT 3249  // Provides a 10 us interrupt period.
+
+// The sysmon (XADC) runs off the bus-clock when accessed via the AXI_XADC IP (as is done here).
+// This default will allow nearly a 26 Mhz clock which is the maximum frequency to achieve 1 megasamples
+// because a single conversion requires 26 clock cycles.
+#define XADC_CLOCK_DIVIDER 4  // 100 MHz bus clock divided by 4 is 25 MHz.
+
+// Assumes that you are connected to auxiliary port 14: pins JA1 (P) and JA7 (N) on the ZYBO board.
+#define XADC_AUX_CHANNEL_14 XSM_CH_AUX_MAX-1
+
+static XScuGic_Config *GicConfig;    // The configuration parameters of the controller.
+static XScuGic InterruptController;  // Pointer to the Xilinx-provided interrupt controller routine.
+static XScuTimer_Config *ConfigPtr;  // Pointer to the ARM private timer.
+static XScuTimer TimerInstance;      // The timer instance (allows access to timer registers).
+static XSysMon_Config *xSysMonConfig;// Handle to the SysMon.
+static XSysMon xSysMonInst;          // Instance of the system monitor (to access AXI_XADC registers).
+
+// Xilinx calls the Axi XADC module the SysMon (System Monitor).
+// This sets up the XADC to continuously sample on aux. channel 14 in single channel mode, unipolar.
+static int initSysMonInterrupts(hal_isr_t sysMonIsr) {
+  int status;
+  xSysMonConfig = XSysMon_LookupConfig(XPAR_AXI_XADC_0_DEVICE_ID);
+  status = XSysMon_CfgInitialize(&xSysMonInst, xSysMonConfig, xSysMonConfig->BaseAddress);
+  if (status != XST_SUCCESS) {
+	printf("XSysMon initialize failed!!!\n\r");
+    return XST_FAILURE;
+  }
+  status = XSysMon_SelfTest(&xSysMonInst);
+  if (status != XST_SUCCESS) {
+	printf("XSysMon self-test failed!!!\n\r");
+    return XST_FAILURE;
+  }
+  XSysMon_SetAdcClkDivisor(&xSysMonInst, XADC_CLOCK_DIVIDER);
+  XSysMon_SetSequencerMode(&xSysMonInst, XSM_SEQ_MODE_SINGCHAN); // Single-channel mode (channel 14).
+  status =  XSysMon_SetSingleChParams(&xSysMonInst, XADC_AUX_CHANNEL_14,
+						              FALSE, FALSE, FALSE);
+  if(status != XST_SUCCESS) {
+	printf("XSysMon set single channel parameters failed!!!\n\r");
+    return XST_FAILURE;
+  }
+ // XSysMon_SetAvg(&xSysMonInst, XSM_AVG_16_SAMPLES); //Don't use, reduces conversion rate by 16.
+  XSysMon_SetAlarmEnables(&xSysMonInst, 0x0);  // Disable all alarms.
+  // Connect the xSysMon ISR to the GIC ISR.
+  status = XScuGic_Connect(&InterruptController,
+		                    XPAR_FABRIC_AXI_XADC_0_IP2INTC_IRPT_INTR,
+		                   (Xil_ExceptionHandler) sysMonIsr,
+		                   (void *) &xSysMonInst);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (sysmon).\n\r");
+	return status;
+  }
+  // Clear out any pending interrupts in the interrupt status register.
+  int intrStatus = XSysMon_IntrGetStatus(&xSysMonInst);
+  XSysMon_IntrClear(&xSysMonInst, intrStatus);
+  // Enable the sysmon interrupt on the GIC (does nothing to the sysmon).
+  XScuGic_Enable(&InterruptController, XPAR_FABRIC_AXI_XADC_0_IP2INTC_IRPT_INTR);
+  return XST_SUCCESS;
+}
+
+// Sets up the timer for periodic interrupts.
+static int initTimerInterrupts(hal_isr_t timerIsr) {
+  int status;  // General Xilinx status reporting.
+  // Get a handle to the timer.
+  ConfigPtr = XScuTimer_LookupConfig(XPAR_XSCUTIMER_0_DEVICE_ID);
+  // Init the timer via the handle.
+  status = XScuTimer_CfgInitialize(&TimerInstance,
+		                           ConfigPtr,
+		                           ConfigPtr->BaseAddr);
+  if (status != XST_SUCCESS){
+	print("XScuTimer_CfgInitialize failed.\n\r");
+    return XST_FAILURE;
+  }
+  status = XScuTimer_SelfTest(&TimerInstance);
+  if (status != XST_SUCCESS){
+    print("XscuTimer_SelfTest failed.\n\r");
+    return status;
+  }
+  // Connect the timer ISR to the GIC ISR.
+  status = XScuGic_Connect(&InterruptController,
+		                   XPAR_SCUTIMER_INTR,
+		                   (Xil_ExceptionHandler) timerIsr,
+		                   (void *) &TimerInstance);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (timer).\n\r");
+	return status;
+  }
+  // Enable the timer interrupt on the GIC (does nothing to the timer).
+  XScuGic_Enable(&InterruptController, XPAR_SCUTIMER_INTR);
+  // Enable auto reload mode.
+  XScuTimer_EnableAutoReload(&TimerInstance);
+  // Load the timer counter preload register.
+  // Subtract 1 from the tick count to account for the extra cycle for the counter
+  // to transition to zero to generate the interrupt. Page 4-2 of ARM Cortex A9 Mpcore r4p1
+  XScuTimer_SetPrescaler(&TimerInstance, PRIVATE_TIMER_PRESCALER_DEFAULT);
+  XScuTimer_LoadTimer(&TimerInstance, PRIVATE_TIMER_LOAD_VALUE_DEFAULT);
+  return XST_SUCCESS;
+}
+
+int hal_interruptsInit(hal_isr_t timerIsr, hal_isr_t sysMonIsr, bool printFailedStatusFlag) {
+  int status;  // General Xilinx status.
+  // Lookup the GIC device and get its handle.
+  GicConfig = XScuGic_LookupConfig(XPAR_SCUGIC_SINGLE_DEVICE_ID);
+  if (!GicConfig) {
+	if (printFailedStatusFlag)
+  	  print("XScuGic_LookupConfig failed.\n\r");
+	return HAL_STATUS_FAIL;
+  }
+  // Init the GIC interrupt controller via its handle.
+  status = XScuGic_CfgInitialize(&InterruptController, GicConfig, GicConfig->CpuBaseAddress);
+  if (status != XST_SUCCESS) {
+	if (printFailedStatusFlag)
+	  print("XScuGic_CfgInitialize failed.\n\r");
+	return HAL_STATUS_FAIL;
+  }
+  Xil_ExceptionInit();  // Initialize the interrupt system.
+  // Connect the GIC interrupt handler (provided by Xilinx) to the GIC interrupt.
+  // You will connect timerIsr, sysMonIsr, etc., to this interrupt hander.
+  Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+							   (Xil_ExceptionHandler) XScuGic_InterruptHandler,
+							   &InterruptController);
+    print("setupGICInterruptController exited successfully.\n\r");
+
+  u8 adcPriority;
+  u8 timerPriority;
+  u8 adcTrigger;
+  u8 timerTrigger;
+  XScuGic_GetPriorityTriggerType(&InterruptController, XPAR_SCUTIMER_INTR,
+   					&timerPriority, &timerTrigger);
+  XScuGic_GetPriorityTriggerType(&InterruptController, XPAR_FABRIC_AXI_XADC_0_IP2INTC_IRPT_INTR,
+  					&adcPriority, &adcTrigger);
+  // Try setting the XADC to a higher priority than the timer (less is higher priority).
+  adcPriority = timerPriority - 10;
+//   adcTrigger = 3;  // Changing to rising edge doesn't work - the EOC interrupt count drops way down.
+  XScuGic_SetPriorityTriggerType(&InterruptController, XPAR_FABRIC_AXI_XADC_0_IP2INTC_IRPT_INTR,
+     					adcPriority, adcTrigger);
+
+  // init the timer interrupts.
+  initTimerInterrupts(timerIsr);
+  // Init the SysMon interrupts (XADC).
+  initSysMonInterrupts(sysMonIsr);
+  return HAL_STATUS_OK;
+}
+
+// The SPI core's interrupt reaches the GIC only if the hardware design connects its IP2INTC_Irpt
+// output to a fabric interrupt; the current design does not. Define HAL_SPI_INTERRUPT_ID to that id
+// (see xparameters.h) to use it.
+int hal_interruptsConnectSpi(hal_isr_t spiIsr) {
+#ifdef HAL_SPI_INTERRUPT_ID
+  int status = XScuGic_Connect(&InterruptController,
+		                       HAL_SPI_INTERRUPT_ID,
+		                       (Xil_ExceptionHandler) spiIsr,
+		                       NULL);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (spi).\n\r");
+	return HAL_STATUS_FAIL;
+  }
+  // Enable the SPI interrupt on the GIC (does nothing to the SPI core).
+  XScuGic_Enable(&InterruptController, HAL_SPI_INTERRUPT_ID);
+  return HAL_STATUS_OK;
+#else
+  return HAL_STATUS_FAIL;
+#endif
+}
+
+// The STMPE610's INT pin is not part of the SPI connection; it reaches the GIC only if the hardware
+// design routes it to a fabric interrupt. Define HAL_TOUCH_INTERRUPT_ID to that id (see
+// xparameters.h) to use it. The driver sets the pin up level-sensitive, active high.
+int hal_interruptsConnectTouch(hal_isr_t touchIsr) {
+#ifdef HAL_TOUCH_INTERRUPT_ID
+  int status = XScuGic_Connect(&InterruptController,
+		                       HAL_TOUCH_INTERRUPT_ID,
+		                       (Xil_ExceptionHandler) touchIsr,
+		                       NULL);
+  if (status != XST_SUCCESS) {
+	print("XScuGic_Connect failed (touch).\n\r");
+	return HAL_STATUS_FAIL;
+  }
+  // Enable the touch interrupt on the GIC (does nothing to the touch controller).
+  XScuGic_Enable(&InterruptController, HAL_TOUCH_INTERRUPT_ID);
+  return HAL_STATUS_OK;
+#else
+  return HAL_STATUS_FAIL;
+#endif
+}
+
+void hal_interruptsEnableArm() {
+  Xil_ExceptionEnable();
+}
+
+void hal_interruptsDisableArm() {
+  Xil_ExceptionDisable();
+}
+
+void hal_privateTimerStart() {
+  XScuTimer_Start(&TimerInstance);
+}
+
+void hal_privateTimerStop() {
+  XScuTimer_Stop(&TimerInstance);
+}
+
+void hal_privateTimerEnableInterrupt() {
+  XScuTimer_EnableInterrupt(&TimerInstance);
+}
+
+void hal_privateTimerDisableInterrupt() {
+  XScuTimer_DisableInterrupt(&TimerInstance);
+}
+
+void hal_privateTimerClearInterruptStatus() {
+  XScuTimer_ClearInterruptStatus(&TimerInstance);
+}
+
+void hal_privateTimerSetLoadValue(uint32_t loadValue) {
+  XScuTimer_LoadTimer(&TimerInstance, loadValue);
+}
+
+void hal_privateTimerSetPrescaler(uint8_t prescaler) {
+  XScuTimer_SetPrescaler(&TimerInstance, prescaler);
+}
+
+uint32_t hal_privateTimerGetCounterValue() {
+  return XScuTimer_GetCounterValue(&TimerInstance);
+}
+
+void hal_sysMonEnableGlobalInterrupts() {
+  XSysMon_IntrGlobalEnable(&xSysMonInst);
+}
+
+void hal_sysMonDisableGlobalInterrupts() {
+  XSysMon_IntrGlobalDisable(&xSysMonInst);
+}
+
+void hal_sysMonEnableEocInterrupts() {
+  XSysMon_IntrEnable(&xSysMonInst, XSM_IPIXR_EOC_MASK);
+}
+
+void hal_sysMonDisableEocInterrupts() {
+  XSysMon_IntrDisable(&xSysMonInst, XSM_IPIXR_EOC_MASK);
+}
+
+// Watch out, this indiscriminately clears out all interrupts from the XADC.
+bool hal_sysMonAcknowledgeInterrupts() {
+  // Get the interrupt status from the device and check the value.
+  u32 intrStatusValue = XSysMon_IntrGetStatus(&xSysMonInst);
+  XSysMon_IntrClear(&xSysMonInst, intrStatusValue);  // Clear out ALL XADC interrupt.
+  return (intrStatusValue & XSM_SR_EOC_MASK) != 0;
+}
+
+uint16_t hal_sysMonGetAdcData() {
+  return XSysMon_GetAdcData(&xSysMonInst, XADC_AUX_CHANNEL_14);
+}
+
+// ********************************** AMP **********************************
+
+#define AMP_SHARED_MEMORY_BASEADDR 0xFFFF0000  // HAL_AMP_SHARED_MEMORY_BYTES of OCM, left out of src/lscript.ld.
+// Shareable, normal, non-cacheable (TEX=100, C=0, B=0, S=1). The setting the Xilinx AMP examples
+// use for the OCM, so neither CPU's L1 cache holds the rings.
+#define AMP_SHARED_MEMORY_TLB_ATTRIBUTES 0x14DE2
+// CPU1 spins in the boot ROM until it is woken with SEV and this address holds its start address.
+#define AMP_CPU1_START_ADDRESS_REGISTER 0xFFFFFFF0
+
+void *hal_ampSharedMemory() {
+  static bool mapped = false;
+  if (!mapped) {
+    Xil_SetTlbAttributes(AMP_SHARED_MEMORY_BASEADDR, AMP_SHARED_MEMORY_TLB_ATTRIBUTES);
+    mapped = true;
+  }
+  return (void *) AMP_SHARED_MEMORY_BASEADDR;
+}
+
+void hal_ampStartCpu1(void (*entry)()) {
+  Xil_Out32(AMP_CPU1_START_ADDRESS_REGISTER, (u32) entry);
+  dmb();  // The address must be visible before CPU1 wakes up.
+  __asm__ __volatile__ ("sev");
+}
+
+void hal_ampIdle() {
+}
+
+// ********************************** Time **********************************
+
+// This provides an accurate ms delay. Number was computed via experimentation and
+// measured with the intervalTimer package.
+#define MS_LOOP_MULTIPLIER 55310
+void hal_msDelay(long msDelay) {
+  volatile int i;
+  for (i=0; i<msDelay*MS_LOOP_MULTIPLIER; i++);
+}
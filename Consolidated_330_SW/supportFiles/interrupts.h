@@ -20,6 +20,9 @@
 // if printFailedStatusFlag is true, it prints out diagnostic messages if something goes awry.
 int interrupts_initAll(bool printFailedStatusFlag);
 
+// True if interrupts_initAll() could connect the SPI core's interrupt (see spi_transferBufferAsync()).
+bool interrupts_isSpiInterruptConnected();
+
 int interrupts_enableArmInts();
 int interrupts_disableArmInts();
 
@@ -8,10 +8,42 @@
 #include "lcd.h"
 #include "arduinoTypes.h"
 #include "mio.h"
+#include "hal.h"
 
-static XGpio gpioTftControl;  // Provides the RD, WR and CD pins for the LCD controller.
-static XGpio gpioTftDataBus;  // Provides an 8-bit data bus for the LCD controller.
 static bool initFlag = false; // Make sure that body of init routine only gets invoked once.
+static uint32_t busWriteCount = 0;  // Number of write cycles issued to the LCD controller.
+static uint32_t controlShadow = 0;  // What was last written to the control GPIO (never read back).
+static uint32_t transactionCounts[LCD_PRIMITIVE_COUNT];  // GPIO reads + writes, per primitive.
+
+// Writes the shadow to the control pins, charged to the given primitive.
+static void LCD_writeControl(lcd_primitive_t primitive) {
+  hal_gpioWrite(HAL_GPIO_TFT_CONTROL, controlShadow);
+  transactionCounts[primitive]++;
+}
+
+// Changes the control pins covered by mask to value. No bus access if they already match.
+static void LCD_updateControl(uint32_t mask, uint32_t value) {
+  uint32_t newShadow = (controlShadow & ~mask) | (value & mask);
+  if (newShadow == controlShadow)
+    return;
+  controlShadow = newShadow;
+  LCD_writeControl(LCD_PRIMITIVE_CONTROL);
+}
+
+// Puts a byte on the data bus, charged to the given primitive.
+static void LCD_writeDataBus(lcd_primitive_t primitive, uint8_t value) {
+  hal_gpioWrite(HAL_GPIO_TFT_DATA_BUS, value);
+  transactionCounts[primitive]++;
+}
+
+// One WR pulse: the controller latches the data bus on the rising edge.
+static void LCD_pulseWr(lcd_primitive_t primitive) {
+  controlShadow &= ~LCD_WR_BIT_MASK;
+  LCD_writeControl(primitive);
+  controlShadow |= LCD_WR_BIT_MASK;
+  LCD_writeControl(primitive);
+  busWriteCount++;
+}
 
 // This init intializes all of the hardware that talks to the LCD panel.
 void LCD_init() {
@@ -19,57 +51,51 @@ void LCD_init() {
   if (initFlag)  // Check to see if init has already been called.
     return;      // Already initialized, just return.
   int status;    // First call, continue...
-  status = XGpio_Initialize(&gpioTftControl, LCD_CONTROL_DEVICE_ID);  // Xilinx GPIO init call.
-  if (status != XST_SUCCESS) {
+  status = hal_gpioInit(HAL_GPIO_TFT_CONTROL);   // Provides the RD, WR and CD pins for the LCD controller.
+  if (status != HAL_STATUS_OK) {
     printf("XGPIO_Initialize (TFT) failed\n\r.");
   }
-  status = XGpio_Initialize(&gpioTftDataBus, LCD_DATA_BUS_DEVICE_ID); // Xilinx GPIO init call.
-  if (status != XST_SUCCESS) {
+  status = hal_gpioInit(HAL_GPIO_TFT_DATA_BUS);  // Provides an 8-bit data bus for the LCD controller.
+  if (status != HAL_STATUS_OK) {
     printf("XGPIO_Initialize (TFT Data Bus) failed\n\r.");
   }
   // Set the direction for all signals to be outputs (0 = output, 1 = input).
-  XGpio_SetDataDirection(&gpioTftControl, 1, 0);  // Control bits are always outputs.
-  XGpio_SetDataDirection(&gpioTftDataBus, 1, 0);  // Set up data-bus direction as output (write).
+  hal_gpioSetDataDirection(HAL_GPIO_TFT_CONTROL, 0);   // Control bits are always outputs.
+  hal_gpioSetDataDirection(HAL_GPIO_TFT_DATA_BUS, 0);  // Set up data-bus direction as output (write).
   mio_init(true);
-  LCD_negateRd();  // negate the RD control signal.
-  LCD_negateWr();  // negate the WR control signal.
+  controlShadow = LCD_RD_BIT_MASK | LCD_WR_BIT_MASK;  // RD and WR negated, command mode.
+  LCD_writeControl(LCD_PRIMITIVE_CONTROL);
   initFlag = true; // Note that init has been invoked.
 }
 
 // Sets the logic value on the command/data pin for the LCD controller to command mode.
 void LCD_setCommandMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_DCX_BIT_MASK);  // Clears the DCX bit.
+  LCD_updateControl(LCD_DCX_BIT_MASK, 0);  // Clears the DCX bit.
 }
 
 // Sets the logic value on the command/data pin for the LCD controller to data mode.
 void LCD_setDataMode() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_DCX_BIT_MASK);  // Sets the DCX bit.
+  LCD_updateControl(LCD_DCX_BIT_MASK, LCD_DCX_BIT_MASK);  // Sets the DCX bit.
 }
 
 // Set the logic value on the LCD RD pin for read operations for the LCD data bus.
 void LCD_assertRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_RD_BIT_MASK);  // Asserts RD
+  LCD_updateControl(LCD_RD_BIT_MASK, 0);  // Asserts RD
 }
 
 // Set the logic value on the LCD RD pin to disable read operations on the LCD data bus.
 void LCD_negateRd() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_RD_BIT_MASK);  // Negates RD
+  LCD_updateControl(LCD_RD_BIT_MASK, LCD_RD_BIT_MASK);  // Negates RD
 }
 
 // Set the logic value on the LCD WR pin to enable write operations on the LCD data bus.
 void LCD_assertWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue & ~LCD_WR_BIT_MASK);  // Asserts WR
+  LCD_updateControl(LCD_WR_BIT_MASK, 0);  // Asserts WR
 }
 
 // Set the logic value on the LCD WR pin to disable write operations on the LCD data bus.
 void LCD_negateWr() {
-  uint32_t regValue = XGpio_DiscreteRead(&gpioTftControl, 1);
-  XGpio_DiscreteWrite(&gpioTftControl, 1, regValue | LCD_WR_BIT_MASK);  // Negates WR
+  LCD_updateControl(LCD_WR_BIT_MASK, LCD_WR_BIT_MASK);  // Negates WR
 }
 
 
@@ -103,20 +129,52 @@ void LCD_delay10Nanoseconds(uint16_t delay){
 // Set the GPIO pins on the LCD data bus for read operations.
 void LCD_setReadDataDirection() {
   LCD_negateWr();  // Negate the WR pin to be consistent.
-  XGpio_SetDataDirection(&gpioTftDataBus, 1, 0xFF);  // LCD data bus is input from ZYNQ perspective.
+  hal_gpioSetDataDirection(HAL_GPIO_TFT_DATA_BUS, 0xFF);  // LCD data bus is input from ZYNQ perspective.
 }
 
 // Set the GPIO pins on the LCD data bus for write operations.
 void LCD_setWriteDataDirection() {
   LCD_negateRd();  // Take care to make sure that two drivers are not enabled at the same time.
-  XGpio_SetDataDirection(&gpioTftDataBus, 1, 0);  // LCD data bus is output from ZYNQ perspective.
+  hal_gpioSetDataDirection(HAL_GPIO_TFT_DATA_BUS, 0);  // LCD data bus is output from ZYNQ perspective.
 }
 
 // Writes 8 bits to the TFT controller.
 void LCD_write8(uint8_t value){
-  LCD_assertWr();               // Assert the WR line.
-  LCD_writeData(value);         // Copy the data out to the MIO pins.
-  LCD_negateWr();               // Negate WR.
+  LCD_writeByteStrobe(value);
+}
+
+// Data bus, WR low, WR high: three GPIO writes per byte.
+void LCD_writeByteStrobe(uint8_t value) {
+  LCD_negateWr();  // Only costs a bus access if something left WR asserted.
+  LCD_writeDataBus(LCD_PRIMITIVE_WRITE_BYTE, value);
+  LCD_pulseWr(LCD_PRIMITIVE_WRITE_BYTE);
+}
+
+// High byte first, as the controller expects for RGB565 pixels and 16-bit parameters.
+void LCD_writeWordStrobe(uint16_t value) {
+  LCD_negateWr();
+  LCD_writeDataBus(LCD_PRIMITIVE_WRITE_WORD, value >> 8);
+  LCD_pulseWr(LCD_PRIMITIVE_WRITE_WORD);
+  LCD_writeDataBus(LCD_PRIMITIVE_WRITE_WORD, value);
+  LCD_pulseWr(LCD_PRIMITIVE_WRITE_WORD);
+}
+
+// When both bytes are the same the data bus is set once and only WR is pulsed after that.
+void LCD_writeRepeated(uint16_t value, uint32_t count) {
+  uint8_t hi = value >> 8, lo = value;
+  LCD_negateWr();
+  if (hi == lo) {
+    LCD_writeDataBus(LCD_PRIMITIVE_WRITE_REPEATED, hi);
+    for (uint32_t i = 0; i < 2 * count; i++)
+      LCD_pulseWr(LCD_PRIMITIVE_WRITE_REPEATED);
+  } else {
+    for (uint32_t i = 0; i < count; i++) {
+      LCD_writeDataBus(LCD_PRIMITIVE_WRITE_REPEATED, hi);
+      LCD_pulseWr(LCD_PRIMITIVE_WRITE_REPEATED);
+      LCD_writeDataBus(LCD_PRIMITIVE_WRITE_REPEATED, lo);
+      LCD_pulseWr(LCD_PRIMITIVE_WRITE_REPEATED);
+    }
+  }
 }
 
 // Reads 8 bits from the TFT controller.
@@ -130,22 +188,47 @@ uint8_t LCD_read8(){
 // Write cycle time requires at least a minimum of 66 ns for a write-strobe.
 void LCD_strobeWriteLine(){
   LCD_negateWr();             // Make sure it is negated.
-  LCD_assertWr();             // Assert it.
-//  LCD_delay10Nanoseconds(4);  // Wait for 40 ns.
-  LCD_negateWr();             // negate it.
-//  LCD_delay10Nanoseconds(4);  // Wait for 40 ns.
+  LCD_pulseWr(LCD_PRIMITIVE_CONTROL);  // Each strobe writes the byte on the bus again.
 }
 
 // Copies the argument value to the MIO pins serving as data pins for the LCD.
 void LCD_writeData(uint8_t value) {
-	XGpio_DiscreteWrite(&gpioTftDataBus, 1, value);  // Perform the write using Xilinx GPIO call.
+  LCD_writeDataBus(LCD_PRIMITIVE_CONTROL, value);  // Perform the write through the HAL.
 }
 
 // Copies the value from the MIO pins serving as the data pins for the LCD.
 uint8_t LCD_readData() {
   uint8_t value = 0;
-  value = XGpio_DiscreteRead(&gpioTftDataBus, 1);
+  value = hal_gpioRead(HAL_GPIO_TFT_DATA_BUS);
+  transactionCounts[LCD_PRIMITIVE_READ]++;
   return value;
 }
 
+// Returns the number of write cycles issued to the LCD controller since the last clear.
+uint32_t LCD_getBusWriteCount() {
+  return busWriteCount;
+}
+
+// Restarts the write-cycle count.
+void LCD_clearBusWriteCount() {
+  busWriteCount = 0;
+}
+
+// Returns the GPIO transactions charged to the primitive since the last clear.
+uint32_t LCD_getTransactionCount(lcd_primitive_t primitive) {
+  return transactionCounts[primitive];
+}
+
+// Sum over all primitives.
+uint32_t LCD_getTotalTransactionCount() {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < LCD_PRIMITIVE_COUNT; i++)
+    total += transactionCounts[i];
+  return total;
+}
 
+// Restarts all of the transaction counts.
+void LCD_clearTransactionCounts() {
+  for (uint8_t i = 0; i < LCD_PRIMITIVE_COUNT; i++)
+    transactionCounts[i] = 0;
+}
@@ -8,8 +8,6 @@
 #ifndef LCD_H_
 #define LCD_H_
 #include "arduinoTypes.h"
-#include "xgpio.h"
-#include "TFTGPIO.h"
 #include <stdio.h>
 
 // Provides an API to read/write the LCD controller.
@@ -19,8 +17,7 @@
 #define LCD_MICROSECOND_DELAY_COUNT    649       // Should be approximately 1 microsecond.
 #define LCD_MILLISECOND_DELAY_COUNT 649000       // Should be approximately 1 millisecond.
 
-#define LCD_CONTROL_DEVICE_ID XPAR_AXI_GPIO_TFT_CONTROL_DEVICE_ID
-#define LCD_DATA_BUS_DEVICE_ID XPAR_AXI_GPIO_TFT_DATA_BUS_DEVICE_ID
+// The control pins are on HAL_GPIO_TFT_CONTROL, the data bus on HAL_GPIO_TFT_DATA_BUS (see hal.h).
 #define LCD_BIT_WIDTH 2
 #define LCD_DCX_BIT_MASK 0x00000001
 #define LCD_RD_BIT_MASK  0x00000002
@@ -41,7 +38,12 @@ void LCD_delayMicroseconds(uint16_t delay);  // microsecond delay
 void LCD_delay10Nanoseconds(uint16_t delay);  // delay in 15 ns chunks
 
 // These calls are related to the data bus pins (GPIO) that are connected to the LCD controller.
+// The control pins are kept in a shadow copy and are never read back, so a control change is one
+// GPIO write (none if the pins already have that value) and a WR strobe is two.
 void LCD_write8(uint8_t value);              // Writes 8 bits to the TFT controller.
+void LCD_writeByteStrobe(uint8_t value);     // Data bus + WR pulse, in the current DCX mode.
+void LCD_writeWordStrobe(uint16_t value);    // Two byte strobes, high byte first.
+void LCD_writeRepeated(uint16_t value, uint32_t count);  // value written count times (e.g., a fill).
 uint8_t LCD_read8();                         // Reads 8 bits from the TFT controller.
 void LCD_setCommandMode();
 void LCD_setDataMode();
@@ -55,4 +57,24 @@ uint8_t LCD_readData(void);
 void LCD_setReadDataDirection();
 void LCD_setWriteDataDirection();
 
+// Bus statistics: counts the write cycles (WR strobes) issued to the LCD controller.
+// Used to measure what a drawing strategy costs on the bus.
+uint32_t LCD_getBusWriteCount();
+void LCD_clearBusWriteCount();
+
+// GPIO transactions (AXI reads and writes) charged to each bus primitive, to see what a drawing
+// call costs the processor rather than the LCD. Direct control-pin calls, LCD_writeData() and
+// LCD_strobeWriteLine() are charged to LCD_PRIMITIVE_CONTROL.
+typedef enum {
+  LCD_PRIMITIVE_CONTROL,
+  LCD_PRIMITIVE_WRITE_BYTE,
+  LCD_PRIMITIVE_WRITE_WORD,
+  LCD_PRIMITIVE_WRITE_REPEATED,
+  LCD_PRIMITIVE_READ,
+  LCD_PRIMITIVE_COUNT
+} lcd_primitive_t;
+uint32_t LCD_getTransactionCount(lcd_primitive_t primitive);
+uint32_t LCD_getTotalTransactionCount();
+void LCD_clearTransactionCounts();
+
 #endif /* LCD_H_ */
@@ -0,0 +1,30 @@
+/*
+ * lcdDrivers.cpp
+ */
+
+#include "lcdDrivers.h"
+
+lcdDrivers_window_t lcdDrivers_ili9341Window = {0, 0, 0, 0, false, 0};
+
+const adafruitTftlcd_driver_t *const lcdDrivers_ili9341[4] = {
+  &LcdDriver<Ili9341Controller<0> >::table,
+  &LcdDriver<Ili9341Controller<1> >::table,
+  &LcdDriver<Ili9341Controller<2> >::table,
+  &LcdDriver<Ili9341Controller<3> >::table
+};
+
+void lcdDrivers_invalidateWindow() {
+  lcdDrivers_ili9341Window.valid = false;
+}
+
+uint32_t lcdDrivers_getSkippedWindowRegisterWrites() {
+  return lcdDrivers_ili9341Window.skippedRegisterWrites;
+}
+
+uint32_t lcdDrivers_getSavedWindowBusWrites() {
+  return lcdDrivers_ili9341Window.skippedRegisterWrites * LCDDRIVERS_WINDOW_REGISTER_BUS_WRITES;
+}
+
+void lcdDrivers_clearSkippedWindowRegisterWrites() {
+  lcdDrivers_ili9341Window.skippedRegisterWrites = 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * lcdDrivers.h
+ */
+
+#ifndef LCDDRIVERS_H_
+#define LCDDRIVERS_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+#include "Adafruit_TFTLCD.h"
+#include "registers.h"
+#include "lcd.h"
+
+// Drawing primitives specialized at compile time for one LCD controller and one rotation.
+// Adafruit_TFTLCD picks a table in begin() and setRotation(); after that a drawing call is one
+// indirect call into code with no driver or rotation tests left in it, and with the screen size
+// known to the compiler for clipping.
+//
+// A controller class provides WIDTH and HEIGHT (for its rotation), setAddrWindow(), and
+// beginGramWrite() (command that starts a GRAM write, bus left in data mode).
+
+// Bus writes for one CASET or PASET: the command byte plus start and end, two bytes each.
+#define LCDDRIVERS_WINDOW_REGISTER_BUS_WRITES 5
+
+// What the ILI9341 column (CASET) and page (PASET) registers currently hold. Every GRAM write
+// starts with RAMWR, which moves the address pointer back to the window start, so a register
+// that already holds the wanted values does not have to be written again.
+typedef struct {
+  int16_t  x1, x2, y1, y2;
+  bool     valid;                // False until the registers are known (e.g., after a reset).
+  uint32_t skippedRegisterWrites;  // CASET/PASET commands that were not needed.
+} lcdDrivers_window_t;
+
+extern lcdDrivers_window_t lcdDrivers_ili9341Window;
+
+// Forget the cached window; call after anything else writes CASET/PASET or resets the controller.
+void lcdDrivers_invalidateWindow();
+// Number of CASET/PASET commands skipped because the register already held the window.
+uint32_t lcdDrivers_getSkippedWindowRegisterWrites();
+// The same, in LCD bus writes (see LCD_getBusWriteCount()).
+uint32_t lcdDrivers_getSavedWindowBusWrites();
+void lcdDrivers_clearSkippedWindowRegisterWrites();
+
+// ILI9341: the rotation is done by MADCTL (see Adafruit_TFTLCD::setRotation()), so the address
+// window is always given in rotated coordinates and is left alone after a fill.
+template <uint8_t ROTATION>
+class Ili9341Controller {
+ public:
+  static const int16_t WIDTH  = (ROTATION & 1) ? 320 : 240;
+  static const int16_t HEIGHT = (ROTATION & 1) ? 240 : 320;
+
+  // Only sends the registers that change.
+  static inline void setAddrWindow(int x1, int y1, int x2, int y2) {
+    lcdDrivers_window_t *window = &lcdDrivers_ili9341Window;
+    if (window->valid && (window->x1 == x1) && (window->x2 == x2)) {
+      window->skippedRegisterWrites++;
+    } else {
+      writeRegisterPair(ILI9341_COLADDRSET, x1, x2);
+      window->x1 = x1;
+      window->x2 = x2;
+    }
+    if (window->valid && (window->y1 == y1) && (window->y2 == y2)) {
+      window->skippedRegisterWrites++;
+    } else {
+      writeRegisterPair(ILI9341_PAGEADDRSET, y1, y2);
+      window->y1 = y1;
+      window->y2 = y2;
+    }
+    window->valid = true;
+  }
+
+  static inline void beginGramWrite() {
+    LCD_setCommandMode();
+    LCD_writeByteStrobe(ILI9341_MEMORYWRITE);
+    LCD_setDataMode();
+  }
+
+ private:
+  static inline void writeRegisterPair(uint8_t command, uint16_t start, uint16_t end) {
+    LCD_setCommandMode();
+    LCD_writeByteStrobe(command);
+    LCD_setDataMode();
+    LCD_writeWordStrobe(start);
+    LCD_writeWordStrobe(end);
+  }
+};
+
+// The drawing primitives, written once against the controller interface above. Clipping is the
+// same as in the generic Adafruit_TFTLCD versions. None needs the Adafruit_TFTLCD the driver table
+// passes, so that parameter is left unnamed.
+template <class Controller>
+class LcdDriver {
+ public:
+  static void drawPixel(Adafruit_TFTLCD *, int16_t x, int16_t y, uint16_t color) {
+    if ((x < 0) || (y < 0) || (x >= Controller::WIDTH) || (y >= Controller::HEIGHT))
+      return;
+    Controller::setAddrWindow(x, y, Controller::WIDTH - 1, Controller::HEIGHT - 1);
+    Controller::beginGramWrite();
+    LCD_writeWordStrobe(color);
+  }
+
+  static void drawFastHLine(Adafruit_TFTLCD *, int16_t x, int16_t y, int16_t length, uint16_t color) {
+    fillClipped(x, y, length, 1, color);
+  }
+
+  static void drawFastVLine(Adafruit_TFTLCD *, int16_t x, int16_t y, int16_t length, uint16_t color) {
+    fillClipped(x, y, 1, length, color);
+  }
+
+  static void fillRect(Adafruit_TFTLCD *, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillClipped(x, y, w, h, color);
+  }
+
+  static void fillScreen(Adafruit_TFTLCD *, uint16_t color) {
+    Controller::setAddrWindow(0, 0, Controller::WIDTH - 1, Controller::HEIGHT - 1);
+    Controller::beginGramWrite();
+    LCD_writeRepeated(color, (uint32_t) Controller::WIDTH * Controller::HEIGHT);
+  }
+
+  static void setAddrWindow(Adafruit_TFTLCD *, int x1, int y1, int x2, int y2) {
+    Controller::setAddrWindow(x1, y1, x2, y2);
+  }
+
+  static void pushColors(Adafruit_TFTLCD *, const uint16_t *data, uint32_t len, bool first) {
+    if (first)
+      Controller::beginGramWrite();
+    LCD_setDataMode();
+    while (len--)
+      LCD_writeWordStrobe(*data++);
+  }
+
+  static void restoreAddrWindow(Adafruit_TFTLCD *) {
+  }
+
+  static const adafruitTftlcd_driver_t table;
+
+ private:
+  static inline void fillClipped(int16_t x1, int16_t y1, int16_t w, int16_t h, uint16_t color) {
+    int16_t x2, y2;
+    if ((w <= 0) || (h <= 0) || (x1 >= Controller::WIDTH) || (y1 >= Controller::HEIGHT) ||
+        ((x2 = x1 + w - 1) < 0) || ((y2 = y1 + h - 1) < 0))
+      return;
+    if (x1 < 0)
+      x1 = 0;
+    if (y1 < 0)
+      y1 = 0;
+    if (x2 >= Controller::WIDTH)
+      x2 = Controller::WIDTH - 1;
+    if (y2 >= Controller::HEIGHT)
+      y2 = Controller::HEIGHT - 1;
+    Controller::setAddrWindow(x1, y1, x2, y2);
+    Controller::beginGramWrite();
+    LCD_writeRepeated(color, (uint32_t) (x2 - x1 + 1) * (y2 - y1 + 1));
+  }
+};
+
+template <class Controller>
+const adafruitTftlcd_driver_t LcdDriver<Controller>::table = {
+  LcdDriver<Controller>::drawPixel,
+  LcdDriver<Controller>::drawFastHLine,
+  LcdDriver<Controller>::drawFastVLine,
+  LcdDriver<Controller>::fillRect,
+  LcdDriver<Controller>::fillScreen,
+  LcdDriver<Controller>::setAddrWindow,
+  LcdDriver<Controller>::pushColors,
+  LcdDriver<Controller>::restoreAddrWindow
+};
+
+// Specialized ILI9341 drivers, indexed by rotation.
+extern const adafruitTftlcd_driver_t *const lcdDrivers_ili9341[4];
+
+#endif /* LCDDRIVERS_H_ */
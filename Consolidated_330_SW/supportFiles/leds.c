@@ -1,17 +1,16 @@
 // Provides easy access to the LEDs.
 #include "leds.h"
 #include "mio.h"
-#include "xgpio.h"
+#include "hal.h"
 #include "stdio.h"
 
-static XGpio Gpio_LEDs;  // Instance of the LED GPIO Driver
 static int initLedFlag = 0;  // This will be '1' if LEDs have been initialized.
 
 // This will init the GPIO hardware so you can write to the 4 LEDs  (LED3 - LED0) on the ZYBO board.
 int leds_init(bool printFailedStatusFlag) {
   int status;
-  status = XGpio_Initialize(&Gpio_LEDs, XPAR_GPIO_LEDS_DEVICE_ID);
-  if (status != XST_SUCCESS) {
+  status = hal_gpioInit(HAL_GPIO_LEDS);
+  if (status != HAL_STATUS_OK) {
 	if (printFailedStatusFlag) {
       printf("XGPIO_Initialize (leds) failed\n\r.");
       return 1;
@@ -21,7 +20,7 @@ int leds_init(bool printFailedStatusFlag) {
   // Also init LD4, connected to MIO7. Also inits the entire MIO system.
   mio_init(printFailedStatusFlag);
   // Set the direction for all signals to be outputs (0 = output).
-  XGpio_SetDataDirection(&Gpio_LEDs, 1, 0);
+  hal_gpioSetDataDirection(HAL_GPIO_LEDS, 0);
   initLedFlag=1;
   return 0;
 }
@@ -32,7 +31,7 @@ int leds_init(bool printFailedStatusFlag) {
 // '0' = off.
 int leds_write(int ledValue) {
   if (initLedFlag) {
-    XGpio_DiscreteWrite(&Gpio_LEDs, 1, ledValue);
+    hal_gpioWrite(HAL_GPIO_LEDS, ledValue);
     return 0;
   } else {
 	printf("Error: you must invoke initializeLeds() prior to calling writeLeds()\n\r.");
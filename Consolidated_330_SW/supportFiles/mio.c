@@ -7,7 +7,7 @@
 
 #include <stdio.h>
 #include "mio.h"
-#include "xgpiops.h"
+#include "hal.h"
 
 // The MIO system is the PS GPIO that communicates with the MIO pins on the ZYBO board.
 // MIO pins: 13, 10, 11, 12, 0, 9, 14, 15 are connected to JF pins: 1, 2, 3, 4, 7, 8, 9, 10.
@@ -16,28 +16,25 @@
 // BTN4 is connected to MIO50
 
 static bool mioInitFlag = false;  // Ensures the init routine will be invoked only once.
-static XGpioPs_Config *ConfigPtr; // Handle to the mio config handle.
-XGpioPs mioGpio;	              // The driver instance for GPIO Device.
 
 // Initializes the MIO system and sets up directions for the LEDs and buttons.
 // The boolean parameter allows you to enable/disable the printing of error messages.
 int mio_init(bool printFailedStatusFlag){
   if (!mioInitFlag) {  // Only do this once.
-    ConfigPtr = XGpioPs_LookupConfig(XPAR_XGPIOPS_0_DEVICE_ID);  // Lookup the config info for the MIO GPIO device.
-	int status = XGpioPs_CfgInitialize(&mioGpio, ConfigPtr, ConfigPtr->BaseAddr);  // Initialize it..
-	if (status != XST_SUCCESS) {   // Check for errors.
+	int status = hal_mioInit();    // Initialize the PS GPIO that drives the MIO pins.
+	if (status != HAL_STATUS_OK) { // Check for errors.
 	  if (printFailedStatusFlag) { // Print an error message if enabled.
 	    printf("XGpioPs_CfgInitialize filed in initMio().\n\r");
 	  }
-      return XST_FAILURE;  // Return the value of the failure code to aid debugging.
+      return status;  // Return the value of the failure code to aid debugging.
 	}
   }
   // Setup direction and enable for LED4 on ZYBO board.
-  XGpioPs_SetDirectionPin(&mioGpio, MIO_LD4_MIO_PIN, 1);
-  XGpioPs_SetOutputEnablePin(&mioGpio, MIO_LD4_MIO_PIN, 1);
+  hal_mioSetDirectionPin(MIO_LD4_MIO_PIN, 1);
+  hal_mioSetOutputEnablePin(MIO_LD4_MIO_PIN, 1);
   // Setup direction for BTN4 and BTN5 on ZYBO board.
-  XGpioPs_SetDirectionPin(&mioGpio, MIO_BTN4_MIO_PIN, 0);
-  XGpioPs_SetDirectionPin(&mioGpio, MIO_BTN5_MIO_PIN, 0);
+  hal_mioSetDirectionPin(MIO_BTN4_MIO_PIN, 0);
+  hal_mioSetDirectionPin(MIO_BTN5_MIO_PIN, 0);
   mioInitFlag = true;
   return 0;
 }
@@ -47,7 +44,7 @@ void mio_writePin(u8 mioPinNumber, u8 value){
   if (!mioInitFlag){
     printf("writeMioPin: must call initMio() first.\n\r");
   } else {
-    XGpioPs_WritePin(&mioGpio, mioPinNumber, value);
+    hal_mioWritePin(mioPinNumber, value);
   }
 }
 
@@ -56,7 +53,7 @@ void mio_WriteBank0(u32 value) {
   if (!mioInitFlag){
     printf("writeMioPin: must call initMio() first.\n\r");
   } else {
-    XGpioPs_Write(&mioGpio, 0, value);
+    hal_mioWriteBank(0, value);
   }
 }
 
@@ -65,7 +62,7 @@ u8 mio_readPin(u8 mioPinNo) {
   if (!mioInitFlag){
 	printf("writeMioPin: must call initMio() first.\n\r");
   } else {
-    return XGpioPs_ReadPin(&mioGpio, mioPinNo);
+    return hal_mioReadPin(mioPinNo);
   }
   return 0;
 }
@@ -75,7 +72,7 @@ void mio_setPinAsInput(u8 mioPinNo) {
   if (!mioInitFlag){
 	printf("setMioPinDirection(): must call initMio() first.\n\r");
   } else {
-	  XGpioPs_SetDirectionPin(&mioGpio, mioPinNo, MIO_INPUT_PIN_CONFIGURATION);
+	  hal_mioSetDirectionPin(mioPinNo, MIO_INPUT_PIN_CONFIGURATION);
   }
 }
 
@@ -84,8 +81,8 @@ void mio_setPinAsOutput(u8 mioPinNo) {
   if (!mioInitFlag){
 	printf("setMioPinDirection(): must call initMio() first.\n\r");
   } else {
-    XGpioPs_SetDirectionPin(&mioGpio, mioPinNo, MIO_OUTPUT_PIN_CONFIGURATION);  // This configures the output direction.
-    XGpioPs_SetOutputEnablePin(&mioGpio, mioPinNo, 1);  // This enables the output.
+    hal_mioSetDirectionPin(mioPinNo, MIO_OUTPUT_PIN_CONFIGURATION);  // This configures the output direction.
+    hal_mioSetOutputEnablePin(mioPinNo, 1);  // This enables the output.
   }
 }
 
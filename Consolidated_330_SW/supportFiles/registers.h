@@ -77,6 +77,8 @@
 #define ILI9341_COLADDRSET         0x2A
 #define ILI9341_PAGEADDRSET        0x2B
 #define ILI9341_MEMORYWRITE        0x2C
+#define ILI9341_VERTSCROLLDEF      0x33
+#define ILI9341_VERTSCROLLSTART    0x37
 #define ILI9341_PIXELFORMAT        0x3A
 #define ILI9341_FRAMECONTROL       0xB1
 #define ILI9341_DISPLAYFUNC        0xB6
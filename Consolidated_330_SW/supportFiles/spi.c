@@ -8,7 +8,7 @@
 #include <stdio.h>
 #include "spi.h"
 #include "arduinoTypes.h"
-#include "xil_io.h"
+#include "hal.h"
 
 void spi_begin(void) {
   spi_softwareReset();  // Just reset the SPI hardware in the ZYNQ fabric.
@@ -68,6 +68,22 @@ void spi_setTransmissionMode(uint8_t mode) {
   }
 }
 
+// Sets the bit-order and the mode together, with one read of the control register and a write
+// only if they changed. Call it once at the start of a transaction instead of setting both before
+// every byte: the settings stay until they are changed again.
+void spi_beginTransaction(uint8_t bitOrder, uint8_t mode) {
+  uint32_t regValue = spi_readRegister(SPI_CNTRL_REG_OFFSET);
+  uint32_t newValue = regValue & ~(SPI_CNTRL_REG_LSB_FIRST_MASK | SPI_CNTRL_CPOL_MASK | SPI_CNTRL_CPHA_MASK);
+  if (bitOrder == SPI_LSBFIRST)
+    newValue |= SPI_CNTRL_REG_LSB_FIRST_MASK;
+  if ((mode == SPI_MODE_2) || (mode == SPI_MODE_3))
+    newValue |= SPI_CNTRL_CPOL_MASK;
+  if ((mode == SPI_MODE_1) || (mode == SPI_MODE_3))
+    newValue |= SPI_CNTRL_CPHA_MASK;
+  if (newValue != regValue)
+    spi_writeRegister(SPI_CNTRL_REG_OFFSET, newValue);
+}
+
 // This actually does the bit transfer. It will block until the transfer is complete.
 // It uses the transfer sequence (mostly) outlined in the Xilinx SPI documentation (see above).
 uint8_t spi_transfer(uint8_t val) {
@@ -111,6 +127,137 @@ uint8_t spi_transfer(uint8_t val) {
   return readValue;
 }
 
+// State of the asynchronous transfer (see spi_transferBufferAsync()).
+static const uint8_t *asyncTx;
+static uint8_t *asyncRx;
+static uint32_t asyncRemaining;   // Bytes not sent yet.
+static uint32_t asyncInFlight;    // Bytes in the FIFOs.
+static uint32_t asyncControl;     // See spi_masterControl().
+static spi_callback_t asyncDone;
+static void *asyncContext;
+static volatile bool asyncBusy = false;
+
+// The control-register value for a transfer: the same settings as spi_transfer() makes, without
+// the inhibit bit. Read once per transfer; the chunks below then just write it.
+static uint32_t spi_masterControl() {
+  return (spi_readRegister(SPI_CNTRL_REG_OFFSET) | SPI_CNTROL_REG_MANUAL_SLAVE_ASSERTION_ENABLE_MASK |
+          SPI_CNTRL_MASTER_MASK | SPI_CNTRL_SPE_MASK) & ~SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK;
+}
+
+// Inhibits transactions and throws away anything left in the receive FIFO.
+static void spi_inhibitAndResetReceiveFifo(uint32_t control) {
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET,
+      control | SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK | SPI_CNTRL_REG_RX_FIFO_RESET_MASK);
+}
+
+// Fills the transmit FIFO (transactions are inhibited) with up to SPI_FIFO_DEPTH bytes of tx, or
+// zeros if tx is NULL, then clears the inhibit bit to start. Returns the number of bytes queued.
+static uint32_t spi_startChunk(uint32_t control, const uint8_t *tx, uint32_t length) {
+  uint32_t count = (length < SPI_FIFO_DEPTH) ? length : SPI_FIFO_DEPTH;
+  for (uint32_t i = 0; i < count; i++)
+    spi_writeRegister(SPI_DATA_TRANSMIT_REG_OFFSET, tx ? tx[i] : 0);
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, control);
+  return count;
+}
+
+// Waits until count bytes have come back: the transmit FIFO runs empty while the last byte is
+// still being shifted. The occupancy register holds the count minus one, so check empty first.
+static void spi_waitForReceived(uint32_t count) {
+  while ((spi_readRegister(SPI_STATUS_REG_OFFET) & SPI_STATUS_REG_RX_EMPTY_MASK) ||
+         (spi_readRegister(SPI_RECEIVE_FIFO_OCC_REG_OFFSET) + 1 < count));
+}
+
+// Inhibits transactions again and moves the count bytes from the receive FIFO to rx (or drops them).
+static void spi_finishChunk(uint32_t control, uint8_t *rx, uint32_t count) {
+  spi_waitForReceived(count);
+  spi_writeRegister(SPI_CNTRL_REG_OFFSET, control | SPI_CNTRL_REG_MASTER_TRANSACTION_INHIBIT_MASK);
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t value = spi_readRegister(SPI_DATA_RECEIVE_REG_OFFSET);
+    if (rx)
+      rx[i] = value;
+  }
+}
+
+bool spi_transferBuffer(const uint8_t *tx, uint8_t *rx, uint32_t length) {
+  if (asyncBusy)
+    return false;
+  uint32_t control = spi_masterControl();
+  spi_inhibitAndResetReceiveFifo(control);
+  while (length) {
+    uint32_t count = spi_startChunk(control, tx, length);
+    spi_finishChunk(control, rx, count);
+    if (tx)
+      tx += count;
+    if (rx)
+      rx += count;
+    length -= count;
+  }
+  return true;
+}
+
+// Starts the next chunk of the asynchronous transfer.
+static void spi_startAsyncChunk() {
+  asyncInFlight = spi_startChunk(asyncControl, asyncTx, asyncRemaining);
+  if (asyncTx)
+    asyncTx += asyncInFlight;
+  asyncRemaining -= asyncInFlight;
+}
+
+// Clears the transmit-FIFO-empty interrupt if it is pending. Returns true if it was.
+static bool spi_acknowledgeTxEmpty() {
+  if (!(spi_readRegister(SPI_INT_STATUS_REG_OFFSET) & SPI_INT_TX_EMPTY_MASK))
+    return false;
+  spi_writeRegister(SPI_INT_STATUS_REG_OFFSET, SPI_INT_TX_EMPTY_MASK);
+  return true;
+}
+
+// Disables the interrupt and calls the completion callback.
+static void spi_finishAsync() {
+  spi_writeRegister(SPI_GLOBAL_INT_ENABLE_REG_OFFSET, 0);
+  spi_writeRegister(SPI_INT_ENABLE_REG_OFFSET, 0);
+  asyncBusy = false;
+  if (asyncDone)
+    asyncDone(asyncContext);
+}
+
+bool spi_transferBufferAsync(const uint8_t *tx, uint8_t *rx, uint32_t length, spi_callback_t done, void *context) {
+  if (asyncBusy)
+    return false;
+  asyncBusy = true;
+  asyncTx = tx;
+  asyncRx = rx;
+  asyncRemaining = length;
+  asyncDone = done;
+  asyncContext = context;
+  asyncControl = spi_masterControl();
+  spi_inhibitAndResetReceiveFifo(asyncControl);
+  if (!length) {
+    spi_finishAsync();
+    return true;
+  }
+  spi_acknowledgeTxEmpty();  // Left over from an earlier transfer.
+  spi_writeRegister(SPI_INT_ENABLE_REG_OFFSET, SPI_INT_TX_EMPTY_MASK);
+  spi_writeRegister(SPI_GLOBAL_INT_ENABLE_REG_OFFSET, SPI_GLOBAL_INT_ENABLE_MASK);
+  spi_startAsyncChunk();
+  return true;
+}
+
+bool spi_isBusy() {
+  return asyncBusy;
+}
+
+void spi_service() {
+  if (!asyncBusy || !spi_acknowledgeTxEmpty())
+    return;
+  spi_finishChunk(asyncControl, asyncRx, asyncInFlight);
+  if (asyncRx)
+    asyncRx += asyncInFlight;
+  if (asyncRemaining)
+    spi_startAsyncChunk();
+  else
+    spi_finishAsync();
+}
+
 // Read the current SPI control-register value and OR the bits of the mask in.
 void spi_setControlRegisterBits(uint32_t mask) {
   uint32_t regValue = spi_readRegister(SPI_CNTRL_REG_OFFSET);
@@ -126,12 +273,12 @@ void spi_clearControlRegisterBits(uint32_t mask) {
 
 // Directly write the specified SPI register (offsets are defined in spi.h).
 void spi_writeRegister(uint32_t regOffset, uint32_t value) {
-  Xil_Out32(SPI_CORE_BASE_ADDRESS + regOffset, value);
+  hal_spiWriteRegister(regOffset, value);
 }
 
 // Directly read the specified SPI register (offset are defined in spi.h).
 uint32_t spi_readRegister(uint32_t regOffset) {
-  return Xil_In32(SPI_CORE_BASE_ADDRESS + regOffset);
+  return hal_spiReadRegister(regOffset);
 }
 
 // The slave-select bits determine which of slaves attached to the SPI controller are active.
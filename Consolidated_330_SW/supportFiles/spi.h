@@ -27,6 +27,13 @@
 
 #define SPI_CORE_BASE_ADDRESS XPAR_SPI_0_BASEADDR  // from xparameters.h
 
+#define SPI_GLOBAL_INT_ENABLE_REG_OFFSET 0x1C
+#define SPI_GLOBAL_INT_ENABLE_MASK 0x80000000
+
+#define SPI_INT_STATUS_REG_OFFSET 0x20  // Bits toggle when written with a 1 (write the status back to clear it).
+#define SPI_INT_ENABLE_REG_OFFSET 0x28
+#define SPI_INT_TX_EMPTY_MASK 0x00000004  // DTR empty: the transmit FIFO has gone empty.
+
 #define SPI_RESET_REG_OFFSET 0x40
 #define SPI_RESET_REG_MASK 0x0000000A  // Write this value to force a software reset of the SPI core.
 
@@ -56,6 +63,8 @@
 #define SPI_TRANSMIT_FIFO_OCC_REG_OFFSET 0x74
 #define SPI_RECEIVE_FIFO_OCC_REG_OFFSET 0x78
 
+#define SPI_FIFO_DEPTH 16  // Bytes in each of the transmit and receive FIFOs (the core is built with FIFOs).
+
 #define SPI_DELAY_FUDGE_FACTOR 10000  // This is the multiplier to get the delay value of 1 to be 1 millisecond.
 
 #define SPI_TFT_SLAVE_SELECT_MASK 0x00000001  // TFT SPI slave select is bit 0 (only used if LCD is accessed via SPI - deprecated).
@@ -69,6 +78,7 @@ void spi_end(void);
 void spi_setBitOrder(uint8_t order);
 void spi_setClockDivider(uint8_t divider);
 void spi_setTransmissionMode(uint8_t mode);
+void spi_beginTransaction(uint8_t order, uint8_t mode);  // Both of the above at once.
 uint8_t spi_transfer(uint8_t val);
 uint32_t spi_readRegister(uint32_t regOffset);
 void spi_writeRegister(uint32_t regOffset, uint32_t value);
@@ -84,4 +94,26 @@ void spi_configure();
 void spi_waitUntilTxRegisterIsEmpty();
 bool spi_isReceiveFifoFull();
 
+// Multi-byte transfers. The slave select and the bit order/mode (spi_beginTransaction()) are the
+// caller's, as for spi_transfer(). tx may be NULL to send zeros, rx may be NULL to drop what comes back.
+// Transfers length bytes, up to SPI_FIFO_DEPTH at a time: fills the transmit FIFO, lets it run
+// empty and then empties the receive FIFO. Blocks until done. Returns false (and does nothing)
+// while an asynchronous transfer is in progress, which owns the FIFOs until it completes.
+bool spi_transferBuffer(const uint8_t *tx, uint8_t *rx, uint32_t length);
+
+// Called with the context when an asynchronous transfer has completed.
+typedef void (*spi_callback_t)(void *context);
+// Starts the same transfer and returns right away; each time the transmit FIFO runs empty the SPI
+// interrupt empties the receive FIFO and refills the transmit FIFO, and done(context) is called
+// from the interrupt at the end. The buffers must stay valid until then. Returns false (and does
+// nothing) if a transfer is still in progress. interrupts_initAll() connects the SPI interrupt where
+// the board routes it (hal.h); otherwise (interrupts_isSpiInterruptConnected()), call spi_service()
+// from a tick instead. The touch-controller driver does not use it: its reads are a few dozen
+// bytes and stay blocking.
+bool spi_transferBufferAsync(const uint8_t *tx, uint8_t *rx, uint32_t length, spi_callback_t done, void *context);
+// True while an asynchronous transfer is in progress.
+bool spi_isBusy();
+// Moves an asynchronous transfer along if the transmit FIFO has run empty. This is the SPI ISR.
+void spi_service();
+
 #endif /* SPI_H_ */
@@ -0,0 +1,144 @@
+/*
+ * touchCalibration.c
+ */
+
+#include "touchCalibration.h"
+
+#define TOUCHCALIBRATION_ONE (1L << TOUCHCALIBRATION_FRACTION_BITS)
+// Rounds a constant to Q16 at compile time.
+#define TOUCHCALIBRATION_Q16(v) ((int32_t) ((v) * TOUCHCALIBRATION_ONE + ((v) < 0 ? -0.5 : 0.5)))
+
+// Limits that keep touchCalibration_map() inside 32 bits for 12-bit raw values:
+// 2 * 4095 * 1.0 + 16384 pixels, in Q16, is below 2^31.
+#define TOUCHCALIBRATION_MAX_SCALE 1.0     // Pixels per raw unit.
+#define TOUCHCALIBRATION_MAX_OFFSET 16384.0  // Pixels.
+// Points closer to a line than this (relative to their spread) do not pin down a matrix.
+#define TOUCHCALIBRATION_MIN_SPREAD 1e-6
+
+void touchCalibration_default(touchCalibration_t *calibration) {
+  // x = (rawY - MIN_X) * width / (MAX_X - MIN_X), y = (MAX_Y - rawX) * height / (MAX_Y - MIN_Y).
+  calibration->a = 0;
+  calibration->b = TOUCHCALIBRATION_Q16(TOUCHCALIBRATION_WIDTH / (TOUCHCALIBRATION_MAX_X_TOUCH_POINT - TOUCHCALIBRATION_MIN_X_TOUCH_POINT));
+  calibration->c = TOUCHCALIBRATION_Q16(-TOUCHCALIBRATION_MIN_X_TOUCH_POINT * TOUCHCALIBRATION_WIDTH /
+      (TOUCHCALIBRATION_MAX_X_TOUCH_POINT - TOUCHCALIBRATION_MIN_X_TOUCH_POINT));
+  calibration->d = TOUCHCALIBRATION_Q16(-TOUCHCALIBRATION_HEIGHT / (TOUCHCALIBRATION_MAX_Y_TOUCH_POINT - TOUCHCALIBRATION_MIN_Y_TOUCH_POINT));
+  calibration->e = 0;
+  calibration->f = TOUCHCALIBRATION_Q16(TOUCHCALIBRATION_MAX_Y_TOUCH_POINT * TOUCHCALIBRATION_HEIGHT /
+      (TOUCHCALIBRATION_MAX_Y_TOUCH_POINT - TOUCHCALIBRATION_MIN_Y_TOUCH_POINT));
+}
+
+// Converts to Q16. Returns false if the value is outside the limits above.
+static bool touchCalibration_toQ16(double value, double limit, int32_t *q16) {
+  if ((value >= limit) || (value <= -limit))
+    return false;
+  *q16 = (int32_t) (value * TOUCHCALIBRATION_ONE + (value < 0 ? -0.5 : 0.5));
+  return true;
+}
+
+// Least squares for one output coordinate. With the raw points centered on their mean, the normal
+// equations for the two scale terms are a 2 x 2 system and the offset follows from the means.
+// out[i] is the LCD x (or y) of point i.
+static bool touchCalibration_solveRow(const touchCalibration_point_t *raw, const int16_t *out, uint8_t count,
+    double meanX, double meanY, double sxx, double sxy, double syy, double det, int32_t *row) {
+  double sxo = 0, syo = 0, meanOut = 0;
+  for (uint8_t i = 0; i < count; i++)
+    meanOut += out[i];
+  meanOut /= count;
+  for (uint8_t i = 0; i < count; i++) {
+    sxo += (raw[i].x - meanX) * (out[i] - meanOut);
+    syo += (raw[i].y - meanY) * (out[i] - meanOut);
+  }
+  double scaleX = (syy * sxo - sxy * syo) / det;
+  double scaleY = (sxx * syo - sxy * sxo) / det;
+  // A press on pixel k is mapped to k + 0.5, the middle of the pixel, so that rounding down in
+  // touchCalibration_map() gives back k, with half a pixel of slack on either side.
+  double offset = meanOut + 0.5 - scaleX * meanX - scaleY * meanY;
+  return touchCalibration_toQ16(scaleX, TOUCHCALIBRATION_MAX_SCALE, &row[0]) &&
+      touchCalibration_toQ16(scaleY, TOUCHCALIBRATION_MAX_SCALE, &row[1]) &&
+      touchCalibration_toQ16(offset, TOUCHCALIBRATION_MAX_OFFSET, &row[2]);
+}
+
+bool touchCalibration_solve(touchCalibration_t *calibration, const touchCalibration_point_t *raw,
+    const touchCalibration_point_t *lcd, uint8_t count) {
+  if ((count < 3) || (count > TOUCHCALIBRATION_MAX_POINTS))
+    return false;
+  double meanX = 0, meanY = 0, sxx = 0, sxy = 0, syy = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    meanX += raw[i].x;
+    meanY += raw[i].y;
+  }
+  meanX /= count;
+  meanY /= count;
+  for (uint8_t i = 0; i < count; i++) {
+    double dx = raw[i].x - meanX, dy = raw[i].y - meanY;
+    sxx += dx * dx;
+    sxy += dx * dy;
+    syy += dy * dy;
+  }
+  double det = sxx * syy - sxy * sxy;
+  if (!(det > TOUCHCALIBRATION_MIN_SPREAD * sxx * syy))
+    return false;  // All on one line (or all the same point).
+  int16_t lcdX[TOUCHCALIBRATION_MAX_POINTS], lcdY[TOUCHCALIBRATION_MAX_POINTS];
+  for (uint8_t i = 0; i < count; i++) {
+    lcdX[i] = lcd[i].x;
+    lcdY[i] = lcd[i].y;
+  }
+  int32_t rowX[3], rowY[3];
+  if (!touchCalibration_solveRow(raw, lcdX, count, meanX, meanY, sxx, sxy, syy, det, rowX) ||
+      !touchCalibration_solveRow(raw, lcdY, count, meanX, meanY, sxx, sxy, syy, det, rowY))
+    return false;
+  calibration->a = rowX[0];
+  calibration->b = rowX[1];
+  calibration->c = rowX[2];
+  calibration->d = rowY[0];
+  calibration->e = rowY[1];
+  calibration->f = rowY[2];
+  return true;
+}
+
+void touchCalibration_fromRotation1(uint8_t rotation, int16_t *x, int16_t *y) {
+  int16_t x1 = *x, y1 = *y;
+  switch (rotation & 3) {
+  case 0:
+    *x = TOUCHCALIBRATION_HEIGHT - 1 - y1;
+    *y = x1;
+    break;
+  case 2:
+    *x = y1;
+    *y = TOUCHCALIBRATION_WIDTH - 1 - x1;
+    break;
+  case 3:
+    *x = TOUCHCALIBRATION_WIDTH - 1 - x1;
+    *y = TOUCHCALIBRATION_HEIGHT - 1 - y1;
+    break;
+  }
+}
+
+void touchCalibration_toRotation1(uint8_t rotation, int16_t *x, int16_t *y) {
+  int16_t x0 = *x, y0 = *y;
+  switch (rotation & 3) {
+  case 0:
+    *x = y0;
+    *y = TOUCHCALIBRATION_HEIGHT - 1 - x0;
+    break;
+  case 2:
+    *x = TOUCHCALIBRATION_WIDTH - 1 - y0;
+    *y = x0;
+    break;
+  case 3:
+    *x = TOUCHCALIBRATION_WIDTH - 1 - x0;
+    *y = TOUCHCALIBRATION_HEIGHT - 1 - y0;
+    break;
+  }
+}
+
+// Raw values are 12 bits and touchCalibration_solve() keeps the matrix within the limits above, so
+// the sums fit in 32 bits. The shift rounds down.
+void touchCalibration_map(const touchCalibration_t *calibration, uint8_t rotation, int16_t *x, int16_t *y) {
+  int32_t rawX = *x, rawY = *y;
+  int16_t x1 = (calibration->a * rawX + calibration->b * rawY + calibration->c) >> TOUCHCALIBRATION_FRACTION_BITS;
+  int16_t y1 = (calibration->d * rawX + calibration->e * rawY + calibration->f) >> TOUCHCALIBRATION_FRACTION_BITS;
+  touchCalibration_fromRotation1(rotation, &x1, &y1);
+  *x = x1;
+  *y = y1;
+}
@@ -0,0 +1,60 @@
+/*
+ * touchCalibration.h
+ */
+
+#ifndef TOUCHCALIBRATION_H_
+#define TOUCHCALIBRATION_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// Maps raw 12-bit touch-controller coordinates to LCD coordinates with an affine matrix
+//   x = a * rawX + b * rawY + c
+//   y = d * rawX + e * rawY + f
+// whose entries are stored in Q16 fixed point, so mapping a sample takes six integer multiplies
+// and no floating point. The matrix maps to the panel in rotation 1 (320 x 240, the rotation
+// display_init() sets); touchCalibration_map() then turns the point for the rotation asked for,
+// the same way the LCD's MADCTL setting turns the image (see Adafruit_TFTLCD::setRotation()).
+// A matrix can correct offset, scale, skew and a panel glued on slightly rotated.
+
+#define TOUCHCALIBRATION_FRACTION_BITS 16
+#define TOUCHCALIBRATION_WIDTH  320  // The panel in rotation 1.
+#define TOUCHCALIBRATION_HEIGHT 240
+#define TOUCHCALIBRATION_MAX_POINTS 16  // Most point pairs touchCalibration_solve() takes.
+
+typedef struct {
+  int32_t a, b, c;  // Q16. x in rotation 1.
+  int32_t d, e, f;  // Q16. y in rotation 1.
+} touchCalibration_t;
+
+typedef struct {
+  int16_t x, y;
+} touchCalibration_point_t;
+
+// The raw values at the edges of the panel in the calibration the board has always used: raw x
+// runs from MAX_Y at the top of the panel to MIN_Y at the bottom, raw y from MIN_X at the left to
+// MAX_X at the right.
+#define TOUCHCALIBRATION_MIN_Y_TOUCH_POINT 280.0
+#define TOUCHCALIBRATION_MAX_Y_TOUCH_POINT 3900.0
+#define TOUCHCALIBRATION_MIN_X_TOUCH_POINT 350.0
+#define TOUCHCALIBRATION_MAX_X_TOUCH_POINT 3950.0
+
+// That calibration, as a matrix.
+void touchCalibration_default(touchCalibration_t *calibration);
+
+// Solves for the matrix that maps raw[i] to lcd[i] (LCD coordinates in rotation 1), exactly for 3
+// points and in the least-squares sense for more. Runs once, so it may use floating point.
+// Returns false, leaving calibration alone, for fewer than 3 or more than TOUCHCALIBRATION_MAX_POINTS
+// points, or for points that do not span the panel (all on one line).
+bool touchCalibration_solve(touchCalibration_t *calibration, const touchCalibration_point_t *raw,
+    const touchCalibration_point_t *lcd, uint8_t count);
+
+// Maps a raw sample to LCD coordinates in the given rotation (0-3). Integer only; rounds down, so
+// a point left of or above the panel comes out negative.
+void touchCalibration_map(const touchCalibration_t *calibration, uint8_t rotation, int16_t *x, int16_t *y);
+
+// Turns a point between rotation 1 and the given rotation. Points outside the panel are turned too.
+void touchCalibration_fromRotation1(uint8_t rotation, int16_t *x, int16_t *y);
+void touchCalibration_toRotation1(uint8_t rotation, int16_t *x, int16_t *y);
+
+#endif /* TOUCHCALIBRATION_H_ */
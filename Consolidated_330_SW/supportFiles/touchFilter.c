@@ -0,0 +1,84 @@
+/*
+ * touchFilter.c
+ */
+
+#include <string.h>
+#include "touchFilter.h"
+
+void touchFilter_init(touchFilter_t *filter, uint8_t minZ) {
+  filter->minZ = minZ;
+  touchFilter_reset(filter);
+}
+
+void touchFilter_reset(touchFilter_t *filter) {
+  uint8_t minZ = filter->minZ;
+  memset(filter, 0, sizeof(*filter));
+  filter->minZ = minZ;
+}
+
+// Median of the window along x (yAxis false) or y. Insertion sort: there are only a few values.
+static int16_t touchFilter_median(const touchFilter_t *filter, bool yAxis) {
+  int16_t values[TOUCHFILTER_MEDIAN_SAMPLES];
+  for (uint8_t i = 0; i < filter->count; i++) {
+    int16_t value = yAxis ? filter->window[i].y : filter->window[i].x;
+    uint8_t j = i;
+    for (; (j > 0) && (values[j - 1] > value); j--)
+      values[j] = values[j - 1];
+    values[j] = value;
+  }
+  return values[(filter->count - 1) / 2];
+}
+
+static void touchFilter_addSample(touchFilter_t *filter, const touchFilter_sample_t *sample) {
+  if (sample->z < filter->minZ) {
+    filter->rejectedCount++;
+    return;
+  }
+  filter->acceptedCount++;
+  filter->window[filter->next] = *sample;
+  filter->next = (filter->next + 1) % TOUCHFILTER_MEDIAN_SAMPLES;
+  filter->z = sample->z;
+  if (filter->count < TOUCHFILTER_MEDIAN_SAMPLES) {
+    if (++filter->count < TOUCHFILTER_MEDIAN_SAMPLES)
+      return;
+    // The window just filled: start the IIR at its median.
+    filter->filteredX = (int32_t) touchFilter_median(filter, false) << TOUCHFILTER_FRACTION_BITS;
+    filter->filteredY = (int32_t) touchFilter_median(filter, true) << TOUCHFILTER_FRACTION_BITS;
+  }
+  int32_t medianX = (int32_t) touchFilter_median(filter, false) << TOUCHFILTER_FRACTION_BITS;
+  int32_t medianY = (int32_t) touchFilter_median(filter, true) << TOUCHFILTER_FRACTION_BITS;
+  filter->filteredX += (medianX - filter->filteredX) >> TOUCHFILTER_IIR_SHIFT;
+  filter->filteredY += (medianY - filter->filteredY) >> TOUCHFILTER_IIR_SHIFT;
+  int32_t dx = medianX - filter->filteredX, dy = medianY - filter->filteredY;
+  int32_t limit = TOUCHFILTER_STABLE_DISTANCE << TOUCHFILTER_FRACTION_BITS;
+  if ((dx <= limit) && (dx >= -limit) && (dy <= limit) && (dy >= -limit)) {
+    if (++filter->stableCount >= TOUCHFILTER_STABLE_SAMPLES)
+      filter->converged = true;
+  } else {
+    filter->stableCount = 0;
+  }
+}
+
+bool touchFilter_addSamples(touchFilter_t *filter, const touchFilter_sample_t *samples, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++)
+    touchFilter_addSample(filter, &samples[i]);
+  return filter->converged;
+}
+
+bool touchFilter_getPoint(const touchFilter_t *filter, int16_t *x, int16_t *y, uint8_t *z) {
+  if (filter->count == 0)
+    return false;
+  if (filter->count < TOUCHFILTER_MEDIAN_SAMPLES) {
+    *x = touchFilter_median(filter, false);
+    *y = touchFilter_median(filter, true);
+  } else {  // Rounded to the nearest raw unit.
+    *x = (filter->filteredX + (1 << (TOUCHFILTER_FRACTION_BITS - 1))) >> TOUCHFILTER_FRACTION_BITS;
+    *y = (filter->filteredY + (1 << (TOUCHFILTER_FRACTION_BITS - 1))) >> TOUCHFILTER_FRACTION_BITS;
+  }
+  *z = filter->z;
+  return true;
+}
+
+bool touchFilter_isConverged(const touchFilter_t *filter) {
+  return filter->converged;
+}
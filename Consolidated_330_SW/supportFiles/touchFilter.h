@@ -0,0 +1,55 @@
+/*
+ * touchFilter.h
+ */
+
+#ifndef TOUCHFILTER_H_
+#define TOUCHFILTER_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// Smooths the raw samples of one touch. A sample lighter than the minimum pressure (z) is thrown
+// away: a finger landing or lifting, or a brush, gives a light, wrong reading. The rest go through
+// a median of the last TOUCHFILTER_MEDIAN_SAMPLES, which drops the odd spike, and then an IIR low
+// pass, which takes out the noise. The filter has converged once the window is full and the median
+// has stayed close to the IIR output for TOUCHFILTER_STABLE_SAMPLES samples in a row, which takes
+// as long as the panel needs to settle and no longer (the fixed settle delays the apps used to wait
+// had to cover the worst case). Integer only, so it can run in the touch ISR. Samples are fed in
+// batches, as they come out of the controller's FIFO.
+
+#define TOUCHFILTER_MEDIAN_SAMPLES 5     // Odd.
+#define TOUCHFILTER_IIR_SHIFT 2          // Each sample moves the output 1/4 of the way to the median.
+#define TOUCHFILTER_FRACTION_BITS 4      // Of the IIR state.
+#define TOUCHFILTER_STABLE_SAMPLES 3
+#define TOUCHFILTER_STABLE_DISTANCE 24   // Raw units (about 2 pixels) between the median and the output.
+#define TOUCHFILTER_DEFAULT_MIN_Z 16
+
+typedef struct {
+  int16_t x, y;  // Raw 12-bit touch-controller coordinates.
+  uint8_t z;
+} touchFilter_sample_t;
+
+typedef struct {
+  uint8_t minZ;
+  touchFilter_sample_t window[TOUCHFILTER_MEDIAN_SAMPLES];  // The last accepted samples.
+  uint8_t count;        // Accepted samples in the window.
+  uint8_t next;         // Where the next one goes.
+  int32_t filteredX, filteredY;  // IIR output, with TOUCHFILTER_FRACTION_BITS.
+  uint8_t z;            // Of the latest accepted sample.
+  uint8_t stableCount;  // Medians in a row within TOUCHFILTER_STABLE_DISTANCE of the output.
+  bool converged;       // Stays set until the next reset.
+  uint32_t acceptedCount, rejectedCount;  // Since the reset.
+} touchFilter_t;
+
+// Samples lighter than minZ are rejected.
+void touchFilter_init(touchFilter_t *filter, uint8_t minZ);
+// Forgets the current touch. Call it when a new touch begins.
+void touchFilter_reset(touchFilter_t *filter);
+// Feeds count samples, oldest first. Returns true if the filter has converged.
+bool touchFilter_addSamples(touchFilter_t *filter, const touchFilter_sample_t *samples, uint8_t count);
+// The filtered point in raw coordinates: the IIR output once the window is full, the median of the
+// samples so far before that. Returns false if no sample has been accepted since the reset.
+bool touchFilter_getPoint(const touchFilter_t *filter, int16_t *x, int16_t *y, uint8_t *z);
+bool touchFilter_isConverged(const touchFilter_t *filter);
+
+#endif /* TOUCHFILTER_H_ */
@@ -0,0 +1,313 @@
+/*
+ * ui.cpp
+ */
+
+#include "ui.h"
+#include "display.h"
+#include "Adafruit_GFX.h"
+#include <string.h>
+
+#define UI_GLYPH_COLUMNS 6
+#define UI_GLYPH_ROWS 8
+#define UI_CELL_INSET_DIVISOR 6  // Marks are inset by 1/6 of the cell on each side.
+
+static ui_widget_t *widgets = NULL;  // In z order, lowest first.
+static uint16_t background = DISPLAY_BLACK;
+
+void ui_init(uint16_t bg) {
+  widgets = NULL;
+  background = bg;
+}
+
+// Fills in the fields every widget has and adds it to the list after the widgets with the same or
+// a lower z, so that (with equal z) widgets added later are painted later.
+static ui_widget_t *ui_add(ui_widget_t *widget, ui_widgetType_t type, ui_widget_t *parent, int8_t z,
+  int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+  widget->type = type;
+  widget->parent = parent;
+  widget->z = (parent && (parent->z > z)) ? parent->z : z;  // Children are never under their parent.
+  widget->x = x;
+  widget->y = y;
+  widget->w = w;
+  widget->h = h;
+  widget->color = color;
+  widget->bg = bg;
+  widget->textSize = 1;
+  widget->shape = UI_SHAPE_RECT;
+  widget->visible = true;
+  widget->dirty = true;
+  widget->painted = false;
+  widget->repaintAll = true;
+  widget->text[0] = '\0';
+  widget->shown[0] = '\0';
+  ui_widget_t **link = &widgets;
+  while (*link && ((*link)->z <= widget->z))
+    link = &(*link)->next;
+  widget->next = *link;
+  *link = widget;
+  return widget;
+}
+
+ui_widget_t *ui_addLabel(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, const char *text, uint8_t textSize, uint16_t color, uint16_t bg) {
+  ui_add(widget, UI_LABEL, parent, z, x, y, w, UI_GLYPH_ROWS * textSize, color, bg);
+  widget->textSize = textSize;
+  ui_setText(widget, text);
+  return widget;
+}
+
+ui_widget_t *ui_addButton(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, int16_t h, ui_shape_t shape, uint16_t color) {
+  ui_add(widget, UI_BUTTON, parent, z, x, y, w, h, color, background);
+  widget->shape = shape;
+  return widget;
+}
+
+ui_widget_t *ui_addGridCell(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+  ui_add(widget, UI_GRID_CELL, parent, z, x, y, w, h, color, bg);
+  ui_setMark(widget, ' ');
+  return widget;
+}
+
+ui_widget_t *ui_addDigit(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  char c, uint8_t textSize, uint16_t color, uint16_t bg) {
+  ui_add(widget, UI_DIGIT, parent, z, x, y, UI_GLYPH_COLUMNS * textSize, UI_GLYPH_ROWS * textSize,
+    color, bg);
+  widget->textSize = textSize;
+  ui_setDigit(widget, c);
+  return widget;
+}
+
+void ui_setText(ui_widget_t *widget, const char *text) {
+  char cut[UI_LABEL_MAX_LENGTH + 1];
+  size_t length = widget->w / (UI_GLYPH_COLUMNS * widget->textSize);
+  if (length > UI_LABEL_MAX_LENGTH)
+    length = UI_LABEL_MAX_LENGTH;
+  strncpy(cut, text, length);  // The characters that fit in the box.
+  cut[length] = '\0';
+  if (!strcmp(widget->text, cut))
+    return;
+  strcpy(widget->text, cut);
+  widget->dirty = true;
+}
+
+void ui_setDigit(ui_widget_t *widget, char c) {
+  if ((widget->text[0] == c) && (widget->text[1] == '\0'))
+    return;
+  widget->text[0] = c;
+  widget->text[1] = '\0';
+  widget->dirty = true;
+}
+
+void ui_setMark(ui_widget_t *widget, char mark) {
+  ui_setDigit(widget, mark);
+}
+
+void ui_setColor(ui_widget_t *widget, uint16_t color) {
+  if (widget->color == color)
+    return;
+  widget->color = color;
+  ui_invalidate(widget);
+}
+
+// Invalidates widget and every widget under it in the tree.
+void ui_setVisible(ui_widget_t *widget, bool visible) {
+  if (widget->visible == visible)
+    return;
+  widget->visible = visible;
+  for (ui_widget_t *w = widgets; w; w = w->next)
+    for (ui_widget_t *a = w; a; a = a->parent)
+      if (a == widget)
+        ui_invalidate(w);
+}
+
+void ui_invalidate(ui_widget_t *widget) {
+  widget->dirty = true;
+  widget->repaintAll = true;
+}
+
+bool ui_isShown(const ui_widget_t *widget) {
+  for (; widget; widget = widget->parent)
+    if (!widget->visible)
+      return false;
+  return true;
+}
+
+ui_widget_t *ui_hitTest(int16_t x, int16_t y) {
+  ui_widget_t *hit = NULL;
+  for (ui_widget_t *w = widgets; w; w = w->next)
+    if ((x >= w->x) && (x < w->x + w->w) && (y >= w->y) && (y < w->y + w->h) && ui_isShown(w))
+      hit = w;  // The list is in z order: the last hit is on top.
+  return hit;
+}
+
+static bool ui_overlap(const ui_widget_t *a, const ui_widget_t *b) {
+  return (a->x < b->x + b->w) && (b->x < a->x + a->w) && (a->y < b->y + b->h) && (b->y < a->y + a->h);
+}
+
+// True if the widget will fill its box with the background (it was hidden).
+static bool ui_erasing(const ui_widget_t *widget) {
+  return widget->painted && !ui_isShown(widget);
+}
+
+// True if a must be painted before b where they overlap: erasing comes first, then z, then the
+// order the widgets were added in.
+static bool ui_paintsBefore(const ui_widget_t *a, const ui_widget_t *b) {
+  if (ui_erasing(a) != ui_erasing(b))
+    return ui_erasing(a);
+  if (a->z != b->z)
+    return a->z < b->z;
+  for (const ui_widget_t *w = a->next; w; w = w->next)
+    if (w == b)
+      return true;
+  return false;
+}
+
+// Paints the font dots of new that differ from old, as rectangles: a run down a font column,
+// widened to the right while the next columns change the same way.
+static void ui_paintGlyphChange(const ui_widget_t *widget, char old, char c) {
+  uint8_t changed[UI_GLYPH_COLUMNS], ink[UI_GLYPH_COLUMNS];
+  uint8_t size = widget->textSize;
+  for (uint8_t i = 0; i < UI_GLYPH_COLUMNS; i++) {
+    ink[i] = Adafruit_GFX::glyphColumn(c, i);
+    changed[i] = ink[i] ^ Adafruit_GFX::glyphColumn(old, i);
+  }
+  for (uint8_t i = 0; i < UI_GLYPH_COLUMNS; i++) {
+    while (changed[i]) {
+      uint8_t top = 0, bottom;
+      while (!(changed[i] & (1 << top)))
+        top++;
+      uint8_t on = ink[i] & (1 << top);
+      for (bottom = top + 1; bottom < UI_GLYPH_ROWS; bottom++)
+        if (!(changed[i] & (1 << bottom)) || ((ink[i] & (1 << bottom)) ? !on : on))
+          break;
+      uint8_t rows = ((1 << bottom) - 1) & ~((1 << top) - 1);
+      uint8_t right = i + 1;
+      while ((right < UI_GLYPH_COLUMNS) && ((changed[right] & rows) == rows) &&
+             ((ink[right] & rows) == (on ? rows : 0)))
+        right++;
+      for (uint8_t j = i; j < right; j++)
+        changed[j] &= ~rows;
+      display_fillRect(widget->x + i * size, widget->y + top * size, (right - i) * size,
+        (bottom - top) * size, on ? widget->color : widget->bg);
+    }
+  }
+}
+
+// Draws an 'X' or an 'O' (anything else draws nothing) in the cell.
+static void ui_drawMark(const ui_widget_t *widget, char mark, uint16_t color) {
+  int16_t side = (widget->w < widget->h) ? widget->w : widget->h;
+  int16_t inset = side / UI_CELL_INSET_DIVISOR;
+  int16_t x1 = widget->x + inset, y1 = widget->y + inset;
+  int16_t x2 = widget->x + widget->w - 1 - inset, y2 = widget->y + widget->h - 1 - inset;
+  if (mark == 'X') {
+    display_drawLine(x1, y1, x2, y2, color);
+    display_drawLine(x1, y2, x2, y1, color);
+  } else if (mark == 'O') {
+    display_drawCircle(widget->x + widget->w / 2, widget->y + widget->h / 2, side / 2 - inset, color);
+  }
+}
+
+static void ui_paintLabel(ui_widget_t *widget) {
+  int16_t charWidth = UI_GLYPH_COLUMNS * widget->textSize;
+  size_t length = strlen(widget->text), shownLength = strlen(widget->shown);
+  for (size_t i = 0; i < length; i++)
+    if (widget->repaintAll || (i >= shownLength) || (widget->text[i] != widget->shown[i]))
+      display_drawChar(widget->x + i * charWidth, widget->y, widget->text[i], widget->color, widget->bg,
+        widget->textSize);
+  // Clear what the text no longer covers: the whole rest of the box the first time.
+  int16_t end = widget->repaintAll ? widget->w : shownLength * charWidth;
+  if (end > (int16_t) length * charWidth)
+    display_fillRect(widget->x + length * charWidth, widget->y, end - length * charWidth, widget->h,
+      widget->bg);
+}
+
+static void ui_paintButton(const ui_widget_t *widget) {
+  int16_t x2 = widget->x + widget->w - 1, y2 = widget->y + widget->h - 1;
+  int16_t apex = widget->x + (widget->w - 1) / 2;
+  switch (widget->shape) {
+  case UI_SHAPE_TRIANGLE_UP:
+    display_fillTriangle(widget->x, y2, x2, y2, apex, widget->y, widget->color);
+    break;
+  case UI_SHAPE_TRIANGLE_DOWN:
+    display_fillTriangle(widget->x, widget->y, x2, widget->y, apex, y2, widget->color);
+    break;
+  default:
+    display_fillRect(widget->x, widget->y, widget->w, widget->h, widget->color);
+    break;
+  }
+}
+
+static void ui_paint(ui_widget_t *widget) {
+  if (ui_erasing(widget)) {
+    display_fillRect(widget->x, widget->y, widget->w, widget->h, background);
+    widget->painted = false;
+    widget->repaintAll = true;
+    return;
+  }
+  if (!ui_isShown(widget))
+    return;
+  switch (widget->type) {
+  case UI_LABEL:
+    ui_paintLabel(widget);
+    break;
+  case UI_BUTTON:
+    ui_paintButton(widget);
+    break;
+  case UI_GRID_CELL:
+    if (!widget->repaintAll)
+      ui_drawMark(widget, widget->shown[0], widget->bg);
+    ui_drawMark(widget, widget->text[0], widget->color);
+    break;
+  case UI_DIGIT:
+    if (widget->repaintAll)
+      display_drawChar(widget->x, widget->y, widget->text[0], widget->color, widget->bg, widget->textSize);
+    else
+      ui_paintGlyphChange(widget, widget->shown[0], widget->text[0]);
+    break;
+  }
+  strcpy(widget->shown, widget->text);
+  widget->painted = true;
+  widget->repaintAll = false;
+}
+
+void ui_render() {
+  // A widget that is repainted or erased covers whatever overlaps it, so those widgets are
+  // repainted in full afterwards: those above it, and anything an erased widget uncovers.
+  bool spread = true;
+  while (spread) {
+    spread = false;
+    for (ui_widget_t *d = widgets; d; d = d->next) {
+      if (!d->dirty || !(d->painted || ui_isShown(d)))
+        continue;
+      for (ui_widget_t *o = widgets; o; o = o->next) {
+        if ((o == d) || (o->dirty && o->repaintAll) || !ui_isShown(o) || !ui_overlap(d, o))
+          continue;
+        if (ui_erasing(d) || ui_paintsBefore(d, o)) {
+          ui_invalidate(o);
+          spread = true;
+        }
+      }
+    }
+  }
+  // Paint every widget whose overlapping widgets that go first are done, top to bottom and left
+  // to right among those, so that neighbors on a row follow each other.
+  while (true) {
+    ui_widget_t *next = NULL;
+    for (ui_widget_t *w = widgets; w; w = w->next) {
+      if (!w->dirty)
+        continue;
+      bool ready = true;
+      for (ui_widget_t *o = widgets; o && ready; o = o->next)
+        if ((o != w) && o->dirty && ui_overlap(o, w) && ui_paintsBefore(o, w))
+          ready = false;
+      if (ready && (!next || (w->y < next->y) || ((w->y == next->y) && (w->x < next->x))))
+        next = w;
+    }
+    if (!next)
+      break;
+    ui_paint(next);
+    next->dirty = false;
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * ui.h
+ */
+
+#ifndef UI_H_
+#define UI_H_
+
+#include <stdbool.h>
+#include "arduinoTypes.h"
+
+// A small retained-mode widget layer on top of display.h. The app keeps its widgets in static
+// ui_widget_t variables, adds them once, and afterwards only changes their state (text, digit,
+// mark, color, visibility); each change invalidates the widget. ui_render() then repaints only the
+// invalidated widgets, and within a widget only what changed: a digit repaints the font dots that
+// differ, a label the characters that differ, a grid cell erases the old mark and draws the new one.
+//
+// Widgets are painted in z order where they overlap, and otherwise top to bottom, left to right, so
+// that consecutive widgets on a row reuse the LCD address window rows (see lcdDrivers.h). A widget
+// is shown only if its parent (if any) is shown too. Buttons and grid cells only paint their shape
+// or mark: the rest of their box is the background the app (or a parent) painted. Hiding a widget
+// fills its box with the background color given to ui_init().
+
+#define UI_LABEL_MAX_LENGTH 32  // Characters a label keeps (longer text is cut).
+
+typedef enum {
+  UI_LABEL,      // Opaque text, one line.
+  UI_BUTTON,     // A filled shape (see ui_shape_t).
+  UI_GRID_CELL,  // An 'X', an 'O' or nothing (' '), drawn with lines like the TicTacToe board.
+  UI_DIGIT       // One opaque character (usually a digit) that changes often.
+} ui_widgetType_t;
+
+typedef enum {
+  UI_SHAPE_RECT,
+  UI_SHAPE_TRIANGLE_UP,    // Base along the bottom of the box, apex at the middle of the top.
+  UI_SHAPE_TRIANGLE_DOWN   // Base along the top of the box, apex at the middle of the bottom.
+} ui_shape_t;
+
+typedef struct ui_widget {
+  ui_widgetType_t   type;
+  struct ui_widget *parent;   // NULL for a top-level widget.
+  struct ui_widget *next;     // Widget list, in z order.
+  int16_t           x, y, w, h;  // Bounding box, in screen coordinates.
+  int8_t            z;        // Higher z is painted over lower z.
+  uint16_t          color, bg;
+  uint8_t           textSize;
+  ui_shape_t        shape;
+  bool              visible;  // As set by the app (see ui_isShown()).
+  bool              dirty;    // Invalidated since the last ui_render().
+  bool              painted;  // Currently on the screen.
+  bool              repaintAll;  // Repaint all of it, not just what changed.
+  char              text[UI_LABEL_MAX_LENGTH + 1];   // Label text, digit or mark in text[0].
+  char              shown[UI_LABEL_MAX_LENGTH + 1];  // What is on the screen now.
+} ui_widget_t;
+
+// Forgets all widgets. bg is what a hidden widget leaves behind.
+void ui_init(uint16_t bg);
+
+// Each of these sets up the widget, adds it (visible and invalidated) and returns it.
+ui_widget_t *ui_addLabel(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, const char *text, uint8_t textSize, uint16_t color, uint16_t bg);
+ui_widget_t *ui_addButton(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, int16_t h, ui_shape_t shape, uint16_t color);
+ui_widget_t *ui_addGridCell(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  int16_t w, int16_t h, uint16_t color, uint16_t bg);
+ui_widget_t *ui_addDigit(ui_widget_t *widget, ui_widget_t *parent, int8_t z, int16_t x, int16_t y,
+  char c, uint8_t textSize, uint16_t color, uint16_t bg);
+
+// State changes. Each invalidates the widget if something actually changed.
+void ui_setText(ui_widget_t *widget, const char *text);  // UI_LABEL
+void ui_setDigit(ui_widget_t *widget, char c);           // UI_DIGIT
+void ui_setMark(ui_widget_t *widget, char mark);         // UI_GRID_CELL: 'X', 'O' or ' '
+void ui_setColor(ui_widget_t *widget, uint16_t color);
+void ui_setVisible(ui_widget_t *widget, bool visible);   // Also hides or shows its children.
+void ui_invalidate(ui_widget_t *widget);                 // Repaint all of it.
+
+// True if the widget and all of its parents are visible.
+bool ui_isShown(const ui_widget_t *widget);
+
+// The topmost shown widget whose box contains (x, y), or NULL.
+ui_widget_t *ui_hitTest(int16_t x, int16_t y);
+
+// Repaints the invalidated widgets. Call it once per frame, after the state changes.
+void ui_render();
+
+#endif /* UI_H_ */
@@ -7,11 +7,11 @@
 
 // This will hold various utility functions that don't have an obvious home elsewhere.
 
-// This provides an accurate ms delay. Number was computed via experimentation and
-// measuDISPLAY_RED with the intervalTimer package.
-#define MS_LOOP_MULTIPLIER 55310
+#include "hal.h"
+
+// This provides an accurate ms delay. The calibrated busy-wait lives in the HAL so that
+// the simulator can let simulated time pass instead.
 void utils_msDelay(long msDelay) {
-  volatile int i;
-  for (i=0; i<msDelay*MS_LOOP_MULTIPLIER; i++);
+  hal_msDelay(msDelay);
 }
 